@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/atomic.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -78,8 +79,9 @@ public:
 	 *
 	 * @param paused true, when the channel should be paused.
 	 *               false when it should be unpaused.
+	 * @param millis the time the request was made at, in milliseconds.
 	 */
-	void pause(bool paused);
+	void pause(bool paused, uint32 millis);
 
 	/**
 	 * Queries whether the channel is currently paused.
@@ -115,15 +117,17 @@ public:
 	int8 getBalance();
 
 	/**
-	 * Notifies the channel that the global sound type
-	 * volume settings changed.
+	 * Sets the volume of the channel's sound type, which is
+	 * 0 when the type is muted.
+	 *
+	 * @param volume new sound type volume
 	 */
-	void notifyGlobalVolChange() { updateChannelVolumes(); }
+	void setSoundTypeVolume(int volume);
 
 	/**
-	 * Queries how long the channel has been playing.
+	 * Stores the data MixerImpl::getElapsedTime() needs.
 	 */
-	Timestamp getElapsedTime();
+	void getTiming(ChannelTiming &timing) const;
 
 	/**
 	 * Queries the channel's sound type.
@@ -151,6 +155,7 @@ private:
 
 	byte _volume;
 	int8 _balance;
+	int _soundTypeVolume;
 
 	void updateChannelVolumes();
 	st_volume_t _volL, _volR;
@@ -173,15 +178,24 @@ private:
 
 
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _syst(system), _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _syst(system), _queueMutex(), _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		_channelState[i].handle = kInvalidHandle;
 		_channels[i] = 0;
+		_finishedHandle[i] = kInvalidHandle;
+
+		_channelTiming[i].sequence = 0;
+		_channelTiming[i].handle = kInvalidHandle;
+	}
 }
 
 MixerImpl::~MixerImpl() {
+	// Pick up channels which were started after the last mixCallback()
+	applyCommands();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
 }
@@ -194,27 +208,164 @@ uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
 
-void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
-	int index = -1;
+bool MixerImpl::isSlotActive(int index) const {
+	const uint32 handle = _channelState[index].handle;
+	return handle != kInvalidHandle && Common::atomicLoad(_finishedHandle[index]) != handle;
+}
+
+int MixerImpl::findFreeSlot() const {
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] == 0) {
-			index = i;
-			break;
+		if (!isSlotActive(i))
+			return i;
+	}
+	return -1;
+}
+
+int MixerImpl::findSlot(SoundHandle handle) const {
+	const int index = handle._val % NUM_CHANNELS;
+	if (_channelState[index].handle != handle._val || !isSlotActive(index))
+		return -1;
+	return index;
+}
+
+void MixerImpl::queueCommand(const Command &cmd) {
+	if (!_commands.push(cmd)) {
+		// The mixing thread is not keeping up (or not running at all),
+		// so catch up on its behalf.
+		Common::StackLock lock(_mutex);
+		applyCommands();
+		applyCommand(cmd);
+	}
+}
+
+void MixerImpl::queueChannelCommand(Command::Type type, int index, int value) {
+	Command cmd;
+	cmd.type = type;
+	cmd.slot = index;
+	cmd.handle = _channelState[index].handle;
+	cmd.value = value;
+	if (type == Command::kPause) {
+		cmd.millis = g_system->getMillis();
+
+		// Keep track of the pause level like Channel::pause() does, so that
+		// getElapsedTime() stops right away instead of once the command
+		// has been applied
+		ChannelState &state = _channelState[index];
+		if (value) {
+			if (!state.pauseLevel++)
+				state.pauseStartTime = cmd.millis;
+		} else if (state.pauseLevel > 0 && !--state.pauseLevel) {
+			state.resumeTime = cmd.millis;
 		}
 	}
+	queueCommand(cmd);
+}
+
+void MixerImpl::queueSoundTypeVolume(SoundType type) {
+	Command cmd;
+	cmd.type = Command::kSetSoundTypeVolume;
+	cmd.soundType = type;
+	cmd.value = _soundTypeSettings[type].mute ? 0 : _soundTypeSettings[type].volume;
+	queueCommand(cmd);
+}
+
+void MixerImpl::applyCommands() {
+	Command cmd;
+	while (_commands.pop(cmd))
+		applyCommand(cmd);
+}
+
+void MixerImpl::applyCommand(const Command &cmd) {
+	if (cmd.type == Command::kPlay) {
+		// The slot was freed by a stop or by the mixing thread before
+		// the engine side handed it out again.
+		assert(!_channels[cmd.slot]);
+		_channels[cmd.slot] = cmd.channel;
+		return;
+	}
+
+	if (cmd.type == Command::kSetSoundTypeVolume) {
+		for (int i = 0; i != NUM_CHANNELS; ++i) {
+			if (_channels[i] && _channels[i]->getType() == cmd.soundType)
+				_channels[i]->setSoundTypeVolume(cmd.value);
+		}
+		return;
+	}
+
+	// Simply ignore requests for sounds which terminated in the meantime
+	Channel *chan = _channels[cmd.slot];
+	if (!chan || chan->getHandle()._val != cmd.handle)
+		return;
+
+	switch (cmd.type) {
+	case Command::kPause:
+		chan->pause(cmd.value != 0, cmd.millis);
+		break;
+	case Command::kSetVolume:
+		chan->setVolume(cmd.value);
+		break;
+	case Command::kSetBalance:
+		chan->setBalance(cmd.value);
+		break;
+	default:
+		break;
+	}
+}
+
+void MixerImpl::stopChannel(int index) {
+	_channelState[index].handle = kInvalidHandle;
+
+	delete _channels[index];
+	_channels[index] = 0;
+	publishTiming(index);
+}
+
+void MixerImpl::publishTiming(int index) {
+	ChannelTiming &timing = _channelTiming[index];
+
+	Common::atomicStore(timing.sequence, timing.sequence + 1);
+	Common::memoryBarrier();
+
+	if (_channels[index])
+		_channels[index]->getTiming(timing);
+	else
+		timing.handle = kInvalidHandle;
+
+	Common::atomicStore(timing.sequence, timing.sequence + 1);
+}
+
+void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
+	const int index = findFreeSlot();
 	if (index == -1) {
 		warning("MixerImpl::out of mixer slots");
 		delete chan;
 		return;
 	}
 
-	_channels[index] = chan;
-
 	SoundHandle chanHandle;
 	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
 
 	chan->setHandle(chanHandle);
 	_handleSeed++;
+
+	ChannelState &state = _channelState[index];
+	state.handle = chanHandle._val;
+	state.id = chan->getId();
+	state.type = chan->getType();
+	state.volume = chan->getVolume();
+	state.balance = chan->getBalance();
+	state.permanent = chan->isPermanent();
+	state.pauseLevel = 0;
+	state.pauseStartTime = 0;
+	state.resumeTime = 0;
+
+	Command cmd;
+	cmd.type = Command::kPlay;
+	cmd.slot = index;
+	cmd.handle = chanHandle._val;
+	cmd.channel = chan;
+	queueCommand(cmd);
+
 	if (handle)
 		*handle = chanHandle;
 }
@@ -227,7 +378,7 @@ void MixerImpl::playStream(
 			DisposeAfterUse::Flag autofreeStream,
 			bool permanent,
 			bool reverseStereo) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
 
 	if (stream == 0) {
 		warning("stream is 0");
@@ -240,7 +391,7 @@ void MixerImpl::playStream(
 	// Prevent duplicate sounds
 	if (id != -1) {
 		for (int i = 0; i != NUM_CHANNELS; i++)
-			if (_channels[i] != 0 && _channels[i]->getId() == id) {
+			if (isSlotActive(i) && _channelState[i].id == id) {
 				// Delete the stream if were asked to auto-dispose it.
 				// Note: This could cause trouble if the client code does not
 				// yet expect the stream to be gone. The primary example to
@@ -257,10 +408,12 @@ void MixerImpl::playStream(
 	reverseStereo = !reverseStereo;
 #endif
 
-	// Create the channel
+	// Create the channel. This happens here rather than in the mixing
+	// thread, so that the latter never has to allocate memory.
 	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
+	chan->setSoundTypeVolume(_soundTypeSettings[type].mute ? 0 : _soundTypeSettings[type].volume);
 	insertChannel(handle, chan);
 }
 
@@ -280,64 +433,73 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	//  zero the buf
 	memset(buf, 0, 2 * len * sizeof(int16));
 
+	applyCommands();
+
 	// mix all channels
 	int res = 0, tmp;
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
+				const uint32 handle = _channels[i]->getHandle()._val;
 				delete _channels[i];
 				_channels[i] = 0;
+
+				// Lets the engine side reuse the slot
+				Common::atomicStore(_finishedHandle[i], handle);
 			} else if (!_channels[i]->isPaused()) {
 				tmp = _channels[i]->mix(buf, len);
 
 				if (tmp > res)
 					res = tmp;
 			}
+
+			publishTiming(i);
 		}
 
 	return res;
 }
 
 void MixerImpl::stopAll() {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
+	Common::StackLock mixLock(_mutex);
+	applyCommands();
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_channels[i] != 0 && !_channels[i]->isPermanent())
+			stopChannel(i);
 	}
 }
 
 void MixerImpl::stopID(int id) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
+	Common::StackLock mixLock(_mutex);
+	applyCommands();
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_channels[i] != 0 && _channels[i]->getId() == id)
+			stopChannel(i);
 	}
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
 
 	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findSlot(handle);
+	if (index == -1)
 		return;
 
-	delete _channels[index];
-	_channels[index] = 0;
+	Common::StackLock mixLock(_mutex);
+	applyCommands();
+	stopChannel(index);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= type && type < ARRAYSIZE(_soundTypeSettings));
-	_soundTypeSettings[type].mute = mute;
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	Common::StackLock lock(_queueMutex);
+	_soundTypeSettings[type].mute = mute;
+	queueSoundTypeVolume(type);
 }
 
 bool MixerImpl::isSoundTypeMuted(SoundType type) const {
@@ -346,39 +508,45 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findSlot(handle);
+	if (index == -1)
 		return;
 
-	_channels[index]->setVolume(volume);
+	_channelState[index].volume = volume;
+	queueChannelCommand(Command::kSetVolume, index, volume);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_queueMutex);
+
+	const int index = findSlot(handle);
+	if (index == -1)
 		return 0;
 
-	return _channels[index]->getVolume();
+	return _channelState[index].volume;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findSlot(handle);
+	if (index == -1)
 		return;
 
-	_channels[index]->setBalance(balance);
+	_channelState[index].balance = balance;
+	queueChannelCommand(Command::kSetBalance, index, balance);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_queueMutex);
+
+	const int index = findSlot(handle);
+	if (index == -1)
 		return 0;
 
-	return _channels[index]->getBalance();
+	return _channelState[index].balance;
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -386,71 +554,116 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 }
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return Timestamp(0, _sampleRate);
+	Timestamp ts(0, _sampleRate);
+
+	const int index = findSlot(handle);
+	if (index == -1)
+		return ts;
 
-	return _channels[index]->getElapsedTime();
+	// Take a consistent copy of what the mixing thread published last,
+	// retrying if it was updated while we were reading it.
+	const ChannelTiming &timing = _channelTiming[index];
+	ChannelTiming snapshot;
+	uint32 sequence;
+	do {
+		sequence = Common::atomicLoad(timing.sequence);
+		snapshot.handle = timing.handle;
+		snapshot.samplesConsumed = timing.samplesConsumed;
+		snapshot.mixerTimeStamp = timing.mixerTimeStamp;
+		snapshot.pauseStartTime = timing.pauseStartTime;
+		snapshot.pauseTime = timing.pauseTime;
+		snapshot.paused = timing.paused;
+		Common::memoryBarrier();
+	} while ((sequence & 1) || Common::atomicLoad(timing.sequence) != sequence);
+
+	// The channel has not been mixed yet
+	if (snapshot.handle != handle._val || snapshot.mixerTimeStamp == 0)
+		return ts;
+
+	// Pause commands the mixing thread has not applied yet are taken into
+	// account, so that the time never goes back once they are
+	const ChannelState &state = _channelState[index];
+	uint32 delta;
+	if (state.pauseLevel) {
+		// The buffer mixed last may have started after the pause was queued
+		delta = MAX<int32>(0, (int32)(state.pauseStartTime - snapshot.mixerTimeStamp));
+	} else if (snapshot.paused) {
+		// Resumed, but the mixing thread doesn't know yet
+		delta = snapshot.pauseStartTime - snapshot.mixerTimeStamp + (g_system->getMillis() - state.resumeTime);
+	} else {
+		delta = g_system->getMillis() - snapshot.mixerTimeStamp - snapshot.pauseTime;
+	}
+
+	// Convert the number of samples into a time duration.
+
+	ts = ts.addFrames(snapshot.samplesConsumed);
+	ts = ts.addMsecs(delta);
+
+	// In theory it would seem like a good idea to limit the approximation
+	// so that it never exceeds the theoretical upper bound set by
+	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
+	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
+	// isn't invoked at the regular intervals that I first imagined.
+
+	return ts;
 }
 
 void MixerImpl::pauseAll(bool paused) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0) {
-			_channels[i]->pause(paused);
-		}
+		if (isSlotActive(i))
+			queueChannelCommand(Command::kPause, i, paused);
 	}
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			_channels[i]->pause(paused);
+		if (isSlotActive(i) && _channelState[i].id == id) {
+			queueChannelCommand(Command::kPause, i, paused);
 			return;
 		}
 	}
 }
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
 
 	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findSlot(handle);
+	if (index == -1)
 		return;
 
-	_channels[index]->pause(paused);
+	queueChannelCommand(Command::kPause, index, paused);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getId() == id)
+		if (isSlotActive(i) && _channelState[i].id == id)
 			return true;
 	return false;
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
-		return _channels[index]->getId();
+	Common::StackLock lock(_queueMutex);
+	const int index = findSlot(handle);
+	if (index != -1)
+		return _channelState[index].id;
 	return 0;
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	Common::StackLock lock(_queueMutex);
+	return findSlot(handle) != -1;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getType() == type)
+		if (isSlotActive(i) && _channelState[i].type == type)
 			return true;
 	return false;
 }
@@ -467,13 +680,9 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// TODO: Maybe we should do logarithmic (not linear) volume
 	// scaling? See also Player_V2::setMasterVolume
 
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_queueMutex);
 	_soundTypeSettings[type].volume = volume;
-
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	queueSoundTypeVolume(type);
 }
 
 int MixerImpl::getVolumeForSoundType(SoundType type) const {
@@ -490,7 +699,7 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
                  DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
     : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
-      _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
+      _balance(0), _soundTypeVolume(Mixer::kMaxMixerVolume), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
       _pauseStartTime(0), _pauseTime(0), _converter(0),
       _stream(stream, autofreeStream) {
 	assert(mixer);
@@ -522,6 +731,11 @@ int8 Channel::getBalance() {
 	return _balance;
 }
 
+void Channel::setSoundTypeVolume(int volume) {
+	_soundTypeVolume = volume;
+	updateChannelVolumes();
+}
+
 void Channel::updateChannelVolumes() {
 	// From the channel balance/volume and the global volume, we compute
 	// the effective volume for the left and right channel. Note the
@@ -531,68 +745,45 @@ void Channel::updateChannelVolumes() {
 	// volume is in the range 0 - kMaxMixerVolume.
 	// Hence, the vol_l/vol_r values will be in that range, too
 
-	if (!_mixer->isSoundTypeMuted(_type)) {
-		int vol = _mixer->getVolumeForSoundType(_type) * _volume;
-
-		if (_balance == 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = vol / Mixer::kMaxChannelVolume;
-		} else if (_balance < 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
-		} else {
-			_volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
-			_volR = vol / Mixer::kMaxChannelVolume;
-		}
+	int vol = _soundTypeVolume * _volume;
+
+	if (_balance == 0) {
+		_volL = vol / Mixer::kMaxChannelVolume;
+		_volR = vol / Mixer::kMaxChannelVolume;
+	} else if (_balance < 0) {
+		_volL = vol / Mixer::kMaxChannelVolume;
+		_volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
 	} else {
-		_volL = _volR = 0;
+		_volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
+		_volR = vol / Mixer::kMaxChannelVolume;
 	}
 }
 
-void Channel::pause(bool paused) {
+void Channel::pause(bool paused, uint32 millis) {
 	//assert((paused && _pauseLevel >= 0) || (!paused && _pauseLevel));
 
 	if (paused) {
 		_pauseLevel++;
 
 		if (_pauseLevel == 1)
-			_pauseStartTime = g_system->getMillis();
+			_pauseStartTime = millis;
 	} else if (_pauseLevel > 0) {
 		_pauseLevel--;
 
 		if (!_pauseLevel) {
-			_pauseTime = (g_system->getMillis() - _pauseStartTime);
+			_pauseTime = (millis - _pauseStartTime);
 			_pauseStartTime = 0;
 		}
 	}
 }
 
-Timestamp Channel::getElapsedTime() {
-	const uint32 rate = _mixer->getOutputRate();
-	uint32 delta = 0;
-
-	Audio::Timestamp ts(0, rate);
-
-	if (_mixerTimeStamp == 0)
-		return ts;
-
-	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
-	else
-		delta = g_system->getMillis() - _mixerTimeStamp - _pauseTime;
-
-	// Convert the number of samples into a time duration.
-
-	ts = ts.addFrames(_samplesConsumed);
-	ts = ts.addMsecs(delta);
-
-	// In theory it would seem like a good idea to limit the approximation
-	// so that it never exceeds the theoretical upper bound set by
-	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
-	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
-	// isn't invoked at the regular intervals that I first imagined.
-
-	return ts;
+void Channel::getTiming(ChannelTiming &timing) const {
+	timing.handle = _handle._val;
+	timing.samplesConsumed = _samplesConsumed;
+	timing.mixerTimeStamp = _mixerTimeStamp;
+	timing.pauseStartTime = _pauseStartTime;
+	timing.pauseTime = _pauseTime;
+	timing.paused = isPaused();
 }
 
 int Channel::mix(int16 *data, uint len) {
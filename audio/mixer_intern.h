@@ -25,10 +25,26 @@
 
 #include "common/scummsys.h"
 #include "common/mutex.h"
+#include "common/spsc-queue.h"
 #include "audio/mixer.h"
 
 namespace Audio {
 
+/**
+ * Playback position of a channel, as published by the mixing thread.
+ * @see MixerImpl::getElapsedTime()
+ */
+struct ChannelTiming {
+	volatile uint32 sequence;	///< Odd while the mixing thread updates the other fields
+
+	uint32 handle;
+	uint32 samplesConsumed;
+	uint32 mixerTimeStamp;
+	uint32 pauseStartTime;
+	uint32 pauseTime;
+	bool paused;
+};
+
 /**
  * The (default) implementation of the ScummVM audio mixing subsystem.
  *
@@ -46,17 +62,79 @@ namespace Audio {
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
  *
+ * Threading: the channels are owned by the thread running mixCallback().
+ * Engine threads never touch them directly; playStream(), the pause methods
+ * and the volume and balance setters push a command to a lock-free queue
+ * instead, which the mixing thread applies at the start of the next buffer.
+ * Queries are answered from a copy of the channel state which the engine
+ * side keeps up to date itself, plus the finished flags and playback
+ * positions the mixing thread publishes after each buffer. Only the stop
+ * methods still synchronize with the mixing thread, since callers expect
+ * to be able to free the stream data as soon as they return.
+ *
  * @see OSystem::getMixer()
  */
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 16
+		NUM_CHANNELS = 16,
+		COMMAND_QUEUE_SIZE = 256
+	};
+
+	enum {
+		kInvalidHandle = 0xFFFFFFFF
+	};
+
+	/**
+	 * A change requested by an engine thread, to be applied to the
+	 * channel in the given slot by the mixing thread.
+	 */
+	struct Command {
+		enum Type {
+			kPlay,
+			kPause,
+			kSetVolume,
+			kSetBalance,
+			kSetSoundTypeVolume
+		};
+
+		Command() : type(kPlay), slot(0), handle(kInvalidHandle), soundType(kPlainSoundType), value(0), millis(0), channel(0) {}
+
+		Type type;
+		int slot;
+		uint32 handle;
+		SoundType soundType;
+		int value;
+		uint32 millis;
+		Channel *channel;
+	};
+
+	/**
+	 * The engine side view of a channel slot. It is updated as soon as a
+	 * command is queued, so it already includes changes the mixing thread
+	 * has not applied yet. Only accessed with _queueMutex held.
+	 */
+	struct ChannelState {
+		uint32 handle;
+		int id;
+		SoundType type;
+		byte volume;
+		int8 balance;
+		bool permanent;
+		int pauseLevel;
+		uint32 pauseStartTime;	///< When the channel was last paused
+		uint32 resumeTime;	///< When the channel was last resumed
 	};
 
 	OSystem *_syst;
+
+	/** Serializes the engine threads, which are the producers of _commands. */
+	Common::Mutex _queueMutex;
+	/** Held while mixing and while applying commands outside mixCallback(). */
 	Common::Mutex _mutex;
 
+	Common::SPSCQueue<Command, COMMAND_QUEUE_SIZE> _commands;
+
 	const uint _sampleRate;
 	bool _mixerReady;
 	uint32 _handleSeed;
@@ -69,8 +147,17 @@ private:
 	};
 
 	SoundTypeSettings _soundTypeSettings[4];
+
+	// Engine side, guarded by _queueMutex
+	ChannelState _channelState[NUM_CHANNELS];
+
+	// Mixing side, guarded by _mutex
 	Channel *_channels[NUM_CHANNELS];
 
+	// Published by the mixing side
+	volatile uint32 _finishedHandle[NUM_CHANNELS];
+	ChannelTiming _channelTiming[NUM_CHANNELS];
+
 
 public:
 
@@ -122,6 +209,19 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	int findFreeSlot() const;
+	int findSlot(SoundHandle handle) const;
+	bool isSlotActive(int index) const;
+
+	void queueCommand(const Command &cmd);
+	void queueChannelCommand(Command::Type type, int index, int value);
+	void queueSoundTypeVolume(SoundType type);
+	void applyCommands();
+	void applyCommand(const Command &cmd);
+
+	void stopChannel(int index);
+	void publishTiming(int index);
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
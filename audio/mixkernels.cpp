@@ -0,0 +1,105 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/mixkernels.h"
+#include "audio/mixer.h"
+#include "common/frac.h"
+
+namespace Audio {
+
+static void mixStereoScalar(st_sample_t *dst, const st_sample_t *src, uint pairs, st_volume_t volL, st_volume_t volR, bool reverseStereo) {
+	const int left = reverseStereo ? 1 : 0;
+
+	for (; pairs > 0; --pairs) {
+		clampedAdd(dst[left    ], (src[0] * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(dst[left ^ 1], (src[1] * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+		dst += 2;
+		src += 2;
+	}
+}
+
+static void mixMonoScalar(st_sample_t *dst, const st_sample_t *src, uint samples, st_volume_t volL, st_volume_t volR) {
+	for (; samples > 0; --samples) {
+		clampedAdd(dst[0], (*src * (int)volL) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(dst[1], (*src * (int)volR) / Audio::Mixer::kMaxMixerVolume);
+		dst += 2;
+		src++;
+	}
+}
+
+static void interpolateScalar(st_sample_t *dst, const st_sample_t *last, const st_sample_t *cur, const uint16 *pos, uint count) {
+	for (uint i = 0; i < count; ++i)
+		dst[i] = (st_sample_t)(last[i] + (((cur[i] - last[i]) * (frac_t)pos[i] + FRAC_HALF) >> FRAC_BITS));
+}
+
+static const MixKernels s_mixKernelsScalar = {
+	mixStereoScalar,
+	mixMonoScalar,
+	interpolateScalar
+};
+
+const MixKernels &getScalarMixKernels() {
+	return s_mixKernelsScalar;
+}
+
+const MixKernels *getMixKernels(Common::CPUFeature feature) {
+	if (!Common::hasCPUFeature(feature))
+		return 0;
+
+	// The SIMD kernels saturate signed samples, so they cannot be used
+	// for unsigned output.
+#ifndef OUTPUT_UNSIGNED_AUDIO
+	switch (feature) {
+#ifdef USE_X86_SIMD
+	case Common::kCPUFeatureSSE2:
+		return &g_mixKernelsSSE2;
+	case Common::kCPUFeatureAVX2:
+		return &g_mixKernelsAVX2;
+#endif
+#ifdef USE_NEON
+	case Common::kCPUFeatureNEON:
+		return &g_mixKernelsNEON;
+#endif
+	default:
+		break;
+	}
+#endif
+
+	return 0;
+}
+
+const MixKernels &getMixKernels() {
+	// This is called once per converter flow() call, which is rare enough
+	// not to bother caching the result. It also means that benchmarks can
+	// switch kernels through Common::setCPUFeatureMask().
+	const MixKernels *kernels = getMixKernels(Common::kCPUFeatureAVX2);
+	if (!kernels)
+		kernels = getMixKernels(Common::kCPUFeatureSSE2);
+	if (!kernels)
+		kernels = getMixKernels(Common::kCPUFeatureNEON);
+	if (!kernels)
+		kernels = &s_mixKernelsScalar;
+
+	return *kernels;
+}
+
+} // End of namespace Audio
@@ -0,0 +1,93 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef SOUND_MIXKERNELS_H
+#define SOUND_MIXKERNELS_H
+
+#include "common/scummsys.h"
+#include "common/cpudetect.h"
+#include "audio/rate.h"
+
+namespace Audio {
+
+/**
+ * The inner loops of the rate converters. The converters first produce a
+ * block of resampled samples and then let these kernels do the per sample
+ * work, for which SIMD versions exist.
+ *
+ * All variants produce bit-identical output to the generic C++ code,
+ * including the rounding of the volume scaling and the saturation of the
+ * output samples.
+ */
+struct MixKernels {
+	/**
+	 * Scale interleaved stereo sample pairs by the left and right volume
+	 * and add them to dst, clamping the result. With reverseStereo the left
+	 * input channel goes to the right output channel and vice versa, the
+	 * volumes still apply to the input channels.
+	 */
+	void (*mixStereo)(st_sample_t *dst, const st_sample_t *src, uint pairs, st_volume_t volL, st_volume_t volR, bool reverseStereo);
+
+	/**
+	 * Like mixStereo, but for mono input which is played on both output
+	 * channels.
+	 */
+	void (*mixMono)(st_sample_t *dst, const st_sample_t *src, uint samples, st_volume_t volL, st_volume_t volR);
+
+	/**
+	 * Linear interpolation between two sets of samples:
+	 * dst[i] = last[i] + (((cur[i] - last[i]) * pos[i] + FRAC_HALF) >> FRAC_BITS)
+	 * where pos[i] is the fractional part of the position, i.e. < FRAC_ONE.
+	 */
+	void (*interpolate)(st_sample_t *dst, const st_sample_t *last, const st_sample_t *cur, const uint16 *pos, uint count);
+};
+
+/**
+ * Return the fastest kernels the host CPU supports.
+ */
+const MixKernels &getMixKernels();
+
+/**
+ * Return the generic C++ kernels.
+ */
+const MixKernels &getScalarMixKernels();
+
+/**
+ * Return the kernels for the given instruction set extension, or 0 if the
+ * build or the host CPU does not support them.
+ */
+const MixKernels *getMixKernels(Common::CPUFeature feature);
+
+#ifdef USE_X86_SIMD
+// Implemented in mixkernels_x86.cpp
+extern const MixKernels g_mixKernelsSSE2;
+extern const MixKernels g_mixKernelsAVX2;
+#endif
+
+#ifdef USE_NEON
+// Implemented in mixkernels_neon.cpp
+extern const MixKernels g_mixKernelsNEON;
+#endif
+
+} // End of namespace Audio
+
+#endif
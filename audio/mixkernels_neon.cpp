@@ -0,0 +1,111 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/mixkernels.h"
+
+#ifdef USE_NEON
+
+#include "common/frac.h"
+
+#include <arm_neon.h>
+
+namespace Audio {
+
+/**
+ * Compute (samples * volumes) / Mixer::kMaxMixerVolume with the same
+ * rounding as the C++ code (i.e. towards zero) and add the result to the
+ * eight samples at dst with saturation.
+ */
+static inline void scaleAndAddNEON(st_sample_t *dst, int16x8_t samples, int16x8_t volumes) {
+	int32x4_t p0 = vmull_s16(vget_low_s16(samples), vget_low_s16(volumes));
+	int32x4_t p1 = vmull_s16(vget_high_s16(samples), vget_high_s16(volumes));
+
+	// Add 255 to negative products so the shift truncates towards zero.
+	p0 = vaddq_s32(p0, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(p0, 31)), 24)));
+	p1 = vaddq_s32(p1, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(p1, 31)), 24)));
+
+	const int16x8_t scaled = vcombine_s16(vqmovn_s32(vshrq_n_s32(p0, 8)), vqmovn_s32(vshrq_n_s32(p1, 8)));
+	vst1q_s16(dst, vqaddq_s16(vld1q_s16(dst), scaled));
+}
+
+static void mixStereoNEON(st_sample_t *dst, const st_sample_t *src, uint pairs, st_volume_t volL, st_volume_t volR, bool reverseStereo) {
+	// Swapping the channels of the input, the volumes follow them.
+	const int16x4_t volPair = reverseStereo ? vreinterpret_s16_u32(vdup_n_u32((volL << 16) | volR))
+	                                        : vreinterpret_s16_u32(vdup_n_u32((volR << 16) | volL));
+	const int16x8_t volumes = vcombine_s16(volPair, volPair);
+	uint i = 0;
+
+	for (; i + 4 <= pairs; i += 4) {
+		int16x8_t samples = vld1q_s16(src + 2 * i);
+		if (reverseStereo)
+			samples = vrev32q_s16(samples);
+		scaleAndAddNEON(dst + 2 * i, samples, volumes);
+	}
+
+	getScalarMixKernels().mixStereo(dst + 2 * i, src + 2 * i, pairs - i, volL, volR, reverseStereo);
+}
+
+static void mixMonoNEON(st_sample_t *dst, const st_sample_t *src, uint samples, st_volume_t volL, st_volume_t volR) {
+	const int16x4_t volPair = vreinterpret_s16_u32(vdup_n_u32((volR << 16) | volL));
+	const int16x8_t volumes = vcombine_s16(volPair, volPair);
+	uint i = 0;
+
+	for (; i + 8 <= samples; i += 8) {
+		const int16x8x2_t dup = vzipq_s16(vld1q_s16(src + i), vld1q_s16(src + i));
+		scaleAndAddNEON(dst + 2 * i,     dup.val[0], volumes);
+		scaleAndAddNEON(dst + 2 * i + 8, dup.val[1], volumes);
+	}
+
+	getScalarMixKernels().mixMono(dst + 2 * i, src + i, samples - i, volL, volR);
+}
+
+static void interpolateNEON(st_sample_t *dst, const st_sample_t *last, const st_sample_t *cur, const uint16 *pos, uint count) {
+	const int32x4_t half = vdupq_n_s32(FRAC_HALF);
+	uint i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const int16x8_t l = vld1q_s16(last + i);
+		const int16x8_t c = vld1q_s16(cur + i);
+		const uint16x8_t p = vld1q_u16(pos + i);
+
+		// The 32 bit multiplication wraps around exactly like the C++ code.
+		int32x4_t v0 = vmulq_s32(vsubl_s16(vget_low_s16(c), vget_low_s16(l)), vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(p))));
+		int32x4_t v1 = vmulq_s32(vsubl_s16(vget_high_s16(c), vget_high_s16(l)), vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(p))));
+		v0 = vaddq_s32(vshrq_n_s32(vaddq_s32(v0, half), FRAC_BITS), vmovl_s16(vget_low_s16(l)));
+		v1 = vaddq_s32(vshrq_n_s32(vaddq_s32(v1, half), FRAC_BITS), vmovl_s16(vget_high_s16(l)));
+
+		// Plain narrowing keeps the low 16 bits, like the cast in the C++ code.
+		vst1q_s16(dst + i, vcombine_s16(vmovn_s32(v0), vmovn_s32(v1)));
+	}
+
+	getScalarMixKernels().interpolate(dst + i, last + i, cur + i, pos + i, count - i);
+}
+
+const MixKernels g_mixKernelsNEON = {
+	mixStereoNEON,
+	mixMonoNEON,
+	interpolateNEON
+};
+
+} // End of namespace Audio
+
+#endif
@@ -0,0 +1,239 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/mixkernels.h"
+
+#ifdef USE_X86_SIMD
+
+#include "common/frac.h"
+
+#include <immintrin.h>
+
+namespace Audio {
+
+// The functions in this file are compiled for the instruction set given in
+// their target attribute, independent of the flags used for the rest of
+// the build. getMixKernels() only hands them out if the CPU supports it.
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+/**
+ * Compute (samples * volumes) / Mixer::kMaxMixerVolume with the same
+ * rounding as the C++ code (i.e. towards zero) and add the result to the
+ * eight samples at dst with saturation.
+ */
+static inline SSE2_TARGET void scaleAndAddSSE2(st_sample_t *dst, __m128i samples, __m128i volumes) {
+	const __m128i lo = _mm_mullo_epi16(samples, volumes);
+	const __m128i hi = _mm_mulhi_epi16(samples, volumes);
+	__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+	__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+
+	// Add 255 to negative products so the shift truncates towards zero.
+	p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_srli_epi32(_mm_srai_epi32(p0, 31), 24)), 8);
+	p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_srli_epi32(_mm_srai_epi32(p1, 31), 24)), 8);
+
+	const __m128i out = _mm_loadu_si128((const __m128i *)dst);
+	_mm_storeu_si128((__m128i *)dst, _mm_adds_epi16(out, _mm_packs_epi32(p0, p1)));
+}
+
+static SSE2_TARGET void mixStereoSSE2(st_sample_t *dst, const st_sample_t *src, uint pairs, st_volume_t volL, st_volume_t volR, bool reverseStereo) {
+	uint i = 0;
+
+	if (reverseStereo) {
+		// Swap the channels of the input, the volumes follow them.
+		const __m128i volumes = _mm_set_epi16(volL, volR, volL, volR, volL, volR, volL, volR);
+		for (; i + 4 <= pairs; i += 4) {
+			__m128i samples = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+			samples = _mm_shufflehi_epi16(_mm_shufflelo_epi16(samples, 0xB1), 0xB1);
+			scaleAndAddSSE2(dst + 2 * i, samples, volumes);
+		}
+	} else {
+		const __m128i volumes = _mm_set_epi16(volR, volL, volR, volL, volR, volL, volR, volL);
+		for (; i + 4 <= pairs; i += 4)
+			scaleAndAddSSE2(dst + 2 * i, _mm_loadu_si128((const __m128i *)(src + 2 * i)), volumes);
+	}
+
+	getScalarMixKernels().mixStereo(dst + 2 * i, src + 2 * i, pairs - i, volL, volR, reverseStereo);
+}
+
+static SSE2_TARGET void mixMonoSSE2(st_sample_t *dst, const st_sample_t *src, uint samples, st_volume_t volL, st_volume_t volR) {
+	const __m128i volumes = _mm_set_epi16(volR, volL, volR, volL, volR, volL, volR, volL);
+	uint i = 0;
+
+	for (; i + 8 <= samples; i += 8) {
+		const __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+		scaleAndAddSSE2(dst + 2 * i,     _mm_unpacklo_epi16(in, in), volumes);
+		scaleAndAddSSE2(dst + 2 * i + 8, _mm_unpackhi_epi16(in, in), volumes);
+	}
+
+	getScalarMixKernels().mixMono(dst + 2 * i, src + i, samples - i, volL, volR);
+}
+
+/**
+ * Multiply signed 16 bit values by unsigned 16 bit values, returning the
+ * low and high halves of the 32 bit products as two vectors of 32 bit
+ * values.
+ */
+static inline SSE2_TARGET void mulSignedUnsignedSSE2(__m128i a, __m128i b, __m128i &p0, __m128i &p1) {
+	const __m128i lo = _mm_mullo_epi16(a, b);
+	// _mm_mulhi_epi16 treats b as signed; correct for b >= 0x8000.
+	const __m128i hi = _mm_add_epi16(_mm_mulhi_epi16(a, b), _mm_and_si128(a, _mm_srai_epi16(b, 15)));
+	p0 = _mm_unpacklo_epi16(lo, hi);
+	p1 = _mm_unpackhi_epi16(lo, hi);
+}
+
+/**
+ * Finish the interpolation of four values: add the rounding bias, shift
+ * and add the base value, then keep the low 16 bits just like the cast in
+ * the C++ code does.
+ */
+static inline SSE2_TARGET __m128i finishInterpolationSSE2(__m128i cur, __m128i last, __m128i base) {
+	__m128i v = _mm_add_epi32(_mm_sub_epi32(cur, last), _mm_set1_epi32(FRAC_HALF));
+	v = _mm_add_epi32(_mm_srai_epi32(v, FRAC_BITS), base);
+	return _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+}
+
+static SSE2_TARGET void interpolateSSE2(st_sample_t *dst, const st_sample_t *last, const st_sample_t *cur, const uint16 *pos, uint count) {
+	uint i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const __m128i l = _mm_loadu_si128((const __m128i *)(last + i));
+		const __m128i c = _mm_loadu_si128((const __m128i *)(cur + i));
+		const __m128i p = _mm_loadu_si128((const __m128i *)(pos + i));
+
+		// (cur - last) * pos is computed as cur * pos - last * pos, which
+		// wraps around exactly like the 32 bit arithmetic of the C++ code.
+		__m128i c0, c1, l0, l1;
+		mulSignedUnsignedSSE2(c, p, c0, c1);
+		mulSignedUnsignedSSE2(l, p, l0, l1);
+
+		const __m128i sign = _mm_srai_epi16(l, 15);
+		const __m128i out0 = finishInterpolationSSE2(c0, l0, _mm_unpacklo_epi16(l, sign));
+		const __m128i out1 = finishInterpolationSSE2(c1, l1, _mm_unpackhi_epi16(l, sign));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(out0, out1));
+	}
+
+	getScalarMixKernels().interpolate(dst + i, last + i, cur + i, pos + i, count - i);
+}
+
+const MixKernels g_mixKernelsSSE2 = {
+	mixStereoSSE2,
+	mixMonoSSE2,
+	interpolateSSE2
+};
+
+#pragma mark -
+
+static inline AVX2_TARGET void scaleAndAddAVX2(st_sample_t *dst, __m256i samples, __m256i volumes) {
+	const __m256i lo = _mm256_mullo_epi16(samples, volumes);
+	const __m256i hi = _mm256_mulhi_epi16(samples, volumes);
+	// Unpacking and packing both work within 128 bit lanes, so the order of
+	// the samples is preserved.
+	__m256i p0 = _mm256_unpacklo_epi16(lo, hi);
+	__m256i p1 = _mm256_unpackhi_epi16(lo, hi);
+
+	p0 = _mm256_srai_epi32(_mm256_add_epi32(p0, _mm256_srli_epi32(_mm256_srai_epi32(p0, 31), 24)), 8);
+	p1 = _mm256_srai_epi32(_mm256_add_epi32(p1, _mm256_srli_epi32(_mm256_srai_epi32(p1, 31), 24)), 8);
+
+	const __m256i out = _mm256_loadu_si256((const __m256i *)dst);
+	_mm256_storeu_si256((__m256i *)dst, _mm256_adds_epi16(out, _mm256_packs_epi32(p0, p1)));
+}
+
+static AVX2_TARGET void mixStereoAVX2(st_sample_t *dst, const st_sample_t *src, uint pairs, st_volume_t volL, st_volume_t volR, bool reverseStereo) {
+	uint i = 0;
+
+	if (reverseStereo) {
+		const __m256i volumes = _mm256_set1_epi32((volL << 16) | volR);
+		for (; i + 8 <= pairs; i += 8) {
+			__m256i samples = _mm256_loadu_si256((const __m256i *)(src + 2 * i));
+			samples = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(samples, 0xB1), 0xB1);
+			scaleAndAddAVX2(dst + 2 * i, samples, volumes);
+		}
+	} else {
+		const __m256i volumes = _mm256_set1_epi32((volR << 16) | volL);
+		for (; i + 8 <= pairs; i += 8)
+			scaleAndAddAVX2(dst + 2 * i, _mm256_loadu_si256((const __m256i *)(src + 2 * i)), volumes);
+	}
+
+	mixStereoSSE2(dst + 2 * i, src + 2 * i, pairs - i, volL, volR, reverseStereo);
+}
+
+static AVX2_TARGET void mixMonoAVX2(st_sample_t *dst, const st_sample_t *src, uint samples, st_volume_t volL, st_volume_t volR) {
+	const __m256i volumes = _mm256_set1_epi32((volR << 16) | volL);
+	uint i = 0;
+
+	for (; i + 16 <= samples; i += 16) {
+		// Reorder the 64 bit quarters to 0, 2, 1, 3, so that the in-lane
+		// unpacking below yields samples 0-7 and 8-15 in order.
+		__m256i in = _mm256_loadu_si256((const __m256i *)(src + i));
+		in = _mm256_permute4x64_epi64(in, 0xD8);
+		scaleAndAddAVX2(dst + 2 * i,      _mm256_unpacklo_epi16(in, in), volumes);
+		scaleAndAddAVX2(dst + 2 * i + 16, _mm256_unpackhi_epi16(in, in), volumes);
+	}
+
+	mixMonoSSE2(dst + 2 * i, src + i, samples - i, volL, volR);
+}
+
+static inline AVX2_TARGET void mulSignedUnsignedAVX2(__m256i a, __m256i b, __m256i &p0, __m256i &p1) {
+	const __m256i lo = _mm256_mullo_epi16(a, b);
+	const __m256i hi = _mm256_add_epi16(_mm256_mulhi_epi16(a, b), _mm256_and_si256(a, _mm256_srai_epi16(b, 15)));
+	p0 = _mm256_unpacklo_epi16(lo, hi);
+	p1 = _mm256_unpackhi_epi16(lo, hi);
+}
+
+static inline AVX2_TARGET __m256i finishInterpolationAVX2(__m256i cur, __m256i last, __m256i base) {
+	__m256i v = _mm256_add_epi32(_mm256_sub_epi32(cur, last), _mm256_set1_epi32(FRAC_HALF));
+	v = _mm256_add_epi32(_mm256_srai_epi32(v, FRAC_BITS), base);
+	return _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+}
+
+static AVX2_TARGET void interpolateAVX2(st_sample_t *dst, const st_sample_t *last, const st_sample_t *cur, const uint16 *pos, uint count) {
+	uint i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		const __m256i l = _mm256_loadu_si256((const __m256i *)(last + i));
+		const __m256i c = _mm256_loadu_si256((const __m256i *)(cur + i));
+		const __m256i p = _mm256_loadu_si256((const __m256i *)(pos + i));
+
+		__m256i c0, c1, l0, l1;
+		mulSignedUnsignedAVX2(c, p, c0, c1);
+		mulSignedUnsignedAVX2(l, p, l0, l1);
+
+		const __m256i sign = _mm256_srai_epi16(l, 15);
+		const __m256i out0 = finishInterpolationAVX2(c0, l0, _mm256_unpacklo_epi16(l, sign));
+		const __m256i out1 = finishInterpolationAVX2(c1, l1, _mm256_unpackhi_epi16(l, sign));
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_packs_epi32(out0, out1));
+	}
+
+	interpolateSSE2(dst + i, last + i, cur + i, pos + i, count - i);
+}
+
+const MixKernels g_mixKernelsAVX2 = {
+	mixStereoAVX2,
+	mixMonoAVX2,
+	interpolateAVX2
+};
+
+} // End of namespace Audio
+
+#endif
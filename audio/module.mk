@@ -9,9 +9,11 @@ MODULE_OBJS := \
 	midiparser.o \
 	midiplayer.o \
 	mixer.o \
+	mixkernels.o \
 	mpu401.o \
 	musicplugin.o \
 	null.o \
+	rate_polyphase.o \
 	timestamp.o \
 	decoders/aac.o \
 	decoders/adpcm.o \
@@ -63,5 +65,15 @@ MODULE_OBJS += \
 	rate_arm_asm.o
 endif
 
+ifdef USE_X86_SIMD
+MODULE_OBJS += \
+	mixkernels_x86.o
+endif
+
+ifdef USE_NEON
+MODULE_OBJS += \
+	mixkernels_neon.o
+endif
+
 # Include common rules
 include $(srcdir)/rules.mk
@@ -31,6 +31,7 @@
 #include "audio/audiostream.h"
 #include "audio/rate.h"
 #include "audio/mixer.h"
+#include "audio/mixkernels.h"
 #include "common/frac.h"
 #include "common/textconsole.h"
 #include "common/util.h"
@@ -46,6 +47,12 @@ namespace Audio {
  */
 #define INTERMEDIATE_BUFFER_SIZE 512
 
+/**
+ * The number of output sample pairs the converters produce before handing
+ * them to the mix kernels (see audio/mixkernels.h).
+ */
+#define MIX_BLOCK_SIZE 256
+
 
 /**
  * Audio rate converter based on simple resampling. Used when no
@@ -60,6 +67,9 @@ protected:
 	const st_sample_t *inPtr;
 	int inLen;
 
+	/** resampled input, waiting to be mixed */
+	st_sample_t mixBuf[MIX_BLOCK_SIZE * 2];
+
 	/** position of how far output is ahead of input */
 	/** Holds what would have been opos-ipos */
 	long opos;
@@ -103,43 +113,55 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
  */
 template<bool stereo, bool reverseStereo>
 int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	const MixKernels &kernels = getMixKernels();
 	st_sample_t *ostart, *oend;
 
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
-	while (obuf < oend) {
-
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
-			}
-		} while (opos >= 0);
-
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
-
-		// Increment output position
-		opos += opos_inc;
+	bool endOfInput = false;
+	while (obuf < oend && !endOfInput) {
+		const st_size_t blockSize = MIN<st_size_t>((oend - obuf) / 2, MIX_BLOCK_SIZE);
+		st_sample_t *mixPtr = mixBuf;
+		st_size_t produced;
+
+		for (produced = 0; produced < blockSize; produced++) {
+			// read enough input samples so that opos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				opos--;
+				if (opos >= 0) {
+					inPtr += (stereo ? 2 : 1);
+				}
+			} while (opos >= 0);
+
+			if (endOfInput)
+				break;
+
+			*mixPtr++ = *inPtr++;
+			if (stereo)
+				*mixPtr++ = *inPtr++;
 
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+			// Increment output position
+			opos += opos_inc;
+		}
 
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		// Scale the block and add it to the output
+		if (stereo)
+			kernels.mixStereo(obuf, mixBuf, produced, vol_l, vol_r, reverseStereo);
+		else
+			kernels.mixMono(obuf, mixBuf, produced, vol_l, vol_r);
 
-		obuf += 2;
+		obuf += produced * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -173,6 +195,12 @@ protected:
 	/** current sample(s) in the input stream (left/right channel) */
 	st_sample_t icur0, icur1;
 
+	/** interpolation input and resampled output, waiting to be mixed */
+	st_sample_t lastBuf[MIX_BLOCK_SIZE * 2];
+	st_sample_t curBuf[MIX_BLOCK_SIZE * 2];
+	uint16 posBuf[MIX_BLOCK_SIZE * 2];
+	st_sample_t mixBuf[MIX_BLOCK_SIZE * 2];
+
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
@@ -212,53 +240,70 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
  */
 template<bool stereo, bool reverseStereo>
 int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	const MixKernels &kernels = getMixKernels();
 	st_sample_t *ostart, *oend;
 
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
-	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
+	bool endOfInput = false;
+	while (obuf < oend && !endOfInput) {
+		const st_size_t blockSize = MIN<st_size_t>((oend - obuf) / 2, MIX_BLOCK_SIZE);
+		st_size_t produced = 0;
+		st_size_t n = 0;
+
+		while (produced < blockSize) {
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE;
 			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+
+			if (endOfInput)
+				break;
+
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the block. The actual interpolation is done by
+			// the kernel for the whole block at once.
+			while (opos < (frac_t)FRAC_ONE && produced < blockSize) {
+				lastBuf[n] = ilast0;
+				curBuf[n] = icur0;
+				posBuf[n++] = (uint16)opos;
+				if (stereo) {
+					lastBuf[n] = ilast1;
+					curBuf[n] = icur1;
+					posBuf[n++] = (uint16)opos;
+				}
+				produced++;
+
+				// Increment output position
+				opos += opos_inc;
 			}
-			opos -= FRAC_ONE;
 		}
 
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF) >> FRAC_BITS));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF) >> FRAC_BITS)) :
-						  out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
+		// Interpolate, then scale the block and add it to the output
+		kernels.interpolate(mixBuf, lastBuf, curBuf, posBuf, n);
+		if (stereo)
+			kernels.mixStereo(obuf, mixBuf, produced, vol_l, vol_r, reverseStereo);
+		else
+			kernels.mixMono(obuf, mixBuf, produced, vol_l, vol_r);
 
-			// Increment output position
-			opos += opos_inc;
-		}
+		obuf += produced * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -283,11 +328,8 @@ public:
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
 		st_size_t len;
 
-		st_sample_t *ostart = obuf;
-
 		if (stereo)
 			osamp *= 2;
 
@@ -305,21 +347,13 @@ public:
 		len = input.readBuffer(_buffer, osamp);
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
+		if (stereo) {
+			getMixKernels().mixStereo(obuf, _buffer, len / 2, vol_l, vol_r, reverseStereo);
+			return len / 2;
+		} else {
+			getMixKernels().mixMono(obuf, _buffer, len, vol_l, vol_r);
+			return len;
 		}
-		return (obuf - ostart) / 2;
 	}
 
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
@@ -347,6 +381,13 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
  * Create and return a RateConverter object for the specified input and output rates.
  */
 RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+	return makeRateConverter(inrate, outrate, stereo, reverseStereo, getConfiguredResampler());
+}
+
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, ResamplerType resampler) {
+	if (inrate != outrate && resampler == kResamplerPolyphase)
+		return makePolyphaseRateConverter(inrate, outrate, stereo, reverseStereo);
+
 	if (stereo) {
 		if (reverseStereo)
 			return makeRateConverter<true, true>(inrate, outrate);
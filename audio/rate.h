@@ -78,8 +78,37 @@ public:
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
 };
 
+/**
+ * The converters to choose from for rate conversions. The copy converter
+ * is always used when no conversion is necessary.
+ */
+enum ResamplerType {
+	/** Linear interpolation, or dropping samples when downsampling by an integer factor */
+	kResamplerLinear,
+	/** Windowed sinc FIR filter; less aliasing, but more expensive */
+	kResamplerPolyphase
+};
+
+/**
+ * Return the resampler selected by the user through the "audio_resampler"
+ * config key, which can be "linear" (the default) or "polyphase".
+ */
+ResamplerType getConfiguredResampler();
+
+/**
+ * Create a RateConverter using the resampler selected by the user.
+ */
 RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
 
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, ResamplerType resampler);
+
+/**
+ * Create a windowed sinc converter. This is used by makeRateConverter()
+ * for kResamplerPolyphase, regardless of which implementation of the other
+ * converters is compiled in.
+ */
+RateConverter *makePolyphaseRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo);
+
 } // End of namespace Audio
 
 #endif
@@ -437,6 +437,13 @@ public:
  * Create and return a RateConverter object for the specified input and output rates.
  */
 RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+	return makeRateConverter(inrate, outrate, stereo, reverseStereo, getConfiguredResampler());
+}
+
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, ResamplerType resampler) {
+	if (inrate != outrate && resampler == kResamplerPolyphase)
+		return makePolyphaseRateConverter(inrate, outrate, stereo, reverseStereo);
+
 	if (inrate != outrate) {
 		if ((inrate % outrate) == 0) {
 			if (stereo) {
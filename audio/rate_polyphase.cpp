@@ -0,0 +1,293 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+#include "audio/mixkernels.h"
+#include "common/config-manager.h"
+#include "common/frac.h"
+#include "common/math.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+namespace Audio {
+
+/**
+ * The size of the intermediate input cache, see rate.cpp.
+ */
+#define INTERMEDIATE_BUFFER_SIZE 512
+
+/**
+ * The number of output sample pairs the converter produces before handing
+ * them to the mix kernels (see audio/mixkernels.h).
+ */
+#define MIX_BLOCK_SIZE 256
+
+/**
+ * The length of the filter, in input samples. Must be a power of two.
+ */
+#define POLYPHASE_TAPS 16
+
+/**
+ * The filter coefficients are precomputed for 2^POLYPHASE_PHASE_BITS
+ * fractional positions between two input samples.
+ */
+#define POLYPHASE_PHASE_BITS 8
+#define POLYPHASE_PHASES (1 << POLYPHASE_PHASE_BITS)
+
+/** Coefficients are stored with this many fractional bits. */
+#define POLYPHASE_COEF_BITS 15
+
+/**
+ * Audio rate converter based on a windowed sinc (Lanczos) FIR filter.
+ *
+ * The filter is evaluated at POLYPHASE_PHASES + 1 evenly spaced fractional
+ * positions between two input samples once, when the converter is created.
+ * Every output sample then only costs POLYPHASE_TAPS multiply-adds per
+ * channel, using the coefficients of the position closest to the exact one.
+ * When downsampling, the cutoff frequency is lowered to the output Nyquist
+ * frequency, so that this converter also avoids the aliasing of
+ * SimpleRateConverter.
+ *
+ * Compared to LinearRateConverter the output is delayed by
+ * POLYPHASE_TAPS / 2 - 1 input samples.
+ *
+ * Limited to sampling frequency <= 65535 Hz.
+ */
+template<bool stereo, bool reverseStereo>
+class PolyphaseRateConverter : public RateConverter {
+protected:
+	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
+	const st_sample_t *inPtr;
+	int inLen;
+
+	/** fractional position of the output stream in input stream unit */
+	frac_t opos;
+
+	/** fractional position increment in the output stream */
+	frac_t opos_inc;
+
+	/**
+	 * The last POLYPHASE_TAPS input samples of each channel. Every sample is
+	 * stored twice, so that the window always is a contiguous block
+	 * starting at histPos.
+	 */
+	st_sample_t hist0[POLYPHASE_TAPS * 2], hist1[POLYPHASE_TAPS * 2];
+	int histPos;
+
+	/** resampled output, waiting to be mixed */
+	st_sample_t mixBuf[MIX_BLOCK_SIZE * 2];
+
+	/** filter coefficients, POLYPHASE_TAPS for each phase */
+	int16 coefs[(POLYPHASE_PHASES + 1) * POLYPHASE_TAPS];
+
+	void computeCoefficients(double cutoff);
+
+	static st_sample_t convolve(const int16 *coef, const st_sample_t *window) {
+		int32 sum = 1 << (POLYPHASE_COEF_BITS - 1);
+		for (int i = 0; i < POLYPHASE_TAPS; i++)
+			sum += coef[i] * window[i];
+		sum >>= POLYPHASE_COEF_BITS;
+
+		if (sum > ST_SAMPLE_MAX)
+			return ST_SAMPLE_MAX;
+		else if (sum < ST_SAMPLE_MIN)
+			return ST_SAMPLE_MIN;
+		return sum;
+	}
+
+public:
+	PolyphaseRateConverter(st_rate_t inrate, st_rate_t outrate);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+};
+
+
+/*
+ * Prepare processing.
+ */
+template<bool stereo, bool reverseStereo>
+PolyphaseRateConverter<stereo, reverseStereo>::PolyphaseRateConverter(st_rate_t inrate, st_rate_t outrate) {
+	if (inrate >= 65536 || outrate >= 65536) {
+		error("rate effect can only handle rates < 65536");
+	}
+
+	opos = FRAC_ONE;
+	opos_inc = (inrate << FRAC_BITS) / outrate;
+
+	memset(hist0, 0, sizeof(hist0));
+	memset(hist1, 0, sizeof(hist1));
+	histPos = 0;
+
+	inLen = 0;
+
+	// Keep a bit of headroom below the Nyquist frequency, since the filter
+	// is too short for a steep transition.
+	double cutoff = 0.9;
+	if (outrate < inrate)
+		cutoff = cutoff * outrate / inrate;
+
+	computeCoefficients(cutoff);
+}
+
+template<bool stereo, bool reverseStereo>
+void PolyphaseRateConverter<stereo, reverseStereo>::computeCoefficients(double cutoff) {
+	// The filter is the Lanczos kernel sinc(cutoff * x) * sinc(x / a) with
+	// a = POLYPHASE_TAPS / 2, sampled at multiples of 1 / POLYPHASE_PHASES.
+	// The sines are computed with the recurrence
+	//   sin((n + 1) * t) = 2 * cos(t) * sin(n * t) - sin((n - 1) * t)
+	// instead of calling sin() for every coefficient, which is expensive
+	// on machines without an FPU.
+	const int halfWidth = POLYPHASE_TAPS / 2;
+	const int points = halfWidth * POLYPHASE_PHASES + 1;
+	double *kernel = new double[points];
+
+	const double step1 = M_PI * cutoff / POLYPHASE_PHASES;
+	const double step2 = M_PI / (halfWidth * POLYPHASE_PHASES);
+	const double cos1 = 2.0 * cos(step1), cos2 = 2.0 * cos(step2);
+	double sin1 = sin(step1), sin1Prev = 0.0;
+	double sin2 = sin(step2), sin2Prev = 0.0;
+
+	kernel[0] = 1.0;
+	for (int i = 1; i < points; i++) {
+		kernel[i] = sin1 * sin2 / ((step1 * i) * (step2 * i));
+
+		const double sin1Next = cos1 * sin1 - sin1Prev;
+		sin1Prev = sin1;
+		sin1 = sin1Next;
+
+		const double sin2Next = cos2 * sin2 - sin2Prev;
+		sin2Prev = sin2;
+		sin2 = sin2Next;
+	}
+	// sinc(x / a) is exactly zero at the edge of the window
+	kernel[points - 1] = 0.0;
+
+	for (int phase = 0; phase <= POLYPHASE_PHASES; phase++) {
+		int16 *coef = coefs + phase * POLYPHASE_TAPS;
+
+		// Tap i is applied to the input sample at distance
+		// i - (halfWidth - 1) - phase / POLYPHASE_PHASES from the output
+		// position.
+		double sum = 0.0;
+		for (int i = 0; i < POLYPHASE_TAPS; i++)
+			sum += kernel[ABS((i - (halfWidth - 1)) * POLYPHASE_PHASES - phase)];
+
+		// Normalize every phase to unity gain. Rounding errors go to the
+		// largest tap, so that constant input gives exactly constant output.
+		int total = 0, largest = 0;
+		for (int i = 0; i < POLYPHASE_TAPS; i++) {
+			const double value = kernel[ABS((i - (halfWidth - 1)) * POLYPHASE_PHASES - phase)] / sum;
+			coef[i] = (int16)floor(value * (1 << POLYPHASE_COEF_BITS) + 0.5);
+			total += coef[i];
+			if (coef[i] > coef[largest])
+				largest = i;
+		}
+		coef[largest] += (1 << POLYPHASE_COEF_BITS) - total;
+	}
+
+	delete[] kernel;
+}
+
+/*
+ * Processed signed long samples from ibuf to obuf.
+ * Return number of sample pairs processed.
+ */
+template<bool stereo, bool reverseStereo>
+int PolyphaseRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	const MixKernels &kernels = getMixKernels();
+	st_sample_t *ostart, *oend;
+
+	ostart = obuf;
+	oend = obuf + osamp * 2;
+
+	bool endOfInput = false;
+	while (obuf < oend && !endOfInput) {
+		const st_size_t blockSize = MIN<st_size_t>((oend - obuf) / 2, MIX_BLOCK_SIZE);
+		st_sample_t *mixPtr = mixBuf;
+		st_size_t produced;
+
+		for (produced = 0; produced < blockSize; produced++) {
+			// read enough input samples so that opos < FRAC_ONE
+			while ((frac_t)FRAC_ONE <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				hist0[histPos] = hist0[histPos + POLYPHASE_TAPS] = *inPtr++;
+				if (stereo)
+					hist1[histPos] = hist1[histPos + POLYPHASE_TAPS] = *inPtr++;
+				histPos = (histPos + 1) & (POLYPHASE_TAPS - 1);
+				opos -= FRAC_ONE;
+			}
+
+			if (endOfInput)
+				break;
+
+			// Pick the coefficients of the nearest phase
+			const int phase = (opos + (1 << (FRAC_BITS - POLYPHASE_PHASE_BITS - 1))) >> (FRAC_BITS - POLYPHASE_PHASE_BITS);
+			const int16 *coef = coefs + phase * POLYPHASE_TAPS;
+
+			*mixPtr++ = convolve(coef, hist0 + histPos);
+			if (stereo)
+				*mixPtr++ = convolve(coef, hist1 + histPos);
+
+			// Increment output position
+			opos += opos_inc;
+		}
+
+		// Scale the block and add it to the output
+		if (stereo)
+			kernels.mixStereo(obuf, mixBuf, produced, vol_l, vol_r, reverseStereo);
+		else
+			kernels.mixMono(obuf, mixBuf, produced, vol_l, vol_r);
+
+		obuf += produced * 2;
+	}
+	return (obuf - ostart) / 2;
+}
+
+RateConverter *makePolyphaseRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+	if (stereo) {
+		if (reverseStereo)
+			return new PolyphaseRateConverter<true, true>(inrate, outrate);
+		else
+			return new PolyphaseRateConverter<true, false>(inrate, outrate);
+	} else
+		return new PolyphaseRateConverter<false, false>(inrate, outrate);
+}
+
+ResamplerType getConfiguredResampler() {
+	if (ConfMan.get("audio_resampler") == "polyphase")
+		return kResamplerPolyphase;
+	return kResamplerLinear;
+}
+
+} // End of namespace Audio
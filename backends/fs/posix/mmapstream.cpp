@@ -0,0 +1,161 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+// Re-enable some forbidden symbols to avoid clashes with stat.h and unistd.h.
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_mkdir
+#define FORBIDDEN_SYMBOL_EXCEPTION_exit		//Needed for IRIX's unistd.h
+#define FORBIDDEN_SYMBOL_EXCEPTION_FILE
+#define FORBIDDEN_SYMBOL_EXCEPTION_fopen
+
+#include "backends/fs/posix/mmapstream.h"
+
+#ifdef USE_MMAP
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+enum {
+	/**
+	 * Files smaller than this are read through stdio. For them, setting up
+	 * the mapping costs more than copying the data does.
+	 */
+	kMinMappedSize = 64 * 1024
+};
+
+MmapStream::Mapping::~Mapping() {
+	munmap(_address, _length);
+}
+
+MmapStream *MmapStream::makeFromPath(const Common::String &path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < kMinMappedSize || st.st_size > 0x7FFFFFFF) {
+		close(fd);
+		return 0;
+	}
+
+	const uint32 length = (uint32)st.st_size;
+	void *address = mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping keeps a reference to the file on its own.
+	close(fd);
+	if (address == MAP_FAILED)
+		return 0;
+
+	return new MmapStream(MappingPtr(new Mapping(address, length)), (const byte *)address, length);
+}
+
+MmapStream::MmapStream(const MappingPtr &mapping, const byte *data, uint32 size)
+	: _mapping(mapping), _data(data), _size(size), _pos(0), _eos(false) {
+}
+
+bool MmapStream::seek(int32 offs, int whence) {
+	switch (whence) {
+	case SEEK_END:
+		offs += _size;
+		break;
+	case SEEK_CUR:
+		offs += _pos;
+		break;
+	default:
+		break;
+	}
+
+	// Like fseek, allow seeking past the end, but not before the start.
+	if (offs < 0)
+		return false;
+
+	_pos = offs;
+	_eos = false;
+	return true;
+}
+
+uint32 MmapStream::read(void *dataPtr, uint32 dataSize) {
+	const uint32 available = _pos < _size ? _size - _pos : 0;
+	if (dataSize > available) {
+		dataSize = available;
+		_eos = true;
+	}
+
+	memcpy(dataPtr, _data + _pos, dataSize);
+	_pos += dataSize;
+	return dataSize;
+}
+
+Common::SeekableReadStream *MmapStream::readStream(uint32 dataSize) {
+	const uint32 available = _pos < _size ? _size - _pos : 0;
+	if (dataSize > available) {
+		dataSize = available;
+		_eos = true;
+	}
+	assert(dataSize > 0);
+
+	MmapStream *view = new MmapStream(_mapping, _data + _pos, dataSize);
+	_pos += dataSize;
+	return view;
+}
+
+MappableStdioStream *MappableStdioStream::makeFromPath(const Common::String &path) {
+	FILE *handle = fopen(path.c_str(), "rb");
+	if (!handle)
+		return 0;
+
+	return new MappableStdioStream(handle, path);
+}
+
+MappableStdioStream::MappableStdioStream(void *handle, const Common::String &path)
+	: StdioStream(handle), _path(path), _mapped(0), _mapTried(false) {
+}
+
+MappableStdioStream::~MappableStdioStream() {
+	delete _mapped;
+}
+
+Common::SeekableReadStream *MappableStdioStream::readStream(uint32 dataSize) {
+	if (!_mapped)
+		return StdioStream::readStream(dataSize);
+
+	// Hand out a view of the mapping, which the caller asked for already
+	_mapped->seek(pos());
+	Common::SeekableReadStream *view = _mapped->readStream(dataSize);
+	seek(view->size(), SEEK_CUR);
+	return view;
+}
+
+const byte *MappableStdioStream::getRawPointer() const {
+	if (!_mapTried) {
+		_mapTried = true;
+		_mapped = MmapStream::makeFromPath(_path);
+	}
+
+	return _mapped ? _mapped->getRawPointer() : 0;
+}
+
+#endif
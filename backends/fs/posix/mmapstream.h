@@ -0,0 +1,115 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef BACKENDS_FS_POSIX_MMAPSTREAM_H
+#define BACKENDS_FS_POSIX_MMAPSTREAM_H
+
+#include "common/scummsys.h"
+
+#ifdef USE_MMAP
+
+#include "backends/fs/stdiostream.h"
+#include "common/noncopyable.h"
+#include "common/ptr.h"
+#include "common/stream.h"
+#include "common/str.h"
+
+/**
+ * A read-only stream on a file which is mapped into memory with mmap().
+ *
+ * Reading from it is a memcpy from the mapping, and getRawPointer() gives
+ * direct access to the file contents. readStream() returns another
+ * MmapStream on a part of the mapping instead of a copy; the mapping stays
+ * alive as long as any stream using it does.
+ *
+ * @note If the file is truncated by another process while it is mapped,
+ *       or reading it fails, accessing the mapping raises SIGBUS.
+ */
+class MmapStream : public Common::SeekableReadStream, public Common::NonCopyable {
+public:
+	/**
+	 * Maps the file with the given path. Returns 0 if the file could not be
+	 * mapped, or if it is too small to gain anything from being mapped; the
+	 * caller should fall back to StdioStream in that case.
+	 */
+	static MmapStream *makeFromPath(const Common::String &path);
+
+	virtual bool eos() const { return _eos; }
+	virtual void clearErr() { _eos = false; }
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+	virtual bool seek(int32 offs, int whence = SEEK_SET);
+	virtual uint32 read(void *dataPtr, uint32 dataSize);
+
+	virtual Common::SeekableReadStream *readStream(uint32 dataSize);
+	virtual const byte *getRawPointer() const { return _data; }
+
+private:
+	/** A mapped file, unmapped when the last stream using it is deleted. */
+	struct Mapping {
+		void *_address;
+		uint32 _length;
+
+		Mapping(void *address, uint32 length) : _address(address), _length(length) {}
+		~Mapping();
+	};
+
+	typedef Common::SharedPtr<Mapping> MappingPtr;
+
+	MmapStream(const MappingPtr &mapping, const byte *data, uint32 size);
+
+	MappingPtr _mapping;
+	const byte *_data;
+	uint32 _size;
+	uint32 _pos;
+	bool _eos;
+};
+
+/**
+ * A StdioStream which maps its file into memory once getRawPointer() is
+ * called, i.e. only for callers which want to access the data directly.
+ * Everything else keeps reading through stdio, so that read errors, e.g.
+ * on removable media or network mounts, set err() instead of raising
+ * SIGBUS.
+ */
+class MappableStdioStream : public StdioStream {
+public:
+	static MappableStdioStream *makeFromPath(const Common::String &path);
+
+	virtual ~MappableStdioStream();
+
+	virtual Common::SeekableReadStream *readStream(uint32 dataSize);
+	virtual const byte *getRawPointer() const;
+
+private:
+	MappableStdioStream(void *handle, const Common::String &path);
+
+	Common::String _path;
+	mutable MmapStream *_mapped;
+	mutable bool _mapTried;
+};
+
+#endif
+
+#endif
@@ -30,6 +30,7 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_exit		//Needed for IRIX's unistd.h
 
 #include "backends/fs/posix/posix-fs.h"
+#include "backends/fs/posix/mmapstream.h"
 #include "backends/fs/stdiostream.h"
 #include "common/algorithm.h"
 
@@ -243,7 +244,11 @@ AbstractFSNode *POSIXFilesystemNode::getParent() const {
 }
 
 Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
+#ifdef USE_MMAP
+	return MappableStdioStream::makeFromPath(getPath());
+#else
 	return StdioStream::makeFromPath(getPath(), false);
+#endif
 }
 
 Common::WriteStream *POSIXFilesystemNode::createWriteStream() {
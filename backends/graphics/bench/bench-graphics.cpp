@@ -0,0 +1,187 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(BENCH_BACKEND)
+
+#include "backends/graphics/bench/bench-graphics.h"
+
+#include "common/rect.h"
+#include "common/textconsole.h"
+
+BenchGraphicsManager::BenchGraphicsManager()
+	: _screenFormat(Graphics::PixelFormat::createFormatCLUT8()),
+	  _screenChangeID(0), _shakePos(0), _overlayVisible(false),
+	  _mouseVisible(false), _mouseX(0), _mouseY(0), _frameCount(0) {
+
+	memset(_palette, 0, sizeof(_palette));
+	memset(_cursorPalette, 0, sizeof(_cursorPalette));
+
+	// The GUI needs an overlay before any game sets up its screen.
+	_overlay.create(320, 200, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+}
+
+BenchGraphicsManager::~BenchGraphicsManager() {
+	_screen.free();
+	_overlay.free();
+	_cursor.free();
+}
+
+#ifdef USE_RGB_COLOR
+Common::List<Graphics::PixelFormat> BenchGraphicsManager::getSupportedFormats() const {
+	Common::List<Graphics::PixelFormat> list;
+	list.push_back(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+	list.push_back(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+	list.push_back(Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0));
+	list.push_back(Graphics::PixelFormat::createFormatCLUT8());
+	return list;
+}
+#endif
+
+void BenchGraphicsManager::initSize(uint width, uint height, const Graphics::PixelFormat *format) {
+#ifdef USE_RGB_COLOR
+	Graphics::PixelFormat newFormat = format ? *format : Graphics::PixelFormat::createFormatCLUT8();
+#else
+	Graphics::PixelFormat newFormat = Graphics::PixelFormat::createFormatCLUT8();
+#endif
+
+	if (_screen.pixels && _screen.w == (int)width && _screen.h == (int)height && _screenFormat == newFormat)
+		return;
+
+	_screenFormat = newFormat;
+	_screen.free();
+	_screen.create(width, height, _screenFormat);
+
+	// Match what the SDL backend does for unscaled modes: the overlay has
+	// the size of the game screen, but never less than what the GUI needs.
+	const uint overlayWidth = MAX<uint>(width, 320);
+	const uint overlayHeight = MAX<uint>(height, 200);
+	if (_overlay.w != (int)overlayWidth || _overlay.h != (int)overlayHeight) {
+		Graphics::PixelFormat overlayFormat = _overlay.format;
+		_overlay.free();
+		_overlay.create(overlayWidth, overlayHeight, overlayFormat);
+	}
+
+	++_screenChangeID;
+}
+
+void BenchGraphicsManager::setPalette(const byte *colors, uint start, uint num) {
+	assert(start + num <= 256);
+	memcpy(_palette + 3 * start, colors, 3 * num);
+}
+
+void BenchGraphicsManager::grabPalette(byte *colors, uint start, uint num) {
+	assert(start + num <= 256);
+	memcpy(colors, _palette + 3 * start, 3 * num);
+}
+
+void BenchGraphicsManager::copyRect(Graphics::Surface &dst, const byte *buf, int pitch, int x, int y, int w, int h) {
+	// Clip like the SDL backend does, so that badly behaved engines do
+	// not crash the benchmark.
+	Common::Rect r(x, y, x + w, y + h);
+	r.clip(dst.w, dst.h);
+	if (r.isEmpty())
+		return;
+
+	const int bpp = dst.format.bytesPerPixel;
+	buf += (r.top - y) * pitch + (r.left - x) * bpp;
+
+	byte *dstPtr = (byte *)dst.getBasePtr(r.left, r.top);
+	const int lineSize = r.width() * bpp;
+	for (int i = r.height(); i > 0; --i) {
+		memcpy(dstPtr, buf, lineSize);
+		dstPtr += dst.pitch;
+		buf += pitch;
+	}
+}
+
+void BenchGraphicsManager::copyRectToScreen(const byte *buf, int pitch, int x, int y, int w, int h) {
+	copyRect(_screen, buf, pitch, x, y, w, h);
+}
+
+void BenchGraphicsManager::fillScreen(uint32 col) {
+	if (!_screen.pixels)
+		return;
+
+	_screen.fillRect(Common::Rect(_screen.w, _screen.h), col);
+}
+
+void BenchGraphicsManager::updateScreen() {
+	// There is no display to present to; the frame only gets counted.
+	// The owning backend measures how long this call takes.
+	++_frameCount;
+}
+
+void BenchGraphicsManager::clearOverlay() {
+	memset(_overlay.pixels, 0, _overlay.h * _overlay.pitch);
+}
+
+void BenchGraphicsManager::grabOverlay(OverlayColor *buf, int pitch) {
+	const byte *src = (const byte *)_overlay.pixels;
+	byte *dst = (byte *)buf;
+	for (int i = 0; i < _overlay.h; ++i) {
+		memcpy(dst, src, _overlay.w * sizeof(OverlayColor));
+		src += _overlay.pitch;
+		dst += pitch * sizeof(OverlayColor);
+	}
+}
+
+void BenchGraphicsManager::copyRectToOverlay(const OverlayColor *buf, int pitch, int x, int y, int w, int h) {
+	// The overlay pitch is passed in pixels, not in bytes.
+	copyRect(_overlay, (const byte *)buf, pitch * sizeof(OverlayColor), x, y, w, h);
+}
+
+bool BenchGraphicsManager::showMouse(bool visible) {
+	bool last = _mouseVisible;
+	_mouseVisible = visible;
+	return last;
+}
+
+void BenchGraphicsManager::warpMouse(int x, int y) {
+	_mouseX = x;
+	_mouseY = y;
+}
+
+void BenchGraphicsManager::setMouseCursor(const byte *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, int cursorTargetScale, const Graphics::PixelFormat *format) {
+#ifdef USE_RGB_COLOR
+	Graphics::PixelFormat cursorFormat = format ? *format : Graphics::PixelFormat::createFormatCLUT8();
+#else
+	Graphics::PixelFormat cursorFormat = Graphics::PixelFormat::createFormatCLUT8();
+#endif
+
+	if (_cursor.w != (int)w || _cursor.h != (int)h || _cursor.format != cursorFormat) {
+		_cursor.free();
+		if (!w || !h)
+			return;
+		_cursor.create(w, h, cursorFormat);
+	}
+
+	copyRect(_cursor, buf, w * cursorFormat.bytesPerPixel, 0, 0, w, h);
+}
+
+void BenchGraphicsManager::setCursorPalette(const byte *colors, uint start, uint num) {
+	assert(start + num <= 256);
+	memcpy(_cursorPalette + 3 * start, colors, 3 * num);
+}
+
+#endif
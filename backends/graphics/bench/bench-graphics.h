@@ -0,0 +1,94 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_BENCH_H
+#define BACKENDS_GRAPHICS_BENCH_H
+
+#include "backends/graphics/null/null-graphics.h"
+#include "graphics/surface.h"
+
+/**
+ * Graphics manager for the headless bench backend. Unlike the null
+ * graphics manager it keeps the game screen, the overlay and the mouse
+ * cursor in memory, so engines that read back the screen or the palette
+ * behave exactly as they do on a real backend. Nothing is ever shown.
+ */
+class BenchGraphicsManager : public NullGraphicsManager {
+public:
+	BenchGraphicsManager();
+	virtual ~BenchGraphicsManager();
+
+#ifdef USE_RGB_COLOR
+	Graphics::PixelFormat getScreenFormat() const { return _screenFormat; }
+	Common::List<Graphics::PixelFormat> getSupportedFormats() const;
+#endif
+	void initSize(uint width, uint height, const Graphics::PixelFormat *format = NULL);
+	int getScreenChangeID() const { return _screenChangeID; }
+
+	int16 getHeight() { return _screen.h; }
+	int16 getWidth() { return _screen.w; }
+	void setPalette(const byte *colors, uint start, uint num);
+	void grabPalette(byte *colors, uint start, uint num);
+	void copyRectToScreen(const byte *buf, int pitch, int x, int y, int w, int h);
+	Graphics::Surface *lockScreen() { return &_screen; }
+	void unlockScreen() {}
+	void fillScreen(uint32 col);
+	void updateScreen();
+	void setShakePos(int shakeOffset) { _shakePos = shakeOffset; }
+
+	void showOverlay() { _overlayVisible = true; }
+	void hideOverlay() { _overlayVisible = false; }
+	Graphics::PixelFormat getOverlayFormat() const { return _overlay.format; }
+	void clearOverlay();
+	void grabOverlay(OverlayColor *buf, int pitch);
+	void copyRectToOverlay(const OverlayColor *buf, int pitch, int x, int y, int w, int h);
+	int16 getOverlayHeight() { return _overlay.h; }
+	int16 getOverlayWidth() { return _overlay.w; }
+
+	bool showMouse(bool visible);
+	void warpMouse(int x, int y);
+	void setMouseCursor(const byte *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, int cursorTargetScale = 1, const Graphics::PixelFormat *format = NULL);
+	void setCursorPalette(const byte *colors, uint start, uint num);
+
+	/** Number of updateScreen() calls since the graphics manager was created. */
+	uint32 getFrameCount() const { return _frameCount; }
+
+protected:
+	Graphics::Surface _screen;
+	Graphics::Surface _overlay;
+	Graphics::Surface _cursor;
+	Graphics::PixelFormat _screenFormat;
+
+	byte _palette[3 * 256];
+	byte _cursorPalette[3 * 256];
+
+	int _screenChangeID;
+	int _shakePos;
+	bool _overlayVisible;
+	bool _mouseVisible;
+	int _mouseX, _mouseY;
+	uint32 _frameCount;
+
+	void copyRect(Graphics::Surface &dst, const byte *buf, int pitch, int x, int y, int w, int h);
+};
+
+#endif
@@ -291,6 +291,7 @@ void DINGUXSdlGraphicsManager::internUpdateScreen() {
 		undrawMouse();
 
 	// Force a full redraw if requested
+	updateDirtyRectList();
 	if (_forceFull) {
 		_numDirtyRects = 1;
 		_dirtyRectList[0].x = 0;
@@ -405,7 +406,7 @@ void DINGUXSdlGraphicsManager::internUpdateScreen() {
 		SDL_UpdateRects(_hwscreen, _numDirtyRects, _dirtyRectList);
 	}
 
-	_numDirtyRects = 0;
+	clearDirtyRects();
 	_forceFull = false;
 	_mouseNeedsRedraw = false;
 }
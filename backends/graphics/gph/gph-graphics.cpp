@@ -320,6 +320,7 @@ void GPHGraphicsManager::internUpdateScreen() {
 		undrawMouse();
 
 	// Force a full redraw if requested
+	updateDirtyRectList();
 	if (_forceFull) {
 		_numDirtyRects = 1;
 		_dirtyRectList[0].x = 0;
@@ -433,7 +434,7 @@ void GPHGraphicsManager::internUpdateScreen() {
 		SDL_UpdateRects(_hwscreen, _numDirtyRects, _dirtyRectList);
 	}
 
-	_numDirtyRects = 0;
+	clearDirtyRects();
 	_forceFull = false;
 	_mouseNeedsRedraw = false;
 }
@@ -332,6 +332,7 @@ void LinuxmotoSdlGraphicsManager::internUpdateScreen() {
 		undrawMouse();
 
 	// Force a full redraw if requested
+	updateDirtyRectList();
 	if (_forceFull) {
 		_numDirtyRects = 1;
 		_dirtyRectList[0].x = 0;
@@ -447,7 +448,7 @@ void LinuxmotoSdlGraphicsManager::internUpdateScreen() {
 		SDL_UpdateRects(_hwscreen, _numDirtyRects, _dirtyRectList);
 	}
 
-	_numDirtyRects = 0;
+	clearDirtyRects();
 	_forceFull = false;
 	_mouseNeedsRedraw = false;
 }
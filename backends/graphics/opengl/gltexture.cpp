@@ -32,10 +32,64 @@
 #include "common/util.h"
 #include "common/tokenizer.h"
 
+// Pixel buffer objects are an extension to OpenGL 1.x, so their entry
+// points have to be looked up at runtime. Only SDL gives us a portable way
+// to do that.
+#if defined(SDL_BACKEND) && !defined(USE_GLES) && !defined(BADA)
+#define USE_GL_PBO
+#include "backends/platform/sdl/sdl-sys.h"
+#include <stddef.h>
+#endif
+
 // Supported GL extensions
 static bool npot_supported = false;
+static bool pbo_supported = false;
 static bool glext_inited = false;
 
+#ifdef USE_GL_PBO
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+#ifndef GL_PIXEL_UNPACK_BUFFER_ARB
+#define GL_PIXEL_UNPACK_BUFFER_ARB	0x88EC
+#endif
+#ifndef GL_STREAM_DRAW_ARB
+#define GL_STREAM_DRAW_ARB			0x88E0
+#endif
+#ifndef GL_WRITE_ONLY_ARB
+#define GL_WRITE_ONLY_ARB			0x88B9
+#endif
+
+typedef void (APIENTRY *GenBuffersProc)(GLsizei n, GLuint *buffers);
+typedef void (APIENTRY *DeleteBuffersProc)(GLsizei n, const GLuint *buffers);
+typedef void (APIENTRY *BindBufferProc)(GLenum target, GLuint buffer);
+typedef void (APIENTRY *BufferDataProc)(GLenum target, ptrdiff_t size, const GLvoid *data, GLenum usage);
+typedef GLvoid *(APIENTRY *MapBufferProc)(GLenum target, GLenum access);
+typedef GLboolean (APIENTRY *UnmapBufferProc)(GLenum target);
+
+static GenBuffersProc glGenBuffersPtr = 0;
+static DeleteBuffersProc glDeleteBuffersPtr = 0;
+static BindBufferProc glBindBufferPtr = 0;
+static BufferDataProc glBufferDataPtr = 0;
+static MapBufferProc glMapBufferPtr = 0;
+static UnmapBufferProc glUnmapBufferPtr = 0;
+
+static bool loadPBOFunctions() {
+	glGenBuffersPtr = (GenBuffersProc)SDL_GL_GetProcAddress("glGenBuffersARB");
+	glDeleteBuffersPtr = (DeleteBuffersProc)SDL_GL_GetProcAddress("glDeleteBuffersARB");
+	glBindBufferPtr = (BindBufferProc)SDL_GL_GetProcAddress("glBindBufferARB");
+	glBufferDataPtr = (BufferDataProc)SDL_GL_GetProcAddress("glBufferDataARB");
+	glMapBufferPtr = (MapBufferProc)SDL_GL_GetProcAddress("glMapBufferARB");
+	glUnmapBufferPtr = (UnmapBufferProc)SDL_GL_GetProcAddress("glUnmapBufferARB");
+
+	return glGenBuffersPtr && glDeleteBuffersPtr && glBindBufferPtr &&
+		glBufferDataPtr && glMapBufferPtr && glUnmapBufferPtr;
+}
+
+#endif
+
 /*static inline GLint xdiv(int numerator, int denominator) {
 	assert(numerator < (1 << 16));
 	return (numerator << 16) / denominator;
@@ -69,8 +123,17 @@ void GLTexture::initGLExtensions() {
 		Common::String token = tokenizer.nextToken();
 		if (token == "GL_ARB_texture_non_power_of_two")
 			npot_supported = true;
+#ifdef USE_GL_PBO
+		else if (token == "GL_ARB_pixel_buffer_object")
+			pbo_supported = true;
+#endif
 	}
 
+#ifdef USE_GL_PBO
+	if (pbo_supported)
+		pbo_supported = loadPBOFunctions();
+#endif
+
 	glext_inited = true;
 }
 
@@ -85,26 +148,56 @@ GLTexture::GLTexture(byte bpp, GLenum internalFormat, GLenum format, GLenum type
 	_realWidth(0),
 	_realHeight(0),
 	_refresh(false),
-	_filter(GL_NEAREST) {
+	_filter(GL_NEAREST),
+	_nextUploadBuffer(0),
+	_convertBuffer(0),
+	_convertBufferSize(0) {
 
 	// Generate the texture ID
 	glGenTextures(1, &_textureName); CHECK_GL_ERROR();
+
+	createUploadBuffers();
 }
 
 GLTexture::~GLTexture() {
 	// Delete the texture
 	glDeleteTextures(1, &_textureName); CHECK_GL_ERROR();
+
+	deleteUploadBuffers();
+	delete[] _convertBuffer;
 }
 
 void GLTexture::refresh() {
 	// Delete previous texture
 	glDeleteTextures(1, &_textureName); CHECK_GL_ERROR();
+	deleteUploadBuffers();
 
 	// Generate the texture ID
 	glGenTextures(1, &_textureName); CHECK_GL_ERROR();
+	createUploadBuffers();
 	_refresh = true;
 }
 
+void GLTexture::createUploadBuffers() {
+	memset(_uploadBuffers, 0, sizeof(_uploadBuffers));
+	_nextUploadBuffer = 0;
+
+#ifdef USE_GL_PBO
+	if (pbo_supported) {
+		glGenBuffersPtr(kNumUploadBuffers, _uploadBuffers); CHECK_GL_ERROR();
+	}
+#endif
+}
+
+void GLTexture::deleteUploadBuffers() {
+#ifdef USE_GL_PBO
+	if (_uploadBuffers[0]) {
+		glDeleteBuffersPtr(kNumUploadBuffers, _uploadBuffers); CHECK_GL_ERROR();
+	}
+#endif
+	memset(_uploadBuffers, 0, sizeof(_uploadBuffers));
+}
+
 void GLTexture::allocBuffer(GLuint w, GLuint h) {
 	_realWidth = w;
 	_realHeight = h;
@@ -149,6 +242,14 @@ void GLTexture::updateBuffer(const void *buf, int pitch, GLuint x, GLuint y, GLu
 	if (static_cast<int>(w) * _bytesPerPixel == pitch) {
 		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h,
 						_glFormat, _glType, buf); CHECK_GL_ERROR();
+#ifdef GL_UNPACK_ROW_LENGTH
+	} else if (pitch % _bytesPerPixel == 0) {
+		// Let OpenGL skip the rest of each line
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch / _bytesPerPixel); CHECK_GL_ERROR();
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h,
+						_glFormat, _glType, buf); CHECK_GL_ERROR();
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0); CHECK_GL_ERROR();
+#endif
 	} else {
 		// Update the texture row by row
 		const byte *src = static_cast<const byte *>(buf);
@@ -161,6 +262,109 @@ void GLTexture::updateBuffer(const void *buf, int pitch, GLuint x, GLuint y, GLu
 	}
 }
 
+void GLTexture::packRect(byte *dst, const Common::Rect &rect, const byte *pixels, int pitch, const byte *palette) const {
+	const int w = rect.width();
+
+	if (palette) {
+		const byte *src = pixels + rect.top * pitch + rect.left;
+		for (int y = rect.top; y < rect.bottom; ++y) {
+			for (int x = 0; x < w; ++x) {
+				const byte *color = palette + src[x] * 3;
+				dst[0] = color[0];
+				dst[1] = color[1];
+				dst[2] = color[2];
+				dst += 3;
+			}
+			src += pitch;
+		}
+	} else {
+		const int lineSize = w * _bytesPerPixel;
+		const byte *src = pixels + rect.top * pitch + rect.left * _bytesPerPixel;
+		for (int y = rect.top; y < rect.bottom; ++y) {
+			memcpy(dst, src, lineSize);
+			dst += lineSize;
+			src += pitch;
+		}
+	}
+}
+
+void GLTexture::updateRects(const Common::Rect *rects, uint numRects, const void *pixels, int pitch, const byte *palette) {
+	assert(!palette || _bytesPerPixel == 3);
+
+	const byte *src = static_cast<const byte *>(pixels);
+
+#ifdef USE_GL_PBO
+	if (_uploadBuffers[0]) {
+		// Every area starts at a 4 byte boundary in the buffer
+		uint size = 0;
+		for (uint i = 0; i < numRects; ++i)
+			size += (rects[i].width() * rects[i].height() * _bytesPerPixel + 3) & ~3;
+
+		if (size == 0)
+			return;
+
+		glBindBufferPtr(GL_PIXEL_UNPACK_BUFFER_ARB, _uploadBuffers[_nextUploadBuffer]); CHECK_GL_ERROR();
+		_nextUploadBuffer = (_nextUploadBuffer + 1) % kNumUploadBuffers;
+
+		// Orphan the old storage first. The driver may still be copying
+		// from it, and this way it just hands us fresh memory instead of
+		// waiting for that to finish.
+		glBufferDataPtr(GL_PIXEL_UNPACK_BUFFER_ARB, size, NULL, GL_STREAM_DRAW_ARB); CHECK_GL_ERROR();
+		byte *dst = static_cast<byte *>(glMapBufferPtr(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB)); CHECK_GL_ERROR();
+
+		if (dst) {
+			uint offset = 0;
+			for (uint i = 0; i < numRects; ++i) {
+				packRect(dst + offset, rects[i], src, pitch, palette);
+				offset += (rects[i].width() * rects[i].height() * _bytesPerPixel + 3) & ~3;
+			}
+			glUnmapBufferPtr(GL_PIXEL_UNPACK_BUFFER_ARB); CHECK_GL_ERROR();
+
+			// With a buffer bound, the data pointer is an offset into it
+			glBindTexture(GL_TEXTURE_2D, _textureName); CHECK_GL_ERROR();
+			offset = 0;
+			for (uint i = 0; i < numRects; ++i) {
+				const Common::Rect &r = rects[i];
+				if (!r.isEmpty()) {
+					glTexSubImage2D(GL_TEXTURE_2D, 0, r.left, r.top, r.width(), r.height(),
+						_glFormat, _glType, (const GLvoid *)(size_t)offset); CHECK_GL_ERROR();
+				}
+				offset += (r.width() * r.height() * _bytesPerPixel + 3) & ~3;
+			}
+
+			glBindBufferPtr(GL_PIXEL_UNPACK_BUFFER_ARB, 0); CHECK_GL_ERROR();
+			return;
+		}
+
+		// Mapping can fail, e.g. when running out of memory; fall back to
+		// uploading from client memory then.
+		glBindBufferPtr(GL_PIXEL_UNPACK_BUFFER_ARB, 0); CHECK_GL_ERROR();
+	}
+#endif
+
+	for (uint i = 0; i < numRects; ++i) {
+		const Common::Rect &r = rects[i];
+		if (r.isEmpty())
+			continue;
+
+		if (!palette) {
+			updateBuffer(src + r.top * pitch + r.left * _bytesPerPixel, pitch,
+				r.left, r.top, r.width(), r.height());
+			continue;
+		}
+
+		const uint size = r.width() * r.height() * 3;
+		if (size > _convertBufferSize) {
+			delete[] _convertBuffer;
+			_convertBuffer = new byte[size];
+			_convertBufferSize = size;
+		}
+
+		packRect(_convertBuffer, r, src, pitch, palette);
+		updateBuffer(_convertBuffer, r.width() * 3, r.left, r.top, r.width(), r.height());
+	}
+}
+
 void GLTexture::drawTexture(GLshort x, GLshort y, GLshort w, GLshort h) {
 	// Select this OpenGL texture
 	glBindTexture(GL_TEXTURE_2D, _textureName); CHECK_GL_ERROR();
@@ -55,6 +55,7 @@ using namespace Osp::Graphics::Opengl;
 #include <GL/gl.h>
 #endif
 
+#include "common/rect.h"
 #include "graphics/surface.h"
 
 /**
@@ -87,6 +88,24 @@ public:
 	virtual void updateBuffer(const void *buf, int pitch, GLuint x, GLuint y,
 		GLuint w, GLuint h);
 
+	/**
+	 * Updates several areas of the texture at once.
+	 *
+	 * When pixel buffer objects are supported, all areas are packed into
+	 * one buffer of a small ring, so the driver can copy them to the
+	 * texture without stalling the CPU.
+	 *
+	 * @param rects		the areas to update
+	 * @param numRects	number of areas
+	 * @param pixels	pixel data covering the whole texture
+	 * @param pitch		pitch of the pixel data
+	 * @param palette	if set, the pixel data is paletted and converted
+	 *					to RGB888 while uploading; the texture must use
+	 *					GL_RGB with GL_UNSIGNED_BYTE then
+	 */
+	virtual void updateRects(const Common::Rect *rects, uint numRects, const void *pixels,
+		int pitch, const byte *palette = 0);
+
 	/**
 	 * Draws the texture to the screen buffer.
 	 */
@@ -121,6 +140,27 @@ protected:
 	GLuint _textureHeight;
 	GLint _filter;
 	bool _refresh;
+
+	enum {
+		kNumUploadBuffers = 3
+	};
+
+	/** Ring of pixel buffer objects for uploads; all 0 if not supported */
+	GLuint _uploadBuffers[kNumUploadBuffers];
+	uint _nextUploadBuffer;
+
+	/** Conversion buffer for paletted uploads without pixel buffer objects */
+	byte *_convertBuffer;
+	uint _convertBufferSize;
+
+	void createUploadBuffers();
+	void deleteUploadBuffers();
+
+	/**
+	 * Copies an area of the pixel data to tightly packed memory, converting
+	 * it to RGB888 if a palette is given.
+	 */
+	void packRect(byte *dst, const Common::Rect &rect, const byte *pixels, int pitch, const byte *palette) const;
 };
 
 #endif
@@ -27,6 +27,7 @@
 #include "backends/graphics/opengl/opengl-graphics.h"
 #include "backends/graphics/opengl/glerrorcheck.h"
 #include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/file.h"
 #include "common/mutex.h"
 #include "common/textconsole.h"
@@ -44,8 +45,8 @@ OpenGLGraphicsManager::OpenGLGraphicsManager()
 #endif
 	_gameTexture(0), _overlayTexture(0), _cursorTexture(0),
 	_screenChangeCount(1 << (sizeof(int) * 8 - 2)), _screenNeedsRedraw(false),
-	_shakePos(0),
-	_overlayVisible(false), _overlayNeedsRedraw(false),
+	_screenDamage(kMaxDirtyRects), _shakePos(0),
+	_overlayVisible(false), _overlayNeedsRedraw(false), _overlayDamage(kMaxDirtyRects),
 	_transactionMode(kTransactionNone),
 	_cursorNeedsRedraw(false), _cursorPaletteDisabled(true),
 	_cursorVisible(false), _cursorKeyColor(0),
@@ -56,6 +57,7 @@ OpenGLGraphicsManager::OpenGLGraphicsManager()
 	memset(&_oldVideoMode, 0, sizeof(_oldVideoMode));
 	memset(&_videoMode, 0, sizeof(_videoMode));
 	memset(&_transactionDetails, 0, sizeof(_transactionDetails));
+	memset(&_frameStats, 0, sizeof(_frameStats));
 
 	_videoMode.mode = OpenGL::GFX_NORMAL;
 	_videoMode.scaleFactor = 2;
@@ -363,6 +365,7 @@ void OpenGLGraphicsManager::copyRectToScreen(const byte *buf, int pitch, int x,
 	if (!_screenNeedsRedraw) {
 		const Common::Rect dirtyRect(x, y, x + w, y + h);
 		_screenDirtyRect.extend(dirtyRect);
+		_screenDamage.addRect(dirtyRect);
 	}
 }
 
@@ -526,6 +529,7 @@ void OpenGLGraphicsManager::copyRectToOverlay(const OverlayColor *buf, int pitch
 	if (!_overlayNeedsRedraw) {
 		const Common::Rect dirtyRect(x, y, x + w, y + h);
 		_overlayDirtyRect.extend(dirtyRect);
+		_overlayDamage.addRect(dirtyRect);
 	}
 }
 
@@ -682,85 +686,35 @@ void OpenGLGraphicsManager::setFullscreenMode(bool enable) {
 	}
 }
 
-void OpenGLGraphicsManager::refreshGameScreen() {
-	if (_screenNeedsRedraw)
-		_screenDirtyRect = Common::Rect(0, 0, _screenData.w, _screenData.h);
-
-	int x = _screenDirtyRect.left;
-	int y = _screenDirtyRect.top;
-	int w = _screenDirtyRect.width();
-	int h = _screenDirtyRect.height();
-
-	if (_screenData.format.bytesPerPixel == 1) {
-		// Create a temporary RGB888 surface
-		byte *surface = new byte[w * h * 3];
-
-		// Convert the paletted buffer to RGB888
-		const byte *src = (byte *)_screenData.pixels + y * _screenData.pitch;
-		src += x * _screenData.format.bytesPerPixel;
-		byte *dst = surface;
-		for (int i = 0; i < h; i++) {
-			for (int j = 0; j < w; j++) {
-				dst[0] = _gamePalette[src[j] * 3];
-				dst[1] = _gamePalette[src[j] * 3 + 1];
-				dst[2] = _gamePalette[src[j] * 3 + 2];
-				dst += 3;
-			}
-			src += _screenData.pitch;
-		}
+void OpenGLGraphicsManager::uploadDirtyRects(GLTexture *texture, const Graphics::Surface &surface, Graphics::DamageTracker &damage, bool full) {
+	// Paletted surfaces are converted to RGB888 during the upload
+	const byte *palette = (surface.format.bytesPerPixel == 1) ? _gamePalette : 0;
 
-		// Update the texture
-		_gameTexture->updateBuffer(surface, w * 3, x, y, w, h);
+	damage.setScreenSize(surface.w, surface.h);
+	if (full || damage.isEmpty())
+		damage.markFull();
 
-		// Free the temp surface
-		delete[] surface;
+	if (damage.isFull()) {
+		const Common::Rect area(0, 0, surface.w, surface.h);
+		texture->updateRects(&area, 1, surface.pixels, surface.pitch, palette);
+		_frameStats.uploadPixels += surface.w * surface.h;
 	} else {
-		// Update the texture
-		_gameTexture->updateBuffer((byte *)_screenData.pixels + y * _screenData.pitch +
-			x * _screenData.format.bytesPerPixel, _screenData.pitch, x, y, w, h);
+		const Common::Array<Common::Rect> &rects = damage.getRects();
+		texture->updateRects(rects.begin(), rects.size(), surface.pixels, surface.pitch, palette);
+		for (uint i = 0; i < rects.size(); ++i)
+			_frameStats.uploadPixels += rects[i].width() * rects[i].height();
 	}
+}
+
+void OpenGLGraphicsManager::refreshGameScreen() {
+	uploadDirtyRects(_gameTexture, _screenData, _screenDamage, _screenNeedsRedraw);
 
 	_screenNeedsRedraw = false;
 	_screenDirtyRect = Common::Rect();
 }
 
 void OpenGLGraphicsManager::refreshOverlay() {
-	if (_overlayNeedsRedraw)
-		_overlayDirtyRect = Common::Rect(0, 0, _overlayData.w, _overlayData.h);
-
-	int x = _overlayDirtyRect.left;
-	int y = _overlayDirtyRect.top;
-	int w = _overlayDirtyRect.width();
-	int h = _overlayDirtyRect.height();
-
-	if (_overlayData.format.bytesPerPixel == 1) {
-		// Create a temporary RGB888 surface
-		byte *surface = new byte[w * h * 3];
-
-		// Convert the paletted buffer to RGB888
-		const byte *src = (byte *)_overlayData.pixels + y * _overlayData.pitch;
-		src += x * _overlayData.format.bytesPerPixel;
-		byte *dst = surface;
-		for (int i = 0; i < h; i++) {
-			for (int j = 0; j < w; j++) {
-				dst[0] = _gamePalette[src[j] * 3];
-				dst[1] = _gamePalette[src[j] * 3 + 1];
-				dst[2] = _gamePalette[src[j] * 3 + 2];
-				dst += 3;
-			}
-			src += _screenData.pitch;
-		}
-
-		// Update the texture
-		_overlayTexture->updateBuffer(surface, w * 3, x, y, w, h);
-
-		// Free the temp surface
-		delete[] surface;
-	} else {
-		// Update the texture
-		_overlayTexture->updateBuffer((byte *)_overlayData.pixels + y * _overlayData.pitch +
-			x * _overlayData.format.bytesPerPixel, _overlayData.pitch, x, y, w, h);
-	}
+	uploadDirtyRects(_overlayTexture, _overlayData, _overlayDamage, _overlayNeedsRedraw);
 
 	_overlayNeedsRedraw = false;
 	_overlayDirtyRect = Common::Rect();
@@ -990,12 +944,22 @@ void OpenGLGraphicsManager::getGLPixelFormat(Graphics::PixelFormat pixelFormat,
 }
 
 void OpenGLGraphicsManager::internUpdateScreen() {
+	const uint32 frameStart = g_system->getMillis();
+	if (_frameStats.frames)
+		_frameStats.frameMillis += frameStart - _frameStats.lastFrameStart;
+	_frameStats.lastFrameStart = frameStart;
+	++_frameStats.frames;
+
 	// Clear the screen buffer
 	glClear(GL_COLOR_BUFFER_BIT); CHECK_GL_ERROR();
 
-	if (_screenNeedsRedraw || !_screenDirtyRect.isEmpty())
+	if (_screenNeedsRedraw || !_screenDirtyRect.isEmpty()) {
 		// Refresh texture if dirty
+		const uint32 uploadStart = g_system->getMillis();
 		refreshGameScreen();
+		_frameStats.uploadMillis += g_system->getMillis() - uploadStart;
+	}
+	_screenDamage.endFrame();
 
 	int scaleFactor = _videoMode.hardwareHeight / _videoMode.screenHeight;
 
@@ -1010,9 +974,13 @@ void OpenGLGraphicsManager::internUpdateScreen() {
 	glPopMatrix();
 
 	if (_overlayVisible) {
-		if (_overlayNeedsRedraw || !_overlayDirtyRect.isEmpty())
+		if (_overlayNeedsRedraw || !_overlayDirtyRect.isEmpty()) {
 			// Refresh texture if dirty
+			const uint32 uploadStart = g_system->getMillis();
 			refreshOverlay();
+			_frameStats.uploadMillis += g_system->getMillis() - uploadStart;
+			_overlayDamage.endFrame();
+		}
 
 		// Draw the overlay
 		_overlayTexture->drawTexture(0, 0, _videoMode.overlayWidth, _videoMode.overlayHeight);
@@ -1067,6 +1035,12 @@ void OpenGLGraphicsManager::internUpdateScreen() {
 		glColor4f(1.0f, 1.0f, 1.0f, 1.0f); CHECK_GL_ERROR();
 	}
 #endif
+
+	if ((_frameStats.frames & 1023) == 0) {
+		debug(5, "OpenGL: %d frames, %d ms per frame, %d ms uploading %d Kpixels",
+			_frameStats.frames, _frameStats.frameMillis / (_frameStats.frames - 1),
+			_frameStats.uploadMillis, _frameStats.uploadPixels / 1000);
+	}
 }
 
 void OpenGLGraphicsManager::initGL() {
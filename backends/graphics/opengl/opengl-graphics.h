@@ -27,6 +27,7 @@
 #include "backends/graphics/graphics.h"
 #include "common/array.h"
 #include "common/rect.h"
+#include "graphics/damagetracker.h"
 #include "graphics/font.h"
 #include "graphics/pixelformat.h"
 
@@ -108,6 +109,17 @@ public:
 	virtual void setCursorPalette(const byte *colors, uint start, uint num);
 
 	virtual void displayMessageOnOSD(const char *msg);
+
+	/** Frame time counters, in milliseconds */
+	struct FrameStats {
+		uint32 frames;			/** < Number of frames drawn */
+		uint32 frameMillis;		/** < Time between the starts of consecutive frames */
+		uint32 uploadMillis;	/** < Time spent updating the textures */
+		uint32 uploadPixels;	/** < Number of pixels uploaded */
+		uint32 lastFrameStart;	/** < Start of the last frame */
+	};
+
+	const FrameStats &getFrameStats() const { return _frameStats; }
 protected:
 	/**
 	 * Setup OpenGL settings
@@ -225,8 +237,15 @@ protected:
 	GLTexture *_gameTexture;
 	Graphics::Surface _screenData;
 	int _screenChangeCount;
+	enum {
+		/** Maximum number of separately uploaded dirty areas per texture */
+		kMaxDirtyRects = 16
+	};
+
 	bool _screenNeedsRedraw;
 	Common::Rect _screenDirtyRect;
+	/** The individual areas making up _screenDirtyRect */
+	Graphics::DamageTracker _screenDamage;
 
 #ifdef USE_RGB_COLOR
 	Graphics::PixelFormat _screenFormat;
@@ -247,9 +266,19 @@ protected:
 	bool _overlayVisible;
 	bool _overlayNeedsRedraw;
 	Common::Rect _overlayDirtyRect;
+	/** The individual areas making up _overlayDirtyRect */
+	Graphics::DamageTracker _overlayDamage;
 
 	virtual void refreshOverlay();
 
+	/**
+	 * Upload the dirty areas of a surface to its texture. A full redraw
+	 * is done if requested or if the tracker has no areas.
+	 */
+	void uploadDirtyRects(GLTexture *texture, const Graphics::Surface &surface, Graphics::DamageTracker &damage, bool full);
+
+	FrameStats _frameStats;
+
 	//
 	// Mouse
 	//
@@ -133,7 +133,8 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 #endif
 	_overlayVisible(false),
 	_overlayscreen(0), _tmpscreen2(0),
-	_scalerProc(0), _screenChangeCount(0),
+	_scalerProc(0), _scalerPool(0), _screenChangeCount(0),
+	_damage(NUM_DIRTY_RECT - 1), _numDirtyRects(0), _tileDiffing(false),
 	_mouseVisible(false), _mouseNeedsRedraw(false), _mouseData(0), _mouseSurface(0),
 	_mouseOrigSurface(0), _cursorTargetScale(1), _cursorPaletteDisabled(true),
 	_currentShakePos(0), _newShakePos(0),
@@ -193,6 +194,20 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 #else
 	_videoMode.fullscreen = true;
 #endif
+	// Comparing screen updates against the old content is opt-in until
+	// it has seen more testing.
+	if (ConfMan.hasKey("dirty_tile_diff"))
+		_tileDiffing = ConfMan.getBool("dirty_tile_diff");
+
+	// Threaded scaling is opt-in. The main thread scales one band itself,
+	// so e.g. scaler_threads=3 splits the screen into four bands.
+	int scalerThreads = 0;
+	if (ConfMan.hasKey("scaler_threads"))
+		scalerThreads = ConfMan.getInt("scaler_threads");
+	if (scalerThreads > 0)
+		_scalerPool = new SdlScalerPool(scalerThreads);
+
+	resetScalerStats();
 }
 
 SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
@@ -208,6 +223,7 @@ SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
 		SDL_FreeSurface(_mouseOrigSurface);
 	_mouseOrigSurface = 0;
 	g_system->deleteMutex(_graphicsMutex);
+	delete _scalerPool;
 
 	free(_currentPalette);
 	free(_cursorPalette);
@@ -1039,7 +1055,10 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		undrawMouse();
 
 	// Force a full redraw if requested
+	_damage.setScreenSize(width, height);
+	updateDirtyRectList();
 	if (_forceFull) {
+		_damage.markFull();
 		_numDirtyRects = 1;
 		_dirtyRectList[0].x = 0;
 		_dirtyRectList[0].y = 0;
@@ -1051,7 +1070,6 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	if (_numDirtyRects > 0 || _mouseNeedsRedraw) {
 		SDL_Rect *r;
 		SDL_Rect dst;
-		uint32 srcPitch, dstPitch;
 		SDL_Rect *lastRect = _dirtyRectList + _numDirtyRects;
 
 		for (r = _dirtyRectList; r != lastRect; ++r) {
@@ -1066,41 +1084,8 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		SDL_LockSurface(srcSurf);
 		SDL_LockSurface(_hwscreen);
 
-		srcPitch = srcSurf->pitch;
-		dstPitch = _hwscreen->pitch;
-
-		for (r = _dirtyRectList; r != lastRect; ++r) {
-			register int dst_y = r->y + _currentShakePos;
-			register int dst_h = 0;
-			register int orig_dst_y = 0;
-			register int rx1 = r->x * scale1;
-
-			if (dst_y < height) {
-				dst_h = r->h;
-				if (dst_h > height - dst_y)
-					dst_h = height - dst_y;
-
-				orig_dst_y = dst_y;
-				dst_y = dst_y * scale1;
-
-				if (_videoMode.aspectRatioCorrection && !_overlayVisible)
-					dst_y = real2Aspect(dst_y);
-
-				assert(scalerProc != NULL);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-					(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
-			}
-
-			r->x = rx1;
-			r->y = dst_y;
-			r->w = r->w * scale1;
-			r->h = dst_h * scale1;
+		scaleDirtyRects(srcSurf, height, scalerProc, scale1);
 
-#ifdef USE_SCALERS
-			if (_videoMode.aspectRatioCorrection && orig_dst_y < height && !_overlayVisible)
-				r->h = stretch200To240((uint8 *) _hwscreen->pixels, dstPitch, r->w, r->h, r->x, r->y, orig_dst_y * scale1);
-#endif
-		}
 		SDL_UnlockSurface(srcSurf);
 		SDL_UnlockSurface(_hwscreen);
 
@@ -1195,11 +1180,139 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		SDL_UpdateRects(_hwscreen, _numDirtyRects, _dirtyRectList);
 	}
 
-	_numDirtyRects = 0;
+	clearDirtyRects();
 	_forceFull = false;
 	_mouseNeedsRedraw = false;
 }
 
+void SurfaceSdlGraphicsManager::scaleDirtyRects(SDL_Surface *srcSurf, int height, ScalerProc *scalerProc, int scale1) {
+	const uint32 startTime = SDL_GetTicks();
+	const uint32 srcPitch = srcSurf->pitch;
+	const uint32 dstPitch = _hwscreen->pitch;
+	const bool aspectCorrection = _videoMode.aspectRatioCorrection && !_overlayVisible;
+	// Scalers which are not reentrant are run on this thread, one rect
+	// at a time.
+	const bool useThreads = _scalerPool && isScalerReentrant(scalerProc);
+	const int maxBands = useThreads ? _scalerPool->getNumThreads() + 1 : 1;
+
+	assert(scalerProc != NULL);
+
+	// The rects whose jobs are queued in the pool. The aspect ratio
+	// correction works in place and reads the row above a rect, so it can
+	// only run once all bands of a rect are scaled, and rects touching the
+	// same area of _hwscreen must be processed in their original order to
+	// get the same result as scaling them one by one.
+	SDL_Rect *batchRects[NUM_DIRTY_RECT];
+	Common::Rect batchAreas[NUM_DIRTY_RECT];
+	int batchOrigY[NUM_DIRTY_RECT];
+	int batchSize = 0;
+
+	SDL_Rect *lastRect = _dirtyRectList + _numDirtyRects;
+	for (SDL_Rect *r = _dirtyRectList; r != lastRect; ++r) {
+		int dst_y = r->y + _currentShakePos;
+		int dst_h = 0;
+		int orig_dst_y = 0;
+		int rx1 = r->x * scale1;
+
+		if (dst_y < height) {
+			dst_h = r->h;
+			if (dst_h > height - dst_y)
+				dst_h = height - dst_y;
+
+			orig_dst_y = dst_y;
+			dst_y = dst_y * scale1;
+
+			if (aspectCorrection)
+				dst_y = real2Aspect(dst_y);
+
+			// The part of _hwscreen this rect writes to, including the
+			// row above which the aspect ratio correction reads.
+			int lastRow = dst_y + dst_h * scale1 - 1;
+			if (aspectCorrection)
+				lastRow = real2Aspect(orig_dst_y * scale1 + dst_h * scale1 - 1);
+			const Common::Rect area(rx1, dst_y - 1, rx1 + r->w * scale1, lastRow + 1);
+
+			for (int i = 0; i < batchSize; ++i) {
+				if (area.intersects(batchAreas[i])) {
+					finishScalerBatch(batchRects, batchOrigY, batchSize, scale1, useThreads);
+					batchSize = 0;
+					break;
+				}
+			}
+
+			// Split the rect into horizontal bands, one per thread. The
+			// scalers read the rows around each band straight from
+			// srcSurf, which is not modified while scaling.
+			const int bandHeight = getScalerBandHeight(dst_h, maxBands);
+
+			const byte *src = (const byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch;
+			byte *dst = (byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch;
+			for (int y = 0; y < dst_h; y += bandHeight) {
+				SdlScalerPool::Job job;
+				job.scaler = scalerProc;
+				job.src = src + y * srcPitch;
+				job.srcPitch = srcPitch;
+				job.dst = dst + y * scale1 * dstPitch;
+				job.dstPitch = dstPitch;
+				job.width = r->w;
+				job.height = MIN<int>(bandHeight, dst_h - y);
+				queueScalerJob(job, useThreads);
+			}
+
+			_scalerStats.pixels += r->w * dst_h;
+			++_scalerStats.rects;
+
+			batchRects[batchSize] = r;
+			batchAreas[batchSize] = area;
+			batchOrigY[batchSize] = aspectCorrection ? orig_dst_y : -1;
+			++batchSize;
+		}
+
+		r->x = rx1;
+		r->y = dst_y;
+		r->w = r->w * scale1;
+		r->h = dst_h * scale1;
+	}
+
+	finishScalerBatch(batchRects, batchOrigY, batchSize, scale1, useThreads);
+
+	++_scalerStats.frames;
+	_scalerStats.millis += SDL_GetTicks() - startTime;
+
+	if ((_scalerStats.frames & 1023) == 0 && _scalerStats.millis) {
+		debug(5, "Scaler: %d frames, %d rects, %d jobs, %d Kpixels in %d ms",
+			_scalerStats.frames, _scalerStats.rects, _scalerStats.jobs,
+			_scalerStats.pixels / 1000, _scalerStats.millis);
+	}
+}
+
+void SurfaceSdlGraphicsManager::queueScalerJob(const SdlScalerPool::Job &job, bool useThreads) {
+	if (useThreads) {
+		_scalerPool->addJob(job);
+		++_scalerStats.jobs;
+	} else {
+		job.scaler(job.src, job.srcPitch, job.dst, job.dstPitch, job.width, job.height);
+	}
+}
+
+void SurfaceSdlGraphicsManager::finishScalerBatch(SDL_Rect **rects, const int *origY, int count, int scale1, bool useThreads) {
+	if (useThreads)
+		_scalerPool->run();
+
+#ifdef USE_SCALERS
+	// The rects were already converted to real coordinates by the caller
+	for (int i = 0; i < count; ++i) {
+		SDL_Rect *r = rects[i];
+		if (origY[i] >= 0)
+			r->h = stretch200To240((uint8 *)_hwscreen->pixels, _hwscreen->pitch, r->w, r->h, r->x, r->y, origY[i] * scale1);
+	}
+#endif
+}
+
+void SurfaceSdlGraphicsManager::resetScalerStats() {
+	memset(&_scalerStats, 0, sizeof(_scalerStats));
+}
+
 bool SurfaceSdlGraphicsManager::saveScreenshot(const char *filename) {
 	assert(_hwscreen != NULL);
 
@@ -1247,12 +1360,16 @@ void SurfaceSdlGraphicsManager::copyRectToScreen(const byte *src, int pitch, int
 	assert(h > 0 && y + h <= _videoMode.screenHeight);
 	assert(w > 0 && x + w <= _videoMode.screenWidth);
 
-	addDirtyRect(x, y, w, h);
-
 	// Try to lock the screen surface
 	if (SDL_LockSurface(_screen) == -1)
 		error("SDL_LockSurface failed: %s", SDL_GetError());
 
+#ifdef USE_RGB_COLOR
+	addChangedRect(src, pitch, _screen, _screenFormat.bytesPerPixel, x, y, w, h);
+#else
+	addChangedRect(src, pitch, _screen, 1, x, y, w, h);
+#endif
+
 #ifdef USE_RGB_COLOR
 	byte *dst = (byte *)_screen->pixels + y * _screen->pitch + x * _screenFormat.bytesPerPixel;
 	if (_videoMode.screenWidth == w && pitch == _screen->pitch) {
@@ -1336,11 +1453,6 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 	if (_forceFull)
 		return;
 
-	if (_numDirtyRects == NUM_DIRTY_RECT) {
-		_forceFull = true;
-		return;
-	}
-
 	int height, width;
 
 	if (!_overlayVisible && !realCoordinates) {
@@ -1390,13 +1502,77 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 		return;
 	}
 
-	if (w > 0 && h > 0) {
-		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
+	if (w <= 0 || h <= 0)
+		return;
+
+	if (!realCoordinates) {
+		// The tracker merges the rects instead of falling back to a full
+		// redraw. It keeps one slot of _dirtyRectList free for the cursor.
+		_damage.addRect(Common::Rect(x, y, x + w, y + h));
+		return;
+	}
 
+	// Real coordinate rects are added after the dirty rects were scaled,
+	// so they must not be mixed with the virtual ones of the tracker.
+	if (_numDirtyRects < NUM_DIRTY_RECT) {
+		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
 		r->x = x;
 		r->y = y;
 		r->w = w;
 		r->h = h;
+	} else {
+		// Grow the last rect, everything in the list is scaled by now
+		SDL_Rect *r = &_dirtyRectList[NUM_DIRTY_RECT - 1];
+		const int right = MAX<int>(r->x + r->w, x + w);
+		const int bottom = MAX<int>(r->y + r->h, y + h);
+		r->x = MIN<int>(r->x, x);
+		r->y = MIN<int>(r->y, y);
+		r->w = right - r->x;
+		r->h = bottom - r->y;
+	}
+}
+
+void SurfaceSdlGraphicsManager::addChangedRect(const byte *src, int pitch, SDL_Surface *surf, int bytesPerPixel, int x, int y, int w, int h) {
+	const Common::Rect rect(x, y, x + w, y + h);
+	_damage.submit(rect);
+
+	if (!_tileDiffing || _forceFull) {
+		addDirtyRect(x, y, w, h);
+		return;
+	}
+
+	const byte *old = (const byte *)surf->pixels + y * surf->pitch + x * bytesPerPixel;
+	_changedTiles.resize(0);
+	_damage.diffRect(src, pitch, old, surf->pitch, bytesPerPixel, rect, _changedTiles);
+
+	for (uint i = 0; i < _changedTiles.size(); ++i) {
+		const Common::Rect &tile = _changedTiles[i];
+		addDirtyRect(tile.left, tile.top, tile.width(), tile.height());
+	}
+}
+
+void SurfaceSdlGraphicsManager::updateDirtyRectList() {
+	const Common::Array<Common::Rect> &rects = _damage.getRects();
+	_numDirtyRects = rects.size();
+	for (int i = 0; i < _numDirtyRects; ++i) {
+		SDL_Rect *r = &_dirtyRectList[i];
+
+		r->x = rects[i].left;
+		r->y = rects[i].top;
+		r->w = rects[i].width();
+		r->h = rects[i].height();
+	}
+}
+
+void SurfaceSdlGraphicsManager::clearDirtyRects() {
+	_damage.endFrame();
+	_numDirtyRects = 0;
+
+	const Graphics::DamageTracker::Stats &stats = _damage.getLastFrameStats();
+	if (stats.submittedPixels || stats.dirtyPixels) {
+		debug(9, "Damage: %d rects with %d pixels submitted, %d pixels changed, %d rects with %d pixels redrawn%s",
+			stats.submittedRects, stats.submittedPixels, stats.changedPixels,
+			stats.dirtyRects, stats.dirtyPixels, stats.full ? " (full)" : "");
 	}
 }
 
@@ -1648,12 +1824,12 @@ void SurfaceSdlGraphicsManager::copyRectToOverlay(const OverlayColor *buf, int p
 	if (w <= 0 || h <= 0)
 		return;
 
-	// Mark the modified region as dirty
-	addDirtyRect(x, y, w, h);
-
 	if (SDL_LockSurface(_overlayscreen) == -1)
 		error("SDL_LockSurface failed: %s", SDL_GetError());
 
+	// Mark the modified region as dirty
+	addChangedRect((const byte *)buf, pitch * 2, _overlayscreen, 2, x, y, w, h);
+
 	byte *dst = (byte *)_overlayscreen->pixels + y * _overlayscreen->pitch + x * 2;
 	do {
 		memcpy(dst, buf, w * 2);
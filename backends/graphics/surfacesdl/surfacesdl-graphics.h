@@ -25,6 +25,7 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/graphics/sdl/sdl-graphics.h"
+#include "graphics/damagetracker.h"
 #include "graphics/pixelformat.h"
 #include "graphics/scaler.h"
 #include "common/events.h"
@@ -32,6 +33,7 @@
 
 #include "backends/events/sdl/sdl-events.h"
 
+#include "backends/graphics/surfacesdl/surfacesdl-scalerpool.h"
 #include "backends/platform/sdl/sdl-sys.h"
 
 #ifndef RELEASE_BUILD
@@ -146,6 +148,21 @@ public:
 	virtual void transformMouseCoordinates(Common::Point &point);
 	virtual void notifyMousePos(Common::Point mouse);
 
+	/** Counters for the scaler stage of internUpdateScreen() */
+	struct ScalerStats {
+		uint32 frames;	/** < Number of frames which scaled anything */
+		uint32 rects;	/** < Number of dirty rects scaled */
+		uint32 jobs;	/** < Number of bands handed to the scaler threads */
+		uint32 pixels;	/** < Number of source pixels scaled */
+		uint32 millis;	/** < Time spent scaling and aspect correcting */
+	};
+
+	const ScalerStats &getScalerStats() const { return _scalerStats; }
+	void resetScalerStats();
+
+	/** Statistics of the dirty rects of the last frame */
+	const Graphics::DamageTracker::Stats &getDamageStats() const { return _damage.getLastFrameStats(); }
+
 protected:
 #ifdef USE_OSD
 	/** Surface containing the OSD message */
@@ -230,6 +247,10 @@ protected:
 
 	ScalerProc *_scalerProc;
 	int _scalerType;
+
+	/** Worker threads for the scaler, or 0 to scale on the main thread only */
+	SdlScalerPool *_scalerPool;
+	ScalerStats _scalerStats;
 	int _transactionMode;
 
 	bool _screenIsLocked;
@@ -242,10 +263,17 @@ protected:
 		MAX_SCALING = 3
 	};
 
-	// Dirty rect management
+	// Dirty rect management. The tracker merges the rects in virtual
+	// coordinates, which are copied to _dirtyRectList once per frame.
+	// Rects in real coordinates are only ever added to _dirtyRectList.
+	Graphics::DamageTracker _damage;
 	SDL_Rect _dirtyRectList[NUM_DIRTY_RECT];
 	int _numDirtyRects;
 
+	/** Whether screen updates are compared against the old content */
+	bool _tileDiffing;
+	Common::Array<Common::Rect> _changedTiles;
+
 	struct MousePos {
 		// The mouse position, using either virtual (game) or real
 		// (overlay) coordinates.
@@ -314,12 +342,35 @@ protected:
 
 	virtual void addDirtyRect(int x, int y, int w, int h, bool realCoordinates = false);
 
+	/**
+	 * Mark the parts of a rect of surf as dirty which differ from the new
+	 * data in src. surf must be locked and still hold the old content.
+	 */
+	void addChangedRect(const byte *src, int pitch, SDL_Surface *surf, int bytesPerPixel, int x, int y, int w, int h);
+
+	/**
+	 * Copy the merged rects of the damage tracker to _dirtyRectList. This
+	 * has to be done once per frame, before the dirty rects are blitted.
+	 */
+	void updateDirtyRectList();
+
+	/** Finish the dirty rects of the current frame. */
+	void clearDirtyRects();
+
 	virtual void drawMouse();
 	virtual void undrawMouse();
 	virtual void blitCursor();
 
 	virtual void internUpdateScreen();
 
+	/**
+	 * Scale all dirty rects from srcSurf to _hwscreen and apply the aspect
+	 * ratio correction. The dirty rects are converted to real coordinates.
+	 */
+	void scaleDirtyRects(SDL_Surface *srcSurf, int height, ScalerProc *scalerProc, int scale1);
+	void queueScalerJob(const SdlScalerPool::Job &job, bool useThreads);
+	void finishScalerBatch(SDL_Rect **rects, const int *origY, int count, int scale1, bool useThreads);
+
 	virtual bool loadGFXMode();
 	virtual void unloadGFXMode();
 	virtual bool hotswapGFXMode();
@@ -0,0 +1,140 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/graphics/surfacesdl/surfacesdl-scalerpool.h"
+
+#include "common/textconsole.h"
+
+SdlScalerPool::SdlScalerPool(uint numThreads)
+	: _mutex(0), _workCond(0), _doneCond(0), _numQueuedJobs(0),
+	  _numActiveJobs(0), _nextJob(0), _pendingJobs(0), _quit(false) {
+
+	_mutex = SDL_CreateMutex();
+	_workCond = SDL_CreateCond();
+	_doneCond = SDL_CreateCond();
+
+	for (uint i = 0; i < numThreads; ++i) {
+		SDL_Thread *thread = SDL_CreateThread(workerThreadEntry, this);
+		if (!thread) {
+			// Not fatal, we just scale with fewer threads
+			warning("Could not create scaler thread: %s", SDL_GetError());
+			break;
+		}
+		_threads.push_back(thread);
+	}
+}
+
+SdlScalerPool::~SdlScalerPool() {
+	SDL_LockMutex(_mutex);
+	_quit = true;
+	SDL_CondBroadcast(_workCond);
+	SDL_UnlockMutex(_mutex);
+
+	for (uint i = 0; i < _threads.size(); ++i)
+		SDL_WaitThread(_threads[i], NULL);
+
+	SDL_DestroyCond(_doneCond);
+	SDL_DestroyCond(_workCond);
+	SDL_DestroyMutex(_mutex);
+}
+
+void SdlScalerPool::addJob(const Job &job) {
+	// The workers only look at the first _numActiveJobs entries, which is
+	// zero outside of run(), so the array can be modified without locking.
+	if (_numQueuedJobs < _jobs.size())
+		_jobs[_numQueuedJobs] = job;
+	else
+		_jobs.push_back(job);
+	++_numQueuedJobs;
+}
+
+void SdlScalerPool::run() {
+	if (_numQueuedJobs == 0)
+		return;
+
+	// Do not bother waking up the workers for a single job
+	if (_numQueuedJobs == 1 || _threads.empty()) {
+		for (uint i = 0; i < _numQueuedJobs; ++i) {
+			const Job &job = _jobs[i];
+			job.scaler(job.src, job.srcPitch, job.dst, job.dstPitch, job.width, job.height);
+		}
+		_numQueuedJobs = 0;
+		return;
+	}
+
+	SDL_LockMutex(_mutex);
+	_numActiveJobs = _numQueuedJobs;
+	_pendingJobs = _numQueuedJobs;
+	_nextJob = 0;
+	SDL_CondBroadcast(_workCond);
+
+	while (runNextJob())
+		;
+
+	// This is the barrier: nothing gets presented before all bands are done
+	while (_pendingJobs > 0)
+		SDL_CondWait(_doneCond, _mutex);
+
+	_numActiveJobs = 0;
+	_nextJob = 0;
+	SDL_UnlockMutex(_mutex);
+
+	_numQueuedJobs = 0;
+}
+
+bool SdlScalerPool::runNextJob() {
+	if (_nextJob >= _numActiveJobs)
+		return false;
+
+	const Job job = _jobs[_nextJob++];
+	SDL_UnlockMutex(_mutex);
+
+	job.scaler(job.src, job.srcPitch, job.dst, job.dstPitch, job.width, job.height);
+
+	SDL_LockMutex(_mutex);
+	if (--_pendingJobs == 0)
+		SDL_CondSignal(_doneCond);
+	return true;
+}
+
+void SdlScalerPool::workerThread() {
+	SDL_LockMutex(_mutex);
+	while (!_quit) {
+		if (!runNextJob())
+			SDL_CondWait(_workCond, _mutex);
+	}
+	SDL_UnlockMutex(_mutex);
+}
+
+int SDLCALL SdlScalerPool::workerThreadEntry(void *arg) {
+	SdlScalerPool *pool = (SdlScalerPool *)arg;
+	assert(pool);
+	pool->workerThread();
+	return 0;
+}
+
+#endif
@@ -0,0 +1,97 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef BACKENDS_GRAPHICS_SURFACESDL_SCALERPOOL_H
+#define BACKENDS_GRAPHICS_SURFACESDL_SCALERPOOL_H
+
+#include "backends/platform/sdl/sdl-sys.h"
+
+#include "common/array.h"
+#include "graphics/scaler.h"
+
+/**
+ * A small pool of worker threads which run scaler procs in parallel.
+ *
+ * The SDL graphics manager queues one job per horizontal band of a dirty
+ * rect and then calls run(), which only returns once every queued job is
+ * finished. The calling thread takes jobs itself while it waits, so a pool
+ * without any worker threads simply runs all jobs in order.
+ *
+ * Jobs of one run() must not write to overlapping memory. The scalers only
+ * read from their source surface, so they are free to read the rows above
+ * and below their band.
+ */
+class SdlScalerPool {
+public:
+	struct Job {
+		ScalerProc *scaler;
+		const uint8 *src;
+		uint32 srcPitch;
+		uint8 *dst;
+		uint32 dstPitch;
+		int width, height;
+	};
+
+	SdlScalerPool(uint numThreads);
+	~SdlScalerPool();
+
+	/** Number of worker threads, not counting the calling thread. */
+	uint getNumThreads() const { return _threads.size(); }
+
+	/** Number of jobs queued since the last run(). */
+	uint getNumQueuedJobs() const { return _numQueuedJobs; }
+
+	/** Queue a job for the next run(). */
+	void addJob(const Job &job);
+
+	/** Execute all queued jobs and wait until they are finished. */
+	void run();
+
+private:
+	Common::Array<SDL_Thread *> _threads;
+	SDL_mutex *_mutex;
+	SDL_cond *_workCond;
+	SDL_cond *_doneCond;
+
+	/** Job storage; it only grows, so that no frame has to allocate. */
+	Common::Array<Job> _jobs;
+	uint _numQueuedJobs;
+
+	// Protected by _mutex
+	uint _numActiveJobs;
+	uint _nextJob;
+	uint _pendingJobs;
+	bool _quit;
+
+	/**
+	 * Takes the next job and runs it with the mutex released. Must be
+	 * called with _mutex locked, and returns with it locked again.
+	 * Returns false if there was no job left.
+	 */
+	bool runNextJob();
+
+	void workerThread();
+	static int SDLCALL workerThreadEntry(void *arg);
+};
+
+#endif
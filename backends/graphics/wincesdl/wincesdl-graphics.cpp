@@ -532,6 +532,7 @@ void WINCESdlGraphicsManager::internUpdateScreen() {
 	}
 
 	// Force a full redraw if requested
+	updateDirtyRectList();
 	if (_forceFull) {
 		_numDirtyRects = 1;
 
@@ -701,7 +702,7 @@ void WINCESdlGraphicsManager::internUpdateScreen() {
 	if (numRectsOut > 0)
 		SDL_UpdateRects(_hwscreen, numRectsOut, _dirtyRectOut);
 
-	_numDirtyRects = 0;
+	clearDirtyRects();
 	_forceFull = false;
 }
 
@@ -63,6 +63,7 @@ MODULE_OBJS += \
 	events/sdl/sdl-events.o \
 	graphics/sdl/sdl-graphics.o \
 	graphics/surfacesdl/surfacesdl-graphics.o \
+	graphics/surfacesdl/surfacesdl-scalerpool.o \
 	mixer/doublebuffersdl/doublebuffersdl-mixer.o \
 	mixer/sdl/sdl-mixer.o \
 	mutex/sdl/sdl-mutex.o \
@@ -78,6 +79,7 @@ endif
 
 ifdef POSIX
 MODULE_OBJS += \
+	fs/posix/mmapstream.o \
 	fs/posix/posix-fs.o \
 	fs/posix/posix-fs-factory.o \
 	plugins/posix/posix-provider.o \
@@ -117,6 +119,11 @@ MODULE_OBJS += \
 	mixer/sdl13/sdl13-mixer.o
 endif
 
+ifeq ($(BACKEND),bench)
+MODULE_OBJS += \
+	graphics/bench/bench-graphics.o
+endif
+
 ifeq ($(BACKEND),bada)
 MODULE_OBJS += \
 	timer/bada/timer.o
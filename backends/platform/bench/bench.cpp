@@ -0,0 +1,231 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "backends/platform/bench/bench.h"
+
+#if defined(BENCH_BACKEND)
+
+#include "backends/graphics/bench/bench-graphics.h"
+#include "backends/timer/default/default-timer.h"
+#include "audio/mixer_intern.h"
+#include "base/main.h"
+#include "common/config-manager.h"
+#include "common/EventRecorder.h"
+#include "common/file.h"
+#include "common/str.h"
+
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+OSystem_Bench::OSystem_Bench()
+	: _timer(0), _mixerImpl(0), _mixBuffer(0), _millis(0), _timerAccum(0),
+	  _mixerAccum(0), _frameStart(0), _frameMixer(0), _maxFrames(0),
+	  _quitSent(false), _report(0) {
+}
+
+OSystem_Bench::~OSystem_Bench() {
+	printSummary();
+
+	if (_report) {
+		_report->finalize();
+		delete _report;
+	}
+
+	delete[] _mixBuffer;
+}
+
+void OSystem_Bench::initBackend() {
+	// Install our own managers first; OSystem_NULL only creates the ones
+	// which are still missing.
+	_graphicsManager = new BenchGraphicsManager();
+
+	_timer = new DefaultTimerManager();
+	_timerManager = _timer;
+
+	uint sampleRate = 44100;
+	if (ConfMan.hasKey("output_rate"))
+		sampleRate = ConfMan.getInt("output_rate");
+	_mixerImpl = new Audio::MixerImpl(this, sampleRate);
+	_mixer = _mixerImpl;
+	_mixBuffer = new byte[kMixerSamples * 4];
+
+	OSystem_NULL::initBackend();
+
+	// OSystem_NULL leaves the mixer switched off since nothing drives it.
+	_mixerImpl->setReady(true);
+
+	if (ConfMan.hasKey("bench_frames"))
+		_maxFrames = ConfMan.getInt("bench_frames");
+
+	if (ConfMan.hasKey("bench_report")) {
+		_report = new Common::DumpFile();
+		if (_report->open(ConfMan.get("bench_report"))) {
+			_report->writeString("frame;millis;engine_us;mixer_us;update_us\n");
+		} else {
+			warning("Could not open bench report file '%s'", ConfMan.get("bench_report").c_str());
+			delete _report;
+			_report = 0;
+		}
+	}
+
+	_frameStart = getHostMicros();
+}
+
+bool OSystem_Bench::pollEvent(Common::Event &event) {
+	// Engines may busy-wait on getMillis() while polling for input, so
+	// every poll has to let some virtual time pass.
+	advanceClock(kPollMillis);
+
+	if (_maxFrames && _stats.frames >= _maxFrames && !_quitSent) {
+		_quitSent = true;
+		event.type = Common::EVENT_QUIT;
+		return true;
+	}
+
+	return false;
+}
+
+uint32 OSystem_Bench::getMillis() {
+	uint32 millis = _millis;
+	g_eventRec.processMillis(millis);
+
+	// During playback the recorder dictates the time. Catch up with it so
+	// that the timer and the mixer see the recorded amount of time passing.
+	if (millis > _millis)
+		advanceClock(millis - _millis);
+
+	return millis;
+}
+
+void OSystem_Bench::delayMillis(uint msecs) {
+	if (!g_eventRec.processDelayMillis(msecs))
+		advanceClock(msecs);
+}
+
+void OSystem_Bench::getTimeAndDate(TimeDate &t) const {
+	// A fixed date which only advances with the virtual clock, so that
+	// savegame descriptions and time based game logic stay reproducible.
+	const uint32 secs = _millis / 1000;
+	t.tm_sec = secs % 60;
+	t.tm_min = (secs / 60) % 60;
+	t.tm_hour = (secs / 3600) % 24;
+	t.tm_mday = 1;
+	t.tm_mon = 0;
+	t.tm_year = 100;
+}
+
+void OSystem_Bench::updateScreen() {
+	const uint32 updateStart = getHostMicros();
+	OSystem_NULL::updateScreen();
+	const uint32 updateEnd = getHostMicros();
+
+	const uint32 frameTime = updateStart - _frameStart;
+	const uint32 mixerTime = _frameMixer;
+	const uint32 engineTime = frameTime > mixerTime ? frameTime - mixerTime : 0;
+	const uint32 updateTime = updateEnd - updateStart;
+
+	_stats.frames++;
+	_stats.engineTotal += engineTime;
+	_stats.mixerTotal += mixerTime;
+	_stats.updateTotal += updateTime;
+	_stats.engineMax = MAX(_stats.engineMax, engineTime);
+	_stats.mixerMax = MAX(_stats.mixerMax, mixerTime);
+	_stats.updateMax = MAX(_stats.updateMax, updateTime);
+
+	if (_report)
+		_report->writeString(Common::String::format("%u;%u;%u;%u;%u\n", _stats.frames, _millis, engineTime, mixerTime, updateTime));
+
+	// Do not count writing the report against the next frame.
+	_frameStart = getHostMicros();
+	_frameMixer = 0;
+}
+
+void OSystem_Bench::advanceClock(uint32 msecs) {
+	const uint32 sampleRate = _mixerImpl->getOutputRate();
+
+	while (msecs--) {
+		++_millis;
+
+		if (++_timerAccum == kTimerInterval) {
+			_timerAccum = 0;
+			_timer->handler();
+		}
+
+		_mixerAccum += sampleRate;
+		while (_mixerAccum >= kMixerSamples * 1000) {
+			_mixerAccum -= kMixerSamples * 1000;
+
+			const uint32 mixStart = getHostMicros();
+			_mixerImpl->mixCallback(_mixBuffer, kMixerSamples * 4);
+			_frameMixer += getHostMicros() - mixStart;
+		}
+	}
+}
+
+uint32 OSystem_Bench::getHostMicros() const {
+#if defined(_POSIX_MONOTONIC_CLOCK) && _POSIX_MONOTONIC_CLOCK >= 0
+	struct timespec ts;
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+		return (uint32)(ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+#endif
+
+	// Fall back to the wall clock, which may jump when the host's time is set
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return (uint32)(tv.tv_sec * 1000000 + tv.tv_usec);
+}
+
+void OSystem_Bench::printSummary() {
+	if (!_stats.frames)
+		return;
+
+	Common::String summary = Common::String::format(
+		"Bench: %u frames in %u virtual ms\n"
+		"Bench: engine avg %.1f us, max %u us\n"
+		"Bench: mixer  avg %.1f us, max %u us\n"
+		"Bench: update avg %.1f us, max %u us\n",
+		_stats.frames, _millis,
+		_stats.engineTotal / _stats.frames, _stats.engineMax,
+		_stats.mixerTotal / _stats.frames, _stats.mixerMax,
+		_stats.updateTotal / _stats.frames, _stats.updateMax);
+	logMessage(LogMessageType::kInfo, summary.c_str());
+}
+
+int main(int argc, char *argv[]) {
+	g_system = new OSystem_Bench();
+	assert(g_system);
+
+	// Invoke the actual ScummVM main entry point:
+	int res = scummvm_main(argc, argv);
+
+	// The event recorder releases its mutexes through g_system, so it has
+	// to go away before the backend does.
+	Common::EventRecorder::destroy();
+
+	delete (OSystem_Bench *)g_system;
+	return res;
+}
+
+#endif
@@ -0,0 +1,119 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef PLATFORM_BENCH_H
+#define PLATFORM_BENCH_H
+
+#include "backends/platform/null/null.h"
+
+namespace Common {
+class DumpFile;
+}
+
+namespace Audio {
+class MixerImpl;
+}
+
+class DefaultTimerManager;
+
+/**
+ * Headless, deterministic benchmark backend.
+ *
+ * The engine runs against a virtual clock which only moves forward when
+ * the engine waits (delayMillis) or polls for events. Every millisecond of
+ * virtual time the timer manager and the mixer are pumped exactly as often
+ * as a real backend would do it, so a given game and event recording
+ * always execute the same work no matter how fast the host is.
+ *
+ * Input comes from the event recorder (--record-mode=playback). The wall
+ * clock time spent in the engine, in the mixer and in updateScreen() is
+ * measured for every frame and summarized on exit; --bench-report=FILE
+ * additionally writes one line per frame, and --bench-frames=NUM quits
+ * after the given number of frames.
+ */
+class OSystem_Bench : public OSystem_NULL {
+public:
+	OSystem_Bench();
+	virtual ~OSystem_Bench();
+
+	virtual void initBackend();
+
+	virtual bool pollEvent(Common::Event &event);
+
+	virtual uint32 getMillis();
+	virtual void delayMillis(uint msecs);
+	virtual void getTimeAndDate(TimeDate &t) const;
+
+	virtual void updateScreen();
+
+protected:
+	enum {
+		/** Virtual milliseconds between two timer manager callbacks. */
+		kTimerInterval = 10,
+		/** Sample pairs generated per mixer callback. */
+		kMixerSamples = 512,
+		/** Virtual milliseconds which pass for every pollEvent() call. */
+		kPollMillis = 1
+	};
+
+	struct FrameStats {
+		FrameStats() : frames(0), engineTotal(0), mixerTotal(0), updateTotal(0), engineMax(0), mixerMax(0), updateMax(0) {}
+
+		uint32 frames;
+		double engineTotal, mixerTotal, updateTotal;
+		uint32 engineMax, mixerMax, updateMax;
+	};
+
+	DefaultTimerManager *_timer;
+	Audio::MixerImpl *_mixerImpl;
+	byte *_mixBuffer;
+
+	/** Current value of the virtual clock. */
+	uint32 _millis;
+	/** Virtual milliseconds since the last timer callback. */
+	uint32 _timerAccum;
+	/** Owed output samples, scaled by 1000 to avoid rounding drift. */
+	uint32 _mixerAccum;
+
+	/** Wall clock time at which the current frame started. */
+	uint32 _frameStart;
+	/** Wall clock time spent mixing during the current frame. */
+	uint32 _frameMixer;
+
+	FrameStats _stats;
+	uint32 _maxFrames;
+	bool _quitSent;
+	Common::DumpFile *_report;
+
+	/** Move the virtual clock forward, pumping the timer and the mixer. */
+	void advanceClock(uint32 msecs);
+
+	/**
+	 * Time of the host in microseconds, taken from the monotonic clock
+	 * where the host has one, and from the wall clock otherwise.
+	 */
+	uint32 getHostMicros() const;
+
+	void printSummary();
+};
+
+#endif
@@ -0,0 +1,12 @@
+MODULE := backends/platform/bench
+
+MODULE_OBJS := \
+	bench.o
+
+# We don't use rules.mk but rather manually update OBJS and MODULE_DIRS.
+MODULE_OBJS := $(addprefix $(MODULE)/, $(MODULE_OBJS))
+OBJS := $(MODULE_OBJS) $(OBJS)
+MODULE_DIRS += $(sort $(dir $(MODULE_OBJS)))
+
+# Hack to ensure the null backend is built so we can use OSystem_NULL.
+-include $(srcdir)/backends/platform/null/module.mk
@@ -20,10 +20,19 @@
  *
  */
 
-#include "backends/modular-backend.h"
+#define FORBIDDEN_SYMBOL_EXCEPTION_FILE
+#define FORBIDDEN_SYMBOL_EXCEPTION_fputs
+#define FORBIDDEN_SYMBOL_EXCEPTION_fflush
+#define FORBIDDEN_SYMBOL_EXCEPTION_stdout
+#define FORBIDDEN_SYMBOL_EXCEPTION_stderr
+
+#include "backends/platform/null/null.h"
 #include "base/main.h"
 
 #if defined(USE_NULL_DRIVER)
+#include "backends/events/default/default-events.h"
+#include "backends/graphics/null/null-graphics.h"
+#include "backends/mutex/null/null-mutex.h"
 #include "backends/saves/default/default-saves.h"
 #include "backends/timer/default/default-timer.h"
 #include "audio/mixer_intern.h"
@@ -40,22 +49,6 @@
 	#include "backends/fs/windows/windows-fs-factory.h"
 #endif
 
-class OSystem_NULL : public ModularBackend {
-public:
-	OSystem_NULL();
-	virtual ~OSystem_NULL();
-
-	virtual void initBackend();
-
-	virtual bool pollEvent(Common::Event &event);
-
-	virtual uint32 getMillis();
-	virtual void delayMillis(uint msecs);
-	virtual void getTimeAndDate(TimeDate &t) const {}
-
-	virtual void logMessage(LogMessageType::Type type, const char *message);
-};
-
 OSystem_NULL::OSystem_NULL() {
 	#if defined(__amigaos4__)
 		_fsFactory = new AmigaOSFilesystemFactory();
@@ -66,24 +59,41 @@ OSystem_NULL::OSystem_NULL() {
 	#else
 		#error Unknown and unsupported FS backend
 	#endif
+
+	// Mutexes are already needed before initBackend() is called.
+	_mutexManager = new NullMutexManager();
 }
 
 OSystem_NULL::~OSystem_NULL() {
+	// Some managers own mutexes, so they have to be deleted while the
+	// mutex manager is still around. The OSystem destructor would only
+	// get to them after the ModularBackend destructor is done.
+	delete _savefileManager;
+	_savefileManager = 0;
+	delete _eventManager;
+	_eventManager = 0;
+	delete _timerManager;
+	_timerManager = 0;
 }
 
 void OSystem_NULL::initBackend() {
-	_mutexManager = new NullMutexManager();
-	_timerManager = new DefaultTimerManager();
-	_eventManager = new DefaultEventManager(this);
-	_savefileManager = new DefaultSaveFileManager();
-	_graphicsManager = new NullGraphicsManager();
-	_mixer = new Audio::MixerImpl(this, 22050);
-
-	((Audio::MixerImpl *)_mixer)->setReady(false);
-
-	// Note that both the mixer and the timer manager are useless
-	// this way; they need to be hooked into the system somehow to
-	// be functional. Of course, can't do that in a NULL backend :).
+	// Derived backends may already have set up some of the managers.
+	if (!_timerManager)
+		_timerManager = new DefaultTimerManager();
+	if (!_eventManager)
+		_eventManager = new DefaultEventManager(this);
+	if (!_savefileManager)
+		_savefileManager = new DefaultSaveFileManager();
+	if (!_graphicsManager)
+		_graphicsManager = new NullGraphicsManager();
+	if (!_mixer) {
+		_mixer = new Audio::MixerImpl(this, 22050);
+
+		// Note that both the mixer and the timer manager are useless
+		// this way; they need to be hooked into the system somehow to
+		// be functional. Of course, can't do that in a NULL backend :).
+		((Audio::MixerImpl *)_mixer)->setReady(false);
+	}
 
 	ModularBackend::initBackend();
 }
@@ -115,6 +125,8 @@ OSystem *OSystem_NULL_create() {
 	return new OSystem_NULL();
 }
 
+#if !defined(BENCH_BACKEND)
+
 int main(int argc, char *argv[]) {
 	g_system = OSystem_NULL_create();
 	assert(g_system);
@@ -125,6 +137,8 @@ int main(int argc, char *argv[]) {
 	return res;
 }
 
+#endif
+
 #else /* USE_NULL_DRIVER */
 
 OSystem *OSystem_NULL_create() {
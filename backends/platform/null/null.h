@@ -0,0 +1,56 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef PLATFORM_NULL_H
+#define PLATFORM_NULL_H
+
+#include "backends/modular-backend.h"
+#include "common/events.h"
+
+#if defined(USE_NULL_DRIVER)
+
+/**
+ * A backend without any input, output or timing. Useful as a starting
+ * point for new ports, and as the base of the headless bench backend.
+ */
+class OSystem_NULL : public ModularBackend, Common::EventSource {
+public:
+	OSystem_NULL();
+	virtual ~OSystem_NULL();
+
+	virtual void initBackend();
+
+	virtual bool pollEvent(Common::Event &event);
+
+	virtual uint32 getMillis();
+	virtual void delayMillis(uint msecs);
+	virtual void getTimeAndDate(TimeDate &t) const {}
+
+	virtual void logMessage(LogMessageType::Type type, const char *message);
+
+protected:
+	virtual Common::EventSource *getDefaultEventSource() { return this; }
+};
+
+#endif
+
+#endif
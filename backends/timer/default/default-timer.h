@@ -23,6 +23,7 @@
 #define BACKENDS_TIMER_DEFAULT_H
 
 #include "common/str.h"
+#include "common/flat-hashmap.h"
 #include "common/hash-str.h"
 #include "common/timer.h"
 #include "common/mutex.h"
@@ -31,7 +32,7 @@ struct TimerSlot;
 
 class DefaultTimerManager : public Common::TimerManager {
 private:
-	typedef Common::HashMap<Common::String, TimerProc, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> TimerSlotMap;
+	typedef Common::FlatHashMap<Common::String, TimerProc, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> TimerSlotMap;
 
 	Common::Mutex _mutex;
 	void *_timerHandler;
@@ -67,6 +67,10 @@ static const char HELP_STRING[] =
 	"  --list-saves=TARGET      Display a list of savegames for the game (TARGET) specified\n"
 #if defined (WIN32) && !defined(_WIN32_WCE) && !defined(__SYMBIAN32__)
 	"  --console                Enable the console window (default:enabled)\n"
+#endif
+#ifdef BENCH_BACKEND
+	"  --bench-frames=NUM       Quit after NUM frames have been rendered\n"
+	"  --bench-report=FILE      Write per-frame timings to FILE\n"
 #endif
 	"\n"
 	"  -c, --config=CONFIG      Use alternate configuration file\n"
@@ -110,6 +114,8 @@ static const char HELP_STRING[] =
 	"  --native-mt32            True Roland MT-32 (disable GM emulation)\n"
 	"  --enable-gs              Enable Roland GS mode for MIDI playback\n"
 	"  --output-rate=RATE       Select output sample rate in Hz (e.g. 22050)\n"
+	"  --audio-resampler=TYPE   Select how sounds are converted to the output rate\n"
+	"                           (linear, polyphase)\n"
 	"  --opl-driver=DRIVER      Select AdLib (OPL) emulator (db, mame)\n"
 	"  --aspect-ratio           Enable aspect ratio correction\n"
 	"  --render-mode=MODE       Enable additional render modes (cga, ega, hercGreen,\n"
@@ -184,6 +190,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("native_mt32", false);
 	ConfMan.registerDefault("enable_gs", false);
 	ConfMan.registerDefault("midi_gain", 100);
+	ConfMan.registerDefault("audio_resampler", "linear");
 
 	ConfMan.registerDefault("music_driver", "auto");
 	ConfMan.registerDefault("mt32_device", "null");
@@ -384,6 +391,9 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION_INT("output-rate")
 			END_OPTION
 
+			DO_LONG_OPTION("audio-resampler")
+			END_OPTION
+
 			DO_OPTION_BOOL('f', "fullscreen")
 			END_OPTION
 
@@ -556,6 +566,14 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			END_OPTION
 #endif
 
+#ifdef BENCH_BACKEND
+			DO_LONG_OPTION_INT("bench-frames")
+			END_OPTION
+
+			DO_LONG_OPTION("bench-report")
+			END_OPTION
+#endif
+
 unknownOption:
 			// If we get till here, the option is unhandled and hence unknown.
 			usage("Unrecognized option '%s'", argv[i]);
@@ -86,6 +86,8 @@ SearchSet::ArchiveNodeList::const_iterator SearchSet::find(const String &name) c
 	order prevails.
 */
 void SearchSet::insert(const Node &node) {
+	_atomCache.clear();
+
 	ArchiveNodeList::iterator it = _list.begin();
 	for ( ; it != _list.end(); ++it) {
 		if (it->_priority < node._priority)
@@ -174,6 +176,7 @@ void SearchSet::remove(const String &name) {
 		if (it->_autoFree)
 			delete it->_arc;
 		_list.erase(it);
+		_atomCache.clear();
 	}
 }
 
@@ -188,6 +191,7 @@ void SearchSet::clear() {
 	}
 
 	_list.clear();
+	_atomCache.clear();
 }
 
 void SearchSet::setPriority(const String &name, int priority) {
@@ -266,6 +270,42 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const String &name) con
 	return 0;
 }
 
+Archive *SearchSet::findArchive(const StringAtom &name) const {
+	AtomCache::const_iterator cached = _atomCache.find(name);
+	if (cached != _atomCache.end())
+		return cached->_value;
+
+	ArchiveNodeList::const_iterator it = _list.begin();
+	for ( ; it != _list.end(); ++it) {
+		if (it->_arc->hasFile(name.string())) {
+			// Only hits are remembered, files may still be added to the
+			// directories of the archives.
+			_atomCache[name] = it->_arc;
+			return it->_arc;
+		}
+	}
+
+	return 0;
+}
+
+bool SearchSet::hasFile(const StringAtom &name) {
+	if (name.empty())
+		return false;
+
+	return findArchive(name) != 0;
+}
+
+SeekableReadStream *SearchSet::createReadStreamForMember(const StringAtom &name) const {
+	if (name.empty())
+		return 0;
+
+	Archive *arc = findArchive(name);
+	if (!arc)
+		return 0;
+
+	return arc->createReadStreamForMember(name.string());
+}
+
 
 SearchManager::SearchManager() {
 	clear();	// Force a reset
@@ -24,6 +24,8 @@
 #define COMMON_ARCHIVE_H
 
 #include "common/str.h"
+#include "common/str-atom.h"
+#include "common/flat-hashmap.h"
 #include "common/list.h"
 #include "common/ptr.h"
 #include "common/singleton.h"
@@ -140,6 +142,13 @@ class SearchSet : public Archive {
 	typedef List<Node> ArchiveNodeList;
 	ArchiveNodeList _list;
 
+	// Archives found for member names looked up by StringAtom. Cleared
+	// whenever the set of archives or their order changes.
+	typedef FlatHashMap<StringAtom, Archive *> AtomCache;
+	mutable AtomCache _atomCache;
+
+	Archive *findArchive(const StringAtom &name) const;
+
 	ArchiveNodeList::iterator find(const String &name);
 	ArchiveNodeList::const_iterator find(const String &name) const;
 
@@ -241,6 +250,14 @@ public:
 	 * opening the first file encountered that matches the name.
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+
+	/**
+	 * Variants of hasFile and createReadStreamForMember for names which are
+	 * looked up repeatedly. The archive containing a member is remembered,
+	 * so later lookups of the same atom only search that archive.
+	 */
+	bool hasFile(const StringAtom &name);
+	SeekableReadStream *createReadStreamForMember(const StringAtom &name) const;
 };
 
 
@@ -0,0 +1,80 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+
+#if defined(_MSC_VER)
+// For _ReadWriteBarrier; common/math.h knows how to include intrin.h
+// without tripping over the forbidden symbol code.
+#include "common/math.h"
+#endif
+
+namespace Common {
+
+/**
+ * Full memory barrier: no load or store is moved across it, neither by
+ * the compiler nor by the CPU.
+ *
+ * On compilers we do not know how to emit a hardware barrier with, this
+ * only stops the compiler from reordering memory accesses. That is enough
+ * for the single core machines such ports usually run on.
+ */
+inline void memoryBarrier() {
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+	__sync_synchronize();
+#elif defined(__GNUC__)
+	__asm__ __volatile__("" : : : "memory");
+#elif defined(_MSC_VER)
+	// x86 only reorders stores with later loads, which the code using
+	// these helpers does not rely on.
+	_ReadWriteBarrier();
+#endif
+}
+
+/**
+ * Read a value shared with another thread. Memory accesses after the load
+ * are not moved before it, so data published together with the value is
+ * visible once the value is.
+ */
+template<typename T>
+inline T atomicLoad(const volatile T &value) {
+	T result = value;
+	memoryBarrier();
+	return result;
+}
+
+/**
+ * Publish a value to another thread. Memory accesses before the store are
+ * not moved after it, see atomicLoad().
+ */
+template<typename T>
+inline void atomicStore(volatile T &value, T newValue) {
+	memoryBarrier();
+	value = newValue;
+}
+
+} // End of namespace Common
+
+#endif
@@ -38,6 +38,9 @@ namespace Common {
 
 DECLARE_SINGLETON(ConfigManager);
 
+/** Returned by the StringAtom variant of get() for keys which aren't set. */
+static const String s_emptyString;
+
 char const *const ConfigManager::kApplicationDomain = "scummvm";
 char const *const ConfigManager::kTransientDomain = "__TRANSIENT";
 
@@ -410,6 +413,20 @@ bool ConfigManager::hasKey(const String &key) const {
 	return false;
 }
 
+bool ConfigManager::hasKey(const StringAtom &key) const {
+	// Same order as in hasKey(const String &) above.
+	if (_transientDomain.contains(key))
+		return true;
+
+	if (_activeDomain && _activeDomain->contains(key))
+		return true;
+
+	if (_appDomain.contains(key))
+		return true;
+
+	return false;
+}
+
 bool ConfigManager::hasKey(const String &key, const String &domName) const {
 	// FIXME: For now we continue to allow empty domName to indicate
 	// "use 'default' domain". This is mainly needed for the SCUMM ConfigDialog
@@ -449,6 +466,28 @@ const String &ConfigManager::get(const String &key) const {
 	return _defaultsDomain.getVal(key);
 }
 
+const String &ConfigManager::get(const StringAtom &key) const {
+	Domain::const_iterator x = _transientDomain.findEquivalent(key);
+	if (x != _transientDomain.end())
+		return x->_value;
+
+	if (_activeDomain) {
+		x = _activeDomain->findEquivalent(key);
+		if (x != _activeDomain->end())
+			return x->_value;
+	}
+
+	x = _appDomain.findEquivalent(key);
+	if (x != _appDomain.end())
+		return x->_value;
+
+	x = _defaultsDomain.findEquivalent(key);
+	if (x != _defaultsDomain.end())
+		return x->_value;
+
+	return s_emptyString;
+}
+
 const String &ConfigManager::get(const String &key, const String &domName) const {
 	// FIXME: For now we continue to allow empty domName to indicate
 	// "use 'default' domain". This is mainly needed for the SCUMM ConfigDialog
@@ -468,29 +507,45 @@ const String &ConfigManager::get(const String &key, const String &domName) const
 	return _defaultsDomain.getVal(key);
 }
 
-int ConfigManager::getInt(const String &key, const String &domName) const {
-	String value(get(key, domName));
-	char *errpos;
-
+static bool parseInt(const String &value, int &ivalue) {
 	// For now, be tolerant against missing config keys. Strictly spoken, it is
 	// a bug in the calling code to retrieve an int for a key which isn't even
 	// present... and a default value of 0 seems rather arbitrary.
-	if (value.empty())
-		return 0;
+	if (value.empty()) {
+		ivalue = 0;
+		return true;
+	}
 
 	// We use the special value '0' for the base passed to strtol. Doing that
 	// makes it possible to enter hex values as "0x1234", but also decimal
 	// values ("123") are still valid.
-	int ivalue = (int)strtol(value.c_str(), &errpos, 0);
-	if (value.c_str() == errpos)
+	char *errpos;
+	ivalue = (int)strtol(value.c_str(), &errpos, 0);
+	return value.c_str() != errpos;
+}
+
+int ConfigManager::getInt(const String &key, const String &domName) const {
+	const String &value = get(key, domName);
+	int ivalue;
+	if (!parseInt(value, ivalue))
 		error("ConfigManager::getInt(%s,%s): '%s' is not a valid integer",
-		      key.c_str(), domName.c_str(), errpos);
+		      key.c_str(), domName.c_str(), value.c_str());
+
+	return ivalue;
+}
+
+int ConfigManager::getInt(const StringAtom &key) const {
+	const String &value = get(key);
+	int ivalue;
+	if (!parseInt(value, ivalue))
+		error("ConfigManager::getInt(%s): '%s' is not a valid integer",
+		      key.c_str(), value.c_str());
 
 	return ivalue;
 }
 
 bool ConfigManager::getBool(const String &key, const String &domName) const {
-	String value(get(key, domName));
+	const String &value = get(key, domName);
 	bool val;
 	if (parseBool(value, val))
 		return val;
@@ -499,6 +554,16 @@ bool ConfigManager::getBool(const String &key, const String &domName) const {
 	      key.c_str(), domName.c_str(), value.c_str());
 }
 
+bool ConfigManager::getBool(const StringAtom &key) const {
+	const String &value = get(key);
+	bool val;
+	if (parseBool(value, val))
+		return val;
+
+	error("ConfigManager::getBool(%s): '%s' is not a valid bool",
+	      key.c_str(), value.c_str());
+}
+
 
 #pragma mark -
 
@@ -28,6 +28,7 @@
 #include "common/hashmap.h"
 #include "common/singleton.h"
 #include "common/str.h"
+#include "common/str-atom.h"
 #include "common/hash-str.h"
 
 namespace Common {
@@ -53,6 +54,9 @@ public:
 		String _domainComment;
 
 	public:
+		using StringMap::contains;
+		bool contains(const StringAtom &key) const { return findEquivalent(key) != end(); }
+
 		void setDomainComment(const String &comment);
 		const String &getDomainComment() const;
 
@@ -95,6 +99,17 @@ public:
 	const String &		get(const String &key) const;
 	void				set(const String &key, const String &value);
 
+	//
+	// Variants of the generic access methods taking a StringAtom, which skip
+	// hashing the key. Use these for keys which are queried frequently, e.g.
+	// from within the main loop of an engine.
+	//
+
+	bool				hasKey(const StringAtom &key) const;
+	const String &		get(const StringAtom &key) const;
+	int					getInt(const StringAtom &key) const;
+	bool				getBool(const StringAtom &key) const;
+
 #if 1
 	//
 	// Domain specific access methods: Acces *one specific* domain and modify it.
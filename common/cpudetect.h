@@ -0,0 +1,57 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_CPUDETECT_H
+#define COMMON_CPUDETECT_H
+
+#include "common/scummsys.h"
+
+namespace Common {
+
+/**
+ * Instruction set extensions for which optimized code paths exist.
+ */
+enum CPUFeature {
+	kCPUFeatureSSE2  = 1 << 0,
+	kCPUFeatureSSSE3 = 1 << 1,
+	kCPUFeatureAVX2  = 1 << 2,
+	kCPUFeatureNEON  = 1 << 3
+};
+
+/**
+ * Check whether the given instruction set extension can be used, i.e. the
+ * build includes code for it (see USE_X86_SIMD and USE_NEON) and the host
+ * CPU supports it. The detection is only done once.
+ */
+bool hasCPUFeature(CPUFeature feature);
+
+/**
+ * Restrict the features reported by hasCPUFeature() to those in the given
+ * mask. This is meant for benchmarks and tests, which need to compare the
+ * optimized code paths against the generic ones. Code which caches its
+ * choice of code path will not notice later changes.
+ */
+void setCPUFeatureMask(uint32 mask);
+
+} // End of namespace Common
+
+#endif
@@ -141,6 +141,21 @@ uint32 File::read(void *ptr, uint32 len) {
 	return _handle->read(ptr, len);
 }
 
+SeekableReadStream *File::readStream(uint32 dataSize) {
+	assert(_handle);
+	return _handle->readStream(dataSize);
+}
+
+const byte *File::getRawPointer() const {
+	assert(_handle);
+	return _handle->getRawPointer();
+}
+
+bool File::isResident() const {
+	assert(_handle);
+	return _handle->isResident();
+}
+
 
 DumpFile::DumpFile() : _handle(0) {
 }
@@ -126,6 +126,10 @@ public:
 	int32 size() const;	// implement abstract SeekableReadStream method
 	bool seek(int32 offs, int whence = SEEK_SET);	// implement abstract SeekableReadStream method
 	uint32 read(void *dataPtr, uint32 dataSize);	// implement abstract SeekableReadStream method
+
+	SeekableReadStream *readStream(uint32 dataSize);	// forwarded to the file stream
+	const byte *getRawPointer() const;	// forwarded to the file stream
+	bool isResident() const;	// forwarded to the file stream
 };
 
 
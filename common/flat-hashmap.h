@@ -0,0 +1,630 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_FLAT_HASHMAP_H
+#define COMMON_FLAT_HASHMAP_H
+
+// For the DEBUG_HASH_COLLISIONS switch and the hash functors.
+#include "common/hashmap.h"
+
+namespace Common {
+
+/**
+ * FlatHashMap<Key,Val> is a drop-in replacement for HashMap<Key,Val> which
+ * stores its entries directly in the probe array instead of behind Node
+ * pointers. It uses linear probing and keeps the hash of every key next to
+ * it, so that a lookup touches a single contiguous run of memory and only
+ * calls the equality functor for entries whose hash matches.
+ *
+ * The public interface is the same as the one of HashMap, including the
+ * _key and _value members of the entries the iterators point to, so code
+ * can switch between the two by changing a typedef. There are two
+ * differences to keep in mind, though:
+ * - Key and Val must be default constructible and assignable; every slot
+ *   of the array holds a Key and a Val, used or not.
+ * - Entries move when the array is resized. Pointers or references to
+ *   values are only valid until the next insertion of a new key. Use
+ *   HashMap where values are referenced for longer than that.
+ *
+ * Like HashMap, erase() leaves a marker behind, so that iterators stay
+ * valid while erasing. Unlike HashMap, markers are dropped again when no
+ * probe sequence runs through them, and the array is rehashed in place
+ * when too many of them pile up.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+private:
+
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> HM_t;
+
+	struct Node {
+		Key _key;
+		Val _value;
+		Node() : _key(), _value() {}
+	};
+
+	/**
+	 * A slot of the probe array. _hash is HASHMAP_SLOT_EMPTY or
+	 * HASHMAP_SLOT_DELETED for unused slots; for used ones it contains the
+	 * hash of the key with the top bit set.
+	 */
+	struct Slot {
+		uint _hash;
+		Node _node;
+	};
+
+	enum {
+		HASHMAP_SLOT_EMPTY = 0,
+		HASHMAP_SLOT_DELETED = 1,
+		HASHMAP_MIN_CAPACITY = 16,
+
+		// The quotient of the next two constants controls how much the
+		// internal storage of the hashmap may fill up before being
+		// increased automatically. Deleted slots are counted as well.
+		// Note: the quotient of these two must be between and different
+		// from 0 and 1.
+		HASHMAP_LOADFACTOR_NUMERATOR = 2,
+		HASHMAP_LOADFACTOR_DENOMINATOR = 3
+	};
+
+	Slot *_storage;	///< hashtable of size arrsize.
+	uint _mask;		///< Capacity of the FlatHashMap minus one; must be a power of two of minus one
+	uint _shift;	///< 32 minus the base 2 logarithm of the capacity
+	uint _size;
+	uint _deleted;	///< Number of slots marked as deleted
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	/** Default value, returned by the const getVal. */
+	const Val _defaultVal;
+
+#ifdef DEBUG_HASH_COLLISIONS
+	mutable int _collisions, _lookups, _dummyHits;
+#endif
+
+	/** Returns the value stored in Slot::_hash for a key with the given hash. */
+	static uint usedHash(uint hash) {
+		return hash | 0x80000000U;
+	}
+
+	static bool isUsed(const Slot &slot) {
+		return (slot._hash & 0x80000000U) != 0;
+	}
+
+	/**
+	 * Maps a hash to its home slot. The multiplication spreads hash functions
+	 * like Hash<int>, which only differ in their low bits for nearby keys,
+	 * over the whole array before linear probing kicks in.
+	 */
+	uint homeSlot(uint hash) const {
+		return (uint)(hash * 2654435769U) >> _shift;
+	}
+
+	void allocStorage(uint capacity);
+	void assign(const HM_t &map);
+	template<class LookupKey>
+	uint lookup(const LookupKey &key) const;
+	uint lookupAndCreateIfMissing(const Key &key);
+	void rehash(uint newCapacity);
+	void eraseSlot(uint ctr);
+
+#if !defined(__sgi) || defined(__GNUC__)
+	template<class T> friend class IteratorImpl;
+#endif
+
+	/**
+	 * Simple FlatHashMap iterator implementation.
+	 */
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+#if (defined(__sgi) && !defined(__GNUC__)) || defined(__INTEL_COMPILER)
+		template<class T> friend class Common::IteratorImpl;
+#else
+		template<class T> friend class IteratorImpl;
+#endif
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		uint _idx;
+		hashmap_t *_hashmap;
+
+	protected:
+		IteratorImpl(uint idx, hashmap_t *hashmap) : _idx(idx), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != 0);
+			assert(_idx <= _hashmap->_mask);
+			assert(isUsed(_hashmap->_storage[_idx]));
+			return &_hashmap->_storage[_idx]._node;
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _hashmap(0) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			do {
+				_idx++;
+			} while (_idx <= _hashmap->_mask && !isUsed(_hashmap->_storage[_idx]));
+			if (_idx > _hashmap->_mask)
+				_idx = (uint)-1;
+
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const HM_t &map);
+	~FlatHashMap();
+
+	HM_t &operator=(const HM_t &map) {
+		if (this == &map)
+			return *this;
+
+		// Remove the previous content and ...
+		delete[] _storage;
+		// ... copy the new stuff.
+		assign(map);
+		return *this;
+	}
+
+	bool contains(const Key &key) const;
+
+	Val &operator[](const Key &key);
+	const Val &operator[](const Key &key) const;
+
+	Val &getVal(const Key &key);
+	const Val &getVal(const Key &key) const;
+	const Val &getVal(const Key &key, const Val &defaultVal) const;
+	void setVal(const Key &key, const Val &val);
+
+	void clear(bool shrinkArray = 0);
+
+	void erase(iterator entry);
+	void erase(const Key &key);
+
+	uint size() const { return _size; }
+
+	iterator	begin() {
+		// Find and return the first used entry
+		for (uint ctr = 0; ctr <= _mask; ++ctr) {
+			if (isUsed(_storage[ctr]))
+				return iterator(ctr, this);
+		}
+		return end();
+	}
+	iterator	end() {
+		return iterator((uint)-1, this);
+	}
+
+	const_iterator	begin() const {
+		// Find and return the first used entry
+		for (uint ctr = 0; ctr <= _mask; ++ctr) {
+			if (isUsed(_storage[ctr]))
+				return const_iterator(ctr, this);
+		}
+		return end();
+	}
+	const_iterator	end() const {
+		return const_iterator((uint)-1, this);
+	}
+
+	iterator	find(const Key &key) {
+		uint ctr = lookup(key);
+		if (isUsed(_storage[ctr]))
+			return iterator(ctr, this);
+		return end();
+	}
+
+	const_iterator	find(const Key &key) const {
+		uint ctr = lookup(key);
+		if (isUsed(_storage[ctr]))
+			return const_iterator(ctr, this);
+		return end();
+	}
+
+	/**
+	 * Like find(), but for a key of another type than Key, for example a
+	 * StringAtom in a map with String keys. HashFunc and EqualFunc must
+	 * accept it, and hash it the same way as the equal Key.
+	 */
+	template<class LookupKey>
+	iterator	findEquivalent(const LookupKey &key) {
+		uint ctr = lookup(key);
+		if (isUsed(_storage[ctr]))
+			return iterator(ctr, this);
+		return end();
+	}
+
+	template<class LookupKey>
+	const_iterator	findEquivalent(const LookupKey &key) const {
+		uint ctr = lookup(key);
+		if (isUsed(_storage[ctr]))
+			return const_iterator(ctr, this);
+		return end();
+	}
+
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+/**
+ * Base constructor, creates an empty hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap()
+//
+// We have to skip _defaultVal() on PS2 to avoid gcc 3.2.2 ICE
+//
+#ifdef __PLAYSTATION2__
+	{
+#else
+	: _defaultVal() {
+#endif
+	allocStorage(HASHMAP_MIN_CAPACITY);
+
+#ifdef DEBUG_HASH_COLLISIONS
+	_collisions = 0;
+	_lookups = 0;
+	_dummyHits = 0;
+#endif
+}
+
+/**
+ * Copy constructor, creates a full copy of the given hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const HM_t &map) :
+	_defaultVal() {
+#ifdef DEBUG_HASH_COLLISIONS
+	_collisions = 0;
+	_lookups = 0;
+	_dummyHits = 0;
+#endif
+	assign(map);
+}
+
+/**
+ * Destructor, frees all used memory.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	delete[] _storage;
+#ifdef DEBUG_HASH_COLLISIONS
+	extern void updateHashCollisionStats(int, int, int, int, int, bool);
+	updateHashCollisionStats(_collisions, _dummyHits, _lookups, _mask+1, _size, true);
+#endif
+}
+
+/**
+ * Internal method for allocating an empty probe array of the given
+ * capacity, which must be a power of two.
+ *
+ * @note We do *not* deallocate the previous storage here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::allocStorage(uint capacity) {
+	assert(capacity >= HASHMAP_MIN_CAPACITY && (capacity & (capacity - 1)) == 0);
+
+	_mask = capacity - 1;
+	_shift = 32;
+	for (uint c = capacity; c > 1; c >>= 1)
+		_shift--;
+
+	_storage = new Slot[capacity];
+	assert(_storage != NULL);
+	for (uint ctr = 0; ctr < capacity; ++ctr)
+		_storage[ctr]._hash = HASHMAP_SLOT_EMPTY;
+
+	_size = 0;
+	_deleted = 0;
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap
+ * to this one.
+ *
+ * @note We do *not* deallocate the previous storage here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const HM_t &map) {
+	allocStorage(map._mask + 1);
+
+	// The layout only depends on the hashes, so the slots can simply be
+	// copied one by one, markers included.
+	for (uint ctr = 0; ctr <= _mask; ++ctr)
+		_storage[ctr] = map._storage[ctr];
+	_size = map._size;
+	_deleted = map._deleted;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	if (shrinkArray && _mask >= HASHMAP_MIN_CAPACITY) {
+		delete[] _storage;
+		allocStorage(HASHMAP_MIN_CAPACITY);
+		return;
+	}
+
+	// Reset the used slots, so that keys and values release their
+	// resources right away.
+	for (uint ctr = 0; ctr <= _mask; ++ctr) {
+		if (isUsed(_storage[ctr]))
+			_storage[ctr]._node = Node();
+		_storage[ctr]._hash = HASHMAP_SLOT_EMPTY;
+	}
+
+	_size = 0;
+	_deleted = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::rehash(uint newCapacity) {
+	assert(newCapacity > _size);
+
+#ifndef NDEBUG
+	const uint old_size = _size;
+#endif
+	const uint old_mask = _mask;
+	Slot *old_storage = _storage;
+
+	allocStorage(newCapacity);
+
+	// Reinsert all the old elements. Since we know that no key exists
+	// twice in the old table, we don't have to call _equal() here; and
+	// since the hash is cached, we don't have to call _hash() either.
+	for (uint ctr = 0; ctr <= old_mask; ++ctr) {
+		if (!isUsed(old_storage[ctr]))
+			continue;
+
+		uint idx = homeSlot(old_storage[ctr]._hash);
+		while (_storage[idx]._hash != HASHMAP_SLOT_EMPTY)
+			idx = (idx + 1) & _mask;
+
+		_storage[idx] = old_storage[ctr];
+		_size++;
+	}
+
+	// Perform a sanity check: Old number of elements should match the new one!
+	// This check will fail if some previous operation corrupted this hashmap.
+	assert(_size == old_size);
+
+	delete[] old_storage;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+template<class LookupKey>
+uint FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const LookupKey &key) const {
+	const uint hash = usedHash(_hash(key));
+	uint ctr = homeSlot(hash);
+	for (;;) {
+		const uint slotHash = _storage[ctr]._hash;
+		if (slotHash == HASHMAP_SLOT_EMPTY)
+			break;
+		if (slotHash == HASHMAP_SLOT_DELETED) {
+#ifdef DEBUG_HASH_COLLISIONS
+			_dummyHits++;
+#endif
+		} else if (slotHash == hash && _equal(_storage[ctr]._node._key, key))
+			break;
+
+		ctr = (ctr + 1) & _mask;
+
+#ifdef DEBUG_HASH_COLLISIONS
+		_collisions++;
+#endif
+	}
+
+#ifdef DEBUG_HASH_COLLISIONS
+	_lookups++;
+	debug("collisions %d, dummies hit %d, lookups %d, ratio %f in FlatHashMap %p; size %d num elements %d",
+		_collisions, _dummyHits, _lookups, ((double) _collisions / (double)_lookups),
+		(const void *)this, _mask+1, _size);
+#endif
+
+	return ctr;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+uint FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
+	const uint hash = usedHash(_hash(key));
+	uint ctr = homeSlot(hash);
+	const uint NONE_FOUND = _mask + 1;
+	uint first_free = NONE_FOUND;
+	for (;;) {
+		const uint slotHash = _storage[ctr]._hash;
+		if (slotHash == HASHMAP_SLOT_EMPTY)
+			break;
+		if (slotHash == HASHMAP_SLOT_DELETED) {
+#ifdef DEBUG_HASH_COLLISIONS
+			_dummyHits++;
+#endif
+			if (first_free == NONE_FOUND)
+				first_free = ctr;
+		} else if (slotHash == hash && _equal(_storage[ctr]._node._key, key)) {
+#ifdef DEBUG_HASH_COLLISIONS
+			_lookups++;
+#endif
+			return ctr;
+		}
+
+		ctr = (ctr + 1) & _mask;
+
+#ifdef DEBUG_HASH_COLLISIONS
+		_collisions++;
+#endif
+	}
+
+#ifdef DEBUG_HASH_COLLISIONS
+	_lookups++;
+	debug("collisions %d, dummies hit %d, lookups %d, ratio %f in FlatHashMap %p; size %d num elements %d",
+		_collisions, _dummyHits, _lookups, ((double) _collisions / (double)_lookups),
+		(const void *)this, _mask+1, _size);
+#endif
+
+	// Reuse the first deleted slot on the probe sequence, if there is one.
+	if (first_free != NONE_FOUND) {
+		ctr = first_free;
+		_deleted--;
+	}
+
+	_storage[ctr]._hash = hash;
+	_storage[ctr]._node._key = key;
+	_size++;
+
+	// Keep the load factor below a certain threshold. Deleted slots are
+	// also counted, since they lengthen the probe sequences as well. If
+	// they make up most of the load, rehashing at the current capacity
+	// is enough to get rid of them.
+	uint capacity = _mask + 1;
+	if ((_size + _deleted) * HASHMAP_LOADFACTOR_DENOMINATOR >
+	        capacity * HASHMAP_LOADFACTOR_NUMERATOR) {
+		if (_size * HASHMAP_LOADFACTOR_DENOMINATOR * 2 > capacity * HASHMAP_LOADFACTOR_NUMERATOR)
+			capacity = capacity < 500 ? (capacity * 4) : (capacity * 2);
+		rehash(capacity);
+		ctr = lookup(key);
+		assert(isUsed(_storage[ctr]));
+	}
+
+	return ctr;
+}
+
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::contains(const Key &key) const {
+	uint ctr = lookup(key);
+	return isUsed(_storage[ctr]);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) const {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
+	uint ctr = lookupAndCreateIfMissing(key);
+	assert(isUsed(_storage[ctr]));
+	return _storage[ctr]._node._value;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const {
+	return getVal(key, _defaultVal);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key, const Val &defaultVal) const {
+	uint ctr = lookup(key);
+	if (isUsed(_storage[ctr]))
+		return _storage[ctr]._node._value;
+	else
+		return defaultVal;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::setVal(const Key &key, const Val &val) {
+	uint ctr = lookupAndCreateIfMissing(key);
+	assert(isUsed(_storage[ctr]));
+	_storage[ctr]._node._value = val;
+}
+
+/**
+ * Internal method for removing the entry in the given slot. The entries
+ * of the other slots are not moved, so iterators stay valid.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::eraseSlot(uint ctr) {
+	_storage[ctr]._node = Node();
+	_size--;
+
+	// With linear probing, a probe sequence only passes through a slot if
+	// it continues in the next one. So if the next slot is empty, neither
+	// this slot nor the run of deleted slots directly before it are needed
+	// as markers any more.
+	if (_storage[(ctr + 1) & _mask]._hash != HASHMAP_SLOT_EMPTY) {
+		_storage[ctr]._hash = HASHMAP_SLOT_DELETED;
+		_deleted++;
+		return;
+	}
+
+	_storage[ctr]._hash = HASHMAP_SLOT_EMPTY;
+	for (ctr = (ctr - 1) & _mask; _storage[ctr]._hash == HASHMAP_SLOT_DELETED; ctr = (ctr - 1) & _mask) {
+		_storage[ctr]._hash = HASHMAP_SLOT_EMPTY;
+		_deleted--;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
+	// Check whether we have a valid iterator
+	assert(entry._hashmap == this);
+	const uint ctr = entry._idx;
+	assert(ctr <= _mask);
+	assert(isUsed(_storage[ctr]));
+
+	eraseSlot(ctr);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
+	uint ctr = lookup(key);
+	if (!isUsed(_storage[ctr]))
+		return;
+
+	eraseSlot(ctr);
+}
+
+}	// End of namespace Common
+
+#endif
@@ -190,8 +190,9 @@ FSNode *FSDirectory::lookupCache(NodeCache &cache, const String &name) const {
 	if (!name.empty()) {
 		ensureCached();
 
-		if (cache.contains(name))
-			return &cache[name];
+		NodeCache::iterator it = cache.find(name);
+		if (it != cache.end())
+			return &it->_value;
 	}
 
 	return 0;
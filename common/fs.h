@@ -25,7 +25,7 @@
 #include "common/array.h"
 #include "common/archive.h"
 #include "common/hash-str.h"
-#include "common/hashmap.h"
+#include "common/flat-hashmap.h"
 #include "common/ptr.h"
 #include "common/str.h"
 
@@ -266,7 +266,7 @@ class FSDirectory : public Archive {
 
 	// Caches are case insensitive, clashes are dealt with when creating
 	// Key is stored in lowercase.
-	typedef HashMap<String, FSNode, IgnoreCase_Hash, IgnoreCase_EqualTo> NodeCache;
+	typedef FlatHashMap<String, FSNode, IgnoreCase_Hash, IgnoreCase_EqualTo> NodeCache;
 	mutable NodeCache	_fileCache, _subDirCache;
 	mutable bool _cached;
 	mutable int	_depth;
@@ -27,6 +27,8 @@
 
 namespace Common {
 
+class StringAtom;
+
 uint hashit(const char *str);
 uint hashit_lower(const char *str);	// Generate a hash based on the lowercase version of the string
 inline uint hashit(const String &str) { return hashit(str.c_str()); }
@@ -46,10 +48,12 @@ struct CaseSensitiveString_Hash {
 
 struct IgnoreCase_EqualTo {
 	bool operator()(const String& x, const String& y) const { return x.equalsIgnoreCase(y); }
+	bool operator()(const String& x, const StringAtom& y) const;	// see common/str-atom.h
 };
 
 struct IgnoreCase_Hash {
 	uint operator()(const String& x) const { return hashit_lower(x.c_str()); }
+	uint operator()(const StringAtom& x) const;	// see common/str-atom.h
 };
 
 
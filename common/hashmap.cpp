@@ -53,52 +53,54 @@ uint hashit_lower(const char *p) {
 }
 
 #ifdef DEBUG_HASH_COLLISIONS
-static double
-	g_collisions = 0,
-	g_dummyHits = 0,
-	g_lookups = 0,
-	g_collPerLook = 0,
-	g_capacity = 0,
-	g_size = 0;
-static int g_max_capacity = 0, g_max_size = 0;
-static int g_totalHashmaps = 0;
-static int g_stats[4] = {0,0,0,0};
-
-void updateHashCollisionStats(int collisions, int dummyHits, int lookups, int arrsize, int nele) {
-	g_collisions += collisions;
-	g_lookups += lookups;
-	g_dummyHits += dummyHits;
+// The statistics are kept separately for HashMap and FlatHashMap, so that
+// the two can be compared on the same workload.
+struct HashCollisionStats {
+	double collisions, dummyHits, lookups, collPerLook, capacity, size;
+	int maxCapacity, maxSize;
+	int totalHashmaps;
+	int stats[4];
+};
+
+static HashCollisionStats g_hashStats[2];
+
+void updateHashCollisionStats(int collisions, int dummyHits, int lookups, int arrsize, int nele, bool flat) {
+	HashCollisionStats &s = g_hashStats[flat ? 1 : 0];
+
+	s.collisions += collisions;
+	s.lookups += lookups;
+	s.dummyHits += dummyHits;
 	if (lookups)
-		g_collPerLook += (double)collisions / (double)lookups;
-	g_capacity += arrsize;
-	g_size += nele;
-	g_totalHashmaps++;
+		s.collPerLook += (double)collisions / (double)lookups;
+	s.capacity += arrsize;
+	s.size += nele;
+	s.totalHashmaps++;
 
 	if (3*nele <= 2*8)
-		g_stats[0]++;
+		s.stats[0]++;
 	if (3*nele <= 2*16)
-		g_stats[1]++;
+		s.stats[1]++;
 	if (3*nele <= 2*32)
-		g_stats[2]++;
+		s.stats[2]++;
 	if (3*nele <= 2*64)
-		g_stats[3]++;
-
-	g_max_capacity = MAX(g_max_capacity, arrsize);
-	g_max_size = MAX(g_max_size, nele);
-
-	debug("%d hashmaps: colls %.1f; dummies hit %.1f, lookups %.1f; ratio %.3f%%; size %f (max: %d); capacity %f (max: %d)",
-		g_totalHashmaps,
-		g_collisions / g_totalHashmaps,
-		g_dummyHits / g_totalHashmaps,
-		g_lookups / g_totalHashmaps,
-		100 * g_collPerLook / g_totalHashmaps,
-		g_size / g_totalHashmaps, g_max_size,
-		g_capacity / g_totalHashmaps, g_max_capacity);
+		s.stats[3]++;
+
+	s.maxCapacity = MAX(s.maxCapacity, arrsize);
+	s.maxSize = MAX(s.maxSize, nele);
+
+	debug("%d %s: colls %.1f; dummies hit %.1f, lookups %.1f; ratio %.3f%%; size %f (max: %d); capacity %f (max: %d)",
+		s.totalHashmaps, flat ? "flat hashmaps" : "hashmaps",
+		s.collisions / s.totalHashmaps,
+		s.dummyHits / s.totalHashmaps,
+		s.lookups / s.totalHashmaps,
+		100 * s.collPerLook / s.totalHashmaps,
+		s.size / s.totalHashmaps, s.maxSize,
+		s.capacity / s.totalHashmaps, s.maxCapacity);
 	debug("  %d less than %d; %d less than %d; %d less than %d; %d less than %d",
-			g_stats[0], 2*8/3,
-			g_stats[1],2*16/3,
-			g_stats[2],2*32/3,
-			g_stats[3],2*64/3);
+			s.stats[0], 2*8/3,
+			s.stats[1],2*16/3,
+			s.stats[2],2*32/3,
+			s.stats[3],2*64/3);
 
 	// TODO:
 	// * Should record the maximal size of the map during its lifetime, not that at its death
@@ -146,7 +146,8 @@ private:
 	}
 
 	void assign(const HM_t &map);
-	uint lookup(const Key &key) const;
+	template<class LookupKey>
+	uint lookup(const LookupKey &key) const;
 	uint lookupAndCreateIfMissing(const Key &key);
 	void expandStorage(uint newCapacity);
 
@@ -287,6 +288,27 @@ public:
 		return end();
 	}
 
+	/**
+	 * Like find(), but for a key of another type than Key, for example a
+	 * StringAtom in a map with String keys. HashFunc and EqualFunc must
+	 * accept it, and hash it the same way as the equal Key.
+	 */
+	template<class LookupKey>
+	iterator	findEquivalent(const LookupKey &key) {
+		uint ctr = lookup(key);
+		if (_storage[ctr])
+			return iterator(ctr, this);
+		return end();
+	}
+
+	template<class LookupKey>
+	const_iterator	findEquivalent(const LookupKey &key) const {
+		uint ctr = lookup(key);
+		if (_storage[ctr])
+			return const_iterator(ctr, this);
+		return end();
+	}
+
 	// TODO: insert() method?
 
 	bool empty() const {
@@ -351,8 +373,8 @@ HashMap<Key, Val, HashFunc, EqualFunc>::~HashMap() {
 
 	delete[] _storage;
 #ifdef DEBUG_HASH_COLLISIONS
-	extern void updateHashCollisionStats(int, int, int, int, int);
-	updateHashCollisionStats(_collisions, _dummyHits, _lookups, _mask+1, _size);
+	extern void updateHashCollisionStats(int, int, int, int, int, bool);
+	updateHashCollisionStats(_collisions, _dummyHits, _lookups, _mask+1, _size, false);
 #endif
 }
 
@@ -460,7 +482,8 @@ void HashMap<Key, Val, HashFunc, EqualFunc>::expandStorage(uint newCapacity) {
 }
 
 template<class Key, class Val, class HashFunc, class EqualFunc>
-uint HashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key) const {
+template<class LookupKey>
+uint HashMap<Key, Val, HashFunc, EqualFunc>::lookup(const LookupKey &key) const {
 	const uint hash = _hash(key);
 	uint ctr = hash & _mask;
 	for (uint perturb = hash; ; perturb >>= HASHMAP_PERTURB_SHIFT) {
@@ -70,6 +70,9 @@ public:
 	int32 size() const { return _size; }
 
 	bool seek(int32 offs, int whence = SEEK_SET);
+
+	const byte *getRawPointer() const { return _ptrOrig; }
+	bool isResident() const { return true; }
 };
 
 
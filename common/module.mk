@@ -4,6 +4,7 @@ MODULE_OBJS := \
 	archive.o \
 	config-file.o \
 	config-manager.o \
+	cpudetect.o \
 	dcl.o \
 	debug.o \
 	error.o \
@@ -19,9 +20,11 @@ MODULE_OBJS := \
 	md5.o \
 	mutex.o \
 	quicktime.o \
+	readaheadstream.o \
 	random.o \
 	rational.o \
 	str.o \
+	str-atom.o \
 	stream.o \
 	system.o \
 	textconsole.o \
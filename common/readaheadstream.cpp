@@ -0,0 +1,485 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/readaheadstream.h"
+#include "common/list.h"
+#include "common/timer.h"
+#include "common/util.h"
+
+namespace Common {
+
+namespace {
+
+enum {
+	/** Interval of the background loading timer, in microseconds. */
+	kFillInterval = 10000
+};
+
+/**
+ * Locks a mutex for the current scope. Streams have no mutexes when there
+ * is no OSystem, in which case this does nothing.
+ */
+class ScopedLock {
+public:
+	explicit ScopedLock(OSystem::MutexRef mutex) : _mutex(mutex) {
+		if (_mutex)
+			g_system->lockMutex(_mutex);
+	}
+
+	~ScopedLock() {
+		if (_mutex)
+			g_system->unlockMutex(_mutex);
+	}
+
+private:
+	OSystem::MutexRef _mutex;
+};
+
+/**
+ * Does the background loading for all read ahead streams from a single
+ * timer, which is installed only as long as there are streams.
+ */
+class ReadAheadService {
+public:
+	ReadAheadService() : _next(0) {
+		_installMutex = g_system->createMutex();
+		_listMutex = g_system->createMutex();
+	}
+
+	void add(AsyncReadAheadStream *stream) {
+		ScopedLock installLock(_installMutex);
+		bool first;
+		{
+			ScopedLock lock(_listMutex);
+			first = _streams.empty();
+			_streams.push_back(stream);
+		}
+		if (first)
+			g_system->getTimerManager()->installTimerProc(&timerProc, kFillInterval, this, "readAheadStreams");
+	}
+
+	void remove(AsyncReadAheadStream *stream) {
+		ScopedLock installLock(_installMutex);
+		bool last;
+		{
+			// This waits for the timer if it is busy with the stream.
+			ScopedLock lock(_listMutex);
+			_streams.remove(stream);
+			last = _streams.empty();
+			_next = 0;
+		}
+		// removeTimerProc() waits for the timer to return, so this must
+		// not be done while holding _listMutex.
+		if (last)
+			g_system->getTimerManager()->removeTimerProc(&timerProc);
+	}
+
+private:
+	OSystem::MutexRef _installMutex;
+	OSystem::MutexRef _listMutex;
+	List<AsyncReadAheadStream *> _streams;
+	/** The stream which gets the first chance to load a block next tick. */
+	uint _next;
+
+	static void timerProc(void *refCon) {
+		((ReadAheadService *)refCon)->fill();
+	}
+
+	/**
+	 * Loads a single block per tick, since a read may block for a while
+	 * and the other timers have deadlines too. The streams take turns, so
+	 * that a busy one can't starve the others.
+	 */
+	void fill() {
+		ScopedLock lock(_listMutex);
+		const uint count = _streams.size();
+		if (_next >= count)
+			_next = 0;
+
+		List<AsyncReadAheadStream *>::iterator start = _streams.begin();
+		for (uint n = 0; n < _next; ++n)
+			++start;
+
+		List<AsyncReadAheadStream *>::iterator i = start;
+		for (uint n = 0; n < count; ++n) {
+			AsyncReadAheadStream *stream = *i;
+			_next = (_next + 1) % count;
+			if (++i == _streams.end())
+				i = _streams.begin();
+
+			if (stream->fillNextBlock())
+				break;
+		}
+	}
+};
+
+/** Created when the first stream is, and kept for the rest of the run. */
+ReadAheadService *s_service = 0;
+
+bool canFillInBackground() {
+	return g_system && g_system->getTimerManager();
+}
+
+} // End of anonymous namespace
+
+AsyncReadAheadStream::AsyncReadAheadStream(SeekableReadStream *parentStream, uint32 blockSize, uint numBlocks, DisposeAfterUse::Flag disposeParentStream)
+	: _parentStream(parentStream), _disposeParentStream(disposeParentStream),
+	  _blockSize(blockSize), _size(parentStream->size()), _pos(0), _eos(false), _err(false),
+	  _ioMutex(0), _mutex(0), _readBlock(0), _useCounter(0), _ioError(false) {
+
+	assert(blockSize > 0);
+	assert(numBlocks >= 2);
+
+	_blocks.resize(numBlocks);
+	for (uint i = 0; i < numBlocks; ++i) {
+		Block &block = _blocks[i];
+		block.index = -1;
+		block.size = 0;
+		block.lastUse = 0;
+		block.loading = false;
+		block.prefetched = false;
+		block.used = false;
+		block.data = new byte[blockSize];
+	}
+
+	memset(&_stats, 0, sizeof(_stats));
+
+	if (g_system) {
+		_ioMutex = g_system->createMutex();
+		_mutex = g_system->createMutex();
+	}
+
+	if (canFillInBackground()) {
+		if (!s_service)
+			s_service = new ReadAheadService();
+		s_service->add(this);
+	}
+}
+
+AsyncReadAheadStream::~AsyncReadAheadStream() {
+	if (canFillInBackground() && s_service)
+		s_service->remove(this);
+
+	for (uint i = 0; i < _blocks.size(); ++i)
+		delete[] _blocks[i].data;
+
+	if (_mutex)
+		g_system->deleteMutex(_mutex);
+	if (_ioMutex)
+		g_system->deleteMutex(_ioMutex);
+
+	if (_disposeParentStream)
+		delete _parentStream;
+}
+
+void AsyncReadAheadStream::willNeed(int32 offset, uint32 size) {
+	if (offset < 0 || offset >= _size || size == 0)
+		return;
+
+	Hint hint;
+	hint.first = offset / _blockSize;
+	hint.last = (MIN<uint32>(offset + size, _size) - 1) / _blockSize;
+
+	ScopedLock lock(_mutex);
+	for (uint i = 0; i < _hints.size(); ++i) {
+		if (_hints[i].first == hint.first && _hints[i].last == hint.last)
+			return;
+	}
+
+	if (_hints.size() >= _blocks.size())
+		_hints.remove_at(0);
+	_hints.push_back(hint);
+}
+
+bool AsyncReadAheadStream::fillNextBlock() {
+	ScopedLock ioLock(_ioMutex);
+	Block *block;
+	{
+		ScopedLock lock(_mutex);
+		if (_ioError)
+			return false;
+
+		const int32 index = nextWantedBlock();
+		if (index < 0)
+			return false;
+
+		block = findVictim(urgency(index));
+		if (!block)
+			return false;
+
+		claimBlock(block, index);
+	}
+
+	loadBlock(block, true);
+	return true;
+}
+
+AsyncReadAheadStream::Stats AsyncReadAheadStream::getStats() const {
+	ScopedLock lock(_mutex);
+	return _stats;
+}
+
+void AsyncReadAheadStream::resetStats() {
+	ScopedLock lock(_mutex);
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+uint32 AsyncReadAheadStream::read(void *dataPtr, uint32 dataSize) {
+	byte *dst = (byte *)dataPtr;
+	uint32 total = 0;
+
+	while (dataSize > 0) {
+		if (_pos >= _size) {
+			_eos = true;
+			break;
+		}
+
+		const int32 index = _pos / _blockSize;
+		const uint32 offset = _pos % _blockSize;
+		bool found = false;
+		uint32 copied = 0;
+		{
+			ScopedLock lock(_mutex);
+			moveReadBlock(index);
+
+			Block *block = findBlock(index);
+			if (block && !block->loading) {
+				found = true;
+				if (!block->used) {
+					block->used = true;
+					if (block->prefetched)
+						++_stats.hits;
+				}
+				block->lastUse = ++_useCounter;
+
+				if (offset < block->size) {
+					copied = MIN(dataSize, block->size - offset);
+					memcpy(dst, block->data + offset, copied);
+				}
+			}
+		}
+
+		if (!found) {
+			waitForBlock(index);
+			continue;
+		}
+
+		if (copied == 0) {
+			// The block is shorter than it should be, so loading it failed.
+			_err = true;
+			break;
+		}
+
+		dst += copied;
+		dataSize -= copied;
+		total += copied;
+		_pos += copied;
+	}
+
+	return total;
+}
+
+bool AsyncReadAheadStream::seek(int32 offset, int whence) {
+	int32 newPos;
+	switch (whence) {
+	case SEEK_END:
+		newPos = _size + offset;
+		break;
+	case SEEK_CUR:
+		newPos = _pos + offset;
+		break;
+	case SEEK_SET:
+	default:
+		newPos = offset;
+		break;
+	}
+
+	if (newPos < 0 || newPos > _size)
+		return false;
+
+	_pos = newPos;
+	_eos = false;
+
+	// Let the background loading start at the new position right away.
+	ScopedLock lock(_mutex);
+	moveReadBlock(_pos / _blockSize);
+	return true;
+}
+
+AsyncReadAheadStream::Block *AsyncReadAheadStream::findBlock(int32 index) {
+	for (uint i = 0; i < _blocks.size(); ++i) {
+		if (_blocks[i].index == index)
+			return &_blocks[i];
+	}
+	return 0;
+}
+
+int AsyncReadAheadStream::urgency(int32 index) const {
+	if (index == _readBlock)
+		return 0;
+
+	int rank = 1;
+	for (uint i = 0; i < _hints.size(); ++i) {
+		const Hint &hint = _hints[i];
+		if (index >= hint.first && index <= hint.last)
+			return rank + index - hint.first;
+		rank += hint.last - hint.first + 1;
+	}
+
+	const int32 ahead = index - _readBlock;
+	if (ahead > 0 && ahead < (int32)_blocks.size())
+		return rank + ahead - 1;
+
+	return -1;
+}
+
+int32 AsyncReadAheadStream::nextWantedBlock() {
+	// Check the blocks in the order urgency() ranks them.
+	const int32 numBlocks = numBlocksInStream();
+
+	if (_readBlock < numBlocks && !findBlock(_readBlock))
+		return _readBlock;
+
+	for (uint i = 0; i < _hints.size(); ++i) {
+		for (int32 index = _hints[i].first; index <= _hints[i].last; ++index) {
+			if (!findBlock(index))
+				return index;
+		}
+	}
+
+	for (int32 index = _readBlock + 1; index < _readBlock + (int32)_blocks.size() && index < numBlocks; ++index) {
+		if (!findBlock(index))
+			return index;
+	}
+
+	return -1;
+}
+
+AsyncReadAheadStream::Block *AsyncReadAheadStream::findVictim(int rank) {
+	// Prefer unused buffers, then the least recently used block nobody
+	// asked for, and finally the block which is needed last, as long as
+	// it is needed after the one which is about to be loaded.
+	Block *unwanted = 0;
+	Block *lessUrgent = 0;
+	int lessUrgentRank = rank;
+
+	for (uint i = 0; i < _blocks.size(); ++i) {
+		Block &block = _blocks[i];
+		if (block.index < 0)
+			return &block;
+		if (block.loading)
+			continue;
+
+		const int blockRank = urgency(block.index);
+		if (blockRank < 0) {
+			if (!unwanted || block.lastUse < unwanted->lastUse)
+				unwanted = &block;
+		} else if (blockRank > lessUrgentRank) {
+			lessUrgent = &block;
+			lessUrgentRank = blockRank;
+		}
+	}
+
+	return unwanted ? unwanted : lessUrgent;
+}
+
+void AsyncReadAheadStream::claimBlock(Block *block, int32 index) {
+	if (block->index >= 0 && block->prefetched && !block->used)
+		++_stats.wasted;
+
+	block->index = index;
+	block->size = 0;
+	block->loading = true;
+}
+
+void AsyncReadAheadStream::loadBlock(Block *block, bool prefetch) {
+	// Only the owner of _ioMutex loads blocks, so block->index can be
+	// read without holding _mutex.
+	const int32 start = block->index * _blockSize;
+	const uint32 expected = MIN<int32>(_blockSize, _size - start);
+
+	uint32 size = 0;
+	if (_parentStream->seek(start))
+		size = _parentStream->read(block->data, expected);
+	const bool failed = size != expected || _parentStream->err();
+
+	ScopedLock lock(_mutex);
+	block->size = size;
+	block->loading = false;
+	block->prefetched = prefetch;
+	block->used = false;
+	block->lastUse = ++_useCounter;
+
+	if (prefetch)
+		++_stats.prefetched;
+	if (failed)
+		_ioError = true;
+}
+
+void AsyncReadAheadStream::waitForBlock(int32 index) {
+	const uint32 start = g_system ? g_system->getMillis() : 0;
+
+	// Waits for the background loading, if it is busy.
+	ScopedLock ioLock(_ioMutex);
+	Block *block;
+	{
+		ScopedLock lock(_mutex);
+		++_stats.stalls;
+
+		block = findBlock(index);
+		if (!block) {
+			// Nothing can be loading while we hold _ioMutex, and the
+			// current block is more urgent than any other, so there is
+			// always a victim.
+			block = findVictim(0);
+			assert(block);
+			claimBlock(block, index);
+		} else {
+			block = 0;
+		}
+	}
+
+	if (block)
+		loadBlock(block, false);
+
+	if (g_system) {
+		ScopedLock lock(_mutex);
+		_stats.stallMillis += g_system->getMillis() - start;
+	}
+}
+
+void AsyncReadAheadStream::moveReadBlock(int32 index) {
+	if (index == _readBlock)
+		return;
+
+	_readBlock = index;
+
+	// Forget about the hints the reader has moved past.
+	for (uint i = 0; i < _hints.size(); ) {
+		if (_hints[i].last < index)
+			_hints.remove_at(i);
+		else
+			++i;
+	}
+}
+
+}	// End of namespace Common
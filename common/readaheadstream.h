@@ -0,0 +1,170 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_READAHEADSTREAM_H
+#define COMMON_READAHEADSTREAM_H
+
+#include "common/array.h"
+#include "common/stream.h"
+#include "common/system.h"
+#include "common/types.h"
+
+namespace Common {
+
+/**
+ * A wrapper around a SeekableReadStream which keeps a fixed number of
+ * buffers filled ahead of the read position, loading them in the
+ * background. It is meant for data which is consumed against a deadline,
+ * like video frames and streamed audio, where a read stalling on disk I/O
+ * results in a dropped frame or a buffer underrun.
+ *
+ * The parent stream is split into blocks of a fixed size. By default the
+ * blocks following the current read position are loaded ahead; callers
+ * which know their access pattern can announce it with willNeed(), e.g. a
+ * video decoder asking for the next frame while decoding the current one.
+ * Reads which find their data already loaded only copy it; reads which do
+ * not have to load it synchronously, which is counted as a stall.
+ *
+ * Background loading runs from a timer installed with the backend's
+ * TimerManager, which is shared by all read ahead streams. Since the
+ * other timers, like the music, run on the same thread, the timer loads
+ * at most one block per tick, taking turns between the streams. The parent
+ * stream is only ever accessed by one thread at a time, so it does not
+ * need to be thread safe itself, but it must not be used by anything else
+ * while it is wrapped. Without an OSystem instance (like in the unit tests)
+ * nothing is loaded in the background; fillNextBlock() can be called
+ * manually instead.
+ */
+class AsyncReadAheadStream : public SeekableReadStream {
+public:
+	/** Counters to check how well I/O latency is hidden from the reader. */
+	struct Stats {
+		uint32 hits;        ///< blocks which were loaded when the reader needed them
+		uint32 stalls;      ///< blocks the reader had to wait for
+		uint32 stallMillis; ///< total time the reader spent waiting
+		uint32 prefetched;  ///< blocks loaded ahead of time
+		uint32 wasted;      ///< blocks loaded ahead of time but evicted unread
+	};
+
+	enum {
+		/**
+		 * Buffers which keep about half a second of a 640x480 movie loaded
+		 * ahead, while one tick of the timer reads a single block.
+		 */
+		kVideoBlockSize = 32 * 1024,
+		kVideoBlocks = 8
+	};
+
+	/**
+	 * Wraps parentStream, using numBlocks buffers of blockSize bytes each.
+	 * numBlocks must be at least two, so that there is a buffer to load the
+	 * next block into while the current one is being read.
+	 */
+	AsyncReadAheadStream(SeekableReadStream *parentStream, uint32 blockSize, uint numBlocks, DisposeAfterUse::Flag disposeParentStream);
+	~AsyncReadAheadStream();
+
+	/**
+	 * Announces that the given range of the stream will be read soon. The
+	 * range is loaded in the background, before the blocks which simply
+	 * follow the read position, and stays loaded until the read position
+	 * moves past it. Only the most recent hints are kept, up to the number
+	 * of buffers.
+	 */
+	void willNeed(int32 offset, uint32 size);
+
+	/**
+	 * Loads the most urgent block which is not loaded yet. This is what the
+	 * background timer calls; it is safe to call from any thread.
+	 *
+	 * @return true if a block was loaded, false if there was nothing to do
+	 */
+	bool fillNextBlock();
+
+	Stats getStats() const;
+	void resetStats();
+
+	bool err() const { return _err; }
+	void clearErr() { _err = false; _eos = false; }
+	bool eos() const { return _eos; }
+	uint32 read(void *dataPtr, uint32 dataSize);
+
+	int32 pos() const { return _pos; }
+	int32 size() const { return _size; }
+	bool seek(int32 offset, int whence = SEEK_SET);
+
+private:
+	struct Block {
+		int32 index;        ///< number of the block in the stream, -1 if unused
+		uint32 size;        ///< bytes of valid data
+		uint32 lastUse;     ///< value of _useCounter when last read
+		bool loading;       ///< data is being loaded, do not touch it
+		bool prefetched;    ///< loaded ahead of time
+		bool used;          ///< read at least once since being loaded
+		byte *data;
+	};
+
+	struct Hint {
+		int32 first;
+		int32 last;
+	};
+
+	SeekableReadStream *_parentStream;
+	DisposeAfterUse::Flag _disposeParentStream;
+	const uint32 _blockSize;
+	const int32 _size;
+	int32 _pos;
+	bool _eos;
+	bool _err;
+
+	/** Protects _parentStream. Always locked before _mutex. */
+	OSystem::MutexRef _ioMutex;
+	/** Protects all members below. */
+	OSystem::MutexRef _mutex;
+
+	Array<Block> _blocks;
+	Array<Hint> _hints;
+	int32 _readBlock;
+	uint32 _useCounter;
+	bool _ioError;
+	Stats _stats;
+
+	Block *findBlock(int32 index);
+
+	/**
+	 * Returns how soon a block will be needed, with 0 for the block at the
+	 * read position and higher values for blocks needed later, or -1 if
+	 * the block is neither hinted nor in the read ahead window.
+	 */
+	int urgency(int32 index) const;
+	int32 nextWantedBlock();
+	Block *findVictim(int rank);
+	int32 numBlocksInStream() const { return (_size + _blockSize - 1) / _blockSize; }
+
+	void claimBlock(Block *block, int32 index);
+	void loadBlock(Block *block, bool prefetch);
+	void waitForBlock(int32 index);
+	void moveReadBlock(int32 index);
+};
+
+}	// End of namespace Common
+
+#endif
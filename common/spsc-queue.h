@@ -0,0 +1,102 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_SPSC_QUEUE_H
+#define COMMON_SPSC_QUEUE_H
+
+#include "common/scummsys.h"
+#include "common/atomic.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * Fixed size, lock-free queue for passing items from exactly one producer
+ * thread to exactly one consumer thread. Neither side ever waits for the
+ * other: push() fails when the queue is full and pop() fails when it is
+ * empty.
+ *
+ * If several threads need to push (or pop), the callers have to serialize
+ * those among themselves, e.g. with a Common::Mutex which is not shared
+ * with the other side.
+ *
+ * One slot is always kept free, so the queue holds up to size - 1 items.
+ */
+template<class T, uint size>
+class SPSCQueue : NonCopyable {
+public:
+	SPSCQueue() : _head(0), _tail(0) {}
+
+	/** May be called from the consumer side only. */
+	bool empty() const {
+		return Common::atomicLoad(_tail) == _head;
+	}
+
+	/** May be called from the producer side only. */
+	bool full() const {
+		return next(_tail) == Common::atomicLoad(_head);
+	}
+
+	/**
+	 * Append an item to the queue. May be called from the producer side only.
+	 *
+	 * @return false if the queue was full and the item was not added
+	 */
+	bool push(const T &item) {
+		const uint tail = _tail;
+		if (next(tail) == Common::atomicLoad(_head))
+			return false;
+
+		_items[tail] = item;
+		Common::atomicStore(_tail, next(tail));
+		return true;
+	}
+
+	/**
+	 * Remove the oldest item from the queue. May be called from the
+	 * consumer side only.
+	 *
+	 * @return false if the queue was empty and item was not changed
+	 */
+	bool pop(T &item) {
+		const uint head = _head;
+		if (head == Common::atomicLoad(_tail))
+			return false;
+
+		item = _items[head];
+		Common::atomicStore(_head, next(head));
+		return true;
+	}
+
+private:
+	static uint next(uint index) {
+		return (index + 1 == size) ? 0 : index + 1;
+	}
+
+	T _items[size];
+	volatile uint _head;	///< Next item to pop, only written by the consumer
+	volatile uint _tail;	///< Next slot to push to, only written by the producer
+};
+
+} // End of namespace Common
+
+#endif
@@ -0,0 +1,76 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "common/str-atom.h"
+#include "common/flat-hashmap.h"
+
+namespace Common {
+
+namespace {
+
+typedef FlatHashMap<String, StringAtom::Entry *, IgnoreCase_Hash, IgnoreCase_EqualTo> AtomMap;
+
+/** The global table of all interned strings. */
+class AtomTable {
+public:
+	~AtomTable() {
+		for (AtomMap::iterator i = _atoms.begin(); i != _atoms.end(); ++i)
+			delete i->_value;
+	}
+
+	const StringAtom::Entry *intern(const char *str) {
+		const String key(str);
+		AtomMap::iterator i = _atoms.find(key);
+		if (i != _atoms.end())
+			return i->_value;
+
+		StringAtom::Entry *entry = new StringAtom::Entry;
+		entry->_string = key;
+		entry->_hash = hashit_lower(key);
+		_atoms[key] = entry;
+		return entry;
+	}
+
+private:
+	AtomMap _atoms;
+};
+
+} // End of anonymous namespace
+
+const StringAtom::Entry *StringAtom::intern(const char *str) {
+	// Atoms may be created during static initialization, so the table
+	// must not depend on the initialization order of global objects.
+	static AtomTable table;
+	return table.intern(str);
+}
+
+StringAtom::StringAtom() : _entry(intern("")) {
+}
+
+StringAtom::StringAtom(const String &str) : _entry(intern(str.c_str())) {
+}
+
+StringAtom::StringAtom(const char *str) : _entry(intern(str)) {
+}
+
+}	// End of namespace Common
@@ -0,0 +1,103 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef COMMON_STR_ATOM_H
+#define COMMON_STR_ATOM_H
+
+#include "common/hash-str.h"
+#include "common/str.h"
+
+namespace Common {
+
+/**
+ * A StringAtom is a handle to an interned string. Creating an atom looks the
+ * string up in a global table and computes its case insensitive hash once;
+ * after that, comparing two atoms is a pointer compare, and hashing one just
+ * returns the stored hash.
+ *
+ * Atoms ignore case, like most string keys in ScummVM do: all strings which
+ * only differ in case map to the same atom, which keeps the spelling it was
+ * created with first. The hash of an atom is the same as IgnoreCase_Hash
+ * computes for its string, so an atom can also be used to look up String keys
+ * in maps using IgnoreCase_Hash and IgnoreCase_EqualTo, via findEquivalent().
+ *
+ * Interned strings are never freed. Atoms are meant for fixed sets of names
+ * which are looked up often, like config keys or data file names, typically
+ * stored in static variables:
+ *
+ *   static const Common::StringAtom kSubtitles("subtitles");
+ *   if (ConfMan.getBool(kSubtitles)) ...
+ *
+ * Creating atoms is not thread safe; copying and comparing them is.
+ */
+class StringAtom {
+public:
+	/** The interned representation of a string. */
+	struct Entry {
+		String _string;
+		uint _hash;
+	};
+
+	/** Creates the atom of the empty string. */
+	StringAtom();
+	explicit StringAtom(const String &str);
+	explicit StringAtom(const char *str);
+
+	const String &string() const { return _entry->_string; }
+	const char *c_str() const { return _entry->_string.c_str(); }
+	bool empty() const { return _entry->_string.empty(); }
+
+	/** Returns the case insensitive hash of the string, see hashit_lower(). */
+	uint hash() const { return _entry->_hash; }
+
+	bool operator==(const StringAtom &x) const { return _entry == x._entry; }
+	bool operator!=(const StringAtom &x) const { return _entry != x._entry; }
+
+private:
+	const Entry *_entry;
+
+	static const Entry *intern(const char *str);
+};
+
+inline uint IgnoreCase_Hash::operator()(const StringAtom &x) const {
+	return x.hash();
+}
+
+inline bool IgnoreCase_EqualTo::operator()(const String &x, const StringAtom &y) const {
+	// Longer strings share their buffer when copied, so keys created from
+	// the atom's string may match without comparing any characters.
+	return x.c_str() == y.c_str() || x.equalsIgnoreCase(y.string());
+}
+
+// Specialization of the Hash functor for StringAtom objects. The default
+// EqualTo functor compares the atoms, which only compares pointers.
+template <>
+struct Hash<StringAtom> {
+	uint operator()(const StringAtom &x) const {
+		return x.hash();
+	}
+};
+
+}	// End of namespace Common
+
+#endif
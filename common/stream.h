@@ -318,8 +318,11 @@ public:
 	 * if reading more failed, because of an I/O error or because
 	 * the end of the stream was reached. Which can be determined by
 	 * calling err() and eos().
+	 *
+	 * Streams which already hold their data in memory may override this
+	 * to return a view of it instead of a copy.
 	 */
-	SeekableReadStream *readStream(uint32 dataSize);
+	virtual SeekableReadStream *readStream(uint32 dataSize);
 
 };
 
@@ -371,6 +374,30 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Returns a pointer to the whole contents of the stream, if they are
+	 * available in memory, e.g. because the stream wraps a buffer or a
+	 * memory mapped file. The pointer stays valid as long as the stream
+	 * exists. Decoders can use this to work on the data directly instead
+	 * of reading it into a buffer of their own first.
+	 *
+	 * File streams may map the file into memory on the first call. Reading
+	 * from such a mapping can't report I/O errors, e.g. on removable media,
+	 * and crashes instead. Only call this when the data is worth it.
+	 *
+	 * @return a pointer to the first byte of the stream, or 0 if the
+	 *         contents are not available in memory
+	 */
+	virtual const byte *getRawPointer() const { return 0; }
+
+	/**
+	 * Returns whether the contents of the stream are resident in memory,
+	 * so that reading from it never waits for I/O. Unlike getRawPointer(),
+	 * this never maps a file; a memory mapped file isn't resident, since
+	 * accessing it can still page fault.
+	 */
+	virtual bool isResident() const { return false; }
+
 	/**
 	 * Reads at most one less than the number of characters specified
 	 * by bufSize from the and stores them in the string buf. Reading
@@ -77,6 +77,13 @@ public:
 	virtual int32 size() const { return _end - _begin; }
 
 	virtual bool seek(int32 offset, int whence = SEEK_SET);
+
+	virtual const byte *getRawPointer() const {
+		const byte *parentData = _parentStream->getRawPointer();
+		return parentData ? parentData + _begin : 0;
+	}
+
+	virtual bool isResident() const { return _parentStream->isResident(); }
 };
 
 /**
@@ -1416,41 +1416,38 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 
 namespace Common {
 
+/** Decompressed contents of a member, shared by the cache and the streams reading them. */
+struct ZipArchive::MemberData {
+	byte *data;
+	uint32 size;
 
-class ZipArchive : public Archive {
-	unzFile _zipFile;
+	MemberData(byte *d, uint32 s) : data(d), size(s) {}
+	~MemberData() { free(data); }
+};
 
+/** A stream reading member data, which keeps the data alive while it exists. */
+class ZipArchive::MemberStream : public MemoryReadStream {
 public:
-	ZipArchive(unzFile zipFile);
-
+	MemberStream(const MemberDataPtr &data)
+		: MemoryReadStream(data->data, data->size), _data(data) {}
 
-	~ZipArchive();
-
-	virtual bool hasFile(const String &name);
-	virtual int listMembers(ArchiveMemberList &list);
-	virtual ArchiveMemberPtr getMember(const String &name);
-	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+private:
+	MemberDataPtr _data;
 };
 
-/*
-class ZipArchiveMember : public ArchiveMember {
-	unzFile _zipFile;
-
-public:
-	ZipArchiveMember(FSNode &node) : _node(node) {
-	}
+namespace {
 
-	String getName() const {
-		...
-	}
+struct MemberOffset {
+	uLong offset;
+	const String *name;
 
-	SeekableReadStream *open() {
-		...
-	}
+	bool operator<(const MemberOffset &x) const { return offset < x.offset; }
 };
-*/
 
-ZipArchive::ZipArchive(unzFile zipFile) : _zipFile(zipFile) {
+} // End of anonymous namespace
+
+ZipArchive::ZipArchive(void *zipFile)
+	: _zipFile(zipFile), _cacheSize(kDefaultZipCacheSize), _cacheUsed(0) {
 	assert(_zipFile);
 }
 
@@ -1459,23 +1456,16 @@ ZipArchive::~ZipArchive() {
 }
 
 bool ZipArchive::hasFile(const String &name) {
-	return (unzLocateFile(_zipFile, name.c_str(), 2) == UNZ_OK);
+	return ((unz_s *)_zipFile)->_hash.contains(name);
 }
 
 int ZipArchive::listMembers(ArchiveMemberList &list) {
+	const ZipHash &hash = ((unz_s *)_zipFile)->_hash;
 	int matches = 0;
-	int err = unzGoToFirstFile(_zipFile);
 
-	while (err == UNZ_OK) {
-		char szCurrentFileName[UNZ_MAXFILENAMEINZIP+1];
-		if (unzGetCurrentFileInfo(_zipFile, NULL,
-		                          szCurrentFileName, sizeof(szCurrentFileName)-1,
-		                          NULL, 0, NULL, 0) == UNZ_OK) {
-			list.push_back(ArchiveMemberList::value_type(new GenericArchiveMember(szCurrentFileName, this)));
-			matches++;
-		}
-
-		err = unzGoToNextFile(_zipFile);
+	for (ZipHash::const_iterator i = hash.begin(); i != hash.end(); ++i) {
+		list.push_back(ArchiveMemberList::value_type(new GenericArchiveMember(i->_key, this)));
+		matches++;
 	}
 
 	return matches;
@@ -1489,46 +1479,140 @@ ArchiveMemberPtr ZipArchive::getMember(const String &name) {
 }
 
 SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) const {
+	MemberDataPtr data = lookupCache(name);
+	if (!data) {
+		data = decompressMember(name);
+		if (!data)
+			return 0;
+		addToCache(name, data);
+	}
+
+	return new MemberStream(data);
+
+	// FIXME: instead of reading all into a memory stream, we could
+	// instead create a new ZipStream class. But then we have to be
+	// careful to handle the case where the client code opens multiple
+	// files in the archive and tries to use them independently.
+}
+
+void ZipArchive::setCacheSize(uint32 size) {
+	_cacheSize = size;
+	shrinkCache(size);
+}
+
+int ZipArchive::preloadMembers(const StringArray &names) {
+	// Sort the members by their position in the file, so that they are
+	// read front to back.
+	const ZipHash &hash = ((unz_s *)_zipFile)->_hash;
+	Array<MemberOffset> members;
+	uint32 total = 0;
+
+	for (StringArray::const_iterator i = names.begin(); i != names.end(); ++i) {
+		ZipHash::const_iterator entry = hash.find(*i);
+		if (entry == hash.end())
+			continue;
+
+		const uint32 size = entry->_value.cur_file_info.uncompressed_size;
+		if (total + size > _cacheSize || total + size < total)
+			continue;
+		total += size;
+
+		MemberOffset member;
+		member.offset = entry->_value.cur_file_info_internal.offset_curfile;
+		member.name = &entry->_key;
+		members.push_back(member);
+	}
+
+	sort(members.begin(), members.end(), Less<MemberOffset>());
+
+	int loaded = 0;
+	for (uint i = 0; i < members.size(); ++i) {
+		const String &name = *members[i].name;
+		if (!lookupCache(name)) {
+			MemberDataPtr data = decompressMember(name);
+			if (!data)
+				continue;
+			addToCache(name, data);
+		}
+		++loaded;
+	}
+
+	return loaded;
+}
+
+ZipArchive::MemberDataPtr ZipArchive::decompressMember(const String &name) const {
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
-		return 0;
+		return MemberDataPtr();
 
 	unz_file_info fileInfo;
 	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
-		return 0;
+		return MemberDataPtr();
 
 	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
-		return 0;
+		return MemberDataPtr();
 
 	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
 	assert(buffer);
 
 	if (unzReadCurrentFile(_zipFile, buffer, fileInfo.uncompressed_size) != (int)fileInfo.uncompressed_size) {
 		free(buffer);
-		return 0;
+		return MemberDataPtr();
 	}
 
 	if (unzCloseCurrentFile(_zipFile) != UNZ_OK) {
 		free(buffer);
-		return 0;
+		return MemberDataPtr();
 	}
 
-	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
+	return MemberDataPtr(new MemberData(buffer, fileInfo.uncompressed_size));
+}
+
+ZipArchive::MemberDataPtr ZipArchive::lookupCache(const String &name) const {
+	CacheIndex::iterator i = _cacheIndex.find(name);
+	if (i == _cacheIndex.end())
+		return MemberDataPtr();
 
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
+	// Move the member to the front of the LRU list
+	CacheEntry entry = *i->_value;
+	_cache.erase(i->_value);
+	_cache.push_front(entry);
+	i->_value = _cache.begin();
+
+	return entry.data;
+}
+
+void ZipArchive::addToCache(const String &name, const MemberDataPtr &data) const {
+	if (data->size > _cacheSize)
+		return;
+
+	shrinkCache(_cacheSize - data->size);
+
+	CacheEntry entry;
+	entry.name = name;
+	entry.data = data;
+	_cache.push_front(entry);
+	_cacheIndex[name] = _cache.begin();
+	_cacheUsed += data->size;
+}
+
+void ZipArchive::shrinkCache(uint32 size) const {
+	while (_cacheUsed > size) {
+		const CacheEntry &entry = _cache.back();
+		_cacheUsed -= entry.data->size;
+		_cacheIndex.erase(entry.name);
+		_cache.pop_back();
+	}
 }
 
-Archive *makeZipArchive(const String &name) {
+ZipArchive *makeZipArchive(const String &name) {
 	return makeZipArchive(SearchMan.createReadStreamForMember(name));
 }
 
-Archive *makeZipArchive(const FSNode &node) {
+ZipArchive *makeZipArchive(const FSNode &node) {
 	return makeZipArchive(node.createReadStream());
 }
 
-Archive *makeZipArchive(SeekableReadStream *stream) {
+ZipArchive *makeZipArchive(SeekableReadStream *stream) {
 	if (!stream)
 		return 0;
 	unzFile zipFile = unzOpen(stream);
@@ -22,21 +22,101 @@
 #ifndef COMMON_UNZIP_H
 #define COMMON_UNZIP_H
 
+#include "common/archive.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/ptr.h"
 #include "common/str.h"
+#include "common/str-array.h"
 
 namespace Common {
 
-class Archive;
 class FSNode;
 class SeekableReadStream;
 
+enum {
+	/** Default budget for the decompressed members a ZipArchive keeps around. */
+	kDefaultZipCacheSize = 256 * 1024
+};
+
+/**
+ * An Archive giving access to the members of a ZIP file.
+ *
+ * The central directory is read once, when the archive is opened, into an
+ * index which is used for all lookups afterwards.
+ *
+ * Members are decompressed into memory as a whole when they are opened.
+ * Recently opened members are kept in an LRU cache, so opening them again
+ * costs neither I/O nor decompression. The cache is limited to a budget of
+ * decompressed bytes; members larger than the whole budget are never cached.
+ * Streams returned for cached members share the cached data, so evicting a
+ * member from the cache does not invalidate them.
+ */
+class ZipArchive : public Archive {
+public:
+	~ZipArchive();
+
+	virtual bool hasFile(const String &name);
+	virtual int listMembers(ArchiveMemberList &list);
+	virtual ArchiveMemberPtr getMember(const String &name);
+	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+
+	/**
+	 * Sets the budget of the member cache, in decompressed bytes, and
+	 * evicts members as needed to fit into it. 0 disables the cache.
+	 */
+	void setCacheSize(uint32 size);
+	uint32 getCacheSize() const { return _cacheSize; }
+
+	/**
+	 * Decompresses the given members into the cache. This is cheaper than
+	 * opening them one by one, as the members are read in the order they
+	 * are stored in the file. Members which do not exist are ignored, as
+	 * are the ones which would not fit into the cache next to the members
+	 * loaded before them.
+	 *
+	 * @return the number of members which are in the cache now
+	 */
+	int preloadMembers(const StringArray &names);
+
+private:
+	struct MemberData;
+	class MemberStream;
+	typedef SharedPtr<MemberData> MemberDataPtr;
+
+	struct CacheEntry {
+		String name;
+		MemberDataPtr data;
+	};
+	typedef List<CacheEntry> CacheList;
+	typedef HashMap<String, CacheList::iterator, IgnoreCase_Hash, IgnoreCase_EqualTo> CacheIndex;
+
+	friend ZipArchive *makeZipArchive(SeekableReadStream *stream);
+	explicit ZipArchive(void *zipFile);
+
+	/** The unzFile handle of the bundled unzip code. */
+	void *_zipFile;
+
+	uint32 _cacheSize;
+	mutable uint32 _cacheUsed;
+	/** Cached members, most recently used first. */
+	mutable CacheList _cache;
+	mutable CacheIndex _cacheIndex;
+
+	MemberDataPtr decompressMember(const String &name) const;
+	MemberDataPtr lookupCache(const String &name) const;
+	void addToCache(const String &name, const MemberDataPtr &data) const;
+	void shrinkCache(uint32 size) const;
+};
+
 /**
  * This factory method creates an Archive instance corresponding to the content
  * of the ZIP compressed file with the given name.
  *
  * May return 0 in case of a failure.
  */
-Archive *makeZipArchive(const String &name);
+ZipArchive *makeZipArchive(const String &name);
 
 /**
  * This factory method creates an Archive instance corresponding to the content
@@ -44,7 +124,7 @@ Archive *makeZipArchive(const String &name);
  *
  * May return 0 in case of a failure.
  */
-Archive *makeZipArchive(const FSNode &node);
+ZipArchive *makeZipArchive(const FSNode &node);
 
 /**
  * This factory method creates an Archive instance corresponding to the content
@@ -54,7 +134,7 @@ Archive *makeZipArchive(const FSNode &node);
  *
  * May return 0 in case of a failure. In this case stream will still be deleted.
  */
-Archive *makeZipArchive(SeekableReadStream *stream);
+ZipArchive *makeZipArchive(SeekableReadStream *stream);
 
 }	// End of namespace Common
 
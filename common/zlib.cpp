@@ -24,6 +24,7 @@
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
 #include "common/zlib.h"
+#include "common/array.h"
 #include "common/ptr.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -38,6 +39,11 @@
   #if ZLIB_VERNUM < 0x1204
   #error Version 1.2.0.4 or newer of zlib is required for this code
   #endif
+
+  // inflateGetDictionary() is needed to record seek checkpoints
+  #if ZLIB_VERNUM >= 0x1271
+  #define GZIP_CHECKPOINTS
+  #endif
 #endif
 
 
@@ -82,11 +88,20 @@ bool inflateZlibHeaderless(byte *dst, uint dstLen, const byte *src, uint srcLen)
  * A simple wrapper class which can be used to wrap around an arbitrary
  * other SeekableReadStream and will then provide on-the-fly decompression support.
  * Assumes the compressed data to be in gzip format.
+ *
+ * Data is inflated directly into the buffer passed to read(). With zlib
+ * 1.2.7.1 or newer, the stream also records checkpoints while decompressing,
+ * i.e. the decompressor state at deflate block boundaries every few hundred
+ * KB, so that seeking backwards does not need to start over from the
+ * beginning of the file.
  */
 class GZipReadStream : public SeekableReadStream {
 protected:
 	enum {
-		BUFSIZE = 16384		// 1 << MAX_WBITS
+		BUFSIZE = 16384,		// 1 << MAX_WBITS
+		WINDOWSIZE = 32768,		// size of the deflate history
+		CHECKPOINT_INTERVAL = 256 * 1024,
+		MAX_CHECKPOINTS = 64
 	};
 
 	byte	_buf[BUFSIZE];
@@ -98,6 +113,82 @@ protected:
 	uint32 _origSize;
 	bool _eos;
 
+#ifdef GZIP_CHECKPOINTS
+	/**
+	 * The decompressor state at the start of a deflate block, from which
+	 * decompression can be resumed.
+	 */
+	struct Checkpoint {
+		uint32 in;			// position of the block in the wrapped stream
+		uint32 out;			// position of the block in the decompressed data
+		int bits;			// number of bits of the byte before 'in' belonging to the block
+		uInt windowSize;
+		byte *window;		// the decompressed data preceding the block
+	};
+
+	Array<Checkpoint> _checkpoints;
+
+	void addCheckpoint(uint32 out) {
+		const uint32 last = _checkpoints.empty() ? 0 : _checkpoints.back().out;
+		if (out < last + CHECKPOINT_INTERVAL || _checkpoints.size() >= MAX_CHECKPOINTS)
+			return;
+
+		Checkpoint checkpoint;
+		checkpoint.in = _wrapped->pos() - _stream.avail_in;
+		checkpoint.out = out;
+		checkpoint.bits = _stream.data_type & 7;
+		checkpoint.windowSize = WINDOWSIZE;
+		checkpoint.window = new byte[WINDOWSIZE];
+		if (inflateGetDictionary(&_stream, checkpoint.window, &checkpoint.windowSize) != Z_OK) {
+			delete[] checkpoint.window;
+			return;
+		}
+
+		_checkpoints.push_back(checkpoint);
+	}
+
+	bool restoreCheckpoint(const Checkpoint &checkpoint) {
+		// Checkpoints point into the raw deflate data, after the header
+		_zlibErr = inflateReset2(&_stream, -MAX_WBITS);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		if (checkpoint.bits) {
+			_wrapped->seek(checkpoint.in - 1, SEEK_SET);
+			const byte partial = _wrapped->readByte();
+			_zlibErr = inflatePrime(&_stream, checkpoint.bits, partial >> (8 - checkpoint.bits));
+		} else {
+			_wrapped->seek(checkpoint.in, SEEK_SET);
+		}
+		if (_zlibErr == Z_OK)
+			_zlibErr = inflateSetDictionary(&_stream, checkpoint.window, checkpoint.windowSize);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_pos = checkpoint.out;
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		return true;
+	}
+#endif
+
+	bool rewind() {
+		_pos = 0;
+		_wrapped->seek(0, SEEK_SET);
+#ifdef GZIP_CHECKPOINTS
+		// A checkpoint may have switched to raw deflate data, so the
+		// header detection has to be set up again.
+		_zlibErr = inflateReset2(&_stream, MAX_WBITS + 32);
+#else
+		_zlibErr = inflateReset(&_stream);
+#endif
+		if (_zlibErr != Z_OK)
+			return false;
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		return true;
+	}
+
 public:
 
 	GZipReadStream(SeekableReadStream *w) : _wrapped(w), _stream() {
@@ -137,6 +228,10 @@ public:
 
 	~GZipReadStream() {
 		inflateEnd(&_stream);
+#ifdef GZIP_CHECKPOINTS
+		for (uint i = 0; i < _checkpoints.size(); ++i)
+			delete[] _checkpoints[i].window;
+#endif
 	}
 
 	bool err() const { return (_zlibErr != Z_OK) && (_zlibErr != Z_STREAM_END); }
@@ -156,7 +251,15 @@ public:
 				_stream.next_in = _buf;
 				_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
 			}
+#ifdef GZIP_CHECKPOINTS
+			// Stop at the end of each deflate block, to check whether a
+			// checkpoint should be recorded there.
+			_zlibErr = inflate(&_stream, Z_BLOCK);
+			if (_zlibErr == Z_OK && (_stream.data_type & 128) && !(_stream.data_type & 64))
+				addCheckpoint(_pos + dataSize - _stream.avail_out);
+#else
 			_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+#endif
 		}
 
 		// Update the position counter
@@ -190,6 +293,18 @@ public:
 
 		assert(newPos >= 0);
 
+#ifdef GZIP_CHECKPOINTS
+		// Resume from the last checkpoint before the new position, if
+		// that is closer than the current position.
+		const Checkpoint *checkpoint = 0;
+		for (uint i = 0; i < _checkpoints.size() && _checkpoints[i].out <= (uint32)newPos; ++i)
+			checkpoint = &_checkpoints[i];
+
+		if (checkpoint && ((uint32)newPos < _pos || checkpoint->out > _pos)) {
+			if (!restoreCheckpoint(*checkpoint))
+				return false;	// FIXME: STREAM REWRITE
+		} else
+#endif
 		if ((uint32)newPos < _pos) {
 			// To search backward, we have to restart the whole decompression
 			// from the start of the file. A rather wasteful operation, best
@@ -197,13 +312,8 @@ public:
 #if DEBUG
 			warning("Backward seeking in GZipReadStream detected");
 #endif
-			_pos = 0;
-			_wrapped->seek(0, SEEK_SET);
-			_zlibErr = inflateReset(&_stream);
-			if (_zlibErr != Z_OK)
+			if (!rewind())
 				return false;	// FIXME: STREAM REWRITE
-			_stream.next_in = _buf;
-			_stream.avail_in = 0;
 		}
 
 		offset = newPos - _pos;
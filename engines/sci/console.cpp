@@ -108,6 +108,8 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("resource_id",		WRAP_METHOD(Console, cmdResourceId));
 	DCmd_Register("resource_info",		WRAP_METHOD(Console, cmdResourceInfo));
 	DCmd_Register("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
+	DCmd_Register("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
+	DCmd_Register("room_change_bench",	WRAP_METHOD(Console, cmdRoomChangeBench));
 	DCmd_Register("list",				WRAP_METHOD(Console, cmdList));
 	DCmd_Register("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	DCmd_Register("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
@@ -146,6 +148,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("gc_reachable",		WRAP_METHOD(Console, cmdGCShowReachable));
 	DCmd_Register("gc_freeable",		WRAP_METHOD(Console, cmdGCShowFreeable));
 	DCmd_Register("gc_normalize",		WRAP_METHOD(Console, cmdGCNormalize));
+	DCmd_Register("gc_stats",			WRAP_METHOD(Console, cmdGCStats));
 	// Music/SFX
 	DCmd_Register("songlib",			WRAP_METHOD(Console, cmdSongLib));
 	DCmd_Register("songinfo",			WRAP_METHOD(Console, cmdSongInfo));
@@ -201,6 +204,8 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("bpe",				WRAP_METHOD(Console, cmdBreakpointFunction));		// alias
 	// VM
 	DCmd_Register("script_steps",		WRAP_METHOD(Console, cmdScriptSteps));
+	DCmd_Register("selector_cache",		WRAP_METHOD(Console, cmdSelectorCache));
+	DCmd_Register("vm_predecode",		WRAP_METHOD(Console, cmdVMPredecode));
 	DCmd_Register("vm_varlist",			WRAP_METHOD(Console, cmdVMVarlist));
 	DCmd_Register("vmvarlist",			WRAP_METHOD(Console, cmdVMVarlist));				// alias
 	DCmd_Register("vl",					WRAP_METHOD(Console, cmdVMVarlist));				// alias
@@ -344,6 +349,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf(" resource_id - Identifies a resource number by splitting it up in resource type and resource number\n");
 	DebugPrintf(" resource_info - Shows info about a resource\n");
 	DebugPrintf(" resource_types - Shows the valid resource types\n");
+	DebugPrintf(" resource_cache - Shows the statistics of the resource cache or sets its size\n");
+	DebugPrintf(" room_change_bench - Measures the time to load the resources of a room, with and without preloading\n");
 	DebugPrintf(" list - Lists all the resources of a given type\n");
 	DebugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	DebugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
@@ -380,6 +387,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf(" gc_reachable - Lists all addresses directly reachable from a given memory object\n");
 	DebugPrintf(" gc_freeable - Lists all addresses freeable in a given segment\n");
 	DebugPrintf(" gc_normalize - Prints the \"normal\" address of a given address\n");
+	DebugPrintf(" gc_stats - Shows the number of garbage collections and a histogram of their pauses\n");
 	DebugPrintf("\n");
 	DebugPrintf("Music/SFX:\n");
 	DebugPrintf(" songlib - Shows the song library\n");
@@ -420,7 +428,9 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf(" bp_function / bpe - Sets a breakpoint on the execution of the specified exported function\n");
 	DebugPrintf("\n");
 	DebugPrintf("VM:\n");
-	DebugPrintf(" script_steps - Shows the number of executed SCI operations\n");
+	DebugPrintf(" script_steps - Shows the number of executed SCI operations, or measures their rate\n");
+	DebugPrintf(" selector_cache - Shows the hit rate of the selector lookup cache\n");
+	DebugPrintf(" vm_predecode - Shows or sets whether the VM executes pre-decoded instructions\n");
 	DebugPrintf(" vm_varlist / vmvarlist / vl - Shows the addresses of variables in the VM\n");
 	DebugPrintf(" vm_vars / vmvars / vv - Displays or changes variables in the VM\n");
 	DebugPrintf(" stack - Lists the specified number of stack elements\n");
@@ -785,6 +795,106 @@ bool Console::cmdResourceTypes(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	ResourceManager *resMan = _engine->getResMan();
+
+	if (argc == 2 && !strcmp(argv[1], "reset")) {
+		resMan->resetCacheStats();
+		DebugPrintf("Resource cache statistics have been reset\n");
+		return true;
+	} else if (argc == 3 && !strcmp(argv[1], "size")) {
+		resMan->setMaxMemory(atoi(argv[2]) * 1024);
+	} else if (argc != 1) {
+		DebugPrintf("Shows the statistics of the cache of unlocked resources, resets them or sets the cache size.\n");
+		DebugPrintf("Usage: %s [reset | size <KB>]\n", argv[0]);
+		return true;
+	}
+
+	const ResourceCacheStats &stats = resMan->getCacheStats();
+	uint32 locked, lru, hotLRU;
+	resMan->getMemoryUsage(locked, lru, hotLRU);
+
+	DebugPrintf("Cache size: %d KB, used: %d KB (%d KB hot), locked: %d KB\n",
+			resMan->getMaxMemory() / 1024, (lru + hotLRU) / 1024, hotLRU / 1024, locked / 1024);
+
+	const uint32 lookups = stats.hits + stats.misses;
+	DebugPrintf("Lookups: %d, hits: %d, misses: %d", lookups, stats.hits, stats.misses);
+	if (lookups)
+		DebugPrintf(" (%d%% hit rate)", (int)(stats.hits * 100.0 / lookups));
+	DebugPrintf("\n");
+	DebugPrintf("Preloaded: %d, evicted: %d\n", stats.preloads, stats.evictions);
+	DebugPrintf("Loaded %d KB in %d ms\n", stats.loadedBytes / 1024, stats.loadMillis);
+	DebugPrintf("Decompressed in the background: %d in %d ms, waited for: %d in %d ms\n",
+			stats.backgroundLoads, stats.backgroundMillis, stats.waits, stats.waitMillis);
+	return true;
+}
+
+bool Console::cmdRoomChangeBench(int argc, const char **argv) {
+	if (argc < 2 || argc > 4) {
+		DebugPrintf("Measures how long the resources of a room take to load, both when loading\n");
+		DebugPrintf("them on first use and when they were preloaded the given time before.\n");
+		DebugPrintf("The resources of a room are the views, pics, scripts, heaps, texts and\n");
+		DebugPrintf("palettes with the room's number and the given number of following ones.\n");
+		DebugPrintf("Usage: %s <room> [<count> [<preload time in ms>]]\n", argv[0]);
+		return true;
+	}
+
+	static const ResourceType types[] = {
+		kResourceTypeView, kResourceTypePic, kResourceTypeScript,
+		kResourceTypeHeap, kResourceTypeText, kResourceTypePalette
+	};
+
+	ResourceManager *resMan = _engine->getResMan();
+	const int room = atoi(argv[1]);
+	const int count = argc > 2 ? atoi(argv[2]) : 1;
+	const uint32 preloadTime = argc > 3 ? atoi(argv[3]) : 100;
+
+	Common::Array<ResourceId> ids;
+	for (int nr = room; nr < room + count; nr++) {
+		for (uint i = 0; i < ARRAYSIZE(types); i++) {
+			const ResourceId id(types[i], nr);
+			if (resMan->testResource(id))
+				ids.push_back(id);
+		}
+	}
+
+	if (ids.empty()) {
+		DebugPrintf("Room %d has no resources\n", room);
+		return true;
+	}
+
+	// Load on first use, like the engine does without kLoad
+	uint32 size = 0;
+	for (uint i = 0; i < ids.size(); i++)
+		resMan->freeResource(ids[i]);
+	uint32 startTime = g_system->getMillis();
+	for (uint i = 0; i < ids.size(); i++) {
+		Resource *res = resMan->findResource(ids[i], false);
+		if (res)
+			size += res->size;
+	}
+	const uint32 syncMillis = g_system->getMillis() - startTime;
+
+	// Preload everything, then let the room transition take its time
+	for (uint i = 0; i < ids.size(); i++)
+		resMan->freeResource(ids[i]);
+	startTime = g_system->getMillis();
+	for (uint i = 0; i < ids.size(); i++)
+		resMan->preloadResource(ids[i]);
+	const uint32 preloadMillis = g_system->getMillis() - startTime;
+	g_system->delayMillis(preloadTime);
+	startTime = g_system->getMillis();
+	for (uint i = 0; i < ids.size(); i++)
+		resMan->findResource(ids[i], false);
+	const uint32 useMillis = g_system->getMillis() - startTime;
+
+	DebugPrintf("%d resources, %d KB\n", ids.size(), size / 1024);
+	DebugPrintf("Loaded on first use: %d ms\n", syncMillis);
+	DebugPrintf("Preloaded: %d ms to preload, %d ms to use them %d ms later\n",
+			preloadMillis, useMillis, preloadTime);
+	return true;
+}
+
 bool Console::cmdHexgrep(int argc, const char **argv) {
 	if (argc < 4) {
 		DebugPrintf("Searches some resources for a particular sequence of bytes, represented as decimal or hexadecimal numbers.\n");
@@ -2271,6 +2381,41 @@ bool Console::cmdGCNormalize(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdGCStats(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset"))) {
+		DebugPrintf("Shows the number of garbage collections, the objects they freed and a histogram of their pauses.\n");
+		DebugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	GCStats &stats = _engine->_gamestate->_gcState->_stats;
+
+	if (argc == 2) {
+		stats.reset();
+		DebugPrintf("Garbage collector statistics have been reset\n");
+		return true;
+	}
+
+	DebugPrintf("Collections: %d, objects freed: %d\n", stats.runs, stats.freed);
+	if (!stats.runs)
+		return true;
+
+	DebugPrintf("Pauses: %d ms in total, %d ms on average, %d ms at most\n",
+			stats.totalMillis, stats.totalMillis / stats.runs, stats.maxMillis);
+	for (int i = 0; i < GCStats::kPauseBuckets; i++) {
+		if (!i)
+			DebugPrintf("    0 ms");
+		else if (i == 1)
+			DebugPrintf("    1 ms");
+		else if (i == GCStats::kPauseBuckets - 1)
+			DebugPrintf(" >= %d ms", 1 << (i - 1));
+		else
+			DebugPrintf(" %d-%d ms", 1 << (i - 1), (1 << i) - 1);
+		DebugPrintf(": %d\n", stats.pauses[i]);
+	}
+	return true;
+}
+
 bool Console::cmdVMVarlist(int argc, const char **argv) {
 	EngineState *s = _engine->_gamestate;
 	const char *varnames[] = {"global", "local", "temp", "param"};
@@ -2635,7 +2780,79 @@ bool Console::cmdViewAccumulatorObject(int argc, const char **argv) {
 }
 
 bool Console::cmdScriptSteps(int argc, const char **argv) {
-	DebugPrintf("Number of executed SCI operations: %d\n", _engine->_gamestate->scriptStepCounter);
+	EngineState *s = _engine->_gamestate;
+
+	if (argc == 2 && !strcmp(argv[1], "start")) {
+		s->scriptTiming = true;
+		s->scriptTimingStart = s->scriptStepCounter;
+		s->scriptMillis = 0;
+	} else if (argc == 2 && !strcmp(argv[1], "stop")) {
+		if (s->scriptTiming) {
+			s->scriptTiming = false;
+			s->scriptTimingEnd = s->scriptStepCounter;
+		}
+	} else if (argc != 1) {
+		DebugPrintf("Shows the number of executed SCI operations. \"start\" measures the time\n");
+		DebugPrintf("spent executing operations from now on, until \"stop\".\n");
+		DebugPrintf("Usage: %s [start | stop]\n", argv[0]);
+		return true;
+	}
+
+	DebugPrintf("Number of executed SCI operations: %d\n", s->scriptStepCounter);
+	if (s->scriptTiming || s->scriptTimingEnd) {
+		// Kernel calls aren't counted in the time, so that the rates of both
+		// interpreters can be compared on the same recorded session
+		const int steps = (s->scriptTiming ? s->scriptStepCounter : s->scriptTimingEnd) - s->scriptTimingStart;
+		DebugPrintf("Measured %s: %d operations in %d ms", s->scriptTiming ? "so far" : "until stopped", steps, s->scriptMillis);
+		if (s->scriptMillis)
+			DebugPrintf(" (%d operations per second)", (int)(steps * 1000.0 / s->scriptMillis));
+		DebugPrintf("\n");
+	}
+	return true;
+}
+
+bool Console::cmdVMPredecode(int argc, const char **argv) {
+	EngineState *s = _engine->_gamestate;
+
+	if (argc == 2 && !strcmp(argv[1], "on")) {
+		s->usePredecodedScripts = true;
+	} else if (argc == 2 && !strcmp(argv[1], "off")) {
+		s->usePredecodedScripts = false;
+	} else if (argc != 1) {
+		DebugPrintf("Shows or sets whether the VM executes the pre-decoded instructions of the scripts,\n");
+		DebugPrintf("instead of decoding each instruction again when executing it.\n");
+		DebugPrintf("Usage: %s [on | off]\n", argv[0]);
+		return true;
+	}
+
+	DebugPrintf("Pre-decoded instructions are %s\n", s->usePredecodedScripts ? "on" : "off");
+	return true;
+}
+
+bool Console::cmdSelectorCache(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset"))) {
+		DebugPrintf("Shows the statistics of the selector lookup cache of send operations.\n");
+		DebugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	SelectorLookupCache &cache = _engine->_gamestate->_segMan->getSelectorLookupCache();
+
+	if (argc == 2) {
+		cache.resetStats();
+		DebugPrintf("Selector cache statistics have been reset\n");
+		return true;
+	}
+
+	const SelectorLookupCache::Stats stats = cache.getStats();
+	const uint32 lookups = stats.hits + stats.misses;
+
+	DebugPrintf("Lookups: %d, hits: %d, misses: %d", lookups, stats.hits, stats.misses);
+	if (lookups)
+		DebugPrintf(" (%d%% hit rate)", (int)(stats.hits * 100.0 / lookups));
+	DebugPrintf("\n");
+	DebugPrintf("Call sites: %d, polymorphic: %d\n", stats.sites, stats.polymorphicSites);
+	DebugPrintf("Invalidations: %d\n", stats.clears);
 	return true;
 }
 
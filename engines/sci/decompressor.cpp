@@ -163,12 +163,20 @@ int DecompressorLZW::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
 		break;
 	case kCompLZW1View:
 		buffer = new byte[nUnpacked];
-		unpackLZW1(src, buffer, nPacked, nUnpacked);
+		// Other errors have always been ignored here, but without its
+		// buffers nothing at all was decompressed
+		if (unpackLZW1(src, buffer, nPacked, nUnpacked) == SCI_ERROR_RESOURCE_TOO_BIG) {
+			delete[] buffer;
+			return SCI_ERROR_RESOURCE_TOO_BIG;
+		}
 		reorderView(buffer, dest);
 		break;
 	case kCompLZW1Pic:
 		buffer = new byte[nUnpacked];
-		unpackLZW1(src, buffer, nPacked, nUnpacked);
+		if (unpackLZW1(src, buffer, nPacked, nUnpacked) == SCI_ERROR_RESOURCE_TOO_BIG) {
+			delete[] buffer;
+			return SCI_ERROR_RESOURCE_TOO_BIG;
+		}
 		reorderPic(buffer, dest, nUnpacked);
 		break;
 	}
@@ -189,7 +197,9 @@ int DecompressorLZW::unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPack
 		free(tokenlist);
 		free(tokenlengthlist);
 
-		error("[DecompressorLZW::unpackLZW] Cannot allocate token memory buffers");
+		// Resources may be decompressed on the timer thread, so leave
+		// reporting this to the caller
+		return SCI_ERROR_RESOURCE_TOO_BIG;
 	}
 
 	while (!isFinished()) {
@@ -263,7 +273,7 @@ int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPac
 		free(stak);
 		free(tokens);
 
-		error("[DecompressorLZW::unpackLZW1] Cannot allocate decompression buffers");
+		return SCI_ERROR_RESOURCE_TOO_BIG;
 	}
 
 	memset(tokens, 0, tokensSize);
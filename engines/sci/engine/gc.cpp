@@ -22,6 +22,7 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 namespace Sci {
@@ -64,20 +65,35 @@ void WorklistManager::pushArray(const Common::Array<reg_t> &tmp) {
 		push(*it);
 }
 
-static AddrSet *normalizeAddresses(SegManager *segMan, const AddrSet &nonnormal_map) {
-	AddrSet *normal_map = new AddrSet();
+void GCStats::reset() {
+	runs = 0;
+	freed = 0;
+	totalMillis = 0;
+	maxMillis = 0;
+	memset(pauses, 0, sizeof(pauses));
+}
+
+void GCStats::addPause(uint32 millis) {
+	runs++;
+	totalMillis += millis;
+	maxMillis = MAX(maxMillis, millis);
+
+	uint bucket = 0;
+	while (bucket < kPauseBuckets - 1 && millis >= (1U << bucket))
+		bucket++;
+	pauses[bucket]++;
+}
 
+static void normalizeAddresses(SegManager *segMan, const AddrSet &nonnormal_map, AddrSet &normal_map) {
 	for (AddrSet::const_iterator i = nonnormal_map.begin(); i != nonnormal_map.end(); ++i) {
 		reg_t reg = i->_key;
 		SegmentObj *mobj = segMan->getSegmentObj(reg.segment);
 
 		if (mobj) {
 			reg = mobj->findCanonicAddress(segMan, reg);
-			normal_map->setVal(reg, true);
+			normal_map.setVal(reg, true);
 		}
 	}
-
-	return normal_map;
 }
 
 static void processWorkList(SegManager *segMan, WorklistManager &wm, const Common::Array<SegmentObj *> &heap) {
@@ -95,11 +111,9 @@ static void processWorkList(SegManager *segMan, WorklistManager &wm, const Commo
 	}
 }
 
-AddrSet *findAllActiveReferences(EngineState *s) {
+static void findActiveReferences(EngineState *s, WorklistManager &wm, AddrSet &activeRefs) {
 	assert(!s->_executionStack.empty());
 
-	WorklistManager wm;
-
 	// Initialize registers
 	wm.push(s->r_acc);
 	wm.push(s->r_prev);
@@ -157,11 +171,20 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	if (g_sci->_gfxPorts)
 		g_sci->_gfxPorts->processEngineHunkList(wm);
 
-	return normalizeAddresses(s->_segMan, wm._map);
+	normalizeAddresses(s->_segMan, wm._map, activeRefs);
+}
+
+AddrSet *findAllActiveReferences(EngineState *s) {
+	WorklistManager wm;
+	AddrSet *activeRefs = new AddrSet();
+	findActiveReferences(s, wm, *activeRefs);
+	return activeRefs;
 }
 
 void run_gc(EngineState *s) {
 	SegManager *segMan = s->_segMan;
+	GCState *gc = s->_gcState;
+	const uint32 startTime = g_system->getMillis();
 
 	// Some debug stuff
 	debugC(kDebugLevelGC, "[GC] Running...");
@@ -172,8 +195,12 @@ void run_gc(EngineState *s) {
 	memset(segcount, 0, sizeof(segcount));
 #endif
 
-	// Compute the set of all segments references currently in use.
-	AddrSet *activeRefs = findAllActiveReferences(s);
+	// Compute the set of all segments references currently in use. The
+	// work list is always left empty by the previous run.
+	gc->_wm._map.clear();
+	gc->_activeRefs.clear();
+	findActiveReferences(s, gc->_wm, gc->_activeRefs);
+	const AddrSet &activeRefs = gc->_activeRefs;
 
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
@@ -192,9 +219,10 @@ void run_gc(EngineState *s) {
 			const Common::Array<reg_t> tmp = mobj->listAllDeallocatable(seg);
 			for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it) {
 				const reg_t addr = *it;
-				if (!activeRefs->contains(addr)) {
+				if (!activeRefs.contains(addr)) {
 					// Not found -> we can free it
 					mobj->freeAtAddress(segMan, addr);
+					gc->_stats.freed++;
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
 #ifdef GC_DEBUG_CODE
 					segcount[type]++;
@@ -205,7 +233,7 @@ void run_gc(EngineState *s) {
 		}
 	}
 
-	delete activeRefs;
+	gc->_stats.addPause(g_system->getMillis() - startTime);
 
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
@@ -63,6 +63,39 @@ struct WorklistManager {
 	void pushArray(const Common::Array<reg_t> &tmp);
 };
 
+/**
+ * Statistics of the garbage collector runs, shown by the gc_stats console
+ * command.
+ */
+struct GCStats {
+	enum {
+		/** Pauses of 0ms, 1ms, 2-3ms, 4-7ms, ..., 32-63ms and 64ms or more */
+		kPauseBuckets = 8
+	};
+
+	uint32 runs;		///< Number of garbage collections
+	uint32 freed;		///< Number of objects freed by them
+	uint32 totalMillis;	///< Time spent collecting
+	uint32 maxMillis;	///< Longest pause
+	uint32 pauses[kPauseBuckets];	///< Histogram of the pause times
+
+	GCStats() { reset(); }
+
+	void reset();
+	void addPause(uint32 millis);
+};
+
+/**
+ * State of the garbage collector which is kept between runs: the work sets
+ * are only cleared, so that their storage doesn't have to be allocated and
+ * grown again for every collection.
+ */
+struct GCState {
+	WorklistManager _wm;
+	AddrSet _activeRefs;	///< Normalised addresses of the reachable objects
+	GCStats _stats;
+};
+
 
 } // End of namespace Sci
 
@@ -339,6 +339,7 @@ reg_t kMemory(EngineState *s, int argc, reg_t *argv) {
 				return s->r_acc;
 			}
 			WRITE_SCIENDIAN_UINT16(ref.raw, argv[2].offset);		// Amiga versions are BE
+			s->_segMan->notifyRawWrite(argv[1], 2);
 		} else {
 			if (ref.skipByte)
 				error("Attempt to poke memory at odd offset %04X:%04X", PRINT_REG(argv[1]));
@@ -49,6 +49,8 @@ Script::Script() : SegmentObj(SEG_TYPE_SCRIPT) {
 	_localsCount = 0;
 
 	_markedAsDeleted = false;
+
+	_instructionIndex = NULL;
 }
 
 Script::~Script() {
@@ -60,6 +62,10 @@ void Script::freeScript() {
 	_buf = NULL;
 	_bufSize = 0;
 
+	delete[] _instructionIndex;
+	_instructionIndex = NULL;
+	_instructions.clear();
+
 	_objects.clear();
 }
 
@@ -146,6 +152,11 @@ void Script::load(ResourceManager *resMan) {
 	// Check scripts for matching signatures and patch those, if found
 	matchSignatureAndPatch(_nr, _buf, script->size);
 
+	// Instructions are only decoded once the script has been patched
+	delete[] _instructionIndex;
+	_instructionIndex = NULL;
+	_instructions.clear();
+
 	if (getSciVersion() >= SCI_VERSION_1_1 && getSciVersion() <= SCI_VERSION_2_1) {
 		Resource *heap = resMan->findResource(ResourceId(kResourceTypeHeap, _nr), 0);
 		assert(heap != 0);
@@ -470,10 +481,47 @@ byte *Script::findBlockSCI0(int type, int startBlockIndex) {
 void Script::mcpyInOut(int dst, const void *src, size_t n) {
 	if (_buf) {
 		assert(dst + n <= _bufSize);
+		invalidateInstructions(dst, n);
 		memcpy(_buf + dst, src, n);
 	}
 }
 
+const PMachineInstruction &Script::decodeInstruction(uint16 offset) {
+	assert(offset < _bufSize);
+
+	if (!_instructionIndex)
+		_instructionIndex = new uint16[_bufSize]();
+
+	// An instruction which was invalidated keeps its slot
+	uint16 &index = _instructionIndex[offset];
+	if (!index) {
+		assert(_instructions.size() < 0xFFFF);
+		_instructions.push_back(PMachineInstruction());
+		index = _instructions.size();
+	}
+
+	PMachineInstruction &instruction = _instructions[index - 1];
+	instruction.size = readPMachineInstruction(_buf + offset, instruction.extOpcode, instruction.params);
+	return instruction;
+}
+
+void Script::invalidateInstructions(uint16 offset, uint size) {
+	if (!_instructionIndex)
+		return;
+
+	// Only op_file, a debug opcode followed by a file name, can be longer,
+	// and scripts never write to that name
+	const uint maxInstructionSize = 7;
+
+	uint start = offset >= maxInstructionSize ? offset - maxInstructionSize + 1 : 0;
+	uint end = MIN<uint>(offset + size, _bufSize);
+	for (uint i = start; i < end; i++) {
+		const uint16 index = _instructionIndex[i];
+		if (index && i + _instructions[index - 1].size > offset)
+			_instructions[index - 1].size = 0;
+	}
+}
+
 bool Script::isValidOffset(uint16 offset) const {
 	return offset < _bufSize;
 }
@@ -23,8 +23,10 @@
 #ifndef SCI_ENGINE_SCRIPT_H
 #define SCI_ENGINE_SCRIPT_H
 
+#include "common/array.h"
 #include "common/str.h"
 #include "sci/engine/segment.h"
+#include "sci/engine/vm.h"
 
 namespace Sci {
 
@@ -70,6 +72,19 @@ private:
 
 	bool _markedAsDeleted;
 
+	/**
+	 * The decoded instructions of the script, in the order in which they
+	 * were first executed.
+	 */
+	Common::Array<PMachineInstruction> _instructions;
+
+	/**
+	 * Maps each offset of the script to 1 + the index of the instruction
+	 * decoded there, or 0 if none was. Only allocated once the VM executes
+	 * code of the script.
+	 */
+	uint16 *_instructionIndex;
+
 public:
 	/**
 	 * Table for objects, contains property variables.
@@ -90,6 +105,23 @@ public:
 
 	int getScriptNumber() const { return _nr; }
 
+	/**
+	 * Returns the decoded instruction at the given offset, decoding it if it
+	 * is executed for the first time. The offset must be within the script.
+	 */
+	const PMachineInstruction &getInstruction(uint16 offset) {
+		const uint16 index = _instructionIndex ? _instructionIndex[offset] : 0;
+		if (index && _instructions[index - 1].size)
+			return _instructions[index - 1];
+		return decodeInstruction(offset);
+	}
+
+	/**
+	 * Drops the decoded instructions overlapping the given range of the
+	 * script, as it is being modified.
+	 */
+	void invalidateInstructions(uint16 offset, uint size);
+
 public:
 	Script();
 	~Script();
@@ -252,6 +284,8 @@ public:
 	int getCodeBlockOffset() { return READ_SCI11ENDIAN_UINT32(_buf); }
 
 private:
+	const PMachineInstruction &decodeInstruction(uint16 offset);
+
 	/**
 	 * Processes a relocation block within a SCI0-SCI2.1 script
 	 *  This function is idempotent, but it must only be called after all
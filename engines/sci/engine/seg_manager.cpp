@@ -75,6 +75,8 @@ void SegManager::resetSegMan() {
 	// Reinitialize class table
 	_classTable.clear();
 	createClassTable();
+
+	_selectorLookupCache.clear();
 }
 
 void SegManager::initSysStrings() {
@@ -153,6 +155,7 @@ void SegManager::deallocate(SegmentId seg) {
 		_scriptSegMap.erase(scr->getScriptNumber());
 		if (scr->_localsSegment)
 			deallocate(scr->_localsSegment);
+		_selectorLookupCache.clear();
 	}
 
 	delete mobj;
@@ -565,6 +568,12 @@ static void *derefPtr(SegManager *segMan, reg_t pointer, int entries, bool wantR
 		return ret.reg;
 }
 
+void SegManager::notifyRawWrite(reg_t dest, size_t n) {
+	Script *scr = getScriptIfLoaded(dest.segment);
+	if (scr)
+		scr->invalidateInstructions(dest.offset, n);
+}
+
 byte *SegManager::derefBulkPtr(reg_t pointer, int entries) {
 	return (byte *)derefPtr(this, pointer, entries, true);
 }
@@ -627,10 +636,13 @@ void SegManager::strncpy(reg_t dest, const char* src, size_t n) {
 
 	if (dest_r.isRaw) {
 		// raw -> raw
-		if (n == 0xFFFFFFFFU)
+		if (n == 0xFFFFFFFFU) {
 			::strcpy((char *)dest_r.raw, src);
-		else
+			notifyRawWrite(dest, ::strlen(src) + 1);
+		} else {
 			::strncpy((char *)dest_r.raw, src, n);
+			notifyRawWrite(dest, n);
+		}
 	} else {
 		// raw -> non-raw
 		for (uint i = 0; i < n; i++) {
@@ -675,12 +687,14 @@ void SegManager::strncpy(reg_t dest, reg_t src, size_t n) {
 		strncpy(dest, (const char*)src_r.raw, n);
 	} else if (dest_r.isRaw && !src_r.isRaw) {
 		// non-raw -> raw
-		for (uint i = 0; i < n; i++) {
+		uint i;
+		for (i = 0; i < n; i++) {
 			char c = getChar(src_r, i);
 			dest_r.raw[i] = c;
 			if (!c)
 				break;
 		}
+		notifyRawWrite(dest, i + 1);
 	} else {
 		// non-raw -> non-raw
 		for (uint i = 0; i < n; i++) {
@@ -714,6 +728,7 @@ void SegManager::memcpy(reg_t dest, const byte* src, size_t n) {
 	if (dest_r.isRaw) {
 		// raw -> raw
 		::memcpy((char*)dest_r.raw, src, n);
+		notifyRawWrite(dest, n);
 	} else {
 		// raw -> non-raw
 		for (uint i = 0; i < n; i++)
@@ -747,6 +762,7 @@ void SegManager::memcpy(reg_t dest, reg_t src, size_t n) {
 	} else if (dest_r.isRaw) {
 		// * -> raw
 		memcpy(dest_r.raw, src, n);
+		notifyRawWrite(dest, n);
 	} else {
 		// non-raw -> non-raw
 		for (uint i = 0; i < n; i++) {
@@ -1004,6 +1020,7 @@ int SegManager::instantiateScript(int scriptNum) {
 	scr->initializeLocals(this);
 	scr->initializeClasses(this);
 	scr->initializeObjects(this, segmentId);
+	_selectorLookupCache.clear();
 
 	return segmentId;
 }
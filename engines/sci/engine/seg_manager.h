@@ -269,6 +269,15 @@ public:
 	 */
 	SegmentRef dereference(reg_t pointer);
 
+	/**
+	 * Must be called after writing to raw memory through a dereferenced
+	 * pointer, so that a script drops the pre-decoded instructions which
+	 * cover the written bytes.
+	 * @param dest	The address written to
+	 * @param n		The number of bytes written
+	 */
+	void notifyRawWrite(reg_t dest, size_t n);
+
 	/**
 	 * Dereferences a heap pointer pointing to raw memory.
 	 * @param pointer The pointer to dereference
@@ -441,6 +450,12 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	/**
+	 * The inline cache of the send instructions. It is cleared whenever a
+	 * script is instantiated or freed.
+	 */
+	SelectorLookupCache &getSelectorLookupCache() { return _selectorLookupCache; }
+
 private:
 	Common::Array<SegmentObj *> _heap;
 	Common::Array<Class> _classTable; /**< Table of all classes */
@@ -449,6 +464,8 @@ private:
 
 	ResourceManager *_resMan;
 
+	SelectorLookupCache _selectorLookupCache;
+
 	SegmentId _clonesSegId; ///< ID of the (a) clones segment
 	SegmentId _listsSegId; ///< ID of the (a) list segment
 	SegmentId _nodesSegId; ///< ID of the (a) node segment
@@ -24,6 +24,7 @@
 #include "sci/engine/kernel.h"
 #include "sci/engine/state.h"
 #include "sci/engine/selector.h"
+#include "sci/engine/seg_manager.h"
 
 namespace Sci {
 
@@ -292,4 +293,87 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector sel
 //	return _lookupSelector_function(segMan, obj, selectorId, fptr);
 }
 
+SelectorLookupCache::SelectorLookupCache() : _hits(0), _misses(0), _clears(0) {
+}
+
+SelectorType SelectorLookupCache::lookup(SegManager *segMan, reg_t site, uint slot, reg_t obj_location, Selector selectorId,
+		ObjVarRef *varp, reg_t *fptr) {
+	// Clones share the position of the object they were cloned from
+	const Object *obj = segMan->getObject(obj_location);
+	if (!obj)
+		return lookupSelector(segMan, obj_location, selectorId, varp, fptr);
+	const reg_t definition = obj->getPos();
+
+	// Different sites may end up with the same key, the entries are
+	// checked against the receiver and selector anyway
+	Site &cacheSite = _sites[((uint32)site.segment << 16 | site.offset) ^ (slot << 24)];
+	for (uint i = 0; i < cacheSite.count; i++) {
+		const Entry &entry = cacheSite.entries[i];
+		if (entry.definition == definition && entry.selector == selectorId) {
+			_hits++;
+			if (entry.type == kSelectorVariable) {
+				if (varp) {
+					varp->obj = obj_location;
+					varp->varindex = entry.varIndex;
+				}
+			} else if (fptr) {
+				*fptr = entry.function;
+			}
+			return entry.type;
+		}
+	}
+
+	_misses++;
+
+	ObjVarRef var;
+	var.varindex = 0;
+	reg_t function = NULL_REG;
+	const SelectorType type = lookupSelector(segMan, obj_location, selectorId, &var, &function);
+	if (type == kSelectorNone)
+		return type;
+
+	Entry &entry = cacheSite.entries[cacheSite.next];
+	entry.definition = definition;
+	entry.selector = selectorId;
+	entry.type = type;
+	entry.varIndex = var.varindex;
+	entry.function = function;
+	cacheSite.next = (cacheSite.next + 1) % kEntriesPerSite;
+	cacheSite.count = MIN<uint>(cacheSite.count + 1, kEntriesPerSite);
+
+	if (type == kSelectorVariable) {
+		if (varp)
+			*varp = var;
+	} else if (fptr) {
+		*fptr = function;
+	}
+	return type;
+}
+
+void SelectorLookupCache::clear() {
+	if (_sites.empty())
+		return;
+
+	_sites.clear();
+	_clears++;
+}
+
+SelectorLookupCache::Stats SelectorLookupCache::getStats() const {
+	Stats stats;
+	stats.hits = _hits;
+	stats.misses = _misses;
+	stats.clears = _clears;
+	stats.sites = _sites.size();
+	stats.polymorphicSites = 0;
+	for (SiteMap::const_iterator it = _sites.begin(); it != _sites.end(); ++it) {
+		if (it->_value.count > 1)
+			stats.polymorphicSites++;
+	}
+	return stats;
+}
+
+void SelectorLookupCache::resetStats() {
+	_hits = _misses = _clears = 0;
+}
+
 } // End of namespace Sci
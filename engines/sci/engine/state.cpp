@@ -26,6 +26,7 @@
 #include "sci/debug.h"	// for g_debug_sleeptime_factor
 #include "sci/event.h"
 
+#include "sci/engine/gc.h"
 #include "sci/engine/kernel.h"
 #include "sci/engine/state.h"
 #include "sci/engine/selector.h"
@@ -68,13 +69,14 @@ static const uint16 s_halfWidthSJISMap[256] = {
 };
 
 EngineState::EngineState(SegManager *segMan)
-: _segMan(segMan), _dirseeker() {
+: _segMan(segMan), _dirseeker(), usePredecodedScripts(true), _gcState(new GCState()) {
 
 	reset(false);
 }
 
 EngineState::~EngineState() {
 	delete _msgState;
+	delete _gcState;
 }
 
 void EngineState::reset(bool isRestoring) {
@@ -112,6 +114,10 @@ void EngineState::reset(bool isRestoring) {
 	_cursorWorkaroundActive = false;
 
 	scriptStepCounter = 0;
+	scriptTiming = false;
+	scriptTimingStart = 0;
+	scriptTimingEnd = 0;
+	scriptMillis = 0;
 	scriptGCInterval = GC_INTERVAL;
 
 	_videoState.reset();
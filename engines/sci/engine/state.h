@@ -45,6 +45,7 @@ namespace Sci {
 class EventManager;
 class MessageState;
 class SoundCommandParser;
+struct GCState;
 
 enum AbortGameState {
 	kAbortNone = 0,
@@ -199,8 +200,24 @@ public:
 	int16 gameIsRestarting; // is set when restarting (=1) or restoring the game (=2)
 
 	int scriptStepCounter; // Counts the number of steps executed
+
+	/**
+	 * Whether the time spent executing steps is measured, which the
+	 * "script_steps start" console command turns on.
+	 */
+	bool scriptTiming;
+	int scriptTimingStart; ///< scriptStepCounter when the measurement was started
+	int scriptTimingEnd; ///< scriptStepCounter when the measurement was stopped
+	uint32 scriptMillis; // Time spent executing steps, not counting kernel calls
 	int scriptGCInterval; // Number of steps in between gcs
 
+	/**
+	 * Whether the VM executes the pre-decoded instructions of the scripts
+	 * (see Script::getInstruction()) or decodes every instruction again
+	 * from the script buffer.
+	 */
+	bool usePredecodedScripts;
+
 	uint16 currentRoomNumber() const;
 	void setRoomNumber(uint16 roomNumber);
 
@@ -216,6 +233,7 @@ public:
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	GCState *_gcState; /**< Work sets and statistics of the garbage collector */
 
 	MessageState *_msgState;
 
@@ -22,6 +22,7 @@
 
 #include "common/debug.h"
 #include "common/debug-channels.h"
+#include "common/system.h"
 
 #include "sci/sci.h"
 #include "sci/console.h"
@@ -286,6 +287,12 @@ ExecStack *send_selector(EngineState *s, reg_t send_obj, reg_t work_obj, StackPt
 	int activeBreakpointTypes = g_sci->_debugState._activeBreakpointTypes;
 	ObjVarRef varp;
 
+	// The call site for the inline cache: the send instruction which is
+	// being executed, or whatever called into the VM otherwise
+	SelectorLookupCache &lookupCache = s->_segMan->getSelectorLookupCache();
+	const reg_t site = s->xs ? s->xs->addr.pc : NULL_REG;
+	uint slot = 0;
+
 	Common::List<ExecStack>::iterator prevElementIterator = s->_executionStack.end();
 
 	while (framesize > 0) {
@@ -296,7 +303,7 @@ ExecStack *send_selector(EngineState *s, reg_t send_obj, reg_t work_obj, StackPt
 		if (argc > 0x800)	// More arguments than the stack could possibly accomodate for
 			error("send_selector(): More than 0x800 arguments to function call");
 
-		SelectorType selectorType = lookupSelector(s->_segMan, send_obj, selector, &varp, &funcp);
+		SelectorType selectorType = lookupCache.lookup(s->_segMan, site, slot++, send_obj, selector, &varp, &funcp);
 		if (selectorType == kSelectorNone)
 			error("Send to invalid selector 0x%x of object at %04x:%04x", 0xffff & selector, PRINT_REG(send_obj));
 
@@ -540,9 +547,44 @@ int readPMachineInstruction(const byte *src, byte &extOpcode, int16 opparams[4])
 	return offset;
 }
 
+/**
+ * Adds the time spent running a VM to EngineState::scriptMillis, while
+ * EngineState::scriptTiming is set. It is paused during kernel calls, VMs
+ * started by these count their own time.
+ */
+class ScriptTimer {
+public:
+	ScriptTimer(EngineState *s) : _s(s), _running(false) { resume(); }
+	~ScriptTimer() { pause(); }
+
+	void pause() {
+		if (_running) {
+			if (_s->scriptTiming)
+				_s->scriptMillis += g_system->getMillis() - _start;
+			_running = false;
+		}
+	}
+
+	void resume() {
+		// Kernel calls are frequent, so don't even read the clock unless
+		// somebody is interested
+		if (_s->scriptTiming) {
+			_start = g_system->getMillis();
+			_running = true;
+		}
+	}
+
+private:
+	EngineState *_s;
+	uint32 _start;
+	bool _running;
+};
+
 void run_vm(EngineState *s) {
 	assert(s);
 
+	ScriptTimer timer(s);
+
 	int temp;
 	reg_t r_temp; // Temporary register
 	StackPtr s_temp; // Temporary stack pointer
@@ -634,7 +676,14 @@ void run_vm(EngineState *s) {
 
 		// Get opcode
 		byte extOpcode;
-		s->xs->addr.pc.offset += readPMachineInstruction(scr->getBuf() + s->xs->addr.pc.offset, extOpcode, opparams);
+		if (s->usePredecodedScripts) {
+			const PMachineInstruction &instruction = scr->getInstruction(s->xs->addr.pc.offset);
+			extOpcode = instruction.extOpcode;
+			memcpy(opparams, instruction.params, sizeof(opparams));
+			s->xs->addr.pc.offset += instruction.size;
+		} else {
+			s->xs->addr.pc.offset += readPMachineInstruction(scr->getBuf() + s->xs->addr.pc.offset, extOpcode, opparams);
+		}
 		const byte opcode = extOpcode >> 1;
 		//debug("%s: %d, %d, %d, %d, acc = %04x:%04x, script %d, local script %d", opcodeNames[opcode], opparams[0], opparams[1], opparams[2], opparams[3], PRINT_REG(s->r_acc), scr->getScriptNumber(), local_script->getScriptNumber());
 
@@ -653,6 +702,10 @@ void run_vm(EngineState *s) {
 		prevOpcode = opcode;
 #endif
 
+		// Computed gotos wouldn't gain anything here: every operation has to
+		// return to the checks at the top of the loop (aborts, execution
+		// stack changes, the debugger), so there would still be a single
+		// indirect jump per operation, just like the jump table of the switch.
 		switch (opcode) {
 
 		case op_bnot: // 0x00 (00)
@@ -862,7 +915,9 @@ void run_vm(EngineState *s) {
 			if (!oldScriptHeader)
 				argc += s->r_rest;
 
+			timer.pause();
 			callKernelFunc(s, opparams[0], argc);
+			timer.resume();
 
 			if (!oldScriptHeader)
 				s->r_rest = 0;
@@ -28,6 +28,7 @@
 #include "sci/engine/vm_types.h"	// for reg_t
 #include "sci/resource.h"	// for SciVersion
 
+#include "common/hashmap.h"
 #include "common/util.h"
 
 namespace Sci {
@@ -368,6 +369,77 @@ void script_debug(EngineState *s);
 SelectorType lookupSelector(SegManager *segMan, reg_t obj, Selector selectorid,
 		ObjVarRef *varp, reg_t *fptr);
 
+/**
+ * Inline cache for the selector lookups of send instructions.
+ *
+ * Every call site, i.e. the address of a send instruction together with
+ * the position of the selector within the send, remembers the results of
+ * its last lookups. Most sites always send to the same kind of object
+ * (monomorphic) and hit on their first entry, the others keep up to
+ * kEntriesPerSite kinds (polymorphic).
+ *
+ * Entries are keyed by the position of the receiver's definition in its
+ * script rather than by its species, since instances may define methods of
+ * their own. Clones share the position of the object they were cloned from.
+ * The cached results are only valid while the scripts stay the same, so the
+ * segment manager clears the cache whenever a script is instantiated or
+ * freed.
+ */
+class SelectorLookupCache {
+public:
+	enum {
+		kEntriesPerSite = 4
+	};
+
+	struct Stats {
+		uint32 hits;		///< Lookups answered from the cache
+		uint32 misses;		///< Lookups which had to search the object
+		uint32 clears;		///< Number of times the cache was invalidated
+		uint sites;			///< Call sites currently cached
+		uint polymorphicSites;	///< Sites which saw more than one kind of object
+	};
+
+	SelectorLookupCache();
+
+	/**
+	 * Look up a selector like lookupSelector() does, going through the
+	 * cache of the given call site.
+	 *
+	 * @param[in] site		address of the send instruction
+	 * @param[in] slot		position of the selector within the send
+	 */
+	SelectorType lookup(SegManager *segMan, reg_t site, uint slot, reg_t obj, Selector selectorId,
+		ObjVarRef *varp, reg_t *fptr);
+
+	/** Drop all cached lookups. */
+	void clear();
+
+	Stats getStats() const;
+	void resetStats();
+
+private:
+	struct Entry {
+		reg_t definition;	///< Position of the receiver's definition
+		Selector selector;
+		SelectorType type;
+		int varIndex;
+		reg_t function;
+	};
+
+	struct Site {
+		Entry entries[kEntriesPerSite];
+		byte count;
+		byte next;	///< Entry to replace once the site is full
+
+		Site() : count(0), next(0) {}
+	};
+
+	typedef Common::HashMap<uint32, Site> SiteMap;
+	SiteMap _sites;
+
+	uint32 _hits, _misses, _clears;
+};
+
 /**
  * Read a PMachine instruction from a memory buffer and return its length.
  *
@@ -386,6 +458,17 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj, Selector selectorid,
  */
 int readPMachineInstruction(const byte *src, byte &extOpcode, int16 opparams[4]);
 
+/**
+ * A PMachine instruction as returned by readPMachineInstruction(), kept by
+ * the scripts so that the VM doesn't have to decode it every time it gets
+ * executed.
+ */
+struct PMachineInstruction {
+	byte extOpcode;		///< "extended" opcode of the instruction
+	uint16 size;		///< length in bytes of the instruction, 0 if not decoded yet
+	int16 params[4];	///< parameters of the instruction
+};
+
 } // End of namespace Sci
 
 #endif // SCI_ENGINE_VM_H
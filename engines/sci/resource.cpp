@@ -22,10 +22,14 @@
 
 // Resource library
 
+#include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
+#include "common/memstream.h"
+#include "common/system.h"
 #include "common/textconsole.h"
+#include "common/timer.h"
 
 #include "sci/resource.h"
 #include "sci/resource_intern.h"
@@ -187,6 +191,8 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : _resMan(resMan), _i
 	_fileOffset = 0;
 	_status = kResStatusNoMalloc;
 	_lockers = 0;
+	_hot = false;
+	_loadJob = NULL;
 	_source = NULL;
 	_header = NULL;
 	_headerSize = 0;
@@ -366,7 +372,25 @@ Common::SeekableReadStream *ResourceManager::getVolumeFile(ResourceSource *sourc
 }
 
 void ResourceManager::loadResource(Resource *res) {
+	const uint32 startTime = g_system->getMillis();
 	res->_source->loadResource(this, res);
+	_cacheStats.loadMillis += g_system->getMillis() - startTime;
+
+	if (res->data)
+		_cacheStats.loadedBytes += res->size;
+
+	checkRecentlyFreed(res);
+}
+
+void ResourceManager::checkRecentlyFreed(Resource *res) {
+	// Resources which are needed again soon after being freed are hot
+	for (Common::List<ResourceId>::iterator it = _freedLRU.begin(); it != _freedLRU.end(); ++it) {
+		if (*it == res->_id) {
+			res->_hot = true;
+			_freedLRU.erase(it);
+			break;
+		}
+	}
 }
 
 
@@ -884,13 +908,19 @@ void ResourceManager::freeResourceSources() {
 	_sources.clear();
 }
 
-ResourceManager::ResourceManager() {
+ResourceManager::ResourceManager() : _loadTimerInstalled(false) {
 }
 
 void ResourceManager::init(bool initFromFallbackDetector) {
 	_memoryLocked = 0;
 	_memoryLRU = 0;
+	_memoryHotLRU = 0;
+	_maxMemoryLRU = MAX_MEMORY;
+	_memoryLoadJobs = 0;
 	_LRU.clear();
+	_hotLRU.clear();
+	_freedLRU.clear();
+	resetCacheStats();
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
 
@@ -942,6 +972,13 @@ void ResourceManager::init(bool initFromFallbackDetector) {
 
 	debugC(1, kDebugLevelResMan, "resMan: Detected %s", getSciVersionDesc(getSciVersion()));
 
+	// SCI32 games have much larger resources, and are run on machines with
+	// much more memory
+	if (ConfMan.hasKey("sci_resource_cache_size"))
+		setMaxMemory(ConfMan.getInt("sci_resource_cache_size") * 1024);
+	else
+		setMaxMemory(getSciVersion() >= SCI_VERSION_2 ? MAX_MEMORY_SCI32 : MAX_MEMORY);
+
 	switch (_viewType) {
 	case kViewEga:
 		debugC(1, kDebugLevelResMan, "resMan: Detected EGA graphic resources");
@@ -973,6 +1010,13 @@ void ResourceManager::init(bool initFromFallbackDetector) {
 }
 
 ResourceManager::~ResourceManager() {
+	// This waits for the timer to return, so the jobs can't be in use anymore
+	if (_loadTimerInstalled)
+		g_system->getTimerManager()->removeTimerProc(&loadJobTimerProc);
+
+	for (Common::List<ResourceLoadJob *>::iterator it = _loadJobs.begin(); it != _loadJobs.end(); ++it)
+		delete *it;
+
 	// freeing resources
 	ResourceMap::iterator itr = _resMap.begin();
 	while (itr != _resMap.end()) {
@@ -993,7 +1037,12 @@ void ResourceManager::removeFromLRU(Resource *res) {
 		warning("resMan: trying to remove resource that isn't enqueued");
 		return;
 	}
-	_LRU.remove(res);
+	if (res->_hot) {
+		_hotLRU.remove(res);
+		_memoryHotLRU -= res->size;
+	} else {
+		_LRU.remove(res);
+	}
 	_memoryLRU -= res->size;
 	res->_status = kResStatusAllocated;
 }
@@ -1003,7 +1052,12 @@ void ResourceManager::addToLRU(Resource *res) {
 		warning("resMan: trying to enqueue resource with state %d", res->_status);
 		return;
 	}
-	_LRU.push_front(res);
+	if (res->_hot) {
+		_hotLRU.push_front(res);
+		_memoryHotLRU += res->size;
+	} else {
+		_LRU.push_front(res);
+	}
 	_memoryLRU += res->size;
 #if SCI_VERBOSE_RESMAN
 	debug("Adding %s.%03d (%d bytes) to lru control: %d bytes total",
@@ -1027,15 +1081,41 @@ void ResourceManager::printLRU() {
 		++it;
 	}
 
+	for (it = _hotLRU.begin(); it != _hotLRU.end(); ++it) {
+		res = *it;
+		debug("\t%s: %d bytes (hot)", res->_id.toString().c_str(), res->size);
+		mem += res->size;
+		++entries;
+	}
+
 	debug("Total: %d entries, %d bytes (mgr says %d)", entries, mem, _memoryLRU);
 }
 
 void ResourceManager::freeOldResources() {
-	while (MAX_MEMORY < _memoryLRU) {
-		assert(!_LRU.empty());
-		Resource *goner = *_LRU.reverse_begin();
+	while (_maxMemoryLRU < (uint32)_memoryLRU + _memoryLoadJobs) {
+		// The buffers of the load jobs can't be freed before they are done
+		if (_LRU.empty() && _hotLRU.empty()) {
+			assert(_memoryLoadJobs);
+			break;
+		}
+
+		// Free the resources which were used once first, unless they only
+		// take up a quarter of the budget anymore
+		Resource *goner;
+		if (_hotLRU.empty() || (!_LRU.empty() && (uint32)(_memoryLRU - _memoryHotLRU) > _maxMemoryLRU / 4))
+			goner = *_LRU.reverse_begin();
+		else
+			goner = *_hotLRU.reverse_begin();
+
 		removeFromLRU(goner);
+		if (!goner->_hot) {
+			_freedLRU.push_front(goner->_id);
+			if (_freedLRU.size() > MAX_FREED_LRU)
+				_freedLRU.pop_back();
+		}
+		goner->_hot = false;
 		goner->unalloc();
+		_cacheStats.evictions++;
 #ifdef SCI_VERBOSE_RESMAN
 		debug("resMan-debug: LRU: Freeing %s.%03d (%d bytes)", getResourceTypeName(goner->type), goner->number, goner->size);
 #endif
@@ -1061,10 +1141,24 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return NULL;
 
-	if (retval->_status == kResStatusNoMalloc)
+	collectLoadJobs();
+
+	if (retval->_status == kResStatusNoMalloc && retval->_loadJob) {
+		// Jobs which were done are collected above, so this one isn't
+		_cacheStats.misses++;
+		finishLoadJob(retval);
+		// If decompressing failed, the error is reported by loading the
+		// resource like any other
+		if (retval->_status == kResStatusNoMalloc)
+			loadResource(retval);
+	} else if (retval->_status == kResStatusNoMalloc) {
+		_cacheStats.misses++;
 		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
-		removeFromLRU(retval);
+	} else {
+		_cacheStats.hits++;
+		if (retval->_status == kResStatusEnqueued)
+			removeFromLRU(retval);
+	}
 	// Unless an error occurred, the resource is now either
 	// locked or allocated, but never queued or freed.
 
@@ -1090,6 +1184,277 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	}
 }
 
+void ResourceManager::preloadResource(ResourceId id) {
+	collectLoadJobs();
+
+	Resource *res = testResource(id);
+
+	if (!res || res->_status != kResStatusNoMalloc || res->_loadJob)
+		return;
+
+	if (queueLoadJob(res)) {
+		_cacheStats.preloads++;
+		return;
+	}
+
+	loadResource(res);
+	if (res->_status != kResStatusAllocated)
+		return;
+
+	_cacheStats.preloads++;
+	addToLRU(res);
+	freeOldResources();
+}
+
+bool ResourceManager::freeResource(ResourceId id) {
+	Resource *res = testResource(id);
+
+	if (!res)
+		return false;
+
+	if (res->_loadJob)
+		finishLoadJob(res);
+	else if (res->_status != kResStatusEnqueued)
+		return false;
+
+	if (res->_status == kResStatusEnqueued)
+		removeFromLRU(res);
+	res->_hot = false;
+	res->unalloc();
+	return true;
+}
+
+static Decompressor *createDecompressor(ResourceCompression compression) {
+	switch (compression) {
+	case kCompNone:
+		return new Decompressor;
+	case kCompHuffman:
+		return new DecompressorHuffman;
+	case kCompLZW:
+	case kCompLZW1:
+	case kCompLZW1View:
+	case kCompLZW1Pic:
+		return new DecompressorLZW(compression);
+	case kCompDCL:
+		return new DecompressorDCL;
+#ifdef ENABLE_SCI32
+	case kCompSTACpack:
+		return new DecompressorLZS;
+#endif
+	default:
+		return NULL;
+	}
+}
+
+ResourceLoadJob::ResourceLoadJob(Resource *res, ResourceCompression comp, uint32 szPacked)
+	: resource(res), state(kStateQueued), compression(comp), packedSize(szPacked),
+	  data(NULL), size(res->size), errorNum(0), millis(0) {
+	packed = new byte[packedSize];
+}
+
+ResourceLoadJob::~ResourceLoadJob() {
+	delete[] packed;
+	delete[] data;
+}
+
+void ResourceLoadJob::decompress() {
+	const uint32 startTime = g_system->getMillis();
+	Decompressor *dec = createDecompressor(compression);
+	Common::MemoryReadStream stream(packed, packedSize);
+
+	// This may run on the timer thread, so errors are only recorded here
+	// and reported by the engine when it loads the resource again
+	if (dec) {
+		data = new byte[size];
+		errorNum = dec->unpack(&stream, data, packedSize, size);
+		if (errorNum) {
+			delete[] data;
+			data = NULL;
+		}
+	} else {
+		errorNum = SCI_ERROR_UNKNOWN_COMPRESSION;
+	}
+
+	delete dec;
+	delete[] packed;
+	packed = NULL;
+	millis = g_system->getMillis() - startTime;
+}
+
+bool ResourceManager::queueLoadJob(Resource *res) {
+	// Only the game's own volumes are read by the common code. The data is
+	// read here, since the volume files are shared with the engine.
+	if (res->_source->getSourceType() != kSourceVolume)
+		return false;
+
+	Common::SeekableReadStream *fileStream = res->_source->getVolumeFile(this, res);
+	if (!fileStream)
+		return false;
+
+	fileStream->seek(res->_fileOffset, SEEK_SET);
+
+	uint32 szPacked = 0;
+	ResourceCompression compression = kCompUnknown;
+	ResourceLoadJob *job = NULL;
+	if (!res->readResourceInfo(_volVersion, fileStream, szPacked, compression) && compression != kCompNone
+			&& res->size <= ResourceLoadJob::kMaxSize
+			&& _memoryLoadJobs + szPacked + res->size <= _maxMemoryLRU) {
+		job = new ResourceLoadJob(res, compression, szPacked);
+		if (fileStream->read(job->packed, szPacked) != szPacked) {
+			delete job;
+			job = NULL;
+		}
+	}
+
+	if (res->_source->_resourceFile)
+		delete fileStream;
+
+	// Errors are reported when the resource is loaded normally
+	if (!job)
+		return false;
+
+	res->_loadJob = job;
+	{
+		Common::StackLock lock(_loadJobsMutex);
+		_loadJobs.push_back(job);
+	}
+
+	// Make room for both buffers, which exist at the same time while the
+	// resource is decompressed
+	_memoryLoadJobs += job->packedSize + job->size;
+	freeOldResources();
+
+	if (!_loadTimerInstalled && g_system->getTimerManager()) {
+		_loadTimerInstalled = g_system->getTimerManager()->installTimerProc(&loadJobTimerProc,
+				10 * 1000, this, "sciResourceLoader");
+	}
+	return true;
+}
+
+void ResourceManager::finishLoadJob(Resource *res) {
+	ResourceLoadJob *job = res->_loadJob;
+	assert(job);
+
+	ResourceLoadJob::State state;
+	{
+		Common::StackLock lock(_loadJobsMutex);
+		state = job->state;
+		if (state == ResourceLoadJob::kStateQueued)
+			job->state = ResourceLoadJob::kStateDecompressing;
+	}
+
+	if (state == ResourceLoadJob::kStateDone) {
+		_cacheStats.backgroundLoads++;
+		_cacheStats.backgroundMillis += job->millis;
+	} else {
+		// Either the timer is decompressing the resource right now, and
+		// holds the mutex until it is done, or nobody has started yet
+		const uint32 startTime = g_system->getMillis();
+		if (state == ResourceLoadJob::kStateQueued) {
+			job->decompress();
+		} else {
+			Common::StackLock decompressLock(_decompressMutex);
+		}
+		_cacheStats.waits++;
+		_cacheStats.waitMillis += g_system->getMillis() - startTime;
+	}
+
+	{
+		Common::StackLock lock(_loadJobsMutex);
+		_loadJobs.remove(job);
+	}
+	res->_loadJob = NULL;
+	_memoryLoadJobs -= job->packedSize + job->size;
+
+	if (job->data) {
+		res->data = job->data;
+		res->size = job->size;
+		res->_status = kResStatusAllocated;
+		job->data = NULL;
+		_cacheStats.loadedBytes += res->size;
+		checkRecentlyFreed(res);
+	} else {
+		debugC(kDebugLevelResMan, "Background decompression of %s failed with error %d, loading it again",
+				res->_id.toString().c_str(), job->errorNum);
+	}
+
+	delete job;
+}
+
+void ResourceManager::collectLoadJobs() {
+	// Only the engine adds and removes jobs, so checking this without
+	// locking is fine
+	if (_loadJobs.empty())
+		return;
+
+	Common::Array<Resource *> done;
+	{
+		Common::StackLock lock(_loadJobsMutex);
+		for (Common::List<ResourceLoadJob *>::iterator it = _loadJobs.begin(); it != _loadJobs.end(); ++it) {
+			if ((*it)->state == ResourceLoadJob::kStateDone)
+				done.push_back((*it)->resource);
+		}
+	}
+
+	for (uint i = 0; i < done.size(); i++) {
+		finishLoadJob(done[i]);
+		if (done[i]->_status == kResStatusAllocated)
+			addToLRU(done[i]);
+	}
+
+	if (!done.empty())
+		freeOldResources();
+}
+
+bool ResourceManager::decompressNextLoadJob() {
+	Common::StackLock decompressLock(_decompressMutex);
+
+	ResourceLoadJob *job = NULL;
+	{
+		Common::StackLock lock(_loadJobsMutex);
+		for (Common::List<ResourceLoadJob *>::iterator it = _loadJobs.begin(); it != _loadJobs.end(); ++it) {
+			if ((*it)->state == ResourceLoadJob::kStateQueued) {
+				job = *it;
+				job->state = ResourceLoadJob::kStateDecompressing;
+				break;
+			}
+		}
+	}
+
+	if (!job)
+		return false;
+
+	job->decompress();
+
+	Common::StackLock lock(_loadJobsMutex);
+	job->state = ResourceLoadJob::kStateDone;
+	return true;
+}
+
+void ResourceManager::loadJobTimerProc(void *refCon) {
+	ResourceManager *resMan = (ResourceManager *)refCon;
+
+	// Don't hold up the other timers, like the music, for too long
+	const uint32 startTime = g_system->getMillis();
+	while (g_system->getMillis() - startTime < ResourceLoadJob::kTimerBudget && resMan->decompressNextLoadJob())
+		;
+}
+
+void ResourceManager::setMaxMemory(uint32 maxMemory) {
+	_maxMemoryLRU = maxMemory;
+	freeOldResources();
+}
+
+void ResourceManager::getMemoryUsage(uint32 &locked, uint32 &lru, uint32 &hotLRU) const {
+	locked = _memoryLocked;
+	lru = _memoryLRU - _memoryHotLRU;
+	hotLRU = _memoryHotLRU;
+}
+
+void ResourceManager::resetCacheStats() {
+	memset(&_cacheStats, 0, sizeof(_cacheStats));
+}
+
 void ResourceManager::unlockResource(Resource *res) {
 	assert(res);
 
@@ -1974,29 +2339,8 @@ int Resource::decompress(ResVersion volVersion, Common::SeekableReadStream *file
 		return errorNum;
 
 	// getting a decompressor
-	Decompressor *dec = NULL;
-	switch (compression) {
-	case kCompNone:
-		dec = new Decompressor;
-		break;
-	case kCompHuffman:
-		dec = new DecompressorHuffman;
-		break;
-	case kCompLZW:
-	case kCompLZW1:
-	case kCompLZW1View:
-	case kCompLZW1Pic:
-		dec = new DecompressorLZW(compression);
-		break;
-	case kCompDCL:
-		dec = new DecompressorDCL;
-		break;
-#ifdef ENABLE_SCI32
-	case kCompSTACpack:
-		dec = new DecompressorLZS;
-		break;
-#endif
-	default:
+	Decompressor *dec = createDecompressor(compression);
+	if (!dec) {
 		error("Resource %s: Compression method %d not supported", _id.toString().c_str(), compression);
 		return SCI_ERROR_UNKNOWN_COMPRESSION;
 	}
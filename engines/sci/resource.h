@@ -26,6 +26,7 @@
 #include "common/str.h"
 #include "common/list.h"
 #include "common/hashmap.h"
+#include "common/mutex.h"
 
 #include "sci/graphics/helpers.h"		// for ViewType
 #include "sci/decompressor.h"
@@ -131,6 +132,7 @@ enum ResVersion {
 
 class ResourceManager;
 class ResourceSource;
+struct ResourceLoadJob;
 
 class ResourceId {
 	static inline ResourceType fixupType(ResourceType type) {
@@ -240,6 +242,8 @@ protected:
 	int32 _fileOffset; /**< Offset in file */
 	ResourceStatus _status;
 	uint16 _lockers; /**< Number of places where this resource was locked */
+	bool _hot; /**< Reloaded shortly after being freed, kept in the hot LRU */
+	ResourceLoadJob *_loadJob; /**< Background decompression of the resource, if any */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
@@ -254,6 +258,20 @@ protected:
 
 typedef Common::HashMap<ResourceId, Resource *, ResourceIdHash> ResourceMap;
 
+/** Statistics of the resource cache, shown by the resource_cache console command */
+struct ResourceCacheStats {
+	uint32 hits;		///< Lookups of resources which were in memory
+	uint32 misses;		///< Lookups which had to load the resource
+	uint32 preloads;	///< Resources loaded ahead of their use
+	uint32 evictions;	///< Resources freed to stay within the budget
+	uint32 loadedBytes;	///< Bytes read and decompressed
+	uint32 loadMillis;	///< Time the engine spent reading and decompressing
+	uint32 backgroundLoads;	///< Preloaded resources decompressed in the background
+	uint32 backgroundMillis;	///< Time spent decompressing them
+	uint32 waits;		///< Lookups which had to wait for a preloaded resource
+	uint32 waitMillis;	///< Time spent waiting
+};
+
 class ResourceManager {
 	// FIXME: These 'friend' declarations are meant to be a temporary hack to
 	// ease transition to the ResourceSource class system.
@@ -296,6 +314,29 @@ public:
 	 */
 	Resource *findResource(ResourceId id, bool lock);
 
+	/**
+	 * Loads a resource ahead of its use, e.g. when a script announces it with
+	 * kLoad. The resource is not locked and may get freed again before it is
+	 * used, if the cache runs out of memory.
+	 *
+	 * Compressed resources of the game's volumes are only read here, and get
+	 * decompressed in the background. Looking the resource up before that
+	 * is done waits for it, or decompresses it right away if that hasn't
+	 * even started yet, so it is never decompressed twice. The buffers of
+	 * these resources count against the memory budget of the cache; once
+	 * they take up all of it, further resources are loaded right away.
+	 * @param id	The resource to load
+	 */
+	void preloadResource(ResourceId id);
+
+	/**
+	 * Frees a resource which is loaded but not locked, e.g. to measure how
+	 * long loading it takes.
+	 * @param id	The resource to free
+	 * @return true if the resource was freed
+	 */
+	bool freeResource(ResourceId id);
+
 	/**
 	 * Unlocks a previously locked resource.
 	 * @param res	The resource to free
@@ -378,20 +419,63 @@ public:
 	 */
 	ResourceType convertResType(byte type);
 
+	/**
+	 * Sets the maximum number of bytes of unlocked resources to keep in memory.
+	 * Defaults to MAX_MEMORY (MAX_MEMORY_SCI32 for SCI32 games), unless the
+	 * "sci_resource_cache_size" setting gives a size in KB.
+	 */
+	void setMaxMemory(uint32 maxMemory);
+	uint32 getMaxMemory() const { return _maxMemoryLRU; }
+
+	/** Returns the number of bytes of locked, recently used and hot resources */
+	void getMemoryUsage(uint32 &locked, uint32 &lru, uint32 &hotLRU) const;
+
+	const ResourceCacheStats &getCacheStats() const { return _cacheStats; }
+	void resetCacheStats();
+
 protected:
-	// Maximum number of bytes to allow being allocated for resources
+	// Default number of bytes to allow being allocated for resources
 	// Note: maxMemory will not be interpreted as a hard limit, only as a restriction
 	// for resources which are not explicitly locked. However, a warning will be
 	// issued whenever this limit is exceeded.
 	enum {
-		MAX_MEMORY = 256 * 1024	// 256KB
+		MAX_MEMORY = 256 * 1024,		// 256KB
+		MAX_MEMORY_SCI32 = 8 * 1024 * 1024	// 8MB
+	};
+
+	/**
+	 * Number of recently freed resources to remember, see _freedLRU. Resources
+	 * which are loaded again while they're still listed there are hot.
+	 */
+	enum {
+		MAX_FREED_LRU = 128
 	};
 
 	ViewType _viewType; // Used to determine if the game has EGA or VGA graphics
 	Common::List<ResourceSource *> _sources;
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
-	int _memoryLRU;		///< Amount of resource bytes under LRU control
+	int _memoryLRU;		///< Amount of resource bytes under LRU control, in both lists
+	int _memoryHotLRU;	///< Amount of resource bytes in the hot LRU
+	uint32 _maxMemoryLRU;	///< Budget for the resources under LRU control
+	uint32 _memoryLoadJobs;	///< Amount of bytes of the buffers of the load jobs, which count against the budget
+
+	// The LRU works like a 2Q cache: resources start out in _LRU, and only
+	// move to _hotLRU if they are needed again soon after being freed. A
+	// room's worth of resources which are used once doesn't push out the
+	// resources which are used all the time, like the views of the ego.
 	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	Common::List<Resource *> _hotLRU; ///< Last Resource Used list of hot resources
+	Common::List<ResourceId> _freedLRU; ///< Resources recently freed from _LRU
+	ResourceCacheStats _cacheStats;
+
+	// Preloaded resources are decompressed by a timer callback, which may
+	// run on another thread. It only touches the jobs and their buffers,
+	// everything else, including the list of jobs, is only changed by the
+	// engine thread.
+	Common::List<ResourceLoadJob *> _loadJobs; ///< Resources being preloaded
+	Common::Mutex _loadJobsMutex; ///< Protects the state of the jobs
+	Common::Mutex _decompressMutex; ///< Held by the timer while decompressing a job
+	bool _loadTimerInstalled;
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
@@ -445,7 +529,14 @@ protected:
 
 	Common::SeekableReadStream *getVolumeFile(ResourceSource *source);
 	void loadResource(Resource *res);
+	void checkRecentlyFreed(Resource *res);
 	void freeOldResources();
+
+	bool queueLoadJob(Resource *res);
+	void finishLoadJob(Resource *res);
+	void collectLoadJobs();
+	bool decompressNextLoadJob();
+	static void loadJobTimerProc(void *refCon);
 	void addResource(ResourceId resId, ResourceSource *src, uint32 offset, uint32 size = 0);
 	Resource *updateResource(ResourceId resId, ResourceSource *src, uint32 size);
 	void removeAudioResource(ResourceId resId);
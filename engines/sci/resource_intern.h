@@ -214,6 +214,44 @@ protected:
 
 #endif
 
+/**
+ * A preloaded resource, read from its volume by the engine and decompressed
+ * in the background. See ResourceManager::preloadResource().
+ */
+struct ResourceLoadJob {
+	enum {
+		/** Time the timer may spend decompressing jobs per call, in ms */
+		kTimerBudget = 5,
+		/**
+		 * Largest decompressed size queued as a job. The timer only checks
+		 * its budget between jobs, so bigger resources are loaded by the
+		 * engine instead of blocking the music for too long.
+		 */
+		kMaxSize = 32 * 1024
+	};
+
+	enum State {
+		kStateQueued,			///< Waiting to be decompressed
+		kStateDecompressing,	///< Being decompressed, by the timer or the engine
+		kStateDone				///< Decompressed by the timer
+	};
+
+	Resource *resource;
+	State state;
+	ResourceCompression compression;
+	byte *packed;		///< Compressed data, freed once decompressed
+	uint32 packedSize;
+	byte *data;			///< Decompressed data, NULL if that failed
+	uint32 size;
+	int errorNum;		///< SCI_ERROR_* code if decompressing failed
+	uint32 millis;		///< Time taken to decompress the data
+
+	ResourceLoadJob(Resource *res, ResourceCompression comp, uint32 szPacked);
+	~ResourceLoadJob();
+
+	void decompress();
+};
+
 } // End of namespace Sci
 
 #endif // SCI_RESOURCE_INTERN_H
@@ -254,6 +254,13 @@ public:
 	 */
 	virtual void setGradientColors(uint8 r1, uint8 g1, uint8 b1, uint8 r2, uint8 g2, uint8 b2) = 0;
 
+	/**
+	 * Gets the colors draw steps use unless they set their own: the
+	 * foreground, background and bevel colors, and the two gradient colors,
+	 * in that order and in the format of the surface.
+	 */
+	virtual void getColors(uint32 colors[5]) const = 0;
+
 	/**
 	 * Sets the active drawing surface. All drawing from this
 	 * point on will be done on that surface.
@@ -264,6 +271,13 @@ public:
 		_activeSurface = surface;
 	}
 
+	/**
+	 * Returns the active drawing surface.
+	 */
+	Surface *getSurface() {
+		return _activeSurface;
+	}
+
 	/**
 	 * Fills the active surface with the specified fg/bg color or the active gradient.
 	 * Defaults to using the active Foreground color for filling.
@@ -416,6 +430,15 @@ public:
 	 */
 	virtual void drawStep(const Common::Rect &area, const DrawStep &step, uint32 extra = 0);
 
+	/**
+	 * Sets the colors and drawing options of a draw step without drawing it,
+	 * leaving the renderer in the same state drawStep() would.
+	 *
+	 * @param step Pointer to a DrawStep struct.
+	 * @param extra Dynamic data of the step.
+	 */
+	void setDrawStepState(const DrawStep &step, uint32 extra = 0);
+
 	/**
 	 * Copies the part of the current frame to the system overlay.
 	 *
@@ -472,6 +495,7 @@ public:
 	 */
 	virtual void disableShadows() { _disableShadows = true; }
 	virtual void enableShadows() { _disableShadows = false; }
+	bool shadowsDisabled() const { return _disableShadows; }
 
 	/**
 	 * Applies a whole-screen shading effect, used before opening a new dialog.
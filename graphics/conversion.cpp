@@ -20,10 +20,136 @@
  */
 
 #include "graphics/conversion.h"
+#include "graphics/conversion_kernels.h"
 #include "graphics/pixelformat.h"
 
+#include "common/cpudetect.h"
+
 namespace Graphics {
 
+static void clut8To16(uint16 *dst, const byte *src, const uint16 *map, uint count) {
+	lookupPalette(dst, src, map, count);
+}
+
+static void clut8To32(uint32 *dst, const byte *src, const uint32 *map, uint count) {
+	lookupPalette(dst, src, map, count);
+}
+
+static void rgb555To565(uint16 *dst, const uint16 *src, uint count) {
+	while (count--)
+		*dst++ = convert555To565(*src++);
+}
+
+static void rgb565To555(uint16 *dst, const uint16 *src, uint count) {
+	while (count--)
+		*dst++ = convert565To555(*src++);
+}
+
+static void rgb16To32(uint32 *dst, const uint16 *src, uint count, const ConversionChannels &channels) {
+	while (count--)
+		*dst++ = convertChannels(*src++, channels);
+}
+
+static void swizzle32(uint32 *dst, const uint32 *src, uint count, const ConversionChannels &channels) {
+	while (count--)
+		*dst++ = convertChannels(*src++, channels);
+}
+
+static const ConversionKernels s_conversionKernelsScalar = {
+	clut8To16,
+	clut8To32,
+	rgb555To565,
+	rgb565To555,
+	rgb16To32,
+	swizzle32
+};
+
+const ConversionKernels &getScalarConversionKernels() {
+	return s_conversionKernelsScalar;
+}
+
+const ConversionKernels &getConversionKernels() {
+#ifdef USE_X86_SIMD
+	if (Common::hasCPUFeature(Common::kCPUFeatureAVX2))
+		return g_conversionKernelsAVX2;
+	if (Common::hasCPUFeature(Common::kCPUFeatureSSSE3))
+		return g_conversionKernelsSSSE3;
+	if (Common::hasCPUFeature(Common::kCPUFeatureSSE2))
+		return g_conversionKernelsSSE2;
+#endif
+	return s_conversionKernelsScalar;
+}
+
+/**
+ * Describe a conversion to a 32 bit format with byte aligned 8 bit channels
+ * for the rgb16To32 and swizzle32 kernels. Returns false if the destination
+ * format does not qualify, or if byteMoves is set and the channels of the
+ * source are not byte aligned 8 bit ones either.
+ */
+static bool getConversionChannels(const PixelFormat &dstFmt, const PixelFormat &srcFmt, bool byteMoves, ConversionChannels &channels) {
+	const uint8 dstLoss[4] = { dstFmt.rLoss, dstFmt.gLoss, dstFmt.bLoss, dstFmt.aLoss };
+	const uint8 dstShift[4] = { dstFmt.rShift, dstFmt.gShift, dstFmt.bShift, dstFmt.aShift };
+	const uint8 srcLoss[4] = { srcFmt.rLoss, srcFmt.gLoss, srcFmt.bLoss, srcFmt.aLoss };
+	const uint8 srcShift[4] = { srcFmt.rShift, srcFmt.gShift, srcFmt.bShift, srcFmt.aShift };
+
+	channels.count = 0;
+	for (int i = 0; i < 4; ++i) {
+		if ((dstLoss[i] != 0 && dstLoss[i] != 8) || (dstShift[i] & 7))
+			return false;
+		if (byteMoves && ((srcLoss[i] != 0 && srcLoss[i] != 8) || (srcShift[i] & 7)))
+			return false;
+
+		// colorToARGB() yields 0 for channels the source lacks, and
+		// ARGBToColor() drops the ones the destination lacks.
+		if (dstLoss[i] == 8 || srcLoss[i] >= 8)
+			continue;
+
+		ConversionChannel &channel = channels.channel[channels.count++];
+		channel.srcShift = srcShift[i];
+		channel.dstShift = srcLoss[i] + dstShift[i];
+		channel.mask = 0xFF << dstShift[i];
+	}
+	return true;
+}
+
+/**
+ * Try to do the conversion of crossBlit() with one of the kernels. Returns
+ * false if there is no kernel for the pair of formats.
+ */
+static bool crossBlitKernel(byte *dst, const byte *src, int dstpitch, int srcpitch,
+						int w, int h, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	const ConversionKernels &kernels = getConversionKernels();
+	ConversionChannels channels;
+
+	if (srcFmt.bytesPerPixel == 2 && dstFmt.bytesPerPixel == 2) {
+		void (*kernel)(uint16 *, const uint16 *, uint);
+		if (srcFmt == PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0) && dstFmt == PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0))
+			kernel = kernels.rgb555To565;
+		else if (srcFmt == PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0) && dstFmt == PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0))
+			kernel = kernels.rgb565To555;
+		else
+			return false;
+
+		for (int y = 0; y < h; y++, dst += dstpitch, src += srcpitch)
+			kernel((uint16 *)dst, (const uint16 *)src, w);
+	} else if (srcFmt.bytesPerPixel == 2 && dstFmt.bytesPerPixel == 4) {
+		if (!getConversionChannels(dstFmt, srcFmt, false, channels))
+			return false;
+
+		for (int y = 0; y < h; y++, dst += dstpitch, src += srcpitch)
+			kernels.rgb16To32((uint32 *)dst, (const uint16 *)src, w, channels);
+	} else if (srcFmt.bytesPerPixel == 4 && dstFmt.bytesPerPixel == 4) {
+		if (!getConversionChannels(dstFmt, srcFmt, true, channels))
+			return false;
+
+		for (int y = 0; y < h; y++, dst += dstpitch, src += srcpitch)
+			kernels.swizzle32((uint32 *)dst, (const uint32 *)src, w, channels);
+	} else {
+		return false;
+	}
+	return true;
+}
+
 // TODO: YUV to RGB conversion function
 
 // Function to blit a rect from one color format to another
@@ -52,6 +178,10 @@ bool crossBlit(byte *dst, const byte *src, int dstpitch, int srcpitch,
 		}
 	}
 
+	// Use the kernels for the common pairs of formats
+	if (crossBlitKernel(dst, src, dstpitch, srcpitch, w, h, dstFmt, srcFmt))
+		return true;
+
 	// Faster, but larger, to provide optimized handling for each case.
 	int srcDelta, dstDelta;
 	srcDelta = (srcpitch - w * srcFmt.bytesPerPixel);
@@ -119,7 +249,7 @@ bool crossBlit(byte *dst, const byte *src, int dstpitch, int srcpitch,
 			col++;
 #endif
 			for (int y = 0; y < h; y++) {
-				for (int x = 0; x < w; x++, src += 2, dst += 4) {
+				for (int x = 0; x < w; x++, src += 3, dst += 4) {
 					memcpy(col, src, 3);
 					srcFmt.colorToARGB(color, a, r, g, b);
 					color = dstFmt.ARGBToColor(a, r, g, b);
@@ -146,4 +276,40 @@ bool crossBlit(byte *dst, const byte *src, int dstpitch, int srcpitch,
 	return true;
 }
 
+bool crossBlitMap(byte *dst, const byte *src, int dstpitch, int srcpitch,
+						int w, int h, uint dstBpp, const uint32 *map) {
+	const ConversionKernels &kernels = getConversionKernels();
+
+	if (dstBpp == 2) {
+		uint16 map16[256];
+		for (int i = 0; i < 256; i++)
+			map16[i] = map[i];
+
+		for (int y = 0; y < h; y++, dst += dstpitch, src += srcpitch)
+			kernels.clut8To16((uint16 *)dst, src, map16, w);
+	} else if (dstBpp == 3) {
+		for (int y = 0; y < h; y++, dst += dstpitch, src += srcpitch) {
+			byte *d = dst;
+			for (int x = 0; x < w; x++, d += 3) {
+				const uint32 color = map[src[x]];
+#ifdef SCUMM_BIG_ENDIAN
+				d[0] = color >> 16;
+				d[1] = color >> 8;
+				d[2] = color;
+#else
+				d[0] = color;
+				d[1] = color >> 8;
+				d[2] = color >> 16;
+#endif
+			}
+		}
+	} else if (dstBpp == 4) {
+		for (int y = 0; y < h; y++, dst += dstpitch, src += srcpitch)
+			kernels.clut8To32((uint32 *)dst, src, map, w);
+	} else {
+		return false;
+	}
+	return true;
+}
+
 } // End of namespace Graphics
@@ -64,11 +64,33 @@ inline static void RGB2YUV(byte r, byte g, byte b, byte &y, byte &u, byte &v) {
  *		 the source's.
  * @note This can convert a rectangle in place, if the source and
  *		 destination format have the same bytedepth.
+ * @note Conversions from RGB555 to RGB565 and back, from 16 bit formats
+ *		 to 32 bit ones and between 32 bit formats use SIMD code where
+ *		 available, as long as the 32 bit formats have byte aligned 8 bit
+ *		 channels.
  *
  */
 bool crossBlit(byte *dst, const byte *src, int dstpitch, int srcpitch,
 						int w, int h, const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt);
 
+/**
+ * Blits a rectangle of 8 bit palette indices to a true color format.
+ *
+ * @param dstbuf	the buffer which will recieve the converted graphics data
+ * @param srcbuf	the buffer containing the palette indices
+ * @param dstpitch	width in bytes of one full line of the dest buffer
+ * @param srcpitch	width in bytes of one full line of the source buffer
+ * @param w			the width of the graphics data
+ * @param h			the height of the graphics data
+ * @param dstBpp	the bytes per pixel of the destination, 2, 3 or 4
+ * @param map		the 256 palette entries, already in the destination
+ *					format (e.g. from PixelFormat::RGBToColor())
+ * @return			true if conversion completes successfully,
+ *					false if dstBpp is not supported.
+ */
+bool crossBlitMap(byte *dst, const byte *src, int dstpitch, int srcpitch,
+						int w, int h, uint dstBpp, const uint32 *map);
+
 } // End of namespace Graphics
 
 #endif // GRAPHICS_CONVERSION_H
@@ -0,0 +1,131 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef GRAPHICS_CONVERSION_KERNELS_H
+#define GRAPHICS_CONVERSION_KERNELS_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+/**
+ * One channel of a conversion to a 32 bit format with 8 bit channels: the
+ * channel contributes ((src >> srcShift) << dstShift) & mask to the
+ * destination pixel. This is the same as going through colorToARGB() and
+ * ARGBToColor(), with the loss of the source channel folded into dstShift.
+ */
+struct ConversionChannel {
+	uint srcShift;
+	uint dstShift;
+	uint32 mask;
+};
+
+/**
+ * The channels of a conversion. Channels which the destination lacks, or
+ * which the source lacks and hence are zero, are left out.
+ */
+struct ConversionChannels {
+	uint count;
+	ConversionChannel channel[4];
+};
+
+/**
+ * The inner loops of crossBlit() and crossBlitMap(). Each kernel converts
+ * a single row of count pixels; source and destination may be the same
+ * buffer if they have the same bytes per pixel, and need not be aligned.
+ *
+ * All variants produce bit-identical output to the generic C++ code.
+ */
+struct ConversionKernels {
+	/** Look up each of the 8 bit source pixels in map. */
+	void (*clut8To16)(uint16 *dst, const byte *src, const uint16 *map, uint count);
+
+	/** Look up each of the 8 bit source pixels in map. */
+	void (*clut8To32)(uint32 *dst, const byte *src, const uint32 *map, uint count);
+
+	/** RGB555 to RGB565; the unused top bit of the source is ignored. */
+	void (*rgb555To565)(uint16 *dst, const uint16 *src, uint count);
+
+	/** RGB565 to RGB555. */
+	void (*rgb565To555)(uint16 *dst, const uint16 *src, uint count);
+
+	/** Any 16 bit format to a 32 bit format with 8 bit channels. */
+	void (*rgb16To32)(uint32 *dst, const uint16 *src, uint count, const ConversionChannels &channels);
+
+	/**
+	 * Between 32 bit formats with 8 bit channels; every channel moves a
+	 * whole byte, i.e. srcShift and dstShift are multiples of 8 and mask
+	 * is 0xFF << dstShift.
+	 */
+	void (*swizzle32)(uint32 *dst, const uint32 *src, uint count, const ConversionChannels &channels);
+};
+
+/**
+ * Return the best kernels for the host CPU, see Common::hasCPUFeature().
+ */
+const ConversionKernels &getConversionKernels();
+
+/**
+ * Return the generic C++ kernels.
+ */
+const ConversionKernels &getScalarConversionKernels();
+
+/** Look up a row of palette indices, like ConversionKernels::clut8To16 and clut8To32. */
+template<typename T>
+static inline void lookupPalette(T *dst, const byte *src, const T *map, uint count) {
+	for (; count >= 4; count -= 4, src += 4, dst += 4) {
+		dst[0] = map[src[0]];
+		dst[1] = map[src[1]];
+		dst[2] = map[src[2]];
+		dst[3] = map[src[3]];
+	}
+	while (count--)
+		*dst++ = map[*src++];
+}
+
+/** Convert a single pixel like ConversionKernels::rgb16To32 and swizzle32. */
+static inline uint32 convertChannels(uint32 color, const ConversionChannels &channels) {
+	uint32 result = 0;
+	for (uint i = 0; i < channels.count; ++i)
+		result |= ((color >> channels.channel[i].srcShift) << channels.channel[i].dstShift) & channels.channel[i].mask;
+	return result;
+}
+
+static inline uint16 convert555To565(uint16 color) {
+	return ((color & 0x7FE0) << 1) | (color & 0x001F);
+}
+
+static inline uint16 convert565To555(uint16 color) {
+	return ((color >> 1) & 0x7FE0) | (color & 0x001F);
+}
+
+#ifdef USE_X86_SIMD
+// Implemented in conversion_kernels_x86.cpp
+extern const ConversionKernels g_conversionKernelsSSE2;
+extern const ConversionKernels g_conversionKernelsSSSE3;
+extern const ConversionKernels g_conversionKernelsAVX2;
+#endif
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,262 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/conversion_kernels.h"
+
+#ifdef USE_X86_SIMD
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+// The functions in this file are compiled for the instruction set given in
+// their target attribute, independent of the flags used for the rest of
+// the build. getConversionKernels() only picks them if the CPU supports it.
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+/**
+ * The shift counts and masks of ConversionChannels in the form the SSE2 and
+ * AVX2 shift instructions take them.
+ */
+struct ChannelVectors {
+	uint count;
+	__m128i srcShift[4];
+	__m128i dstShift[4];
+	uint32 mask[4];
+};
+
+static SSE2_TARGET void loadChannelVectors(ChannelVectors &vectors, const ConversionChannels &channels) {
+	vectors.count = channels.count;
+	for (uint i = 0; i < channels.count; ++i) {
+		vectors.srcShift[i] = _mm_cvtsi32_si128(channels.channel[i].srcShift);
+		vectors.dstShift[i] = _mm_cvtsi32_si128(channels.channel[i].dstShift);
+		vectors.mask[i] = channels.channel[i].mask;
+	}
+}
+
+/**
+ * Build the pshufb control for four pixels of a byte moving conversion; the
+ * destination bytes without a channel get index 0x80, i.e. zero.
+ */
+static void getSwizzleMask(int8 *mask, const ConversionChannels &channels) {
+	memset(mask, 0x80, 16);
+	for (int pixel = 0; pixel < 4; ++pixel) {
+		for (uint i = 0; i < channels.count; ++i)
+			mask[4 * pixel + channels.channel[i].dstShift / 8] = 4 * pixel + channels.channel[i].srcShift / 8;
+	}
+}
+
+#pragma mark -
+
+// There is no gather before AVX2, so the palette lookups stay scalar.
+
+static void clut8To16Generic(uint16 *dst, const byte *src, const uint16 *map, uint count) {
+	lookupPalette(dst, src, map, count);
+}
+
+static void clut8To32Generic(uint32 *dst, const byte *src, const uint32 *map, uint count) {
+	lookupPalette(dst, src, map, count);
+}
+
+static SSE2_TARGET void rgb555To565SSE2(uint16 *dst, const uint16 *src, uint count) {
+	const __m128i rgMask = _mm_set1_epi16(0x7FE0);
+	const __m128i bMask = _mm_set1_epi16(0x001F);
+
+	for (; count >= 8; count -= 8, src += 8, dst += 8) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)src);
+		const __m128i rg = _mm_slli_epi16(_mm_and_si128(v, rgMask), 1);
+		_mm_storeu_si128((__m128i *)dst, _mm_or_si128(rg, _mm_and_si128(v, bMask)));
+	}
+	while (count--)
+		*dst++ = convert555To565(*src++);
+}
+
+static SSE2_TARGET void rgb565To555SSE2(uint16 *dst, const uint16 *src, uint count) {
+	const __m128i rgMask = _mm_set1_epi16(0x7FE0);
+	const __m128i bMask = _mm_set1_epi16(0x001F);
+
+	for (; count >= 8; count -= 8, src += 8, dst += 8) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)src);
+		const __m128i rg = _mm_and_si128(_mm_srli_epi16(v, 1), rgMask);
+		_mm_storeu_si128((__m128i *)dst, _mm_or_si128(rg, _mm_and_si128(v, bMask)));
+	}
+	while (count--)
+		*dst++ = convert565To555(*src++);
+}
+
+/** Apply the channels to four pixels in 32 bit lanes. */
+static inline SSE2_TARGET __m128i convertChannelsSSE2(__m128i v, const ChannelVectors &vectors) {
+	__m128i result = _mm_setzero_si128();
+	for (uint i = 0; i < vectors.count; ++i) {
+		const __m128i moved = _mm_sll_epi32(_mm_srl_epi32(v, vectors.srcShift[i]), vectors.dstShift[i]);
+		result = _mm_or_si128(result, _mm_and_si128(moved, _mm_set1_epi32(vectors.mask[i])));
+	}
+	return result;
+}
+
+static SSE2_TARGET void rgb16To32SSE2(uint32 *dst, const uint16 *src, uint count, const ConversionChannels &channels) {
+	ChannelVectors vectors;
+	loadChannelVectors(vectors, channels);
+	const __m128i zero = _mm_setzero_si128();
+
+	for (; count >= 8; count -= 8, src += 8, dst += 8) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)src);
+		_mm_storeu_si128((__m128i *)dst, convertChannelsSSE2(_mm_unpacklo_epi16(v, zero), vectors));
+		_mm_storeu_si128((__m128i *)(dst + 4), convertChannelsSSE2(_mm_unpackhi_epi16(v, zero), vectors));
+	}
+	while (count--)
+		*dst++ = convertChannels(*src++, channels);
+}
+
+static SSE2_TARGET void swizzle32SSE2(uint32 *dst, const uint32 *src, uint count, const ConversionChannels &channels) {
+	ChannelVectors vectors;
+	loadChannelVectors(vectors, channels);
+
+	for (; count >= 4; count -= 4, src += 4, dst += 4) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)src);
+		_mm_storeu_si128((__m128i *)dst, convertChannelsSSE2(v, vectors));
+	}
+	while (count--)
+		*dst++ = convertChannels(*src++, channels);
+}
+
+#pragma mark -
+
+static SSSE3_TARGET void swizzle32SSSE3(uint32 *dst, const uint32 *src, uint count, const ConversionChannels &channels) {
+	int8 mask[16];
+	getSwizzleMask(mask, channels);
+	const __m128i shuffle = _mm_loadu_si128((const __m128i *)mask);
+
+	for (; count >= 4; count -= 4, src += 4, dst += 4) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)src);
+		_mm_storeu_si128((__m128i *)dst, _mm_shuffle_epi8(v, shuffle));
+	}
+	while (count--)
+		*dst++ = convertChannels(*src++, channels);
+}
+
+#pragma mark -
+
+// The AVX2 kernels do their tails in C++ rather than calling the SSE
+// versions, which would have to pay for the switch from AVX to SSE code.
+
+static AVX2_TARGET void clut8To32AVX2(uint32 *dst, const byte *src, const uint32 *map, uint count) {
+	for (; count >= 8; count -= 8, src += 8, dst += 8) {
+		const __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)src));
+		_mm256_storeu_si256((__m256i *)dst, _mm256_i32gather_epi32((const int *)map, indices, 4));
+	}
+	while (count--)
+		*dst++ = map[*src++];
+}
+
+static AVX2_TARGET void rgb555To565AVX2(uint16 *dst, const uint16 *src, uint count) {
+	const __m256i rgMask = _mm256_set1_epi16(0x7FE0);
+	const __m256i bMask = _mm256_set1_epi16(0x001F);
+
+	for (; count >= 16; count -= 16, src += 16, dst += 16) {
+		const __m256i v = _mm256_loadu_si256((const __m256i *)src);
+		const __m256i rg = _mm256_slli_epi16(_mm256_and_si256(v, rgMask), 1);
+		_mm256_storeu_si256((__m256i *)dst, _mm256_or_si256(rg, _mm256_and_si256(v, bMask)));
+	}
+	while (count--)
+		*dst++ = convert555To565(*src++);
+}
+
+static AVX2_TARGET void rgb565To555AVX2(uint16 *dst, const uint16 *src, uint count) {
+	const __m256i rgMask = _mm256_set1_epi16(0x7FE0);
+	const __m256i bMask = _mm256_set1_epi16(0x001F);
+
+	for (; count >= 16; count -= 16, src += 16, dst += 16) {
+		const __m256i v = _mm256_loadu_si256((const __m256i *)src);
+		const __m256i rg = _mm256_and_si256(_mm256_srli_epi16(v, 1), rgMask);
+		_mm256_storeu_si256((__m256i *)dst, _mm256_or_si256(rg, _mm256_and_si256(v, bMask)));
+	}
+	while (count--)
+		*dst++ = convert565To555(*src++);
+}
+
+static AVX2_TARGET void rgb16To32AVX2(uint32 *dst, const uint16 *src, uint count, const ConversionChannels &channels) {
+	ChannelVectors vectors;
+	loadChannelVectors(vectors, channels);
+
+	for (; count >= 8; count -= 8, src += 8, dst += 8) {
+		const __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)src));
+		__m256i result = _mm256_setzero_si256();
+		for (uint i = 0; i < vectors.count; ++i) {
+			const __m256i moved = _mm256_sll_epi32(_mm256_srl_epi32(v, vectors.srcShift[i]), vectors.dstShift[i]);
+			result = _mm256_or_si256(result, _mm256_and_si256(moved, _mm256_set1_epi32(vectors.mask[i])));
+		}
+		_mm256_storeu_si256((__m256i *)dst, result);
+	}
+	while (count--)
+		*dst++ = convertChannels(*src++, channels);
+}
+
+static AVX2_TARGET void swizzle32AVX2(uint32 *dst, const uint32 *src, uint count, const ConversionChannels &channels) {
+	int8 mask[16];
+	getSwizzleMask(mask, channels);
+	const __m256i shuffle = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)mask));
+
+	for (; count >= 8; count -= 8, src += 8, dst += 8) {
+		const __m256i v = _mm256_loadu_si256((const __m256i *)src);
+		_mm256_storeu_si256((__m256i *)dst, _mm256_shuffle_epi8(v, shuffle));
+	}
+	while (count--)
+		*dst++ = convertChannels(*src++, channels);
+}
+
+#pragma mark -
+
+const ConversionKernels g_conversionKernelsSSE2 = {
+	clut8To16Generic,
+	clut8To32Generic,
+	rgb555To565SSE2,
+	rgb565To555SSE2,
+	rgb16To32SSE2,
+	swizzle32SSE2
+};
+
+const ConversionKernels g_conversionKernelsSSSE3 = {
+	clut8To16Generic,
+	clut8To32Generic,
+	rgb555To565SSE2,
+	rgb565To555SSE2,
+	rgb16To32SSE2,
+	swizzle32SSSE3
+};
+
+const ConversionKernels g_conversionKernelsAVX2 = {
+	clut8To16Generic,
+	clut8To32AVX2,
+	rgb555To565AVX2,
+	rgb565To555AVX2,
+	rgb16To32AVX2,
+	swizzle32AVX2
+};
+
+} // End of namespace Graphics
+
+#endif // #ifdef USE_X86_SIMD
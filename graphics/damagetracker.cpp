@@ -0,0 +1,183 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/damagetracker.h"
+
+#include "common/util.h"
+
+namespace Graphics {
+
+DamageTracker::DamageTracker(uint maxRects, uint rectCost)
+	: _screenWidth(0), _screenHeight(0), _maxRects(maxRects), _rectCost(rectCost), _full(false) {
+	assert(maxRects > 0);
+	memset(&_stats, 0, sizeof(_stats));
+	memset(&_lastFrameStats, 0, sizeof(_lastFrameStats));
+	_rects.reserve(maxRects);
+}
+
+int DamageTracker::mergeGain(const Common::Rect &a, const Common::Rect &b) const {
+	Common::Rect merged(a);
+	merged.extend(b);
+
+	return a.width() * a.height() + b.width() * b.height() + (int)_rectCost - merged.width() * merged.height();
+}
+
+void DamageTracker::addRect(const Common::Rect &rect) {
+	if (_full || rect.isEmpty())
+		return;
+
+	Common::Rect r(rect);
+
+	// Every merge grows r, so rects which were not worth merging before
+	// may be now; start over after each merge.
+	for (uint i = 0; i < _rects.size(); ) {
+		if (_rects[i].contains(r))
+			return;
+
+		if (mergeGain(_rects[i], r) >= 0) {
+			r.extend(_rects[i]);
+			_rects.remove_at(i);
+			i = 0;
+		} else {
+			++i;
+		}
+	}
+
+	if (_rects.size() >= _maxRects) {
+		// No room left: merge with the rect for which this costs the least
+		uint best = 0;
+		int bestGain = mergeGain(_rects[0], r);
+		for (uint i = 1; i < _rects.size(); ++i) {
+			const int gain = mergeGain(_rects[i], r);
+			if (gain > bestGain) {
+				best = i;
+				bestGain = gain;
+			}
+		}
+
+		r.extend(_rects[best]);
+		_rects.remove_at(best);
+
+		// The grown rect may overlap others now
+		addRect(r);
+		return;
+	}
+
+	_rects.push_back(r);
+}
+
+void DamageTracker::markFull() {
+	_full = true;
+	_rects.resize(0);
+}
+
+void DamageTracker::submit(const Common::Rect &rect) {
+	++_stats.submittedRects;
+	_stats.submittedPixels += rect.width() * rect.height();
+}
+
+void DamageTracker::diffRect(const byte *newPixels, int newPitch, const byte *oldPixels, int oldPitch,
+                             int bytesPerPixel, const Common::Rect &rect, Common::Array<Common::Rect> &changed) {
+	if (rect.isEmpty())
+		return;
+
+	const int firstColumn = rect.left / kTileSize;
+	const int numColumns = (rect.right - 1) / kTileSize - firstColumn + 1;
+	const int lineSize = rect.width() * bytesPerPixel;
+	_changedColumns.resize(numColumns);
+
+	int y = rect.top;
+	while (y < rect.bottom) {
+		const int tileBottom = MIN<int>((y / kTileSize + 1) * kTileSize, rect.bottom);
+		const int tileTop = y;
+		int numChanged = 0;
+
+		for (int i = 0; i < numColumns; ++i)
+			_changedColumns[i] = false;
+
+		// Most lines of a mostly static screen are identical, so compare
+		// whole lines first and only look at single tiles when that fails.
+		for (; y < tileBottom && numChanged < numColumns; ++y) {
+			const byte *n = newPixels + (y - rect.top) * newPitch;
+			const byte *o = oldPixels + (y - rect.top) * oldPitch;
+			if (!memcmp(n, o, lineSize))
+				continue;
+
+			for (int i = 0; i < numColumns; ++i) {
+				if (_changedColumns[i])
+					continue;
+
+				const int left = MAX<int>((firstColumn + i) * kTileSize, rect.left);
+				const int right = MIN<int>((firstColumn + i + 1) * kTileSize, rect.right);
+				const int offset = (left - rect.left) * bytesPerPixel;
+				if (memcmp(n + offset, o + offset, (right - left) * bytesPerPixel)) {
+					_changedColumns[i] = true;
+					++numChanged;
+				}
+			}
+		}
+		y = tileBottom;
+
+		if (!numChanged)
+			continue;
+
+		// Return runs of changed tiles as one rect
+		for (int i = 0; i < numColumns; ) {
+			if (!_changedColumns[i]) {
+				++i;
+				continue;
+			}
+
+			const int runStart = i;
+			while (i < numColumns && _changedColumns[i])
+				++i;
+
+			const Common::Rect tiles(MAX<int>((firstColumn + runStart) * kTileSize, rect.left), tileTop,
+			                         MIN<int>((firstColumn + i) * kTileSize, rect.right), tileBottom);
+			_stats.changedPixels += tiles.width() * tiles.height();
+			changed.push_back(tiles);
+		}
+	}
+}
+
+void DamageTracker::endFrame() {
+	_stats.full = _full;
+	if (_full) {
+		_stats.dirtyRects = 1;
+		_stats.dirtyPixels = _screenWidth * _screenHeight;
+	} else {
+		_stats.dirtyRects = _rects.size();
+		_stats.dirtyPixels = 0;
+		for (uint i = 0; i < _rects.size(); ++i)
+			_stats.dirtyPixels += _rects[i].width() * _rects[i].height();
+	}
+
+	_lastFrameStats = _stats;
+	memset(&_stats, 0, sizeof(_stats));
+
+	// Keep the storage around, so that the next frame does not allocate
+	_rects.resize(0);
+	_full = false;
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,144 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef GRAPHICS_DAMAGETRACKER_H
+#define GRAPHICS_DAMAGETRACKER_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Graphics {
+
+/**
+ * Collects the areas of a screen which changed since the last frame.
+ *
+ * Rects are merged as they come in whenever processing their bounding box
+ * is estimated to be cheaper than processing them separately. Every rect
+ * is assumed to cost its area plus a fixed overhead, which stands for the
+ * per-rect setup of the scaler and the screen update. That way overlapping
+ * and adjacent rects end up as one, while rects far apart stay separate.
+ * Once the maximum number of rects is reached, the new rect is merged into
+ * whichever existing rect grows the least, so the list never overflows.
+ *
+ * Additionally, diffRect() compares new pixel data against the current
+ * screen content in tiles, so that callers which redraw the whole screen
+ * every frame only dirty what actually changed.
+ */
+class DamageTracker {
+public:
+	enum {
+		/** Width and height of the tiles compared by diffRect() */
+		kTileSize = 16,
+		/** Default per-rect overhead of the cost model, in pixels */
+		kDefaultRectCost = 512
+	};
+
+	/** Per frame statistics */
+	struct Stats {
+		uint32 submittedRects;	/** < Rects passed to submit() */
+		uint32 submittedPixels;	/** < Pixels passed to submit() */
+		uint32 changedPixels;	/** < Pixels of the changed tiles found by diffRect() */
+		uint32 dirtyRects;		/** < Number of rects left after merging */
+		uint32 dirtyPixels;		/** < Pixels covered by those rects */
+		bool full;				/** < Whether the whole screen is dirty */
+	};
+
+	DamageTracker(uint maxRects, uint rectCost = kDefaultRectCost);
+
+	/**
+	 * Set the size of the screen. This is only used for the statistics of
+	 * full redraws; rects are expected to be clipped by the caller.
+	 */
+	void setScreenSize(int width, int height) { _screenWidth = width; _screenHeight = height; }
+
+	/** Add a rect to the damaged area. Empty rects are ignored. */
+	void addRect(const Common::Rect &rect);
+
+	/** Mark the whole screen as damaged. */
+	void markFull();
+
+	/** Whether the whole screen is damaged. */
+	bool isFull() const { return _full; }
+
+	/** Whether nothing is damaged at all. */
+	bool isEmpty() const { return !_full && _rects.empty(); }
+
+	/**
+	 * The damaged rects. This is empty if the whole screen is damaged, in
+	 * that case the caller should use the screen bounds instead.
+	 */
+	const Common::Array<Common::Rect> &getRects() const { return _rects; }
+
+	/**
+	 * Record that a caller handed in new data for a rect. This only
+	 * updates the statistics, the rect is not marked as damaged.
+	 */
+	void submit(const Common::Rect &rect);
+
+	/**
+	 * Compare the new pixel data of a rect against the old content of the
+	 * same area, and append the tiles which differ to 'changed'. Tiles are
+	 * aligned to the screen, runs of changed tiles in a tile row are
+	 * returned as one rect. The rects are not added to the tracker, so that
+	 * the caller can adjust them first.
+	 *
+	 * @param newPixels	pixels of the top left corner of rect in the new data
+	 * @param newPitch	pitch of the new data
+	 * @param oldPixels	pixels of the top left corner of rect in the old data
+	 * @param oldPitch	pitch of the old data
+	 * @param bytesPerPixel	size of one pixel
+	 * @param rect		area to compare, in screen coordinates
+	 * @param changed	receives the changed areas
+	 */
+	void diffRect(const byte *newPixels, int newPitch, const byte *oldPixels, int oldPitch,
+	              int bytesPerPixel, const Common::Rect &rect, Common::Array<Common::Rect> &changed);
+
+	/**
+	 * Finish the current frame: remember its statistics and clear the
+	 * tracker for the next frame.
+	 */
+	void endFrame();
+
+	/** Statistics of the frame most recently passed to endFrame(). */
+	const Stats &getLastFrameStats() const { return _lastFrameStats; }
+
+private:
+	Common::Array<Common::Rect> _rects;
+	int _screenWidth, _screenHeight;
+	uint _maxRects;
+	uint _rectCost;
+	bool _full;
+	Stats _stats;
+	Stats _lastFrameStats;
+
+	/** Which tile columns diffRect() found to be changed in the current tile row */
+	Common::Array<bool> _changedColumns;
+
+	/** The rect cost saved by merging a and b; negative if it does not pay off. */
+	int mergeGain(const Common::Rect &a, const Common::Rect &b) const;
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -20,12 +20,18 @@
  */
 
 #include "graphics/font.h"
+#include "graphics/fontcache.h"
+#include "graphics/surface.h"
 
 #include "common/array.h"
 #include "common/util.h"
 
 namespace Graphics {
 
+Font::~Font() {
+	delete _cache;
+}
+
 int Font::getStringWidth(const Common::String &str) const {
 	int space = 0;
 
@@ -104,6 +110,31 @@ void Font::drawString(Surface *dst, const Common::String &sOld, int x, int y, in
 		x = x + w - width;
 	x += deltax;
 
+	const uint bpp = dst->format.bytesPerPixel;
+	if (isCacheable() && (bpp == 1 || bpp == 2 || bpp == 4)) {
+		// Find the characters which fit, and draw them as one run
+		uint first = str.size(), last = 0;
+		int runX = x;
+		for (i = 0; i < str.size(); ++i) {
+			w = getCharWidth(str[i]);
+			if (x+w > rightX)
+				break;
+			if (x >= leftX && first > i) {
+				first = i;
+				runX = x;
+			}
+			last = i + 1;
+			x += w;
+		}
+
+		if (first < last) {
+			if (!_cache)
+				_cache = new FontCache(*this);
+			_cache->drawString(dst, Common::String(str.c_str() + first, last - first), runX, y, color);
+		}
+		return;
+	}
+
 	for (i = 0; i < str.size(); ++i) {
 		w = getCharWidth(str[i]);
 		if (x+w > rightX)
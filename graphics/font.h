@@ -31,6 +31,7 @@ template<class T> class Array;
 namespace Graphics {
 
 struct Surface;
+class FontCache;
 
 /** Text alignment modes */
 enum TextAlign {
@@ -47,8 +48,11 @@ enum TextAlign {
  */
 class Font {
 public:
-	Font() {}
-	virtual ~Font() {}
+	Font() : _cache(0) {}
+	Font(const Font &) : _cache(0) {}
+	virtual ~Font();
+
+	Font &operator=(const Font &) { return *this; }
 
 	/**
 	 * Query the height of the font.
@@ -111,6 +115,20 @@ public:
 	 * @return the maximal width of any of the lines added to lines
 	 */
 	int wordWrapText(const Common::String &str, int maxWidth, Common::Array<Common::String> &lines) const;
+
+protected:
+	/**
+	 * Whether drawString() may draw from pre-rendered masks of the glyphs.
+	 * This requires that drawChar() can draw into 1 byte per pixel surfaces,
+	 * and that the glyphs only consist of pixels in the given color.
+	 *
+	 * @see FontCache
+	 */
+	virtual bool isCacheable() const { return false; }
+
+private:
+	/** Glyph atlas and string cache, created on the first drawString() */
+	mutable FontCache *_cache;
 };
 
 } // End of namespace Graphics
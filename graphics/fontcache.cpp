@@ -0,0 +1,355 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+
+#include "graphics/fontcache.h"
+#include "graphics/font.h"
+#include "graphics/surface.h"
+
+#include "common/textconsole.h"
+#include "common/util.h"
+
+namespace Graphics {
+
+FontCache::FontCache(const Font &font, uint32 maxRunCacheSize)
+	: _font(font), _kernels(getFontBlitKernels()), _maxRunCacheSize(maxRunCacheSize), _runCacheSize(0), _useCounter(0) {
+	for (int i = 0; i < 3; i++)
+		_atlases[i] = 0;
+}
+
+FontCache::~FontCache() {
+	clearRuns();
+	for (int i = 0; i < 3; i++) {
+		if (_atlases[i]) {
+			delete[] _atlases[i]->pixels;
+			delete _atlases[i];
+		}
+	}
+}
+
+int FontCache::atlasIndex(uint bytesPerPixel) {
+	switch (bytesPerPixel) {
+	case 1:
+		return 0;
+	case 2:
+		return 1;
+	case 4:
+		return 2;
+	default:
+		error("FontCache: Unsupported pixel size %d", bytesPerPixel);
+	}
+}
+
+FontCache::Atlas *FontCache::getAtlas(uint bytesPerPixel) {
+	Atlas *&atlas = _atlases[atlasIndex(bytesPerPixel)];
+	if (!atlas)
+		atlas = buildAtlas(bytesPerPixel);
+	return atlas;
+}
+
+FontCache::Atlas *FontCache::buildAtlas(uint bytesPerPixel) const {
+	// The glyphs are drawn into a scratch surface with a margin around the
+	// character cell, since they may extend beyond it
+	const int marginX = _font.getMaxCharWidth(), marginY = _font.getFontHeight();
+	Surface scratch;
+	scratch.create(marginX * 3, marginY * 3, PixelFormat::createFormatCLUT8());
+
+	Atlas *atlas = new Atlas();
+	uint32 size = 0;
+
+	// First pass: the bounding box of every glyph
+	for (int chr = 0; chr < 256; chr++) {
+		memset(scratch.pixels, 0, scratch.pitch * scratch.h);
+		_font.drawChar(&scratch, chr, marginX, marginY, 0xFF);
+
+		int left = scratch.w, top = scratch.h, right = 0, bottom = 0;
+		for (int y = 0; y < scratch.h; y++) {
+			const byte *row = (const byte *)scratch.getBasePtr(0, y);
+			for (int x = 0; x < scratch.w; x++) {
+				if (row[x]) {
+					left = MIN(left, x);
+					right = MAX(right, x + 1);
+					top = MIN(top, y);
+					bottom = MAX(bottom, y + 1);
+				}
+			}
+		}
+
+		Mask &glyph = atlas->glyphs[chr];
+		if (left < right) {
+			glyph.x = left - marginX;
+			glyph.y = top - marginY;
+			glyph.w = right - left;
+			glyph.h = bottom - top;
+		} else {
+			glyph.x = glyph.y = 0;
+			glyph.w = glyph.h = 0;
+		}
+		size += glyph.w * glyph.h * bytesPerPixel;
+	}
+
+	// Second pass: expand the pixels into the atlas
+	atlas->pixels = new byte[MAX<uint32>(size, 1)];
+	byte *dst = atlas->pixels;
+	for (int chr = 0; chr < 256; chr++) {
+		Mask &glyph = atlas->glyphs[chr];
+		glyph.pixels = dst;
+		if (!glyph.w)
+			continue;
+
+		memset(scratch.pixels, 0, scratch.pitch * scratch.h);
+		_font.drawChar(&scratch, chr, marginX, marginY, 0xFF);
+
+		for (int y = 0; y < glyph.h; y++) {
+			const byte *src = (const byte *)scratch.getBasePtr(glyph.x + marginX, glyph.y + marginY + y);
+			for (int x = 0; x < glyph.w; x++) {
+				memset(dst, src[x] ? 0xFF : 0, bytesPerPixel);
+				dst += bytesPerPixel;
+			}
+		}
+	}
+
+	scratch.free();
+	return atlas;
+}
+
+FontCache::Run *FontCache::buildRun(const Atlas &atlas, uint bytesPerPixel, const Common::String &str) const {
+	int left = 0, top = 0, right = 0, bottom = 0;
+	bool empty = true;
+	int penX = 0;
+	for (uint i = 0; i < str.size(); i++) {
+		const Mask &glyph = atlas.glyphs[(byte)str[i]];
+		if (glyph.w) {
+			if (empty) {
+				left = penX + glyph.x;
+				top = glyph.y;
+				right = left + glyph.w;
+				bottom = top + glyph.h;
+				empty = false;
+			} else {
+				left = MIN<int>(left, penX + glyph.x);
+				top = MIN<int>(top, glyph.y);
+				right = MAX<int>(right, penX + glyph.x + glyph.w);
+				bottom = MAX<int>(bottom, glyph.y + glyph.h);
+			}
+		}
+		penX += _font.getCharWidth(str[i]);
+	}
+
+	Run *run = new Run();
+	run->x = left;
+	run->y = top;
+	run->w = right - left;
+	run->h = bottom - top;
+	run->pixels = 0;
+	run->lastUse = 0;
+	if (empty)
+		return run;
+
+	const uint pitch = run->w * bytesPerPixel;
+	run->pixels = new byte[pitch * run->h];
+	memset(run->pixels, 0, pitch * run->h);
+
+	// Overlapping glyphs are combined, like drawing them one after the other
+	penX = 0;
+	for (uint i = 0; i < str.size(); i++) {
+		const Mask &glyph = atlas.glyphs[(byte)str[i]];
+		const uint glyphPitch = glyph.w * bytesPerPixel;
+		for (int y = 0; y < glyph.h; y++) {
+			const byte *src = glyph.pixels + y * glyphPitch;
+			byte *dst = run->pixels + (glyph.y - top + y) * pitch + (penX + glyph.x - left) * bytesPerPixel;
+			for (uint j = 0; j < glyphPitch; j++)
+				dst[j] |= src[j];
+		}
+		penX += _font.getCharWidth(str[i]);
+	}
+
+	return run;
+}
+
+void FontCache::freeRun(Run *run) {
+	delete[] run->pixels;
+	delete run;
+}
+
+uint FontCache::getRunCount() const {
+	return _runs[0].size() + _runs[1].size() + _runs[2].size();
+}
+
+void FontCache::clearRuns() {
+	for (int i = 0; i < 3; i++) {
+		for (RunMap::iterator it = _runs[i].begin(); it != _runs[i].end(); ++it)
+			freeRun(it->_value);
+		_runs[i].clear();
+	}
+	_runCacheSize = 0;
+}
+
+static uint32 runSize(const Common::String &str, uint16 w, uint16 h, uint bytesPerPixel) {
+	return w * h * bytesPerPixel + str.size() + 64;
+}
+
+void FontCache::evictRuns(uint32 neededSize) {
+	while (_runCacheSize + neededSize > _maxRunCacheSize) {
+		RunMap *oldestMap = 0;
+		RunMap::iterator oldest;
+		uint oldestBytesPerPixel = 0;
+
+		static const uint bytesPerPixel[3] = { 1, 2, 4 };
+		for (int i = 0; i < 3; i++) {
+			for (RunMap::iterator it = _runs[i].begin(); it != _runs[i].end(); ++it) {
+				if (!oldestMap || it->_value->lastUse < oldest->_value->lastUse) {
+					oldestMap = &_runs[i];
+					oldest = it;
+					oldestBytesPerPixel = bytesPerPixel[i];
+				}
+			}
+		}
+
+		if (!oldestMap)
+			break;
+
+		_runCacheSize -= runSize(oldest->_key, oldest->_value->w, oldest->_value->h, oldestBytesPerPixel);
+		freeRun(oldest->_value);
+		oldestMap->erase(oldest);
+	}
+}
+
+void FontCache::drawString(Surface *dst, const Common::String &str, int x, int y, uint32 color) {
+	assert(dst);
+	const uint bytesPerPixel = dst->format.bytesPerPixel;
+	RunMap &runs = _runs[atlasIndex(bytesPerPixel)];
+
+	RunMap::iterator it = runs.find(str);
+	if (it != runs.end()) {
+		it->_value->lastUse = ++_useCounter;
+		blitMask(dst, *it->_value, x, y, color);
+		return;
+	}
+
+	Run *run = buildRun(*getAtlas(bytesPerPixel), bytesPerPixel, str);
+	blitMask(dst, *run, x, y, color);
+
+	const uint32 size = runSize(str, run->w, run->h, bytesPerPixel);
+	if (size > _maxRunCacheSize) {
+		freeRun(run);
+		return;
+	}
+
+	evictRuns(size);
+	run->lastUse = ++_useCounter;
+	runs[str] = run;
+	_runCacheSize += size;
+}
+
+void FontCache::drawChar(Surface *dst, byte chr, int x, int y, uint32 color) {
+	assert(dst);
+	blitMask(dst, getAtlas(dst->format.bytesPerPixel)->glyphs[chr], x, y, color);
+}
+
+void FontCache::blitMask(Surface *dst, const Mask &mask, int x, int y, uint32 color) const {
+	const uint bytesPerPixel = dst->format.bytesPerPixel;
+	const uint maskPitch = mask.w * bytesPerPixel;
+
+	// Clip against the surface
+	int left = x + mask.x, top = y + mask.y;
+	const int right = MIN<int>(left + mask.w, dst->w), bottom = MIN<int>(top + mask.h, dst->h);
+	const byte *src = mask.pixels;
+	if (left < 0) {
+		src -= left * bytesPerPixel;
+		left = 0;
+	}
+	if (top < 0) {
+		src -= top * maskPitch;
+		top = 0;
+	}
+	if (left >= right || top >= bottom)
+		return;
+
+	byte colorBytes[16];
+	for (uint i = 0; i < 16; i += bytesPerPixel) {
+		if (bytesPerPixel == 1)
+			colorBytes[i] = color;
+		else if (bytesPerPixel == 2)
+			*(uint16 *)(colorBytes + i) = color;
+		else
+			*(uint32 *)(colorBytes + i) = color;
+	}
+
+	_kernels.blitMask((byte *)dst->getBasePtr(left, top), dst->pitch, src, maskPitch, (right - left) * bytesPerPixel, bottom - top, colorBytes);
+}
+
+#pragma mark -
+
+static void blitMask(byte *dst, uint dstPitch, const byte *mask, uint maskPitch, uint length, uint h, const byte *color) {
+	uint32 color32;
+	memcpy(&color32, color, 4);
+
+	while (h-- > 0) {
+		// Four bytes at a time; the color repeats every four bytes
+		uint i = 0;
+		for (; i + 4 <= length; i += 4) {
+			uint32 d, m;
+			memcpy(&d, dst + i, 4);
+			memcpy(&m, mask + i, 4);
+			d = (d & ~m) | (color32 & m);
+			memcpy(dst + i, &d, 4);
+		}
+		for (; i < length; i++)
+			dst[i] = (dst[i] & ~mask[i]) | (color[i & 3] & mask[i]);
+
+		dst += dstPitch;
+		mask += maskPitch;
+	}
+}
+
+static const FontBlitKernels s_fontBlitKernelsScalar = {
+	blitMask
+};
+
+const FontBlitKernels &getScalarFontBlitKernels() {
+	return s_fontBlitKernelsScalar;
+}
+
+const FontBlitKernels *getFontBlitKernels(Common::CPUFeature feature) {
+	if (!Common::hasCPUFeature(feature))
+		return 0;
+
+	switch (feature) {
+#ifdef USE_X86_SIMD
+	case Common::kCPUFeatureSSE2:
+		return &g_fontBlitKernelsSSE2;
+#endif
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+const FontBlitKernels &getFontBlitKernels() {
+	const FontBlitKernels *kernels = getFontBlitKernels(Common::kCPUFeatureSSE2);
+	return kernels ? *kernels : s_fontBlitKernelsScalar;
+}
+
+} // End of namespace Graphics
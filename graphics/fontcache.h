@@ -0,0 +1,170 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+
+#ifndef GRAPHICS_FONTCACHE_H
+#define GRAPHICS_FONTCACHE_H
+
+#include "common/scummsys.h"
+#include "common/cpudetect.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/str.h"
+
+namespace Graphics {
+
+class Font;
+struct Surface;
+
+/**
+ * Draw a color where a mask is set: every byte of the h rows of dst, each
+ * length bytes long, is replaced by the corresponding byte of the color
+ * where the mask byte is 0xFF, and kept where it is zero. The color holds
+ * 16 bytes which repeat the pixel value, and the rows start at a pixel
+ * boundary.
+ */
+struct FontBlitKernels {
+	void (*blitMask)(byte *dst, uint dstPitch, const byte *mask, uint maskPitch, uint length, uint h, const byte *color);
+};
+
+/**
+ * Return the kernels for the given instruction set extension, or 0 if the
+ * build or the host CPU does not support them.
+ */
+const FontBlitKernels *getFontBlitKernels(Common::CPUFeature feature);
+
+/**
+ * Return the fastest kernels the host CPU supports.
+ */
+const FontBlitKernels &getFontBlitKernels();
+
+/**
+ * Return the generic C++ kernels.
+ */
+const FontBlitKernels &getScalarFontBlitKernels();
+
+#ifdef USE_X86_SIMD
+// Implemented in fontcache_x86.cpp
+extern const FontBlitKernels g_fontBlitKernelsSSE2;
+#endif
+
+/**
+ * Pre-rendered glyphs and strings of a monochrome font.
+ *
+ * The glyph atlas holds the pixels of every glyph as a mask, expanded to the
+ * pixel size of the target surface: each pixel is either zero or has all
+ * bits set. Drawing a mask then only takes a bitwise select per pixel,
+ * instead of testing the bits of the font bitmap one by one.
+ *
+ * On top of that, strings are composed from the glyph masks into runs,
+ * which are kept in a least recently used cache. GUI widgets draw the same
+ * labels over and over, so most strings end up being a single masked blit.
+ * The masks do not depend on the color, so neither does the cache.
+ *
+ * The kernels are picked when the cache is created.
+ */
+class FontCache {
+public:
+	enum {
+		/** Default limit of the memory used by the cached runs, in bytes */
+		kDefaultRunCacheSize = 256 * 1024
+	};
+
+	/**
+	 * Create the cache for a font. The font has to be able to draw into
+	 * 1 byte per pixel surfaces, and its glyphs have to be monochrome.
+	 */
+	FontCache(const Font &font, uint32 maxRunCacheSize = kDefaultRunCacheSize);
+	~FontCache();
+
+	/**
+	 * Draw a string like consecutive calls to Font::drawChar() would, with
+	 * the characters advancing by their width. Pixels outside of the surface
+	 * are clipped.
+	 *
+	 * @param dst	the surface to draw on, with 1, 2 or 4 bytes per pixel
+	 * @param str	the characters to draw
+	 * @param x		the x coordinate of the first character
+	 * @param y		the y coordinate of the top of the characters
+	 * @param color	the color of the text
+	 */
+	void drawString(Surface *dst, const Common::String &str, int x, int y, uint32 color);
+
+	/** Draw a single character from the glyph atlas. */
+	void drawChar(Surface *dst, byte chr, int x, int y, uint32 color);
+
+	/** Memory currently used by the cached runs, in bytes. */
+	uint32 getRunCacheSize() const { return _runCacheSize; }
+
+	/** Number of runs currently cached. */
+	uint getRunCount() const;
+
+	/** Drop all cached runs. The glyph atlases are kept. */
+	void clearRuns();
+
+private:
+	/**
+	 * A pre-rendered mask. The position is relative to the origin of the
+	 * character or string, as passed to drawChar().
+	 */
+	struct Mask {
+		int16 x, y;
+		uint16 w, h;
+		byte *pixels;	///< w * h pixels of the pixel size of the atlas
+	};
+
+	struct Run : public Mask {
+		uint32 lastUse;
+	};
+
+	typedef Common::HashMap<Common::String, Run *> RunMap;
+
+	/** The glyphs for one pixel size. */
+	struct Atlas {
+		Mask glyphs[256];
+		byte *pixels;
+	};
+
+	const Font &_font;
+	const FontBlitKernels &_kernels;
+	/** Atlases for 1, 2 and 4 bytes per pixel, built on first use */
+	Atlas *_atlases[3];
+	/** Cached runs for 1, 2 and 4 bytes per pixel */
+	RunMap _runs[3];
+	uint32 _maxRunCacheSize;
+	uint32 _runCacheSize;
+	uint32 _useCounter;
+
+	static int atlasIndex(uint bytesPerPixel);
+	Atlas *getAtlas(uint bytesPerPixel);
+	Atlas *buildAtlas(uint bytesPerPixel) const;
+	Run *buildRun(const Atlas &atlas, uint bytesPerPixel, const Common::String &str) const;
+	void evictRuns(uint32 neededSize);
+	static void freeRun(Run *run);
+
+	void blitMask(Surface *dst, const Mask &mask, int x, int y, uint32 color) const;
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,63 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+
+#include "graphics/fontcache.h"
+
+#ifdef USE_X86_SIMD
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+// The functions in this file are compiled for the instruction set given in
+// their target attribute, independent of the flags used for the rest of
+// the build. getFontBlitKernels() only picks them if the CPU supports it.
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+
+SSE2_TARGET static void blitMaskSSE2(byte *dst, uint dstPitch, const byte *mask, uint maskPitch, uint length, uint h, const byte *color) {
+	const __m128i color128 = _mm_loadu_si128((const __m128i *)color);
+
+	while (h-- > 0) {
+		uint i = 0;
+		for (; i + 16 <= length; i += 16) {
+			const __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+			const __m128i m = _mm_loadu_si128((const __m128i *)(mask + i));
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(_mm_andnot_si128(m, d), _mm_and_si128(m, color128)));
+		}
+		for (; i < length; i++)
+			dst[i] = (dst[i] & ~mask[i]) | (color[i & 15] & mask[i]);
+
+		dst += dstPitch;
+		mask += maskPitch;
+	}
+}
+
+const FontBlitKernels g_fontBlitKernelsSSE2 = {
+	blitMaskSSE2
+};
+
+} // End of namespace Graphics
+
+#endif // #ifdef USE_X86_SIMD
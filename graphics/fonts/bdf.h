@@ -79,6 +79,9 @@ public:
 	static BdfFont *loadFont(Common::SeekableReadStream &stream);
 	static bool cacheFontData(const BdfFont &font, const Common::String &filename);
 	static BdfFont *loadFromCache(Common::SeekableReadStream &stream);
+
+protected:
+	virtual bool isCacheable() const { return true; }
 };
 
 #define DEFINE_FONT(n) \
@@ -22,6 +22,7 @@
 
 #include "graphics/conversion.h"
 #include "graphics/jpeg.h"
+#include "graphics/jpeg_idct.h"
 #include "graphics/pixelformat.h"
 
 #include "common/debug.h"
@@ -43,23 +44,9 @@ static const uint8 _zigZagOrder[64] = {
 	53, 60, 61, 54, 47, 55, 62, 63
 };
 
-// IDCT table built with :
-// _idct8x8[x][y] = cos(((2 * x + 1) * y) * (M_PI / 16.0)) * 0.5;
-// _idct8x8[x][y] /= sqrt(2.0) if y == 0
-static const double _idct8x8[8][8] = {
-	{ 0.353553390593274,  0.490392640201615,  0.461939766255643,  0.415734806151273,  0.353553390593274,  0.277785116509801,  0.191341716182545,  0.097545161008064 },
-	{ 0.353553390593274,  0.415734806151273,  0.191341716182545, -0.097545161008064, -0.353553390593274, -0.490392640201615, -0.461939766255643, -0.277785116509801 },
-	{ 0.353553390593274,  0.277785116509801, -0.191341716182545, -0.490392640201615, -0.353553390593274,  0.097545161008064,  0.461939766255643,  0.415734806151273 },
-	{ 0.353553390593274,  0.097545161008064, -0.461939766255643, -0.277785116509801,  0.353553390593274,  0.415734806151273, -0.191341716182545, -0.490392640201615 },
-	{ 0.353553390593274, -0.097545161008064, -0.461939766255643,  0.277785116509801,  0.353553390593274, -0.415734806151273, -0.191341716182545,  0.490392640201615 },
-	{ 0.353553390593274, -0.277785116509801, -0.191341716182545,  0.490392640201615, -0.353553390593273, -0.097545161008064,  0.461939766255643, -0.415734806151273 },
-	{ 0.353553390593274, -0.415734806151273,  0.191341716182545,  0.097545161008064, -0.353553390593274,  0.490392640201615, -0.461939766255643,  0.277785116509801 },
-	{ 0.353553390593274, -0.490392640201615,  0.461939766255643, -0.415734806151273,  0.353553390593273, -0.277785116509801,  0.191341716182545, -0.097545161008064 }
-};
-
 JPEG::JPEG() :
-	_stream(NULL), _w(0), _h(0), _numComp(0), _components(NULL), _numScanComp(0),
-	_scanComp(NULL), _currentComp(NULL) {
+	_stream(NULL), _w(0), _h(0), _output(NULL), _outputDone(false), _numComp(0), _components(NULL), _numScanComp(0),
+	_scanComp(NULL), _currentComp(NULL), _idct(NULL) {
 
 	// Initialize the quantization tables
 	for (int i = 0; i < JPEG_MAX_QUANT_TABLES; i++)
@@ -69,8 +56,6 @@ JPEG::JPEG() :
 	for (int i = 0; i < 2 * JPEG_MAX_HUFF_TABLES; i++) {
 		_huff[i].count = 0;
 		_huff[i].values = NULL;
-		_huff[i].sizes = NULL;
-		_huff[i].codes = NULL;
 	}
 }
 
@@ -87,28 +72,64 @@ Surface *JPEG::getSurface(const PixelFormat &format) {
 	if (format.bytesPerPixel == 1)
 		return 0;
 
-	// Get our component surfaces
-	Graphics::Surface *yComponent = getComponent(1);
-	Graphics::Surface *uComponent = getComponent(2);
-	Graphics::Surface *vComponent = getComponent(3);
-
 	Graphics::Surface *output = new Graphics::Surface();
-	output->create(yComponent->w, yComponent->h, format);
-
-	for (uint16 i = 0; i < output->h; i++) {
-		for (uint16 j = 0; j < output->w; j++) {
-			byte r = 0, g = 0, b = 0;
-			YUV2RGB(*((byte *)yComponent->getBasePtr(j, i)), *((byte *)uComponent->getBasePtr(j, i)), *((byte *)vComponent->getBasePtr(j, i)), r, g, b);
-			if (format.bytesPerPixel == 2)
-				*((uint16 *)output->getBasePtr(j, i)) = format.RGBToColor(r, g, b);
-			else
-				*((uint32 *)output->getBasePtr(j, i)) = format.RGBToColor(r, g, b);
-		}
+	output->create(_w, _h, format);
+	if (!convertTo(output)) {
+		output->free();
+		delete output;
+		return 0;
 	}
 
 	return output;
 }
 
+template<typename PixelInt>
+static void convertYUVRow(PixelInt *dst, const byte *y, const byte *u, const byte *v, uint16 w, const PixelFormat &format) {
+	for (uint16 i = 0; i < w; i++) {
+		byte r, g, b;
+		YUV2RGB(y[i], u[i], v[i], r, g, b);
+		dst[i] = format.RGBToColor(r, g, b);
+	}
+}
+
+bool JPEG::canConvertTo(const Surface *dst) const {
+	// Only accept >8bpp surfaces
+	if (dst->format.bytesPerPixel != 2 && dst->format.bytesPerPixel != 4)
+		return false;
+	return dst->w >= _w && dst->h >= _h;
+}
+
+void JPEG::convertRows(Surface *dst, uint16 firstRow, uint16 numRows, uint16 planeRow) {
+	// Get our component surfaces
+	const Graphics::Surface *yComponent = getComponent(1);
+	const Graphics::Surface *uComponent = getComponent(2);
+	const Graphics::Surface *vComponent = getComponent(3);
+
+	// Convert row by row, straight from the component planes
+	for (uint16 i = 0; i < numRows; i++) {
+		const byte *y = (const byte *)yComponent->getBasePtr(0, planeRow + i);
+		const byte *u = (const byte *)uComponent->getBasePtr(0, planeRow + i);
+		const byte *v = (const byte *)vComponent->getBasePtr(0, planeRow + i);
+
+		if (dst->format.bytesPerPixel == 2)
+			convertYUVRow((uint16 *)dst->getBasePtr(0, firstRow + i), y, u, v, _w, dst->format);
+		else
+			convertYUVRow((uint32 *)dst->getBasePtr(0, firstRow + i), y, u, v, _w, dst->format);
+	}
+}
+
+bool JPEG::convertTo(Surface *dst) {
+	// Make sure we have loaded data, and kept the component planes
+	if (!isLoaded() || !_components[0].surface.pixels)
+		return false;
+
+	if (!canConvertTo(dst))
+		return false;
+
+	convertRows(dst, 0, _h, 0);
+	return true;
+}
+
 void JPEG::reset() {
 	// Reset member variables
 	_stream = NULL;
@@ -135,17 +156,21 @@ void JPEG::reset() {
 	for (int i = 0; i < 2 * JPEG_MAX_HUFF_TABLES; i++) {
 		_huff[i].count = 0;
 		delete[] _huff[i].values; _huff[i].values = NULL;
-		delete[] _huff[i].sizes; _huff[i].sizes = NULL;
-		delete[] _huff[i].codes; _huff[i].codes = NULL;
 	}
 }
 
 bool JPEG::read(Common::SeekableReadStream *stream) {
+	return read(stream, NULL);
+}
+
+bool JPEG::read(Common::SeekableReadStream *stream, Surface *dst) {
 	// Reset member variables and tables from previous reads
 	reset();
 
 	// Save the input stream
 	_stream = stream;
+	_output = dst;
+	_outputDone = false;
 
 	bool ok = true;
 	bool done = false;
@@ -218,6 +243,12 @@ bool JPEG::read(Common::SeekableReadStream *stream) {
 		}
 		}
 	}
+
+	// Images with one scan per component are only complete at the end
+	if (ok && _output && !_outputDone)
+		ok = convertTo(_output);
+	_output = NULL;
+
 	return ok;
 }
 
@@ -283,6 +314,10 @@ bool JPEG::readSOF0() {
 		_components[c].factorV = _components[c].factorH & 0xF;
 		_components[c].factorH >>= 4;
 		_components[c].quantTableSelector = _stream->readByte();
+		if (_components[c].quantTableSelector >= JPEG_MAX_QUANT_TABLES) {
+			warning("JPEG: Invalid quantization table");
+			return false;
+		}
 	}
 
 	return true;
@@ -300,50 +335,54 @@ bool JPEG::readDHT() {
 		uint8 tableType = tableId >> 4; // type 0: DC, 1: AC
 		tableId &= 0xF;
 		uint8 tableNum = (tableId << 1) + tableType;
+		if (tableNum >= 2 * JPEG_MAX_HUFF_TABLES) {
+			warning("JPEG: Invalid Huffman table");
+			return false;
+		}
 
 		// Free the Huffman table
-		delete[] _huff[tableNum].values; _huff[tableNum].values = NULL;
-		delete[] _huff[tableNum].sizes; _huff[tableNum].sizes = NULL;
-		delete[] _huff[tableNum].codes;	_huff[tableNum].codes = NULL;
+		HuffmanTable &table = _huff[tableNum];
+		delete[] table.values; table.values = NULL;
 
 		// Read the number of values for each length
 		uint8 numValues[16];
-		_huff[tableNum].count = 0;
+		int count = 0;
 		for (int len = 0; len < 16; len++) {
 			numValues[len] = _stream->readByte();
-			_huff[tableNum].count += numValues[len];
+			count += numValues[len];
 		}
 
-		// Allocate memory for the current table
-		_huff[tableNum].values = new uint8[_huff[tableNum].count];
-		_huff[tableNum].sizes = new uint8[_huff[tableNum].count];
-		_huff[tableNum].codes = new uint16[_huff[tableNum].count];
+		// There are only 256 different values
+		if (count > 256) {
+			warning("JPEG: Invalid Huffman table");
+			return false;
+		}
+		table.count = count;
 
 		// Read the table contents
-		int cur = 0;
-		for (int len = 0; len < 16; len++) {
-			for (int i = 0; i < numValues[len]; i++) {
-				_huff[tableNum].values[cur] = _stream->readByte();
-				_huff[tableNum].sizes[cur] = len + 1;
-				cur++;
-			}
-		}
+		table.values = new uint8[count];
+		_stream->read(table.values, count);
 
-		// Fill the table of Huffman codes
-		cur = 0;
-		uint16 curCode = 0;
-		uint8 curCodeSize = _huff[tableNum].sizes[0];
-		while (cur < _huff[tableNum].count) {
-			// Increase the code size to fit the request
-			while (_huff[tableNum].sizes[cur] != curCodeSize) {
-				curCode <<= 1;
-				curCodeSize++;
+		// Assign the canonical codes, see Annex C of the specification,
+		// and build the decoding tables from them
+		memset(table.lookup, 0, sizeof(table.lookup));
+		int cur = 0;
+		uint32 code = 0;
+		for (int len = 1; len <= 16; len++) {
+			table.valueOffset[len] = cur - code;
+			table.maxCode[len] = numValues[len - 1] ? code + numValues[len - 1] - 1 : -1;
+
+			for (int i = 0; i < numValues[len - 1]; i++, cur++, code++) {
+				if (len > JPEG_HUFF_LOOKUP_BITS || code >= (1u << len))
+					continue;
+
+				// All lookup indices which start with the code
+				const int shift = JPEG_HUFF_LOOKUP_BITS - len;
+				for (uint32 j = 0; j < (1u << shift); j++)
+					table.lookup[(code << shift) | j] = (len << 8) | table.values[cur];
 			}
 
-			// Assign the current code
-			_huff[tableNum].codes[cur] = curCode;
-			curCode++;
-			cur++;
+			code <<= 1;
 		}
 	}
 
@@ -396,6 +435,14 @@ bool JPEG::readSOS() {
 		_scanComp[c]->DCentropyTableSelector = _stream->readByte();
 		_scanComp[c]->ACentropyTableSelector = _scanComp[c]->DCentropyTableSelector & 0xF;
 		_scanComp[c]->DCentropyTableSelector >>= 4;
+		if (_scanComp[c]->DCentropyTableSelector >= JPEG_MAX_HUFF_TABLES || _scanComp[c]->ACentropyTableSelector >= JPEG_MAX_HUFF_TABLES) {
+			warning("JPEG: Invalid Huffman table");
+			return false;
+		}
+		if (!_huff[_scanComp[c]->DCentropyTableSelector << 1].values || !_huff[(_scanComp[c]->ACentropyTableSelector << 1) + 1].values) {
+			warning("JPEG: Missing Huffman table");
+			return false;
+		}
 
 		// Calculate the maximum sampling factors
 		if (_scanComp[c]->factorV > _maxFactorV)
@@ -427,7 +474,10 @@ bool JPEG::readSOS() {
 	}
 
 	// Entropy coded sequence starts, initialize Huffman decoder
+	_bitsData = 0;
 	_bitsNumber = 0;
+	_bitsEnd = false;
+	_idct = &getJPEGIDCTKernels();
 
 	// Read all the scan MCUs
 	uint16 xMCU = _w / (_maxFactorH * 8);
@@ -439,15 +489,36 @@ bool JPEG::readSOS() {
 	if (_h % (_maxFactorV * 8) != 0)
 		yMCU++;
 
+	// If the scan has all components of a color image, each row of MCUs
+	// can be converted into the output surface as soon as it is decoded,
+	// and the planes only need to hold a single row of them
+	const bool convertEachRow = _output && _numComp == 3 && _numScanComp == 3;
+	const uint16 rowHeight = _maxFactorV * 8;
+	if (convertEachRow && !canConvertTo(_output)) {
+		warning("JPEG: Unsupported output surface");
+		return false;
+	}
+
 	// Initialize the scan surfaces
 	for (uint16 c = 0; c < _numScanComp; c++) {
-		_scanComp[c]->surface.create(xMCU * _maxFactorH * 8, yMCU * _maxFactorV * 8, PixelFormat::createFormatCLUT8());
+		_scanComp[c]->surface.create(xMCU * _maxFactorH * 8, convertEachRow ? rowHeight : yMCU * rowHeight, PixelFormat::createFormatCLUT8());
 	}
 
 	bool ok = true;
-	for (int y = 0; ok && (y < yMCU); y++)
+	for (int y = 0; ok && (y < yMCU); y++) {
 		for (int x = 0; ok && (x < xMCU); x++)
-			ok = readMCU(x, y);
+			ok = readMCU(x, convertEachRow ? 0 : y);
+
+		if (ok && convertEachRow)
+			convertRows(_output, y * rowHeight, MIN<int>(rowHeight, _h - y * rowHeight), 0);
+	}
+
+	if (convertEachRow) {
+		for (uint16 c = 0; c < _numScanComp; c++)
+			_scanComp[c]->surface.free();
+		_outputDone = true;
+		return ok;
+	}
 
 	// Trim Component surfaces back to image height and width
 	// Note: Code using jpeg must use surface.pitch correctly...
@@ -472,18 +543,21 @@ bool JPEG::readDQT() {
 
 		// Validate the table id
 		tableId &= 0xF;
-		if (tableId > JPEG_MAX_QUANT_TABLES) {
+		if (tableId >= JPEG_MAX_QUANT_TABLES) {
 			warning("JPEG: Invalid number of components");
 			return false;
 		}
 
 		// Create the new table if necessary
 		if (!_quant[tableId])
-			_quant[tableId] = new uint16[64];
+			_quant[tableId] = new uint32[64];
 
-		// Read the table (stored in Zig-Zag order)
-		for (int i = 0; i < 64; i++)
-			_quant[tableId][i] = highPrecision ? _stream->readUint16BE() : _stream->readByte();
+		// Read the table (stored in Zig-Zag order), and fold in the scale
+		// factors of the IDCT
+		for (int i = 0; i < 64; i++) {
+			uint16 quant = highPrecision ? _stream->readUint16BE() : _stream->readByte();
+			_quant[tableId][i] = quant * g_jpegIDCTScales[_zigZagOrder[i]];
+		}
 	}
 
 	return true;
@@ -504,80 +578,30 @@ bool JPEG::readMCU(uint16 xMCU, uint16 yMCU) {
 	return ok;
 }
 
-void JPEG::idct8x8(float result[64], const int16 dct[64]) {
-	float tmp[64];
-
-	// Apply 1D IDCT to rows
-	for (int y = 0; y < 8; y++) {
-		for (int x = 0; x < 8; x++) {
-			tmp[y + x * 8] = dct[0] * _idct8x8[x][0]
-							+ dct[1] * _idct8x8[x][1]
-							+ dct[2] * _idct8x8[x][2]
-							+ dct[3] * _idct8x8[x][3]
-							+ dct[4] * _idct8x8[x][4]
-							+ dct[5] * _idct8x8[x][5]
-							+ dct[6] * _idct8x8[x][6]
-							+ dct[7] * _idct8x8[x][7];
-		}
-
-		dct += 8;
-	}
-
-	// Apply 1D IDCT to columns
-	for (int x = 0; x < 8; x++) {
-		const float *u = tmp + x * 8;
-		for (int y = 0; y < 8; y++) {
-			result[y * 8 + x] = u[0] * _idct8x8[y][0]
-								+ u[1] * _idct8x8[y][1]
-								+ u[2] * _idct8x8[y][2]
-								+ u[3] * _idct8x8[y][3]
-								+ u[4] * _idct8x8[y][4]
-								+ u[5] * _idct8x8[y][5]
-								+ u[6] * _idct8x8[y][6]
-								+ u[7] * _idct8x8[y][7];
-		}
-	}
+/**
+ * Dequantize a coefficient into the input of the IDCT, see
+ * kJPEGIDCTInputBits.
+ */
+static inline int16 dequantize(int16 value, uint32 quant) {
+	// Wrap around instead of overflowing on corrupt data
+	return (int16)((int32)((uint32)(int32)value * quant + (1 << 11)) >> 12);
 }
 
 bool JPEG::readDataUnit(uint16 x, uint16 y) {
-	// Prepare an empty data array
-	int16 readData[64];
-	for (int i = 1; i < 64; i++)
-		readData[i] = 0;
+	const uint32 *quant = _quant[_currentComp->quantTableSelector];
+	if (!quant) {
+		warning("JPEG: Missing quantization table");
+		return false;
+	}
 
 	// Read the DC component
-	readData[0] = _currentComp->DCpredictor + readDC();
-	_currentComp->DCpredictor = readData[0];
+	_currentComp->DCpredictor += readDC();
 
-	// Read the AC components (stored in Zig-Zag)
-	readAC(readData);
-
-	// Calculate the DCT coefficients from the input sequence
+	// Read the AC components, dequantized and in natural order
 	int16 DCT[64];
-	for (uint8 i = 0; i < 64; i++) {
-		// Dequantize
-		int16 val = readData[i];
-		int16 quant = _quant[_currentComp->quantTableSelector][i];
-		val *= quant;
-
-		// Store the normalized coefficients, undoing the Zig-Zag
-		DCT[_zigZagOrder[i]] = val;
-	}
-
-	// Apply the IDCT
-	float result[64];
-	idct8x8(result, DCT);
-
-	// Level shift to make the values unsigned
-	for (int i = 0; i < 64; i++) {
-		result[i] = result[i] + 128;
-
-		if (result[i] < 0)
-			result[i] = 0;
-
-		if (result[i] > 255)
-			result[i] = 255;
-	}
+	memset(DCT, 0, sizeof(DCT));
+	DCT[0] = dequantize(_currentComp->DCpredictor, quant[0]);
+	bool hasAC = readAC(DCT, quant);
 
 	// Paint the component surface
 	uint8 scalingV = _maxFactorV / _currentComp->factorV;
@@ -587,14 +611,35 @@ bool JPEG::readDataUnit(uint16 x, uint16 y) {
 	x <<= 3;
 	y <<= 3;
 
+	// Without subsampling, the IDCT can write to the surface directly
+	Surface &surface = _currentComp->surface;
+	if (scalingV == 1 && scalingH == 1) {
+		byte *ptr = (byte *)surface.getBasePtr(x, y);
+		if (hasAC) {
+			_idct->idct8x8(ptr, surface.pitch, DCT);
+		} else {
+			const byte value = jpegIDCTDCOnly(DCT[0]);
+			for (uint8 j = 0; j < 8; j++, ptr += surface.pitch)
+				memset(ptr, value, 8);
+		}
+		return true;
+	}
+
+	// Apply the IDCT
+	byte result[64];
+	if (hasAC)
+		_idct->idct8x8(result, 8, DCT);
+	else
+		memset(result, jpegIDCTDCOnly(DCT[0]), sizeof(result));
+
 	for (uint8 j = 0; j < 8; j++) {
 		for (uint16 sV = 0; sV < scalingV; sV++) {
 			// Get the beginning of the block line
-			byte *ptr = (byte *)_currentComp->surface.getBasePtr(x * scalingH, (y + j) * scalingV + sV);
+			byte *ptr = (byte *)surface.getBasePtr(x * scalingH, (y + j) * scalingV + sV);
 
 			for (uint8 i = 0; i < 8; i++) {
 				for (uint16 sH = 0; sH < scalingH; sH++) {
-					*ptr = (byte)(result[j * 8 + i]);
+					*ptr = result[j * 8 + i];
 					ptr++;
 				}
 			}
@@ -615,9 +660,10 @@ int16 JPEG::readDC() {
 	return readSignedBits(numBits);
 }
 
-void JPEG::readAC(int16 *out) {
+bool JPEG::readAC(int16 *out, const uint32 *quant) {
 	// AC is type 1
 	uint8 tableNum = (_currentComp->ACentropyTableSelector << 1) + 1;
+	bool hasAC = false;
 
 	// Start reading AC element 1
 	uint8 cur = 1;
@@ -637,87 +683,100 @@ void JPEG::readAC(int16 *out) {
 		} else {
 			// Skip r values
 			cur += r;
+			if (cur >= 64)
+				break;
 
-			// Read the next value
-			out[cur] = readSignedBits(s);
+			// Read the next value, undoing the Zig-Zag
+			int16 value = dequantize(readSignedBits(s), quant[cur]);
+			out[_zigZagOrder[cur]] = value;
+			hasAC |= (value != 0);
 			cur++;
 		}
 	}
+
+	return hasAC;
 }
 
 int16 JPEG::readSignedBits(uint8 numBits) {
-	uint16 ret = 0;
+	if (numBits == 0)
+		return 0;
 	if (numBits > 16) error("requested %d bits", numBits); //XXX
 
-	// MSB=0 for negatives, 1 for positives
-	for (int i = 0; i < numBits; i++)
-		ret = (ret << 1) + readBit();
+	if (_bitsNumber < numBits)
+		fillBits();
+	_bitsNumber -= numBits;
+	int32 ret = (_bitsData >> _bitsNumber) & ((1 << numBits) - 1);
 
-	// Extend sign bits (PAG109)
-	if (!(ret >> (numBits - 1)))
-	{
-		uint16 tmp = ((uint16)-1 << numBits) + 1;
-		ret = ret + tmp;
-	}
+	// MSB=0 for negatives, 1 for positives; extend sign bits (PAG109)
+	if (ret < (1 << (numBits - 1)))
+		ret -= (1 << numBits) - 1;
 	return ret;
 }
 
-// TODO: optimize?
 uint8 JPEG::readHuff(uint8 table) {
-	bool foundCode = false;
-	uint8 val = 0;
-
-	uint8 cur = 0;
-	uint8 codeSize = 1;
-	uint16 code = readBit();
-	while (!foundCode) {
-		// Prepare a code of the current size
-		while (codeSize < _huff[table].sizes[cur]) {
-			code = (code << 1) + readBit();
-			codeSize++;
-		}
+	const HuffmanTable &huff = _huff[table];
+	if (_bitsNumber < 16)
+		fillBits();
+
+	// Most codes are short enough for the lookup table
+	uint16 entry = huff.lookup[(_bitsData >> (_bitsNumber - JPEG_HUFF_LOOKUP_BITS)) & ((1 << JPEG_HUFF_LOOKUP_BITS) - 1)];
+	if (entry) {
+		_bitsNumber -= entry >> 8;
+		return entry & 0xFF;
+	}
 
-		// Compare the codes of the current size
-		while (!foundCode && (codeSize == _huff[table].sizes[cur])) {
-			if (code == _huff[table].codes[cur]) {
-				// Found the code
-				val = _huff[table].values[cur];
-				foundCode = true;
-			} else {
-				// Continue reading
-				cur++;
-			}
+	// Compare longer codes against the largest one of each size
+	for (int size = JPEG_HUFF_LOOKUP_BITS + 1; size <= 16; size++) {
+		int32 code = (_bitsData >> (_bitsNumber - size)) & ((1 << size) - 1);
+		if (code <= huff.maxCode[size]) {
+			_bitsNumber -= size;
+			return huff.values[huff.valueOffset[size] + code];
 		}
 	}
 
-	return val;
+	warning("JPEG: Invalid Huffman code");
+	_bitsNumber -= 16;
+	return 0;
 }
 
-uint8 JPEG::readBit() {
-	// Read a whole byte if necessary
-	if (_bitsNumber == 0) {
-		_bitsData = _stream->readByte();
-		_bitsNumber = 8;
-
-		// Detect markers
-		if (_bitsData == 0xFF) {
-			uint8 byte2 = _stream->readByte();
-
-			// A stuffed 0 validates the previous byte
-			if (byte2 != 0) {
-				if (byte2 == 0xDC) {
-					// DNL marker: Define Number of Lines
-					// TODO: terminate scan
-					warning("DNL marker detected: terminate scan");
-				} else {
-					warning("Error: marker 0x%02X read in entropy data", byte2);
+void JPEG::fillBits() {
+	// Keep at least 24 bits buffered, enough for the largest code
+	while (_bitsNumber <= 24) {
+		uint8 data = 0;
+
+		// Once a marker has been found, the entropy coded data is over and
+		// the rest of the bits are zero
+		if (!_bitsEnd) {
+			data = _stream->readByte();
+
+			// Detect markers
+			if (data == 0xFF) {
+				uint8 byte2 = _stream->readByte();
+
+				// A stuffed 0 validates the previous byte
+				if (byte2 != 0) {
+					if (byte2 == 0xDC) {
+						// DNL marker: Define Number of Lines
+						// TODO: terminate scan
+						warning("DNL marker detected: terminate scan");
+					}
+
+					// Leave the marker for read()
+					_stream->seek(-2, SEEK_CUR);
+					_bitsEnd = true;
+					data = 0;
 				}
 			}
+
+			if (_stream->eos()) {
+				_bitsEnd = true;
+				data = 0;
+			}
 		}
-	}
-	_bitsNumber--;
 
-	return (_bitsData & (1 << _bitsNumber)) ? 1 : 0;
+		_bitsData = (_bitsData << 8) | data;
+		_bitsNumber += 8;
+	}
 }
 
 Surface *JPEG::getComponent(uint c) {
@@ -32,9 +32,11 @@ class SeekableReadStream;
 namespace Graphics {
 
 struct PixelFormat;
+struct JPEGIDCTKernels;
 
 #define JPEG_MAX_QUANT_TABLES 4
 #define JPEG_MAX_HUFF_TABLES 2
+#define JPEG_HUFF_LOOKUP_BITS 9
 
 class JPEG {
 public:
@@ -42,6 +44,15 @@ public:
 	~JPEG();
 
 	bool read(Common::SeekableReadStream *str);
+
+	/**
+	 * Decode the image straight into the given surface, which has the same
+	 * requirements as for convertTo(). Each row of MCUs is converted as soon
+	 * as it is decoded, so only one row of the component planes is kept
+	 * instead of whole planes. Afterwards getComponent() and convertTo()
+	 * are not available.
+	 */
+	bool read(Common::SeekableReadStream *str, Surface *dst);
 	bool isLoaded() const { return _numComp && _w && _h; }
 	uint16 getWidth() const { return _w; }
 	uint16 getHeight() const { return _h; }
@@ -49,12 +60,25 @@ public:
 	Surface *getComponent(uint c);
 	Surface *getSurface(const PixelFormat &format);
 
+	/**
+	 * Convert the image to the format of the given surface, which has to
+	 * have at least 2 bytes per pixel and be at least as large as the
+	 * image. Unlike getSurface(), this does not allocate a new surface.
+	 */
+	bool convertTo(Surface *dst);
+
 private:
 	void reset();
+	bool canConvertTo(const Surface *dst) const;
+	void convertRows(Surface *dst, uint16 firstRow, uint16 numRows, uint16 planeRow);
 
 	Common::SeekableReadStream *_stream;
 	uint16 _w, _h;
 
+	// The surface read() decodes into, if any, and whether it is done
+	Surface *_output;
+	bool _outputDone;
+
 	// Image components
 	uint8 _numComp;
 	struct Component {
@@ -84,17 +108,29 @@ private:
 	uint8 _maxFactorV;
 	uint8 _maxFactorH;
 
-	// Quantization tables
-	uint16 *_quant[JPEG_MAX_QUANT_TABLES];
+	// Quantization tables (in Zig-Zag order), premultiplied by the scale
+	// factors of the IDCT
+	uint32 *_quant[JPEG_MAX_QUANT_TABLES];
 
 	// Huffman tables
 	struct HuffmanTable {
-		uint8 count;
+		uint16 count;
 		uint8 *values;
-		uint8 *sizes;
-		uint16 *codes;
+
+		// Codes of up to JPEG_HUFF_LOOKUP_BITS bits, indexed by the next
+		// bits of the stream: the code size in the high byte and the value
+		// in the low byte, or 0 for longer codes
+		uint16 lookup[1 << JPEG_HUFF_LOOKUP_BITS];
+
+		// For each code size, the largest code (-1 if there is none) and
+		// the offset from a code to the index of its value
+		int32 maxCode[17];
+		int32 valueOffset[17];
 	} _huff[2 * JPEG_MAX_HUFF_TABLES];
 
+	// The IDCT used for the current scan
+	const JPEGIDCTKernels *_idct;
+
 	// Marker read functions
 	bool readJFIF();
 	bool readSOF0();
@@ -106,17 +142,15 @@ private:
 	bool readMCU(uint16 xMCU, uint16 yMCU);
 	bool readDataUnit(uint16 x, uint16 y);
 	int16 readDC();
-	void readAC(int16 *out);
+	bool readAC(int16 *out, const uint32 *quant);
 	int16 readSignedBits(uint8 numBits);
 
 	// Huffman decoding
 	uint8 readHuff(uint8 table);
-	uint8 readBit();
-	uint8 _bitsData;
+	void fillBits();
+	uint32 _bitsData;
 	uint8 _bitsNumber;
-
-	// Inverse Discrete Cosine Transformation
-	void idct8x8(float dst[64], const int16 src[64]);
+	bool _bitsEnd;
 };
 
 } // End of Graphics namespace
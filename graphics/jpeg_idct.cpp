@@ -0,0 +1,159 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/jpeg_idct.h"
+
+namespace Graphics {
+
+const uint16 g_jpegIDCTScales[64] = {
+	16384, 22725, 21407, 19266, 16384, 12873,  8867,  4520,
+	22725, 31521, 29692, 26722, 22725, 17855, 12299,  6270,
+	21407, 29692, 27969, 25172, 21407, 16819, 11585,  5906,
+	19266, 26722, 25172, 22654, 19266, 15137, 10426,  5315,
+	16384, 22725, 21407, 19266, 16384, 12873,  8867,  4520,
+	12873, 17855, 16819, 15137, 12873, 10114,  6967,  3552,
+	 8867, 12299, 11585, 10426,  8867,  6967,  4799,  2446,
+	 4520,  6270,  5906,  5315,  4520,  3552,  2446,  1247
+};
+
+/**
+ * The high half of the product, as the SIMD multiply instructions give it.
+ * The factors of the AAN algorithm are split into an integer part, which
+ * is done with additions, and a fraction of 65536 in [-0.5, 0.5).
+ */
+static inline int16 mulHigh(int16 x, int16 fraction) {
+	return (int16)(((int32)x * fraction) >> 16);
+}
+
+enum {
+	kFix0_414 = 27146,  ///< 1.414213562 - 1
+	kFix1_848 = -9977,  ///< 1.847759065 - 2
+	kFix1_082 = 5400,   ///< 1.082392200 - 1
+	kFix2_613 = -25354  ///< 2.613125930 - 3
+};
+
+/**
+ * One dimensional IDCT of the eight values at in[0], in[stride], ... into
+ * out[0], out[stride], ... All sums wrap around in 16 bits, like they do
+ * in the SIMD kernels.
+ */
+static inline void idct1D(int16 *out, const int16 *in, int stride) {
+	// Even part
+	const int16 tmp10 = in[0] + in[4 * stride];
+	const int16 tmp11 = in[0] - in[4 * stride];
+	const int16 tmp13 = in[2 * stride] + in[6 * stride];
+	const int16 d26 = in[2 * stride] - in[6 * stride];
+	const int16 tmp12 = (int16)(d26 + mulHigh(d26, kFix0_414)) - tmp13;
+
+	const int16 even0 = tmp10 + tmp13;
+	const int16 even3 = tmp10 - tmp13;
+	const int16 even1 = tmp11 + tmp12;
+	const int16 even2 = tmp11 - tmp12;
+
+	// Odd part
+	const int16 z13 = in[5 * stride] + in[3 * stride];
+	const int16 z10 = in[5 * stride] - in[3 * stride];
+	const int16 z11 = in[1 * stride] + in[7 * stride];
+	const int16 z12 = in[1 * stride] - in[7 * stride];
+
+	const int16 odd7 = z11 + z13;
+	const int16 z1113 = z11 - z13;
+	const int16 odd11 = z1113 + mulHigh(z1113, kFix0_414);
+	const int16 z1012 = z10 + z12;
+	const int16 z5 = (int16)(z1012 + z1012) + mulHigh(z1012, kFix1_848);
+	const int16 odd10 = (int16)(z12 + mulHigh(z12, kFix1_082)) - z5;
+	const int16 odd12 = z5 - (int16)((int16)(z10 + z10 + z10) + mulHigh(z10, kFix2_613));
+
+	const int16 odd6 = odd12 - odd7;
+	const int16 odd5 = odd11 - odd6;
+	const int16 odd4 = odd10 + odd5;
+
+	out[0 * stride] = even0 + odd7;
+	out[7 * stride] = even0 - odd7;
+	out[1 * stride] = even1 + odd6;
+	out[6 * stride] = even1 - odd6;
+	out[2 * stride] = even2 + odd5;
+	out[5 * stride] = even2 - odd5;
+	out[4 * stride] = even3 + odd4;
+	out[3 * stride] = even3 - odd4;
+}
+
+static void idct8x8(byte *dst, int pitch, const int16 *coeffs) {
+	int16 workspace[64];
+
+	// Columns. Without AC coefficients, all outputs equal the DC one.
+	for (int x = 0; x < 8; x++) {
+		const int16 *in = coeffs + x;
+		if (!(in[8] | in[16] | in[24] | in[32] | in[40] | in[48] | in[56])) {
+			for (int y = 0; y < 8; y++)
+				workspace[y * 8 + x] = in[0];
+		} else {
+			idct1D(workspace + x, in, 8);
+		}
+	}
+
+	// Rows
+	for (int y = 0; y < 8; y++, dst += pitch) {
+		int16 *row = workspace + y * 8;
+		row[0] += kJPEGIDCTBias;
+
+		int16 out[8];
+		idct1D(out, row, 1);
+
+		for (int x = 0; x < 8; x++) {
+			const int16 v = out[x] >> (kJPEGIDCTInputBits + 3);
+			dst[x] = v < 0 ? 0 : (v > 255 ? 255 : v);
+		}
+	}
+}
+
+static const JPEGIDCTKernels s_jpegIDCTKernelsScalar = {
+	idct8x8
+};
+
+const JPEGIDCTKernels &getScalarJPEGIDCTKernels() {
+	return s_jpegIDCTKernelsScalar;
+}
+
+const JPEGIDCTKernels *getJPEGIDCTKernels(Common::CPUFeature feature) {
+	if (!Common::hasCPUFeature(feature))
+		return 0;
+
+	switch (feature) {
+#ifdef USE_X86_SIMD
+	case Common::kCPUFeatureSSE2:
+		return &g_jpegIDCTKernelsSSE2;
+#endif
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+const JPEGIDCTKernels &getJPEGIDCTKernels() {
+	const JPEGIDCTKernels *kernels = getJPEGIDCTKernels(Common::kCPUFeatureSSE2);
+	return kernels ? *kernels : s_jpegIDCTKernelsScalar;
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,101 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef GRAPHICS_JPEG_IDCT_H
+#define GRAPHICS_JPEG_IDCT_H
+
+#include "common/scummsys.h"
+#include "common/cpudetect.h"
+
+namespace Graphics {
+
+/**
+ * The scale factors of the AAN (Arai, Agui, Nakajima) IDCT in 2.14 fixed
+ * point, in natural order: the coefficient (u, v) has to be multiplied by
+ * cos(u * pi / 16) * cos(v * pi / 16) * 2 (with 1 / sqrt(2) for u, v = 0)
+ * before the transform. JPEG folds them into the quantization tables.
+ */
+extern const uint16 g_jpegIDCTScales[64];
+
+enum {
+	/**
+	 * The number of fractional bits of the coefficients the IDCT kernels
+	 * take, i.e. the result of (coefficient * quantizer * scale) >> 12.
+	 */
+	kJPEGIDCTInputBits = 2,
+
+	/**
+	 * Added to the DC term of the second pass: rounding for the final
+	 * shift by kJPEGIDCTInputBits + 3, and the level shift by 128.
+	 */
+	kJPEGIDCTBias = (1 << (kJPEGIDCTInputBits + 2)) + (128 << (kJPEGIDCTInputBits + 3))
+};
+
+/**
+ * The sample value of all pixels of a block which only has a DC
+ * coefficient, the same as what the IDCT kernels produce for it.
+ */
+static inline byte jpegIDCTDCOnly(int16 dc) {
+	const int16 v = (int16)(dc + kJPEGIDCTBias) >> (kJPEGIDCTInputBits + 3);
+	return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+/**
+ * The integer IDCT used by the JPEG decoder. It is the AAN algorithm with
+ * all intermediate values in 16 bits, the multiplications keeping the
+ * high half of the 32 bit product, so that SIMD versions can produce the
+ * same results. Compared to an exact floating point IDCT, the samples are
+ * off by at most one for the coefficients of real images.
+ */
+struct JPEGIDCTKernels {
+	/**
+	 * Transform the scaled coefficients of one block, given in natural
+	 * order, and store the 8x8 clamped samples at dst.
+	 */
+	void (*idct8x8)(byte *dst, int pitch, const int16 *coeffs);
+};
+
+/**
+ * Return the kernels for the given instruction set extension, or 0 if the
+ * build or the host CPU does not support them.
+ */
+const JPEGIDCTKernels *getJPEGIDCTKernels(Common::CPUFeature feature);
+
+/**
+ * Return the fastest kernels the host CPU supports.
+ */
+const JPEGIDCTKernels &getJPEGIDCTKernels();
+
+/**
+ * Return the generic C++ kernels.
+ */
+const JPEGIDCTKernels &getScalarJPEGIDCTKernels();
+
+#ifdef USE_X86_SIMD
+// Implemented in jpeg_idct_x86.cpp
+extern const JPEGIDCTKernels g_jpegIDCTKernelsSSE2;
+#endif
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,146 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/jpeg_idct.h"
+
+#ifdef USE_X86_SIMD
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+// The functions in this file are compiled for the instruction set given in
+// their target attribute, independent of the flags used for the rest of
+// the build. getJPEGIDCTKernels() only picks them if the CPU supports it.
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+
+/**
+ * The same one dimensional IDCT as idct1D() in jpeg_idct.cpp, applied to
+ * each of the eight lanes of v[0] to v[7].
+ */
+static inline SSE2_TARGET void idct1DSSE2(__m128i *v) {
+	const __m128i fix0_414 = _mm_set1_epi16(27146);
+	const __m128i fix1_848 = _mm_set1_epi16(-9977);
+	const __m128i fix1_082 = _mm_set1_epi16(5400);
+	const __m128i fix2_613 = _mm_set1_epi16(-25354);
+
+	// Even part
+	const __m128i tmp10 = _mm_add_epi16(v[0], v[4]);
+	const __m128i tmp11 = _mm_sub_epi16(v[0], v[4]);
+	const __m128i tmp13 = _mm_add_epi16(v[2], v[6]);
+	const __m128i d26 = _mm_sub_epi16(v[2], v[6]);
+	const __m128i tmp12 = _mm_sub_epi16(_mm_add_epi16(d26, _mm_mulhi_epi16(d26, fix0_414)), tmp13);
+
+	const __m128i even0 = _mm_add_epi16(tmp10, tmp13);
+	const __m128i even3 = _mm_sub_epi16(tmp10, tmp13);
+	const __m128i even1 = _mm_add_epi16(tmp11, tmp12);
+	const __m128i even2 = _mm_sub_epi16(tmp11, tmp12);
+
+	// Odd part
+	const __m128i z13 = _mm_add_epi16(v[5], v[3]);
+	const __m128i z10 = _mm_sub_epi16(v[5], v[3]);
+	const __m128i z11 = _mm_add_epi16(v[1], v[7]);
+	const __m128i z12 = _mm_sub_epi16(v[1], v[7]);
+
+	const __m128i odd7 = _mm_add_epi16(z11, z13);
+	const __m128i z1113 = _mm_sub_epi16(z11, z13);
+	const __m128i odd11 = _mm_add_epi16(z1113, _mm_mulhi_epi16(z1113, fix0_414));
+	const __m128i z1012 = _mm_add_epi16(z10, z12);
+	const __m128i z5 = _mm_add_epi16(_mm_add_epi16(z1012, z1012), _mm_mulhi_epi16(z1012, fix1_848));
+	const __m128i odd10 = _mm_sub_epi16(_mm_add_epi16(z12, _mm_mulhi_epi16(z12, fix1_082)), z5);
+	const __m128i z10x3 = _mm_add_epi16(_mm_add_epi16(z10, z10), z10);
+	const __m128i odd12 = _mm_sub_epi16(z5, _mm_add_epi16(z10x3, _mm_mulhi_epi16(z10, fix2_613)));
+
+	const __m128i odd6 = _mm_sub_epi16(odd12, odd7);
+	const __m128i odd5 = _mm_sub_epi16(odd11, odd6);
+	const __m128i odd4 = _mm_add_epi16(odd10, odd5);
+
+	v[0] = _mm_add_epi16(even0, odd7);
+	v[7] = _mm_sub_epi16(even0, odd7);
+	v[1] = _mm_add_epi16(even1, odd6);
+	v[6] = _mm_sub_epi16(even1, odd6);
+	v[2] = _mm_add_epi16(even2, odd5);
+	v[5] = _mm_sub_epi16(even2, odd5);
+	v[4] = _mm_add_epi16(even3, odd4);
+	v[3] = _mm_sub_epi16(even3, odd4);
+}
+
+/** Transpose the 8x8 matrix of 16 bit values in v[0] to v[7]. */
+static inline SSE2_TARGET void transposeSSE2(__m128i *v) {
+	const __m128i a0 = _mm_unpacklo_epi16(v[0], v[1]);
+	const __m128i a1 = _mm_unpackhi_epi16(v[0], v[1]);
+	const __m128i a2 = _mm_unpacklo_epi16(v[2], v[3]);
+	const __m128i a3 = _mm_unpackhi_epi16(v[2], v[3]);
+	const __m128i a4 = _mm_unpacklo_epi16(v[4], v[5]);
+	const __m128i a5 = _mm_unpackhi_epi16(v[4], v[5]);
+	const __m128i a6 = _mm_unpacklo_epi16(v[6], v[7]);
+	const __m128i a7 = _mm_unpackhi_epi16(v[6], v[7]);
+
+	const __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+	const __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+	const __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+	const __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+	const __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+	const __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+	const __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+	const __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+	v[0] = _mm_unpacklo_epi64(b0, b4);
+	v[1] = _mm_unpackhi_epi64(b0, b4);
+	v[2] = _mm_unpacklo_epi64(b1, b5);
+	v[3] = _mm_unpackhi_epi64(b1, b5);
+	v[4] = _mm_unpacklo_epi64(b2, b6);
+	v[5] = _mm_unpackhi_epi64(b2, b6);
+	v[6] = _mm_unpacklo_epi64(b3, b7);
+	v[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+static SSE2_TARGET void idct8x8SSE2(byte *dst, int pitch, const int16 *coeffs) {
+	__m128i v[8];
+	for (int i = 0; i < 8; i++)
+		v[i] = _mm_loadu_si128((const __m128i *)(coeffs + 8 * i));
+
+	// Columns: each vector is a row, so the lanes are the columns
+	idct1DSSE2(v);
+
+	// Rows, on the transposed matrix
+	transposeSSE2(v);
+	v[0] = _mm_add_epi16(v[0], _mm_set1_epi16(kJPEGIDCTBias));
+	idct1DSSE2(v);
+	transposeSSE2(v);
+
+	for (int i = 0; i < 8; i += 2, dst += 2 * pitch) {
+		const __m128i rows = _mm_packus_epi16(_mm_srai_epi16(v[i], kJPEGIDCTInputBits + 3), _mm_srai_epi16(v[i + 1], kJPEGIDCTInputBits + 3));
+		_mm_storel_epi64((__m128i *)dst, rows);
+		_mm_storel_epi64((__m128i *)(dst + pitch), _mm_unpackhi_epi64(rows, rows));
+	}
+}
+
+const JPEGIDCTKernels g_jpegIDCTKernelsSSE2 = {
+	idct8x8SSE2
+};
+
+} // End of namespace Graphics
+
+#endif // #ifdef USE_X86_SIMD
@@ -3,7 +3,9 @@ MODULE := graphics
 MODULE_OBJS := \
 	conversion.o \
 	cursorman.o \
+	damagetracker.o \
 	font.o \
+	fontcache.o \
 	fontman.o \
 	fonts/bdf.o \
 	fonts/consolefont.o \
@@ -13,9 +15,11 @@ MODULE_OBJS := \
 	iff.o \
 	imagedec.o \
 	jpeg.o \
+	jpeg_idct.o \
 	maccursor.o \
 	pict.o \
 	png.o \
+	png_filters.o \
 	primitives.o \
 	scaler.o \
 	scaler/thumbnail_intern.o \
@@ -27,15 +31,35 @@ MODULE_OBJS := \
 	wincursor.o \
 	yuv_to_rgb.o
 
+ifdef USE_X86_SIMD
+MODULE_OBJS += \
+	conversion_kernels_x86.o \
+	fontcache_x86.o \
+	jpeg_idct_x86.o \
+	png_filters_x86.o \
+	yuv_to_rgb_x86.o
+endif
+
+ifdef USE_NEON
+MODULE_OBJS += \
+	yuv_to_rgb_neon.o
+endif
+
 ifdef USE_SCALERS
 MODULE_OBJS += \
 	scaler/2xsai.o \
 	scaler/aspect.o \
 	scaler/downscaler.o \
+	scaler/kernels.o \
 	scaler/scale2x.o \
 	scaler/scale3x.o \
 	scaler/scalebit.o
 
+ifdef USE_X86_SIMD
+MODULE_OBJS += \
+	scaler/kernels_x86.o
+endif
+
 ifdef USE_ARM_SCALER_ASM
 MODULE_OBJS += \
 	scaler/downscalerARM.o \
@@ -24,7 +24,9 @@
 
 #ifdef GRAPHICS_PNG_H
 
+#include "graphics/conversion.h"
 #include "graphics/pixelformat.h"
+#include "graphics/png_filters.h"
 #include "graphics/surface.h"
 
 #include "common/endian.h"
@@ -100,11 +102,100 @@ enum PNGFilters {
 	kFilterPaeth   = 4
 };
 
-PNG::PNG() : _compressedBuffer(0), _compressedBufferSize(0),
-			_unfilteredSurface(0), _transparentColorSpecified(false) {
+/**
+ * The contents of consecutive IDAT chunks, which together form the zlib
+ * stream of the image data. The chunks are read from the file stream on
+ * demand, so that the image can be inflated one row at a time.
+ */
+class IDATReadStream : public Common::SeekableReadStream {
+public:
+	IDATReadStream(Common::SeekableReadStream *stream, int32 start, uint32 size) :
+		_stream(stream), _start(start), _size(size) {
+		rewind();
+	}
+
+	bool err() const { return _stream->err(); }
+	bool eos() const { return _eos; }
+	int32 pos() const { return _pos; }
+	int32 size() const { return _size; }
+
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		byte *dst = (byte *)dataPtr;
+		uint32 total = 0;
+
+		while (total < dataSize && !_eos) {
+			if (_chunkLeft == 0 && !nextChunk()) {
+				_eos = true;
+				break;
+			}
+
+			const uint32 n = _stream->read(dst + total, MIN(_chunkLeft, dataSize - total));
+			if (n == 0) {
+				_eos = true;
+				break;
+			}
+
+			_chunkLeft -= n;
+			total += n;
+		}
+
+		_pos += total;
+		return total;
+	}
+
+	bool seek(int32 offset, int whence = SEEK_SET) {
+		int32 newPos = offset;
+		if (whence == SEEK_CUR)
+			newPos += _pos;
+		else if (whence == SEEK_END)
+			newPos += _size;
+
+		if (newPos < _pos)
+			rewind();
+
+		// Seeking forward has to walk through the chunks
+		byte buffer[256];
+		while (_pos < newPos && !_eos)
+			read(buffer, MIN<int32>(sizeof(buffer), newPos - _pos));
+
+		_eos = false;
+		return !err();
+	}
+
+private:
+	Common::SeekableReadStream *_stream;
+	int32 _start;
+	uint32 _size;
+
+	int32 _pos;
+	uint32 _chunkLeft;
+	bool _eos;
+
+	void rewind() {
+		_stream->seek(_start);
+		_chunkLeft = _stream->readUint32BE();
+		_stream->skip(4);	// chunk type
+		_pos = 0;
+		_eos = false;
+	}
+
+	bool nextChunk() {
+		_stream->skip(4);	// skip the chunk CRC checksum
+		_chunkLeft = _stream->readUint32BE();
+		const uint32 chunkType = _stream->readUint32BE();
+		return !_stream->eos() && chunkType == kChunkIDAT;
+	}
+};
+
+PNG::PNG() : _stream(0), _imageDataStart(-1), _imageDataSize(0), _paletteEntries(0),
+			_transparentColorSpecified(false), _unfilteredSurface(0) {
+	memset(&_header, 0, sizeof(_header));
+	memset(_palette, 0, sizeof(_palette));
 }
 
 PNG::~PNG() {
+	delete _stream;
+
 	if (_unfilteredSurface) {
 		_unfilteredSurface->free();
 		delete _unfilteredSurface;
@@ -112,109 +203,52 @@ PNG::~PNG() {
 }
 
 Graphics::Surface *PNG::getSurface(const PixelFormat &format) {
+	if (format.bytesPerPixel != 2 && format.bytesPerPixel != 4) {
+		warning("PNG: Unsupported output format with %d bytes per pixel", format.bytesPerPixel);
+		return 0;
+	}
+
 	Graphics::Surface *output = new Graphics::Surface();
-	output->create(_unfilteredSurface->w, _unfilteredSurface->h, format);
-	byte *src = (byte *)_unfilteredSurface->pixels;
-	byte a = 0xFF;
-	byte bpp = _unfilteredSurface->format.bytesPerPixel;
-
-	if (_header.colorType != kIndexed) {
-		if (_header.colorType == kTrueColor || 
-			_header.colorType == kTrueColorWithAlpha) {
-			if (bpp != 3 && bpp != 4)
-				error("Unsupported truecolor PNG format");
-		} else if (_header.colorType == kGrayScale ||
-				   _header.colorType == kGrayScaleWithAlpha) {
-			if (bpp != 1 && bpp != 2)
-				error("Unsupported grayscale PNG format");
-		}
+	output->create(_header.width, _header.height, format);
+	constructImage(output);
 
-		for (uint16 i = 0; i < output->h; i++) {
-			for (uint16 j = 0; j < output->w; j++) {
-				uint32 result = 0;
-
-				switch (bpp) {
-				case 1:	// Grayscale
-					if (_transparentColorSpecified)
-						a = (src[0] == _transparentColor[0]) ? 0 : 0xFF;
-					result = format.ARGBToColor(    a, src[0], src[0], src[0]);
-					break;
-				case 2: // Grayscale + alpha
-					result = format.ARGBToColor(src[1], src[0], src[0], src[0]);
-					break;
-				case 3: // RGB
-					if (_transparentColorSpecified) {
-						bool isTransparentColor = (src[0] == _transparentColor[0] &&
-												   src[1] == _transparentColor[1] &&
-												   src[2] == _transparentColor[2]);
-						a = isTransparentColor ? 0 : 0xFF;
-					}
-					result = format.ARGBToColor(     a, src[0], src[1], src[2]);
-					break;
-				case 4: // RGBA
-					result = format.ARGBToColor(src[3], src[0], src[1], src[2]);
-					break;
-				}
-
-				if (format.bytesPerPixel == 2) 	// 2bpp
-					*((uint16 *)output->getBasePtr(j, i)) = (uint16)result;
-				else	// 4bpp
-					*((uint32 *)output->getBasePtr(j, i)) = result;
-
-				src += bpp;
-			}
-		}
-	} else {
-		byte index, r, g, b;
-		uint32 mask = (0xff >> (8 - _header.bitDepth)) << (8 - _header.bitDepth);
-
-		// Convert the indexed surface to the target pixel format
-		for (uint16 i = 0; i < output->h; i++) {
-			int data = 0;
-			int bitCount = 8;
-			byte *src1 = src;
-
-			for (uint16 j = 0; j < output->w; j++) {
-				if (bitCount == 8) {
-					data = *src;
-					src++;
-				}
-
-				index = (data & mask) >> (8 - _header.bitDepth);
-				data = (data << _header.bitDepth) & 0xff;
-				bitCount -= _header.bitDepth;
-
-				if (bitCount == 0)
-					bitCount = 8;
-
-				r = _palette[index * 4 + 0];
-				g = _palette[index * 4 + 1];
-				b = _palette[index * 4 + 2];
-				a = _palette[index * 4 + 3];
-
-				if (format.bytesPerPixel == 2)
-					*((uint16 *)output->getBasePtr(j, i)) = format.ARGBToColor(a, r, g, b);
-				else
-					*((uint32 *)output->getBasePtr(j, i)) = format.ARGBToColor(a, r, g, b);
-			}
-			src = src1 + output->w;
-		}
+	return output;
+}
+
+Graphics::Surface *PNG::getIndexedSurface() {
+	if (_header.colorType != kIndexed)
+		error("Indexed surface requested for a non-indexed PNG");
+
+	if (!_unfilteredSurface) {
+		_unfilteredSurface = new Graphics::Surface();
+		// TODO/FIXME: It seems we can not properly determine the format here. But maybe there is a way...
+		_unfilteredSurface->create(_header.width, _header.height, PixelFormat((getNumColorChannels() * _header.bitDepth + 7) / 8, 0, 0, 0, 0, 0, 0, 0, 0));
+		constructImage(_unfilteredSurface);
 	}
 
-	return output;
+	return _unfilteredSurface;
 }
 
 bool PNG::read(Common::SeekableReadStream *str) {
 	uint32 chunkLength = 0, chunkType = 0;
-	_stream = str;
 
-	// First, check the PNG signature
-	if (_stream->readUint32BE() != MKTAG(0x89, 0x50, 0x4e, 0x47)) {
+	// Forget about any previously read image
+	if (_stream != str)
 		delete _stream;
-		return false;
+	_stream = str;
+	_imageDataStart = -1;
+	_imageDataSize = 0;
+	if (_unfilteredSurface) {
+		_unfilteredSurface->free();
+		delete _unfilteredSurface;
+		_unfilteredSurface = 0;
 	}
-	if (_stream->readUint32BE() != MKTAG(0x0d, 0x0a, 0x1a, 0x0a)) {
+
+	// First, check the PNG signature
+	if (_stream->readUint32BE() != MKTAG(0x89, 0x50, 0x4e, 0x47) ||
+		_stream->readUint32BE() != MKTAG(0x0d, 0x0a, 0x1a, 0x0a)) {
 		delete _stream;
+		_stream = 0;
 		return false;
 	}
 
@@ -229,22 +263,12 @@ bool PNG::read(Common::SeekableReadStream *str) {
 			readHeaderChunk();
 			break;
 		case kChunkIDAT:
-			if (_compressedBufferSize == 0) {
-				_compressedBufferSize += chunkLength;
-				_compressedBuffer = (byte *)malloc(_compressedBufferSize);
-				_stream->read(_compressedBuffer, chunkLength);
-			} else {
-				// Expand the buffer
-				uint32 prevSize = _compressedBufferSize;
-				_compressedBufferSize += chunkLength;
-				byte *tmp = new byte[prevSize];
-				memcpy(tmp, _compressedBuffer, prevSize);
-				free(_compressedBuffer);
-				_compressedBuffer = (byte *)malloc(_compressedBufferSize);
-				memcpy(_compressedBuffer, tmp, prevSize);
-				delete[] tmp;
-				_stream->read(_compressedBuffer + prevSize, chunkLength);
-			}
+			// The image data is only inflated when the image is requested,
+			// straight from the chunks
+			if (_imageDataStart < 0)
+				_imageDataStart = _stream->pos() - 8;
+			_imageDataSize += chunkLength;
+			_stream->skip(chunkLength);
 			break;
 		case kChunkPLTE:	// only available in indexed PNGs
 			if (_header.colorType != kIndexed)
@@ -268,149 +292,174 @@ bool PNG::read(Common::SeekableReadStream *str) {
 
 		if (chunkType != kChunkIEND)
 			_stream->skip(4);	// skip the chunk CRC checksum
-	}
-
-	// We no longer need the file stream, thus close it here
-	delete _stream;
-	_stream = 0;
 
-	// Unpack the compressed buffer
-	Common::MemoryReadStream *compData = new Common::MemoryReadStream(_compressedBuffer, _compressedBufferSize, DisposeAfterUse::YES);
-	_imageData = Common::wrapCompressedReadStream(compData);
-
-	// Construct the final image
-	constructImage();
+		if (_stream->eos()) {
+			warning("PNG: Missing IEND chunk");
+			break;
+		}
+	}
 
-	// Close the uncompressed stream, which will also delete the memory stream,
-	// and thus the original compressed buffer
-	delete _imageData;
+	return _imageDataStart >= 0;
+}
 
-	return true;
+void PNG::buildColorMap(uint32 *map, const PixelFormat &format) {
+	if (_header.colorType == kIndexed) {
+		for (int i = 0; i < 256; i++)
+			map[i] = format.ARGBToColor(_palette[i * 4 + 3], _palette[i * 4 + 0], _palette[i * 4 + 1], _palette[i * 4 + 2]);
+	} else if (_header.colorType == kGrayScale) {
+		// Samples of less than 8 bits are scaled to the full range
+		const int maxValue = (1 << _header.bitDepth) - 1;
+		for (int i = 0; i <= maxValue; i++) {
+			const byte gray = i * 255 / maxValue;
+			const byte a = (_transparentColorSpecified && _transparentColor[0] == i) ? 0 : 0xFF;
+			map[i] = format.ARGBToColor(a, gray, gray, gray);
+		}
+	}
 }
 
-/**
- * Paeth predictor, used by PNG filter type 4
- * The parameters are of signed 16-bit integers, but should come
- * from unsigned chars. The integers  are only needed to make
- * the paeth calculation correct.
- *
- * Taken from lodePNG, with a slight patch:
- * http://www.atalasoft.com/cs/blogs/stevehawley/archive/2010/02/23/libpng-you-re-doing-it-wrong.aspx
- */
-byte PNG::paethPredictor(int16 a, int16 b, int16 c) {
-  int16 pa = ABS<int16>(b - c);
-  int16 pb = ABS<int16>(a - c);
-  int16 pc = ABS<int16>(a + b - c - c);
-
-  if (pa <= MIN<int16>(pb, pc))
-	  return (byte)a;
-  else if (pb <= pc)
-	  return (byte)b;
-  else
-	  return (byte)c;
+static inline void writePixel(byte *dest, uint32 x, uint32 color, byte bytesPerPixel) {
+	if (bytesPerPixel == 2)
+		((uint16 *)dest)[x] = color;
+	else
+		((uint32 *)dest)[x] = color;
 }
 
 /**
- * Unfilters a filtered PNG scan line.
- * PNG filters are defined in: http://www.w3.org/TR/PNG/#9Filters
- * Note that filters are always applied to bytes
- *
- * Taken from lodePNG
+ * Converts an unfiltered scan line to the given pixel format. Indexed and
+ * grayscale images go through the color map; samples of less than 8 bits
+ * are unpacked into indices first.
  */
-void PNG::unfilterScanLine(byte *dest, const byte *scanLine, const byte *prevLine, uint16 byteWidth, byte filterType, uint16 length) {
-	uint16 i;
+void PNG::convertScanLine(byte *dest, const byte *scanLine, byte *indices, const PixelFormat &format, const uint32 *map) {
+	const uint32 width = _header.width;
+	const byte bytesPerPixel = format.bytesPerPixel;
+	const byte *src = scanLine;
 
-	switch (filterType) {
-	case kFilterNone:		// no change
-		for (i = 0; i < length; i++)
-			dest[i] = scanLine[i];
-		break;
-	case kFilterSub:		// add the bytes to the left
-		for (i = 0; i < byteWidth; i++)
-			dest[i] = scanLine[i];
-		for (i = byteWidth; i < length; i++)
-			dest[i] = scanLine[i] + dest[i - byteWidth];
-		break;
-	case kFilterUp:			// add the bytes of the above scanline
-		if (prevLine) {
-			for (i = 0; i < length; i++)
-				dest[i] = scanLine[i] + prevLine[i];
-		} else {
-			for (i = 0; i < length; i++)
-				dest[i] = scanLine[i];
+	switch (_header.colorType) {
+	case kIndexed:
+	case kGrayScale:
+		if (_header.bitDepth < 8) {
+			// The leftmost pixel is in the high order bits
+			const byte depth = _header.bitDepth;
+			const byte mask = (1 << depth) - 1;
+			for (uint32 x = 0; x < width; x++) {
+				const uint32 bit = x * depth;
+				indices[x] = (scanLine[bit >> 3] >> (8 - depth - (bit & 7))) & mask;
+			}
+			src = indices;
 		}
+		crossBlitMap(dest, src, width * bytesPerPixel, width, width, 1, bytesPerPixel, map);
 		break;
-	case kFilterAverage:	// average value of the left and top left
-		if (prevLine) {
-			for (i = 0; i < byteWidth; i++)
-				dest[i] = scanLine[i] + prevLine[i] / 2;
-			for (i = byteWidth; i < length; i++)
-				dest[i] = scanLine[i] + ((dest[i - byteWidth] + prevLine[i]) / 2);
-		} else {
-			for (i = 0; i < byteWidth; i++)
-				dest[i] = scanLine[i];
-			for (i = byteWidth; i < length; i++)
-				dest[i] = scanLine[i] + dest[i - byteWidth] / 2;
+	case kGrayScaleWithAlpha:
+		for (uint32 x = 0; x < width; x++, src += 2)
+			writePixel(dest, x, format.ARGBToColor(src[1], src[0], src[0], src[0]), bytesPerPixel);
+		break;
+	case kTrueColor:
+		for (uint32 x = 0; x < width; x++, src += 3) {
+			byte a = 0xFF;
+			if (_transparentColorSpecified) {
+				bool isTransparentColor = (src[0] == _transparentColor[0] &&
+										   src[1] == _transparentColor[1] &&
+										   src[2] == _transparentColor[2]);
+				a = isTransparentColor ? 0 : 0xFF;
+			}
+			writePixel(dest, x, format.ARGBToColor(a, src[0], src[1], src[2]), bytesPerPixel);
 		}
 		break;
-	case kFilterPaeth:		// Paeth filter: http://www.w3.org/TR/PNG/#9Filter-type-4-Paeth
-		if (prevLine) {
-			for(i = 0; i < byteWidth; i++)
-				dest[i] = (scanLine[i] + prevLine[i]); // paethPredictor(0, prevLine[i], 0) is always prevLine[i]
-			for(i = byteWidth; i < length; i++)
-				dest[i] = (scanLine[i] + paethPredictor(dest[i - byteWidth], prevLine[i], prevLine[i - byteWidth]));
+	case kTrueColorWithAlpha:
+		if (bytesPerPixel == 4) {
+			// The bytes of each pixel as one 32 bit value, which crossBlit
+			// can swizzle with SIMD code
+#ifdef SCUMM_BIG_ENDIAN
+			static const PixelFormat rgbaFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
+#else
+			static const PixelFormat rgbaFormat(4, 8, 8, 8, 8, 0, 8, 16, 24);
+#endif
+			crossBlit(dest, scanLine, width * 4, width * 4, width, 1, format, rgbaFormat);
 		} else {
-			for(i = 0; i < byteWidth; i++)
-				dest[i] = scanLine[i];
-			for(i = byteWidth; i < length; i++)
-				dest[i] = (scanLine[i] + dest[i - byteWidth]); // paethPredictor(dest[i - byteWidth], 0, 0) is always dest[i - byteWidth]
+			for (uint32 x = 0; x < width; x++, src += 4)
+				writePixel(dest, x, format.ARGBToColor(src[3], src[0], src[1], src[2]), bytesPerPixel);
 		}
 		break;
-	default:
-		error("Unknown line filter");
 	}
-
 }
 
-void PNG::constructImage() {
-	assert (_header.bitDepth != 0);
-
-	byte *dest;
-	byte *scanLine;
-	byte *prevLine = 0;
-	byte filterType;
-	uint16 scanLineWidth = (_header.width * getNumColorChannels() * _header.bitDepth + 7) / 8;
+/**
+ * Inflates and unfilters the image one scan line at a time, and writes
+ * each line to the output surface. The indexed surface receives the
+ * unfiltered data as is, any other surface the converted pixels.
+ * PNG filters are defined in: http://www.w3.org/TR/PNG/#9Filters
+ */
+void PNG::constructImage(Graphics::Surface *output) {
+	assert(_header.bitDepth != 0);
 
-	if (_unfilteredSurface) {
-		_unfilteredSurface->free();
-		delete _unfilteredSurface;
-	}
-	_unfilteredSurface = new Graphics::Surface();
-	// TODO/FIXME: It seems we can not properly determine the format here. But maybe there is a way...
-	_unfilteredSurface->create(_header.width, _header.height, PixelFormat((getNumColorChannels() * _header.bitDepth + 7) / 8, 0, 0, 0, 0, 0, 0, 0, 0));
-	scanLine = new byte[_unfilteredSurface->pitch];
-	dest = (byte *)_unfilteredSurface->getBasePtr(0, 0);
-
-	switch(_header.interlaceType) {
-	case kNonInterlaced:
-		for (uint16 y = 0; y < _unfilteredSurface->h; y++) {
-			filterType = _imageData->readByte();
-			_imageData->read(scanLine, scanLineWidth);
-			unfilterScanLine(dest, scanLine, prevLine, _unfilteredSurface->format.bytesPerPixel, filterType, scanLineWidth);
-			prevLine = dest;
-			dest += _unfilteredSurface->pitch;
-		}
-		break;
-	case kInterlaced:
+	if (_header.interlaceType != kNonInterlaced) {
 		// Theoretically, this shouldn't be needed, as interlacing is only
 		// useful for web images. Interlaced PNG images require more complex
 		// handling, so unless having support for such images is needed, there
 		// is no reason to add support for them.
 		error("TODO: Support for interlaced PNG images");
-		break;
 	}
 
-	delete[] scanLine;
+	const byte bytesPerPixel = (getNumColorChannels() * _header.bitDepth + 7) / 8;
+	const uint32 scanLineWidth = (_header.width * getNumColorChannels() * _header.bitDepth + 7) / 8;
+	const bool convert = (output != _unfilteredSurface);
+
+	uint32 map[256];
+	byte *indices = 0;
+	if (convert) {
+		buildColorMap(map, output->format);
+		if (_header.bitDepth < 8)
+			indices = new byte[_header.width];
+	}
+
+	// Only the current and the previous scan line are kept, with the zero
+	// padding the filter kernels expect
+	const uint32 rowSize = kPNGRowPadding + scanLineWidth + kPNGRowSlack;
+	byte *rows = (byte *)calloc(2, rowSize);
+	byte *scanLine = rows + kPNGRowPadding;
+	byte *prevLine = rows + rowSize + kPNGRowPadding;
+
+	const PNGFilterKernels &kernels = getPNGFilterKernels();
+	Common::SeekableReadStream *imageData = Common::wrapCompressedReadStream(new IDATReadStream(_stream, _imageDataStart, _imageDataSize));
+
+	for (uint32 y = 0; y < _header.height; y++) {
+		const byte filterType = imageData->readByte();
+		if (imageData->read(scanLine, scanLineWidth) != scanLineWidth) {
+			warning("PNG: Image data ends after %d of %d lines", y, _header.height);
+			break;
+		}
+
+		switch (filterType) {
+		case kFilterNone:		// no change
+			break;
+		case kFilterSub:		// add the bytes to the left
+			kernels.unfilterSub(scanLine, prevLine, scanLineWidth, bytesPerPixel);
+			break;
+		case kFilterUp:			// add the bytes of the above scanline
+			kernels.unfilterUp(scanLine, prevLine, scanLineWidth, bytesPerPixel);
+			break;
+		case kFilterAverage:	// average value of the left and top left
+			kernels.unfilterAverage(scanLine, prevLine, scanLineWidth, bytesPerPixel);
+			break;
+		case kFilterPaeth:		// Paeth filter: http://www.w3.org/TR/PNG/#9Filter-type-4-Paeth
+			kernels.unfilterPaeth(scanLine, prevLine, scanLineWidth, bytesPerPixel);
+			break;
+		default:
+			error("Unknown line filter");
+		}
+
+		byte *dest = (byte *)output->getBasePtr(0, y);
+		if (convert)
+			convertScanLine(dest, scanLine, indices, output->format, map);
+		else
+			memcpy(dest, scanLine, scanLineWidth);
+
+		SWAP(scanLine, prevLine);
+	}
+
+	delete imageData;
+	free(rows);
+	delete[] indices;
 }
 
 void PNG::readHeaderChunk() {
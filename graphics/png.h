@@ -29,7 +29,10 @@
 
 // Currently, only the sword25 engine uses the PNG decoder, so skip compiling
 // it if sword25 is not enabled, or if zlib (a required dependency) is not
-// enabled.
+// enabled. The configuration comes from scummsys.h, which has to be
+// included first.
+
+#include "common/scummsys.h"
 
 #if !(defined(ENABLE_SWORD25) || defined(USE_ZLIB))
 
@@ -103,7 +106,9 @@ public:
 	~PNG();
 
 	/**
-	 * Reads a PNG image from the specified stream
+	 * Reads a PNG image from the specified stream. The image data is only
+	 * decoded by getSurface() resp. getIndexedSurface(), so the stream is
+	 * kept until the PNG is destroyed.
 	 */
 	bool read(Common::SeekableReadStream *str);
 
@@ -113,20 +118,18 @@ public:
 	PNGHeader getHeader() const { return _header; }
 
 	/**
-	 * Returns the PNG image, formatted for the specified pixel format.
+	 * Returns the PNG image, formatted for the specified pixel format,
+	 * which needs to have 2 or 4 bytes per pixel. The rows are decoded
+	 * straight into the new surface, one at a time.
 	 */
 	Graphics::Surface *getSurface(const PixelFormat &format);
 
 	/**
 	 * Returns the indexed PNG8 image. Used for PNGs with an indexed 256 color
 	 * palette, when they're shown on an 8-bit color screen, as no translation
-	 * is taking place.
+	 * is taking place. The surface is owned by the PNG object.
 	 */
-	Graphics::Surface *getIndexedSurface() {
-		if (_header.colorType != kIndexed)
-			error("Indexed surface requested for a non-indexed PNG");
-		return _unfilteredSurface;
-	}
+	Graphics::Surface *getIndexedSurface();
 
 	/**
 	 * Returns the palette of the specified PNG8 image, given a pointer to
@@ -151,14 +154,16 @@ private:
 	void readPaletteChunk();
 	void readTransparencyChunk(uint32 chunkLength);
 
-	void constructImage();
-	void unfilterScanLine(byte *dest, const byte *scanLine, const byte *prevLine, uint16 byteWidth, byte filterType, uint16 length);
-	byte paethPredictor(int16 a, int16 b, int16 c);
+	void constructImage(Graphics::Surface *output);
+	void buildColorMap(uint32 *map, const PixelFormat &format);
+	void convertScanLine(byte *dest, const byte *scanLine, byte *indices, const PixelFormat &format, const uint32 *map);
 
 	// The original file stream
 	Common::SeekableReadStream *_stream;
-	// The unzipped image data stream
-	Common::SeekableReadStream *_imageData;
+	// The position of the first IDAT chunk in the file stream, and the
+	// size of the data of all of them
+	int32 _imageDataStart;
+	uint32 _imageDataSize;
 
 	PNGHeader _header;
 
@@ -167,9 +172,6 @@ private:
 	uint16 _transparentColor[3];
 	bool _transparentColorSpecified;
 
-	byte *_compressedBuffer;
-	uint32 _compressedBufferSize;
-
 	Graphics::Surface *_unfilteredSurface;
 };
 
@@ -0,0 +1,84 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/png_filters.h"
+
+namespace Graphics {
+
+static void unfilterSub(byte *row, const byte *prevRow, uint32 length, uint bpp) {
+	const byte *left = row - bpp;
+	for (uint32 i = 0; i < length; i++)
+		row[i] += left[i];
+}
+
+static void unfilterUp(byte *row, const byte *prevRow, uint32 length, uint bpp) {
+	for (uint32 i = 0; i < length; i++)
+		row[i] += prevRow[i];
+}
+
+static void unfilterAverage(byte *row, const byte *prevRow, uint32 length, uint bpp) {
+	const byte *left = row - bpp;
+	for (uint32 i = 0; i < length; i++)
+		row[i] += (left[i] + prevRow[i]) >> 1;
+}
+
+static void unfilterPaeth(byte *row, const byte *prevRow, uint32 length, uint bpp) {
+	const byte *left = row - bpp;
+	const byte *upperLeft = prevRow - bpp;
+	for (uint32 i = 0; i < length; i++)
+		row[i] += pngPaethPredictor(left[i], prevRow[i], upperLeft[i]);
+}
+
+static const PNGFilterKernels s_pngFilterKernelsScalar = {
+	unfilterSub,
+	unfilterUp,
+	unfilterAverage,
+	unfilterPaeth
+};
+
+const PNGFilterKernels &getScalarPNGFilterKernels() {
+	return s_pngFilterKernelsScalar;
+}
+
+const PNGFilterKernels *getPNGFilterKernels(Common::CPUFeature feature) {
+	if (!Common::hasCPUFeature(feature))
+		return 0;
+
+	switch (feature) {
+#ifdef USE_X86_SIMD
+	case Common::kCPUFeatureSSE2:
+		return &g_pngFilterKernelsSSE2;
+#endif
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+const PNGFilterKernels &getPNGFilterKernels() {
+	const PNGFilterKernels *kernels = getPNGFilterKernels(Common::kCPUFeatureSSE2);
+	return kernels ? *kernels : s_pngFilterKernelsScalar;
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,104 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef GRAPHICS_PNG_FILTERS_H
+#define GRAPHICS_PNG_FILTERS_H
+
+#include "common/scummsys.h"
+#include "common/cpudetect.h"
+#include "common/util.h"
+
+namespace Graphics {
+
+enum {
+	/**
+	 * The number of zero bytes in front of the rows passed to the filter
+	 * kernels. They stand in for the pixels left of the row, so that the
+	 * first pixel needs no special case.
+	 */
+	kPNGRowPadding = 16,
+
+	/**
+	 * The number of bytes after the rows the kernels may read, but do not
+	 * change.
+	 */
+	kPNGRowSlack = 16
+};
+
+/**
+ * Paeth predictor, used by PNG filter type 4: whichever of the left (a),
+ * upper (b) and upper left (c) neighbours is closest to a + b - c.
+ */
+static inline byte pngPaethPredictor(int a, int b, int c) {
+	const int pa = ABS(b - c);
+	const int pb = ABS(a - c);
+	const int pc = ABS(a + b - c - c);
+
+	if (pa <= pb && pa <= pc)
+		return a;
+	else if (pb <= pc)
+		return b;
+	else
+		return c;
+}
+
+/**
+ * Undo the PNG filters (http://www.w3.org/TR/PNG/#9Filters) of one row in
+ * place. row and prevRow hold length bytes, and bpp (1 to 4) is the
+ * distance to the corresponding byte of the previous pixel. Both rows need
+ * kPNGRowPadding zero bytes in front and kPNGRowSlack bytes after them;
+ * for the first row of the image, prevRow is all zeros.
+ *
+ * There is no kernel for the None filter, which leaves the row unchanged.
+ */
+struct PNGFilterKernels {
+	void (*unfilterSub)(byte *row, const byte *prevRow, uint32 length, uint bpp);
+	void (*unfilterUp)(byte *row, const byte *prevRow, uint32 length, uint bpp);
+	void (*unfilterAverage)(byte *row, const byte *prevRow, uint32 length, uint bpp);
+	void (*unfilterPaeth)(byte *row, const byte *prevRow, uint32 length, uint bpp);
+};
+
+/**
+ * Return the kernels for the given instruction set extension, or 0 if the
+ * build or the host CPU does not support them.
+ */
+const PNGFilterKernels *getPNGFilterKernels(Common::CPUFeature feature);
+
+/**
+ * Return the fastest kernels the host CPU supports.
+ */
+const PNGFilterKernels &getPNGFilterKernels();
+
+/**
+ * Return the generic C++ kernels.
+ */
+const PNGFilterKernels &getScalarPNGFilterKernels();
+
+#ifdef USE_X86_SIMD
+// Implemented in png_filters_x86.cpp
+extern const PNGFilterKernels g_pngFilterKernelsSSE2;
+#endif
+
+} // End of namespace Graphics
+
+#endif
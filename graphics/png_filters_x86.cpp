@@ -0,0 +1,196 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/png_filters.h"
+
+#ifdef USE_X86_SIMD
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+// The functions in this file are compiled for the instruction set given in
+// their target attribute, independent of the flags used for the rest of
+// the build. getPNGFilterKernels() only picks them if the CPU supports it.
+//
+// Sub, Average and Paeth depend on the previous pixel of the same row, so
+// they handle one pixel of 3 or 4 bytes per step; rows with 1 or 2 bytes
+// per pixel use plain C++ loops.
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+
+/** Load a pixel into the low bytes; always reads 4 bytes. */
+SSE2_TARGET static inline __m128i loadPixel(const byte *src) {
+	int32 value;
+	memcpy(&value, src, 4);
+	return _mm_cvtsi32_si128(value);
+}
+
+template<uint kBpp>
+SSE2_TARGET static inline void storePixel(byte *dst, __m128i pixel) {
+	const int32 value = _mm_cvtsi128_si32(pixel);
+	memcpy(dst, &value, kBpp);
+}
+
+#pragma mark -
+
+template<uint kBpp>
+SSE2_TARGET static void unfilterSubPixels(byte *row, uint32 length) {
+	__m128i a = _mm_setzero_si128();
+	for (uint32 i = 0; i < length; i += kBpp) {
+		a = _mm_add_epi8(a, loadPixel(row + i));
+		storePixel<kBpp>(row + i, a);
+	}
+}
+
+/**
+ * With 4 bytes per pixel, four pixels fit into a register: a prefix sum
+ * over them, plus the last pixel of the previous step.
+ */
+SSE2_TARGET static void unfilterSub4(byte *row, uint32 length) {
+	__m128i carry = _mm_setzero_si128();
+	uint32 i = 0;
+	for (; i + 16 <= length; i += 16) {
+		__m128i x = _mm_loadu_si128((const __m128i *)(row + i));
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+		x = _mm_add_epi8(x, carry);
+		carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+		_mm_storeu_si128((__m128i *)(row + i), x);
+	}
+
+	const byte *left = row - 4;
+	for (; i < length; i++)
+		row[i] += left[i];
+}
+
+SSE2_TARGET static void unfilterSubSSE2(byte *row, const byte *prevRow, uint32 length, uint bpp) {
+	if (bpp == 4) {
+		unfilterSub4(row, length);
+	} else if (bpp == 3) {
+		unfilterSubPixels<3>(row, length);
+	} else {
+		const byte *left = row - bpp;
+		for (uint32 i = 0; i < length; i++)
+			row[i] += left[i];
+	}
+}
+
+SSE2_TARGET static void unfilterUpSSE2(byte *row, const byte *prevRow, uint32 length, uint bpp) {
+	uint32 i = 0;
+	for (; i + 16 <= length; i += 16) {
+		const __m128i x = _mm_loadu_si128((const __m128i *)(row + i));
+		const __m128i b = _mm_loadu_si128((const __m128i *)(prevRow + i));
+		_mm_storeu_si128((__m128i *)(row + i), _mm_add_epi8(x, b));
+	}
+
+	for (; i < length; i++)
+		row[i] += prevRow[i];
+}
+
+template<uint kBpp>
+SSE2_TARGET static void unfilterAveragePixels(byte *row, const byte *prevRow, uint32 length) {
+	// pavgb rounds up, (a + b) >> 1 is rounded down
+	const __m128i one = _mm_set1_epi8(1);
+	__m128i a = _mm_setzero_si128();
+	for (uint32 i = 0; i < length; i += kBpp) {
+		const __m128i b = loadPixel(prevRow + i);
+		const __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+		a = _mm_add_epi8(loadPixel(row + i), average);
+		storePixel<kBpp>(row + i, a);
+	}
+}
+
+SSE2_TARGET static void unfilterAverageSSE2(byte *row, const byte *prevRow, uint32 length, uint bpp) {
+	if (bpp == 4) {
+		unfilterAveragePixels<4>(row, prevRow, length);
+	} else if (bpp == 3) {
+		unfilterAveragePixels<3>(row, prevRow, length);
+	} else {
+		const byte *left = row - bpp;
+		for (uint32 i = 0; i < length; i++)
+			row[i] += (left[i] + prevRow[i]) >> 1;
+	}
+}
+
+SSE2_TARGET static inline __m128i abs16(__m128i x) {
+	return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+SSE2_TARGET static inline __m128i select16(__m128i mask, __m128i x, __m128i y) {
+	return _mm_or_si128(_mm_and_si128(mask, x), _mm_andnot_si128(mask, y));
+}
+
+/**
+ * The same as pngPaethPredictor(), with the neighbours in 16 bit lanes.
+ * The first of the three distances which equals the smallest one picks
+ * the predictor.
+ */
+template<uint kBpp>
+SSE2_TARGET static void unfilterPaethPixels(byte *row, const byte *prevRow, uint32 length) {
+	const __m128i zero = _mm_setzero_si128();
+	__m128i a = zero, c = zero;
+	for (uint32 i = 0; i < length; i += kBpp) {
+		const __m128i b = _mm_unpacklo_epi8(loadPixel(prevRow + i), zero);
+
+		const __m128i pa = _mm_sub_epi16(b, c);
+		const __m128i pb = _mm_sub_epi16(a, c);
+		const __m128i pc = abs16(_mm_add_epi16(pa, pb));
+		const __m128i absA = abs16(pa);
+		const __m128i absB = abs16(pb);
+		const __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(absA, absB));
+
+		__m128i predictor = select16(_mm_cmpeq_epi16(smallest, absB), b, c);
+		predictor = select16(_mm_cmpeq_epi16(smallest, absA), a, predictor);
+
+		const __m128i x = _mm_add_epi8(loadPixel(row + i), _mm_packus_epi16(predictor, predictor));
+		storePixel<kBpp>(row + i, x);
+
+		a = _mm_unpacklo_epi8(x, zero);
+		c = b;
+	}
+}
+
+SSE2_TARGET static void unfilterPaethSSE2(byte *row, const byte *prevRow, uint32 length, uint bpp) {
+	if (bpp == 4) {
+		unfilterPaethPixels<4>(row, prevRow, length);
+	} else if (bpp == 3) {
+		unfilterPaethPixels<3>(row, prevRow, length);
+	} else {
+		const byte *left = row - bpp;
+		const byte *upperLeft = prevRow - bpp;
+		for (uint32 i = 0; i < length; i++)
+			row[i] += pngPaethPredictor(left[i], prevRow[i], upperLeft[i]);
+	}
+}
+
+const PNGFilterKernels g_pngFilterKernelsSSE2 = {
+	unfilterSubSSE2,
+	unfilterUpSSE2,
+	unfilterAverageSSE2,
+	unfilterPaethSSE2
+};
+
+} // End of namespace Graphics
+
+#endif // #ifdef USE_X86_SIMD
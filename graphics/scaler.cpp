@@ -21,7 +21,9 @@
  */
 
 #include "graphics/scaler/intern.h"
-#include "graphics/scaler/scalebit.h"
+#include "graphics/scaler.h"
+#include "graphics/scaler/kernels.h"
+#include "common/cpudetect.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -120,6 +122,15 @@ void InitLUT(Graphics::PixelFormat format) {
 #endif
 
 
+#ifdef USE_SCALERS
+static const ScalerKernels *s_scalerKernels = 0;
+
+const ScalerKernels &getScalerKernels() {
+	// Use the C++ code until InitScalers() has been called.
+	return s_scalerKernels ? *s_scalerKernels : getScalarScalerKernels();
+}
+#endif
+
 /** Lookup table for the DotMatrix scaler. */
 uint16 g_dotmatrix[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
 
@@ -150,6 +161,22 @@ void InitScalers(uint32 BitFormat) {
 	g_dotmatrix[2] = g_dotmatrix[8] = format.RGBToColor(63, 0, 0);
 	g_dotmatrix[4] = g_dotmatrix[6] =
 		g_dotmatrix[12] = g_dotmatrix[14] = format.RGBToColor(63, 63, 63);
+
+#ifdef USE_SCALERS
+	// The SIMD kernels only know about the two formats the scalers have
+	// templates for; anything else uses the LUT based C++ code.
+	s_scalerKernels = &getScalarScalerKernels();
+	if (gBitFormat == 565 || gBitFormat == 555) {
+#ifdef USE_X86_SIMD
+		if (Common::hasCPUFeature(Common::kCPUFeatureAVX2))
+			s_scalerKernels = &g_scalerKernelsAVX2;
+		else if (Common::hasCPUFeature(Common::kCPUFeatureSSSE3))
+			s_scalerKernels = &g_scalerKernelsSSSE3;
+		else if (Common::hasCPUFeature(Common::kCPUFeatureSSE2))
+			s_scalerKernels = &g_scalerKernelsSSE2;
+#endif
+	}
+#endif
 }
 
 void DestroyScalers(){
@@ -159,6 +186,23 @@ void DestroyScalers(){
 #endif
 }
 
+bool isScalerReentrant(ScalerProc *scaler) {
+#if defined(USE_HQ_SCALERS) && defined(USE_NASM)
+	// hq2x_i386.asm and hq3x_i386.asm use variables in .bss
+	if (scaler == HQ2x || scaler == HQ3x)
+		return false;
+#endif
+	return true;
+}
+
+int getScalerBandHeight(int height, int numBands) {
+	if (numBands <= 1)
+		return height;
+
+	const int bandHeight = MAX<int>(kMinScalerBandHeight, (height + numBands - 1) / numBands);
+	return (bandHeight + 1) & ~1;
+}
+
 
 /**
  * Trivial 'scaler' - in fact it doesn't do any scaling but just copies the
@@ -306,7 +350,15 @@ void Normal1o5x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstP
  */
 void AdvMame2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 							 int width, int height) {
-	scale(2, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, 2, width, height);
+	const ScalerKernels &kernels = getScalerKernels();
+	const uint32 nextlineSrc = srcPitch / sizeof(uint16);
+	const uint16 *p = (const uint16 *)srcPtr;
+
+	while (height--) {
+		kernels.scale2x((uint16 *)dstPtr, (uint16 *)(dstPtr + dstPitch), p - nextlineSrc, p, p + nextlineSrc, width);
+		p += nextlineSrc;
+		dstPtr += dstPitch * 2;
+	}
 }
 
 /**
@@ -315,7 +367,16 @@ void AdvMame2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPi
  */
 void AdvMame3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 							 int width, int height) {
-	scale(3, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, 2, width, height);
+	const ScalerKernels &kernels = getScalerKernels();
+	const uint32 nextlineSrc = srcPitch / sizeof(uint16);
+	const uint16 *p = (const uint16 *)srcPtr;
+
+	while (height--) {
+		kernels.scale3x((uint16 *)dstPtr, (uint16 *)(dstPtr + dstPitch), (uint16 *)(dstPtr + 2 * dstPitch),
+		                p - nextlineSrc, p, p + nextlineSrc, width);
+		p += nextlineSrc;
+		dstPtr += dstPitch * 3;
+	}
 }
 
 template<typename ColorMask>
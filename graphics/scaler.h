@@ -61,6 +61,30 @@ DECLARE_SCALER(HQ3x);
 
 #endif // #ifdef USE_SCALERS
 
+enum {
+	/**
+	 * The smallest band getScalerBandHeight() splits a rect into. It is
+	 * even, since some scalers (e.g. DotMatrix) depend on the parity of the
+	 * row they start at.
+	 */
+	kMinScalerBandHeight = 16
+};
+
+/**
+ * Returns whether the given scaler may be called for several areas at the
+ * same time, e.g. from a thread pool. This is false for the assembler
+ * versions of the HQ scalers, which keep their state in global variables.
+ */
+extern bool isScalerReentrant(ScalerProc *scaler);
+
+/**
+ * Returns the height of the horizontal bands a rect of the given height
+ * is split into, so it can be scaled by at most numBands calls running
+ * at the same time. Scaling the bands one by one gives the same result as
+ * scaling the whole rect at once.
+ */
+extern int getScalerBandHeight(int height, int numBands);
+
 // creates a 160x100 thumbnail for 320x200 games
 // and 160x120 thumbnail for 320x240 and 640x480 games
 // only 565 mode
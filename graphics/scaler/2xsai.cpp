@@ -21,6 +21,7 @@
  */
 
 #include "graphics/scaler/intern.h"
+#include "graphics/scaler/kernels.h"
 
 
 
@@ -271,143 +272,143 @@ void SuperEagle(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstP
 }
 
 template<typename ColorMask>
-void _2xSaITemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
-	const uint16 *bP;
-	uint16 *dP;
-	const uint32 nextlineSrc = srcPitch >> 1;
-
-	while (height--) {
-		bP = (const uint16 *)srcPtr;
-		dP = (uint16 *)dstPtr;
-
-		for (int i = 0; i < width; ++i) {
+static void _2xSaIRowTemplate(uint16 *dst0, uint16 *dst1, const uint16 *bP, uint32 nextlineSrc, uint count) {
+	for (uint i = 0; i < count; ++i) {
 
-			register unsigned colorA, colorB;
-			unsigned colorC, colorD,
-				colorE, colorF, colorG, colorH, colorI, colorJ, colorK, colorL, colorM, colorN, colorO;
-			unsigned product, product1, product2;
+		register unsigned colorA, colorB;
+		unsigned colorC, colorD,
+			colorE, colorF, colorG, colorH, colorI, colorJ, colorK, colorL, colorM, colorN, colorO;
+		unsigned product, product1, product2;
 
 //---------------------------------------
 // Map of the pixels:                    I|E F|J
 //                                       G|A B|K
 //                                       H|C D|L
 //                                       M|N O|P
-			colorI = *(bP - nextlineSrc - 1);
-			colorE = *(bP - nextlineSrc);
-			colorF = *(bP - nextlineSrc + 1);
-			colorJ = *(bP - nextlineSrc + 2);
-
-			colorG = *(bP - 1);
-			colorA = *(bP);
-			colorB = *(bP + 1);
-			colorK = *(bP + 2);
-
-			colorH = *(bP + nextlineSrc - 1);
-			colorC = *(bP + nextlineSrc);
-			colorD = *(bP + nextlineSrc + 1);
-			colorL = *(bP + nextlineSrc + 2);
-
-			colorM = *(bP + 2 * nextlineSrc - 1);
-			colorN = *(bP + 2 * nextlineSrc);
-			colorO = *(bP + 2 * nextlineSrc + 1);
-
-			if ((colorA == colorD) && (colorB != colorC)) {
-				if (((colorA == colorE) && (colorB == colorL)) ||
-					((colorA == colorC) && (colorA == colorF) && (colorB != colorE) && (colorB == colorJ))) {
-					product = colorA;
-				} else {
-					product = interpolate_1_1(colorA, colorB);
-				}
+		colorI = *(bP - nextlineSrc - 1);
+		colorE = *(bP - nextlineSrc);
+		colorF = *(bP - nextlineSrc + 1);
+		colorJ = *(bP - nextlineSrc + 2);
+
+		colorG = *(bP - 1);
+		colorA = *(bP);
+		colorB = *(bP + 1);
+		colorK = *(bP + 2);
+
+		colorH = *(bP + nextlineSrc - 1);
+		colorC = *(bP + nextlineSrc);
+		colorD = *(bP + nextlineSrc + 1);
+		colorL = *(bP + nextlineSrc + 2);
+
+		colorM = *(bP + 2 * nextlineSrc - 1);
+		colorN = *(bP + 2 * nextlineSrc);
+		colorO = *(bP + 2 * nextlineSrc + 1);
+
+		if ((colorA == colorD) && (colorB != colorC)) {
+			if (((colorA == colorE) && (colorB == colorL)) ||
+				((colorA == colorC) && (colorA == colorF) && (colorB != colorE) && (colorB == colorJ))) {
+				product = colorA;
+			} else {
+				product = interpolate_1_1(colorA, colorB);
+			}
 
-				if (((colorA == colorG) && (colorC == colorO)) ||
-					((colorA == colorB) && (colorA == colorH) && (colorG != colorC)  && (colorC == colorM))) {
-					product1 = colorA;
-				} else {
-					product1 = interpolate_1_1(colorA, colorC);
-				}
-				product2 = colorA;
-			} else if ((colorB == colorC) && (colorA != colorD)) {
-				if (((colorB == colorF) && (colorA == colorH)) ||
-					((colorB == colorE) && (colorB == colorD) && (colorA != colorF) && (colorA == colorI))) {
-					product = colorB;
-				} else {
-					product = interpolate_1_1(colorA, colorB);
-				}
+			if (((colorA == colorG) && (colorC == colorO)) ||
+				((colorA == colorB) && (colorA == colorH) && (colorG != colorC)  && (colorC == colorM))) {
+				product1 = colorA;
+			} else {
+				product1 = interpolate_1_1(colorA, colorC);
+			}
+			product2 = colorA;
+		} else if ((colorB == colorC) && (colorA != colorD)) {
+			if (((colorB == colorF) && (colorA == colorH)) ||
+				((colorB == colorE) && (colorB == colorD) && (colorA != colorF) && (colorA == colorI))) {
+				product = colorB;
+			} else {
+				product = interpolate_1_1(colorA, colorB);
+			}
 
-				if (((colorC == colorH) && (colorA == colorF)) ||
-					((colorC == colorG) && (colorC == colorD) && (colorA != colorH) && (colorA == colorI))) {
-					product1 = colorC;
-				} else {
-					product1 = interpolate_1_1(colorA, colorC);
-				}
-				product2 = colorB;
-			} else if ((colorA == colorD) && (colorB == colorC)) {
-				if (colorA == colorB) {
-					product = colorA;
-					product1 = colorA;
-					product2 = colorA;
-				} else {
-					register int r = 0;
+			if (((colorC == colorH) && (colorA == colorF)) ||
+				((colorC == colorG) && (colorC == colorD) && (colorA != colorH) && (colorA == colorI))) {
+				product1 = colorC;
+			} else {
+				product1 = interpolate_1_1(colorA, colorC);
+			}
+			product2 = colorB;
+		} else if ((colorA == colorD) && (colorB == colorC)) {
+			if (colorA == colorB) {
+				product = colorA;
+				product1 = colorA;
+				product2 = colorA;
+			} else {
+				register int r = 0;
 
-					product1 = interpolate_1_1(colorA, colorC);
-					product = interpolate_1_1(colorA, colorB);
+				product1 = interpolate_1_1(colorA, colorC);
+				product = interpolate_1_1(colorA, colorB);
 
-					r += GetResult(colorA, colorB, colorG, colorE);
-					r -= GetResult(colorB, colorA, colorK, colorF);
-					r -= GetResult(colorB, colorA, colorH, colorN);
-					r += GetResult(colorA, colorB, colorL, colorO);
+				r += GetResult(colorA, colorB, colorG, colorE);
+				r -= GetResult(colorB, colorA, colorK, colorF);
+				r -= GetResult(colorB, colorA, colorH, colorN);
+				r += GetResult(colorA, colorB, colorL, colorO);
 
-					if (r > 0)
-						product2 = colorA;
-					else if (r < 0)
-						product2 = colorB;
-					else {
-						product2 = interpolate_1_1_1_1(colorA, colorB, colorC, colorD);
-					}
+				if (r > 0)
+					product2 = colorA;
+				else if (r < 0)
+					product2 = colorB;
+				else {
+					product2 = interpolate_1_1_1_1(colorA, colorB, colorC, colorD);
 				}
+			}
+		} else {
+			product2 = interpolate_1_1_1_1(colorA, colorB, colorC, colorD);
+
+			if ((colorA == colorC) && (colorA == colorF)
+					&& (colorB != colorE) && (colorB == colorJ)) {
+				product = colorA;
+			} else if ((colorB == colorE) && (colorB == colorD)
+								 && (colorA != colorF) && (colorA == colorI)) {
+				product = colorB;
 			} else {
-				product2 = interpolate_1_1_1_1(colorA, colorB, colorC, colorD);
-
-				if ((colorA == colorC) && (colorA == colorF)
-						&& (colorB != colorE) && (colorB == colorJ)) {
-					product = colorA;
-				} else if ((colorB == colorE) && (colorB == colorD)
-									 && (colorA != colorF) && (colorA == colorI)) {
-					product = colorB;
-				} else {
-					product = interpolate_1_1(colorA, colorB);
-				}
-
-				if ((colorA == colorB) && (colorA == colorH)
-						&& (colorG != colorC) && (colorC == colorM)) {
-					product1 = colorA;
-				} else if ((colorC == colorG) && (colorC == colorD)
-									 && (colorA != colorH) && (colorA == colorI)) {
-					product1 = colorC;
-				} else {
-					product1 = interpolate_1_1(colorA, colorC);
-				}
+				product = interpolate_1_1(colorA, colorB);
 			}
 
-			*(dP + 0) = (uint16) colorA;
-			*(dP + 1) = (uint16) product;
-			*(dP + dstPitch/2 + 0) = (uint16) product1;
-			*(dP + dstPitch/2 + 1) = (uint16) product2;
-
-			bP += 1;
-			dP += 2;
+			if ((colorA == colorB) && (colorA == colorH)
+					&& (colorG != colorC) && (colorC == colorM)) {
+				product1 = colorA;
+			} else if ((colorC == colorG) && (colorC == colorD)
+								 && (colorA != colorH) && (colorA == colorI)) {
+				product1 = colorC;
+			} else {
+				product1 = interpolate_1_1(colorA, colorC);
+			}
 		}
 
-		srcPtr += srcPitch;
-		dstPtr += dstPitch * 2;
+		*(dst0 + 0) = (uint16) colorA;
+		*(dst0 + 1) = (uint16) product;
+		*(dst1 + 0) = (uint16) product1;
+		*(dst1 + 1) = (uint16) product2;
+
+		bP += 1;
+		dst0 += 2;
+		dst1 += 2;
 	}
 }
 
 
+void _2xSaIRow(uint16 *dst0, uint16 *dst1, const uint16 *src, uint32 pitch, uint count, int bitFormat) {
+	if (bitFormat == 565)
+		_2xSaIRowTemplate<Graphics::ColorMasks<565> >(dst0, dst1, src, pitch, count);
+	else
+		_2xSaIRowTemplate<Graphics::ColorMasks<555> >(dst0, dst1, src, pitch, count);
+}
+
 void _2xSaI(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	extern int gBitFormat;
-	if (gBitFormat == 565)
-		_2xSaITemplate<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
-	else
-		_2xSaITemplate<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+	const ScalerKernels &kernels = getScalerKernels();
+
+	while (height--) {
+		kernels.scale2xSaI((uint16 *)dstPtr, (uint16 *)(dstPtr + dstPitch), (const uint16 *)srcPtr, srcPitch >> 1, width, gBitFormat);
+
+		srcPtr += srcPitch;
+		dstPtr += dstPitch * 2;
+	}
 }
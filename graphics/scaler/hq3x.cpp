@@ -21,6 +21,8 @@
  */
 
 #include "graphics/scaler/intern.h"
+#include "graphics/scaler/kernels.h"
+#include "common/util.h"
 
 #ifdef USE_NASM
 // Assembly version of HQ3x
@@ -126,6 +128,12 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	//	 | w7 | w8 | w9 |
 	//	 +----+----+----+
 
+	// The neighbour patterns are computed for a number of pixels at a time,
+	// which allows the kernels to use SIMD instructions.
+	extern int gBitFormat;
+	const ScalerKernels &kernels = getScalerKernels();
+	uint8 patterns[64];
+
 	while (height--) {
 		w1 = *(p - 1 - nextlineSrc);
 		w4 = *(p - 1);
@@ -136,23 +144,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 		w8 = *(p + nextlineSrc);
 
 		int tmpWidth = width;
+		int patternIndex = ARRAYSIZE(patterns);
 		while (tmpWidth--) {
+			if (patternIndex == ARRAYSIZE(patterns)) {
+				kernels.hqxPatterns(patterns, p, nextlineSrc, MIN<int>(tmpWidth + 1, ARRAYSIZE(patterns)), gBitFormat);
+				patternIndex = 0;
+			}
+
 			p++;
 
 			w3 = *(p - nextlineSrc);
 			w6 = *(p);
 			w9 = *(p + nextlineSrc);
 
-			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			const int pattern = patterns[patternIndex++];
 
 			switch (pattern) {
 			case 0:
@@ -218,4 +218,9 @@ static inline bool diffYUV(int yuv1, int yuv2) {
 */
 }
 
+/**
+ * The generic C++ row kernel of the 2xSaI scaler, see ScalerKernels.
+ */
+void _2xSaIRow(uint16 *dst0, uint16 *dst1, const uint16 *src, uint32 pitch, uint count, int bitFormat);
+
 #endif
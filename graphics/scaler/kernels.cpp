@@ -0,0 +1,92 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/scaler/kernels.h"
+#include "graphics/scaler/intern.h"
+#include "graphics/scaler/scale2x.h"
+#include "graphics/scaler/scale3x.h"
+
+static void scale2xScalar(uint16 *dst0, uint16 *dst1, const uint16 *src0, const uint16 *src1, const uint16 *src2, uint count) {
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	scale2x_16_mmx(dst0, dst1, src0, src1, src2, count);
+	scale2x_mmx_emms();
+#elif defined(USE_ARM_SCALER_ASM)
+	scale2x_16_arm(dst0, dst1, src0, src1, src2, count);
+#else
+	scale2x_16_def(dst0, dst1, src0, src1, src2, count);
+#endif
+}
+
+static void scale3xScalar(uint16 *dst0, uint16 *dst1, uint16 *dst2, const uint16 *src0, const uint16 *src1, const uint16 *src2, uint count) {
+	scale3x_16_def(dst0, dst1, dst2, src0, src1, src2, count);
+}
+
+#if defined(USE_HQ_SCALERS) && !defined(USE_NASM)
+
+extern "C" uint32 *RGBtoYUV;
+
+static void hqxPatternsScalar(uint8 *patterns, const uint16 *src, uint32 pitch, uint count, int bitFormat) {
+	// The same sliding 3x3 window as in the HQ2x and HQ3x code.
+	int w1 = *(src - 1 - pitch), w2 = *(src - pitch);
+	int w4 = *(src - 1),         w5 = *(src);
+	int w7 = *(src - 1 + pitch), w8 = *(src + pitch);
+
+	for (uint i = 0; i < count; ++i) {
+		src++;
+
+		const int w3 = *(src - pitch);
+		const int w6 = *(src);
+		const int w9 = *(src + pitch);
+
+		int pattern = 0;
+		const int yuv5 = RGBtoYUV[w5];
+		if (w5 != w1 && diffYUV(yuv5, RGBtoYUV[w1])) pattern |= 0x0001;
+		if (w5 != w2 && diffYUV(yuv5, RGBtoYUV[w2])) pattern |= 0x0002;
+		if (w5 != w3 && diffYUV(yuv5, RGBtoYUV[w3])) pattern |= 0x0004;
+		if (w5 != w4 && diffYUV(yuv5, RGBtoYUV[w4])) pattern |= 0x0008;
+		if (w5 != w6 && diffYUV(yuv5, RGBtoYUV[w6])) pattern |= 0x0010;
+		if (w5 != w7 && diffYUV(yuv5, RGBtoYUV[w7])) pattern |= 0x0020;
+		if (w5 != w8 && diffYUV(yuv5, RGBtoYUV[w8])) pattern |= 0x0040;
+		if (w5 != w9 && diffYUV(yuv5, RGBtoYUV[w9])) pattern |= 0x0080;
+		patterns[i] = pattern;
+
+		w1 = w2; w2 = w3;
+		w4 = w5; w5 = w6;
+		w7 = w8; w8 = w9;
+	}
+}
+
+#else
+#define hqxPatternsScalar 0
+#endif
+
+static const ScalerKernels s_scalerKernelsScalar = {
+	scale2xScalar,
+	scale3xScalar,
+	hqxPatternsScalar,
+	_2xSaIRow
+};
+
+const ScalerKernels &getScalarScalerKernels() {
+	return s_scalerKernelsScalar;
+}
@@ -0,0 +1,87 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef GRAPHICS_SCALER_KERNELS_H
+#define GRAPHICS_SCALER_KERNELS_H
+
+#include "common/scummsys.h"
+
+#ifdef USE_SCALERS
+
+/**
+ * The inner loops of the scalers that have SIMD versions. Each kernel
+ * handles a single row of 16 bit pixels; the scalers loop over the rows.
+ * Like the scalers themselves, the kernels read one pixel beyond each
+ * border of the source rectangle (two to the right and below for 2xSaI).
+ *
+ * All variants produce bit-identical output to the generic C++ code. The
+ * bitFormat parameters are either 565 or 555, see gBitFormat.
+ */
+struct ScalerKernels {
+	/**
+	 * Scale2x (AdvMame2x): src0, src1 and src2 point at the rows above, at
+	 * and below the current one; dst0 and dst1 receive 2 * count pixels.
+	 */
+	void (*scale2x)(uint16 *dst0, uint16 *dst1, const uint16 *src0, const uint16 *src1, const uint16 *src2, uint count);
+
+	/**
+	 * Scale3x (AdvMame3x), the same as scale2x but with three output rows
+	 * of 3 * count pixels each.
+	 */
+	void (*scale3x)(uint16 *dst0, uint16 *dst1, uint16 *dst2, const uint16 *src0, const uint16 *src1, const uint16 *src2, uint count);
+
+	/**
+	 * Compute the neighbour patterns of the HQ2x and HQ3x scalers: bit n of
+	 * patterns[i] is set if the YUV value of src[i] differs from that of its
+	 * n-th neighbour, numbered row by row from the top left, skipping the
+	 * pixel itself. pitch is the row distance in pixels.
+	 */
+	void (*hqxPatterns)(uint8 *patterns, const uint16 *src, uint32 pitch, uint count, int bitFormat);
+
+	/**
+	 * 2xSaI: src points at the first pixel of the current row, dst0 and dst1
+	 * receive 2 * count pixels each.
+	 */
+	void (*scale2xSaI)(uint16 *dst0, uint16 *dst1, const uint16 *src, uint32 pitch, uint count, int bitFormat);
+};
+
+/**
+ * Return the kernels chosen by InitScalers().
+ */
+const ScalerKernels &getScalerKernels();
+
+/**
+ * Return the generic C++ kernels.
+ */
+const ScalerKernels &getScalarScalerKernels();
+
+#ifdef USE_X86_SIMD
+// Implemented in kernels_x86.cpp
+extern const ScalerKernels g_scalerKernelsSSE2;
+extern const ScalerKernels g_scalerKernelsSSSE3;
+extern const ScalerKernels g_scalerKernelsAVX2;
+#endif
+
+#endif // #ifdef USE_SCALERS
+
+#endif
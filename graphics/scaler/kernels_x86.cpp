@@ -0,0 +1,622 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/scaler/kernels.h"
+
+#ifdef USE_X86_SIMD
+
+#include "graphics/scaler/intern.h"
+
+#include <immintrin.h>
+
+// The functions in this file are compiled for the instruction set given in
+// their target attribute, independent of the flags used for the rest of
+// the build. InitScalers() only picks them if the CPU supports it.
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+/**
+ * The per channel bit masks of the 565 and 555 pixel formats, used by the
+ * interpolation and the YUV conversion.
+ */
+struct FormatMasks {
+	int16 lowBits;   ///< The lowest bit of each channel
+	int16 qlowBits;  ///< The lowest two bits of each channel
+	int16 qhighBits; ///< All but the lowest two bits of each channel
+	int redShift;    ///< Right shift to get red into bits 3-7
+	int greenShift;  ///< Right shift to get green into bits 2-7 resp. 3-7
+	int16 greenMask; ///< The green bits after greenShift
+};
+
+static const FormatMasks s_formatMasks565 = {
+	Graphics::ColorMasks<565>::kLowBits,
+	Graphics::ColorMasks<565>::qlowBits & 0xFFFF,
+	(int16)(Graphics::ColorMasks<565>::qhighBits & 0xFFFF),
+	8, 3, 0xFC
+};
+
+static const FormatMasks s_formatMasks555 = {
+	Graphics::ColorMasks<555>::kLowBits,
+	Graphics::ColorMasks<555>::qlowBits & 0xFFFF,
+	(int16)(Graphics::ColorMasks<555>::qhighBits & 0xFFFF),
+	7, 2, 0xF8
+};
+
+static inline const FormatMasks &getFormatMasks(int bitFormat) {
+	return bitFormat == 565 ? s_formatMasks565 : s_formatMasks555;
+}
+
+/**
+ * Shuffle masks for interleaving three vectors of eight 16 bit values, see
+ * interleave3SSSE3(). Index one is the output vector, index two the input
+ * vector.
+ */
+static const int8 s_interleave3Masks[3][3][16] = {
+	{
+		{  0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1,  4,  5, -1, -1 },
+		{ -1, -1,  0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1,  4,  5 },
+		{ -1, -1, -1, -1,  0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1 }
+	}, {
+		{ -1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1, -1, -1, 10, 11 },
+		{ -1, -1, -1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1, -1, -1 },
+		{  4,  5, -1, -1, -1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1 }
+	}, {
+		{ -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15, -1, -1, -1, -1 },
+		{ 10, 11, -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15, -1, -1 },
+		{ -1, -1, 10, 11, -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15 }
+	}
+};
+
+static inline SSE2_TARGET __m128i loadSSE2(const uint16 *src) {
+	return _mm_loadu_si128((const __m128i *)src);
+}
+
+/** Return a where mask is set and b elsewhere. */
+static inline SSE2_TARGET __m128i selectSSE2(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/** Store a0 b0 a1 b1 ... a7 b7 at dst. */
+static inline SSE2_TARGET void interleave2SSE2(uint16 *dst, __m128i a, __m128i b) {
+	_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(a, b));
+	_mm_storeu_si128((__m128i *)(dst + 8), _mm_unpackhi_epi16(a, b));
+}
+
+static SSE2_TARGET void scale2xSSE2(uint16 *dst0, uint16 *dst1, const uint16 *src0, const uint16 *src1, const uint16 *src2, uint count) {
+	uint i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const __m128i B = loadSSE2(src0 + i);
+		const __m128i D = loadSSE2(src1 + i - 1);
+		const __m128i E = loadSSE2(src1 + i);
+		const __m128i F = loadSSE2(src1 + i + 1);
+		const __m128i H = loadSSE2(src2 + i);
+
+		// Only if B != H and D != F anything but E is output.
+		const __m128i keep = _mm_or_si128(_mm_cmpeq_epi16(B, H), _mm_cmpeq_epi16(D, F));
+
+		interleave2SSE2(dst0 + 2 * i,
+		                selectSSE2(_mm_andnot_si128(keep, _mm_cmpeq_epi16(D, B)), B, E),
+		                selectSSE2(_mm_andnot_si128(keep, _mm_cmpeq_epi16(F, B)), B, E));
+		interleave2SSE2(dst1 + 2 * i,
+		                selectSSE2(_mm_andnot_si128(keep, _mm_cmpeq_epi16(D, H)), H, E),
+		                selectSSE2(_mm_andnot_si128(keep, _mm_cmpeq_epi16(F, H)), H, E));
+	}
+
+	if (i < count)
+		getScalarScalerKernels().scale2x(dst0 + 2 * i, dst1 + 2 * i, src0 + i, src1 + i, src2 + i, count - i);
+}
+
+#if defined(USE_HQ_SCALERS) && !defined(USE_NASM)
+
+/**
+ * Convert eight pixels to the YUV values of the RGBtoYUV table, less the
+ * offset of 128 of U and V which does not matter for the comparisons.
+ */
+static inline SSE2_TARGET void toYUVSSE2(__m128i c, const FormatMasks &masks, __m128i &y, __m128i &u, __m128i &v) {
+	const __m128i r = _mm_and_si128(_mm_srl_epi16(c, _mm_cvtsi32_si128(masks.redShift)), _mm_set1_epi16(0xF8));
+	const __m128i g = _mm_and_si128(_mm_srl_epi16(c, _mm_cvtsi32_si128(masks.greenShift)), _mm_set1_epi16(masks.greenMask));
+	const __m128i b = _mm_and_si128(_mm_slli_epi16(c, 3), _mm_set1_epi16(0xF8));
+
+	y = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(r, g), b), 2);
+	u = _mm_srai_epi16(_mm_sub_epi16(r, b), 2);
+	v = _mm_srai_epi16(_mm_sub_epi16(_mm_sub_epi16(_mm_slli_epi16(g, 1), r), b), 3);
+}
+
+static inline SSE2_TARGET __m128i absDiffSSE2(__m128i a, __m128i b) {
+	return _mm_max_epi16(_mm_sub_epi16(a, b), _mm_sub_epi16(b, a));
+}
+
+static SSE2_TARGET void hqxPatternsSSE2(uint8 *patterns, const uint16 *src, uint32 pitch, uint count, int bitFormat) {
+	const FormatMasks &masks = getFormatMasks(bitFormat);
+	const int offsets[8] = {
+		-(int)pitch - 1, -(int)pitch, -(int)pitch + 1,
+		-1, 1,
+		(int)pitch - 1, (int)pitch, (int)pitch + 1
+	};
+	uint i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const uint16 *p = src + i;
+		__m128i y5, u5, v5;
+		toYUVSSE2(loadSSE2(p), masks, y5, u5, v5);
+
+		__m128i pattern = _mm_setzero_si128();
+		for (int n = 0; n < 8; ++n) {
+			__m128i y, u, v;
+			toYUVSSE2(loadSSE2(p + offsets[n]), masks, y, u, v);
+
+			// The thresholds of diffYUV().
+			const __m128i diff = _mm_or_si128(_mm_or_si128(
+				_mm_cmpgt_epi16(absDiffSSE2(y5, y), _mm_set1_epi16(48)),
+				_mm_cmpgt_epi16(absDiffSSE2(u5, u), _mm_set1_epi16(7))),
+				_mm_cmpgt_epi16(absDiffSSE2(v5, v), _mm_set1_epi16(6)));
+			pattern = _mm_or_si128(pattern, _mm_and_si128(diff, _mm_set1_epi16(1 << n)));
+		}
+
+		_mm_storel_epi64((__m128i *)(patterns + i), _mm_packus_epi16(pattern, pattern));
+	}
+
+	if (i < count)
+		getScalarScalerKernels().hqxPatterns(patterns + i, src + i, pitch, count - i, bitFormat);
+}
+
+#else
+#define hqxPatternsSSE2 0
+#endif
+
+/** Interpolate with weights 1 and 1 like interpolate16_1_1(). */
+static inline SSE2_TARGET __m128i interpolate_1_1SSE2(__m128i a, __m128i b, __m128i lowBits) {
+	return _mm_add_epi16(_mm_and_si128(a, b), _mm_srli_epi16(_mm_andnot_si128(lowBits, _mm_xor_si128(a, b)), 1));
+}
+
+/** Interpolate with weights 1, 1, 1 and 1 like interpolate16_1_1_1_1(). */
+static inline SSE2_TARGET __m128i interpolate_1_1_1_1SSE2(__m128i a, __m128i b, __m128i c, __m128i d, __m128i qlowBits) {
+	const __m128i high = _mm_add_epi16(
+		_mm_add_epi16(_mm_srli_epi16(_mm_andnot_si128(qlowBits, a), 2), _mm_srli_epi16(_mm_andnot_si128(qlowBits, b), 2)),
+		_mm_add_epi16(_mm_srli_epi16(_mm_andnot_si128(qlowBits, c), 2), _mm_srli_epi16(_mm_andnot_si128(qlowBits, d), 2)));
+	const __m128i low = _mm_add_epi16(
+		_mm_add_epi16(_mm_and_si128(qlowBits, a), _mm_and_si128(qlowBits, b)),
+		_mm_add_epi16(_mm_and_si128(qlowBits, c), _mm_and_si128(qlowBits, d)));
+	return _mm_add_epi16(high, _mm_and_si128(_mm_srli_epi16(low, 2), qlowBits));
+}
+
+/** GetResult() of the 2xSaI code, which returns -1, 0 or 1. */
+static inline SSE2_TARGET __m128i getResultSSE2(__m128i a, __m128i b, __m128i c, __m128i d) {
+	const __m128i ac = _mm_cmpeq_epi16(a, c);
+	const __m128i ad = _mm_cmpeq_epi16(a, d);
+	const __m128i x = _mm_and_si128(ac, ad);
+	const __m128i y = _mm_andnot_si128(_mm_or_si128(ac, ad), _mm_and_si128(_mm_cmpeq_epi16(b, c), _mm_cmpeq_epi16(b, d)));
+	// x and y are -1 where set.
+	return _mm_sub_epi16(x, y);
+}
+
+static SSE2_TARGET void scale2xSaISSE2(uint16 *dst0, uint16 *dst1, const uint16 *src, uint32 pitch, uint count, int bitFormat) {
+	const FormatMasks &masks = getFormatMasks(bitFormat);
+	const __m128i lowBits = _mm_set1_epi16(masks.lowBits);
+	const __m128i qlowBits = _mm_set1_epi16(masks.qlowBits);
+	uint i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		// See _2xSaIRowTemplate() for the map of the pixels.
+		const uint16 *p = src + i;
+		const __m128i I = loadSSE2(p - pitch - 1);
+		const __m128i E = loadSSE2(p - pitch);
+		const __m128i F = loadSSE2(p - pitch + 1);
+		const __m128i J = loadSSE2(p - pitch + 2);
+		const __m128i G = loadSSE2(p - 1);
+		const __m128i A = loadSSE2(p);
+		const __m128i B = loadSSE2(p + 1);
+		const __m128i K = loadSSE2(p + 2);
+		const __m128i H = loadSSE2(p + pitch - 1);
+		const __m128i C = loadSSE2(p + pitch);
+		const __m128i D = loadSSE2(p + pitch + 1);
+		const __m128i L = loadSSE2(p + pitch + 2);
+		const __m128i M = loadSSE2(p + 2 * pitch - 1);
+		const __m128i N = loadSSE2(p + 2 * pitch);
+		const __m128i O = loadSSE2(p + 2 * pitch + 1);
+
+		const __m128i AD = _mm_cmpeq_epi16(A, D);
+		const __m128i BC = _mm_cmpeq_epi16(B, C);
+		const __m128i case1 = _mm_andnot_si128(BC, AD);
+		const __m128i case2 = _mm_andnot_si128(AD, BC);
+		const __m128i case3 = _mm_and_si128(AD, BC);
+		const __m128i case4 = _mm_xor_si128(_mm_or_si128(AD, BC), _mm_set1_epi16(-1));
+		// The case A == B == C == D is part of case3: all interpolations
+		// then yield A, so it needs no special treatment.
+
+		const __m128i AE = _mm_cmpeq_epi16(A, E);
+		const __m128i AF = _mm_cmpeq_epi16(A, F);
+		const __m128i AH = _mm_cmpeq_epi16(A, H);
+		const __m128i AI = _mm_cmpeq_epi16(A, I);
+		const __m128i BE = _mm_cmpeq_epi16(B, E);
+		const __m128i CG = _mm_cmpeq_epi16(C, G);
+
+		const __m128i pA = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi16(A, C), AF), _mm_andnot_si128(BE, _mm_cmpeq_epi16(B, J)));
+		const __m128i pB = _mm_and_si128(_mm_and_si128(BE, _mm_cmpeq_epi16(B, D)), _mm_andnot_si128(AF, AI));
+		const __m128i qA = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi16(A, B), AH), _mm_andnot_si128(CG, _mm_cmpeq_epi16(C, M)));
+		const __m128i qC = _mm_and_si128(_mm_and_si128(CG, _mm_cmpeq_epi16(C, D)), _mm_andnot_si128(AH, AI));
+
+		const __m128i selA = _mm_or_si128(_mm_and_si128(case1, _mm_and_si128(AE, _mm_cmpeq_epi16(B, L))),
+		                                  _mm_and_si128(_mm_or_si128(case1, case4), pA));
+		const __m128i selB = _mm_or_si128(_mm_and_si128(case2, _mm_and_si128(_mm_cmpeq_epi16(B, F), AH)),
+		                                  _mm_and_si128(_mm_or_si128(case2, case4), pB));
+		const __m128i product = selectSSE2(selA, A, selectSSE2(selB, B, interpolate_1_1SSE2(A, B, lowBits)));
+
+		const __m128i selA1 = _mm_or_si128(_mm_and_si128(case1, _mm_and_si128(_mm_cmpeq_epi16(A, G), _mm_cmpeq_epi16(C, O))),
+		                                   _mm_and_si128(_mm_or_si128(case1, case4), qA));
+		const __m128i selC1 = _mm_or_si128(_mm_and_si128(case2, _mm_and_si128(_mm_cmpeq_epi16(C, H), AF)),
+		                                   _mm_and_si128(_mm_or_si128(case2, case4), qC));
+		const __m128i product1 = selectSSE2(selA1, A, selectSSE2(selC1, C, interpolate_1_1SSE2(A, C, lowBits)));
+
+		__m128i r = getResultSSE2(A, B, G, E);
+		r = _mm_sub_epi16(r, getResultSSE2(B, A, K, F));
+		r = _mm_sub_epi16(r, getResultSSE2(B, A, H, N));
+		r = _mm_add_epi16(r, getResultSSE2(A, B, L, O));
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i selA2 = _mm_or_si128(case1, _mm_and_si128(case3, _mm_cmpgt_epi16(r, zero)));
+		const __m128i selB2 = _mm_or_si128(case2, _mm_and_si128(case3, _mm_cmplt_epi16(r, zero)));
+		const __m128i product2 = selectSSE2(selA2, A, selectSSE2(selB2, B, interpolate_1_1_1_1SSE2(A, B, C, D, qlowBits)));
+
+		interleave2SSE2(dst0 + 2 * i, A, product);
+		interleave2SSE2(dst1 + 2 * i, product1, product2);
+	}
+
+	if (i < count)
+		getScalarScalerKernels().scale2xSaI(dst0 + 2 * i, dst1 + 2 * i, src + i, pitch, count - i, bitFormat);
+}
+
+static void scale3xSSE2(uint16 *dst0, uint16 *dst1, uint16 *dst2, const uint16 *src0, const uint16 *src1, const uint16 *src2, uint count) {
+	// Scale3x needs to interleave three vectors for its output, which is
+	// only worthwhile with the byte shuffle of SSSE3.
+	getScalarScalerKernels().scale3x(dst0, dst1, dst2, src0, src1, src2, count);
+}
+
+const ScalerKernels g_scalerKernelsSSE2 = {
+	scale2xSSE2,
+	scale3xSSE2,
+	hqxPatternsSSE2,
+	scale2xSaISSE2
+};
+
+#pragma mark -
+
+static inline SSSE3_TARGET __m128i shuffleSSSE3(__m128i v, int out, int in) {
+	return _mm_shuffle_epi8(v, _mm_loadu_si128((const __m128i *)s_interleave3Masks[out][in]));
+}
+
+/** Store a0 b0 c0 a1 b1 c1 ... a7 b7 c7 at dst. */
+static inline SSSE3_TARGET void interleave3SSSE3(uint16 *dst, __m128i a, __m128i b, __m128i c) {
+	for (int out = 0; out < 3; ++out) {
+		const __m128i v = _mm_or_si128(_mm_or_si128(shuffleSSSE3(a, out, 0), shuffleSSSE3(b, out, 1)), shuffleSSSE3(c, out, 2));
+		_mm_storeu_si128((__m128i *)(dst + 8 * out), v);
+	}
+}
+
+static SSSE3_TARGET void scale3xSSSE3(uint16 *dst0, uint16 *dst1, uint16 *dst2, const uint16 *src0, const uint16 *src1, const uint16 *src2, uint count) {
+	uint i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const __m128i A = loadSSE2(src0 + i - 1);
+		const __m128i B = loadSSE2(src0 + i);
+		const __m128i C = loadSSE2(src0 + i + 1);
+		const __m128i D = loadSSE2(src1 + i - 1);
+		const __m128i E = loadSSE2(src1 + i);
+		const __m128i F = loadSSE2(src1 + i + 1);
+		const __m128i G = loadSSE2(src2 + i - 1);
+		const __m128i H = loadSSE2(src2 + i);
+		const __m128i I = loadSSE2(src2 + i + 1);
+
+		// Only if B != H and D != F anything but E is output.
+		const __m128i keep = _mm_or_si128(_mm_cmpeq_epi16(B, H), _mm_cmpeq_epi16(D, F));
+		const __m128i DB = _mm_andnot_si128(keep, _mm_cmpeq_epi16(D, B));
+		const __m128i FB = _mm_andnot_si128(keep, _mm_cmpeq_epi16(F, B));
+		const __m128i DH = _mm_andnot_si128(keep, _mm_cmpeq_epi16(D, H));
+		const __m128i FH = _mm_andnot_si128(keep, _mm_cmpeq_epi16(F, H));
+		const __m128i EA = _mm_cmpeq_epi16(E, A);
+		const __m128i EC = _mm_cmpeq_epi16(E, C);
+		const __m128i EG = _mm_cmpeq_epi16(E, G);
+		const __m128i EI = _mm_cmpeq_epi16(E, I);
+
+		interleave3SSSE3(dst0 + 3 * i,
+		                 selectSSE2(DB, D, E),
+		                 selectSSE2(_mm_or_si128(_mm_andnot_si128(EC, DB), _mm_andnot_si128(EA, FB)), B, E),
+		                 selectSSE2(FB, F, E));
+		interleave3SSSE3(dst1 + 3 * i,
+		                 selectSSE2(_mm_or_si128(_mm_andnot_si128(EG, DB), _mm_andnot_si128(EA, DH)), D, E),
+		                 E,
+		                 selectSSE2(_mm_or_si128(_mm_andnot_si128(EI, FB), _mm_andnot_si128(EC, FH)), F, E));
+		interleave3SSSE3(dst2 + 3 * i,
+		                 selectSSE2(DH, D, E),
+		                 selectSSE2(_mm_or_si128(_mm_andnot_si128(EI, DH), _mm_andnot_si128(EG, FH)), H, E),
+		                 selectSSE2(FH, F, E));
+	}
+
+	if (i < count)
+		getScalarScalerKernels().scale3x(dst0 + 3 * i, dst1 + 3 * i, dst2 + 3 * i, src0 + i, src1 + i, src2 + i, count - i);
+}
+
+// The other kernels have no use for the SSSE3 instructions.
+const ScalerKernels g_scalerKernelsSSSE3 = {
+	scale2xSSE2,
+	scale3xSSSE3,
+	hqxPatternsSSE2,
+	scale2xSaISSE2
+};
+
+#pragma mark -
+
+static inline AVX2_TARGET __m256i loadAVX2(const uint16 *src) {
+	return _mm256_loadu_si256((const __m256i *)src);
+}
+
+static inline AVX2_TARGET __m256i selectAVX2(__m256i mask, __m256i a, __m256i b) {
+	return _mm256_blendv_epi8(b, a, mask);
+}
+
+static inline AVX2_TARGET void interleave2AVX2(uint16 *dst, __m256i a, __m256i b) {
+	// Unpacking works within 128 bit lanes, so the lanes of the results
+	// need to be reordered.
+	const __m256i lo = _mm256_unpacklo_epi16(a, b);
+	const __m256i hi = _mm256_unpackhi_epi16(a, b);
+	_mm256_storeu_si256((__m256i *)dst, _mm256_permute2x128_si256(lo, hi, 0x20));
+	_mm256_storeu_si256((__m256i *)(dst + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+static inline AVX2_TARGET __m256i shuffleAVX2(__m256i v, int out, int in) {
+	return _mm256_shuffle_epi8(v, _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)s_interleave3Masks[out][in])));
+}
+
+static inline AVX2_TARGET void interleave3AVX2(uint16 *dst, __m256i a, __m256i b, __m256i c) {
+	// Each lane yields three output vectors: the low lanes give the output
+	// for the first eight pixels, the high lanes the rest.
+	__m256i v[3];
+	for (int out = 0; out < 3; ++out)
+		v[out] = _mm256_or_si256(_mm256_or_si256(shuffleAVX2(a, out, 0), shuffleAVX2(b, out, 1)), shuffleAVX2(c, out, 2));
+
+	_mm256_storeu_si256((__m256i *)dst, _mm256_permute2x128_si256(v[0], v[1], 0x20));
+	_mm256_storeu_si256((__m256i *)(dst + 16), _mm256_permute2x128_si256(v[2], v[0], 0x30));
+	_mm256_storeu_si256((__m256i *)(dst + 32), _mm256_permute2x128_si256(v[1], v[2], 0x31));
+}
+
+static AVX2_TARGET void scale2xAVX2(uint16 *dst0, uint16 *dst1, const uint16 *src0, const uint16 *src1, const uint16 *src2, uint count) {
+	uint i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		const __m256i B = loadAVX2(src0 + i);
+		const __m256i D = loadAVX2(src1 + i - 1);
+		const __m256i E = loadAVX2(src1 + i);
+		const __m256i F = loadAVX2(src1 + i + 1);
+		const __m256i H = loadAVX2(src2 + i);
+
+		const __m256i keep = _mm256_or_si256(_mm256_cmpeq_epi16(B, H), _mm256_cmpeq_epi16(D, F));
+
+		interleave2AVX2(dst0 + 2 * i,
+		                selectAVX2(_mm256_andnot_si256(keep, _mm256_cmpeq_epi16(D, B)), B, E),
+		                selectAVX2(_mm256_andnot_si256(keep, _mm256_cmpeq_epi16(F, B)), B, E));
+		interleave2AVX2(dst1 + 2 * i,
+		                selectAVX2(_mm256_andnot_si256(keep, _mm256_cmpeq_epi16(D, H)), H, E),
+		                selectAVX2(_mm256_andnot_si256(keep, _mm256_cmpeq_epi16(F, H)), H, E));
+	}
+
+	scale2xSSE2(dst0 + 2 * i, dst1 + 2 * i, src0 + i, src1 + i, src2 + i, count - i);
+}
+
+static AVX2_TARGET void scale3xAVX2(uint16 *dst0, uint16 *dst1, uint16 *dst2, const uint16 *src0, const uint16 *src1, const uint16 *src2, uint count) {
+	uint i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		const __m256i A = loadAVX2(src0 + i - 1);
+		const __m256i B = loadAVX2(src0 + i);
+		const __m256i C = loadAVX2(src0 + i + 1);
+		const __m256i D = loadAVX2(src1 + i - 1);
+		const __m256i E = loadAVX2(src1 + i);
+		const __m256i F = loadAVX2(src1 + i + 1);
+		const __m256i G = loadAVX2(src2 + i - 1);
+		const __m256i H = loadAVX2(src2 + i);
+		const __m256i I = loadAVX2(src2 + i + 1);
+
+		const __m256i keep = _mm256_or_si256(_mm256_cmpeq_epi16(B, H), _mm256_cmpeq_epi16(D, F));
+		const __m256i DB = _mm256_andnot_si256(keep, _mm256_cmpeq_epi16(D, B));
+		const __m256i FB = _mm256_andnot_si256(keep, _mm256_cmpeq_epi16(F, B));
+		const __m256i DH = _mm256_andnot_si256(keep, _mm256_cmpeq_epi16(D, H));
+		const __m256i FH = _mm256_andnot_si256(keep, _mm256_cmpeq_epi16(F, H));
+		const __m256i EA = _mm256_cmpeq_epi16(E, A);
+		const __m256i EC = _mm256_cmpeq_epi16(E, C);
+		const __m256i EG = _mm256_cmpeq_epi16(E, G);
+		const __m256i EI = _mm256_cmpeq_epi16(E, I);
+
+		interleave3AVX2(dst0 + 3 * i,
+		                selectAVX2(DB, D, E),
+		                selectAVX2(_mm256_or_si256(_mm256_andnot_si256(EC, DB), _mm256_andnot_si256(EA, FB)), B, E),
+		                selectAVX2(FB, F, E));
+		interleave3AVX2(dst1 + 3 * i,
+		                selectAVX2(_mm256_or_si256(_mm256_andnot_si256(EG, DB), _mm256_andnot_si256(EA, DH)), D, E),
+		                E,
+		                selectAVX2(_mm256_or_si256(_mm256_andnot_si256(EI, FB), _mm256_andnot_si256(EC, FH)), F, E));
+		interleave3AVX2(dst2 + 3 * i,
+		                selectAVX2(DH, D, E),
+		                selectAVX2(_mm256_or_si256(_mm256_andnot_si256(EI, DH), _mm256_andnot_si256(EG, FH)), H, E),
+		                selectAVX2(FH, F, E));
+	}
+
+	scale3xSSSE3(dst0 + 3 * i, dst1 + 3 * i, dst2 + 3 * i, src0 + i, src1 + i, src2 + i, count - i);
+}
+
+#if defined(USE_HQ_SCALERS) && !defined(USE_NASM)
+
+static inline AVX2_TARGET void toYUVAVX2(__m256i c, const FormatMasks &masks, __m256i &y, __m256i &u, __m256i &v) {
+	const __m256i r = _mm256_and_si256(_mm256_srl_epi16(c, _mm_cvtsi32_si128(masks.redShift)), _mm256_set1_epi16(0xF8));
+	const __m256i g = _mm256_and_si256(_mm256_srl_epi16(c, _mm_cvtsi32_si128(masks.greenShift)), _mm256_set1_epi16(masks.greenMask));
+	const __m256i b = _mm256_and_si256(_mm256_slli_epi16(c, 3), _mm256_set1_epi16(0xF8));
+
+	y = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(r, g), b), 2);
+	u = _mm256_srai_epi16(_mm256_sub_epi16(r, b), 2);
+	v = _mm256_srai_epi16(_mm256_sub_epi16(_mm256_sub_epi16(_mm256_slli_epi16(g, 1), r), b), 3);
+}
+
+static inline AVX2_TARGET __m256i absDiffAVX2(__m256i a, __m256i b) {
+	return _mm256_abs_epi16(_mm256_sub_epi16(a, b));
+}
+
+static AVX2_TARGET void hqxPatternsAVX2(uint8 *patterns, const uint16 *src, uint32 pitch, uint count, int bitFormat) {
+	const FormatMasks &masks = getFormatMasks(bitFormat);
+	const int offsets[8] = {
+		-(int)pitch - 1, -(int)pitch, -(int)pitch + 1,
+		-1, 1,
+		(int)pitch - 1, (int)pitch, (int)pitch + 1
+	};
+	uint i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		const uint16 *p = src + i;
+		__m256i y5, u5, v5;
+		toYUVAVX2(loadAVX2(p), masks, y5, u5, v5);
+
+		__m256i pattern = _mm256_setzero_si256();
+		for (int n = 0; n < 8; ++n) {
+			__m256i y, u, v;
+			toYUVAVX2(loadAVX2(p + offsets[n]), masks, y, u, v);
+
+			const __m256i diff = _mm256_or_si256(_mm256_or_si256(
+				_mm256_cmpgt_epi16(absDiffAVX2(y5, y), _mm256_set1_epi16(48)),
+				_mm256_cmpgt_epi16(absDiffAVX2(u5, u), _mm256_set1_epi16(7))),
+				_mm256_cmpgt_epi16(absDiffAVX2(v5, v), _mm256_set1_epi16(6)));
+			pattern = _mm256_or_si256(pattern, _mm256_and_si256(diff, _mm256_set1_epi16(1 << n)));
+		}
+
+		// Packing works within 128 bit lanes; gather the low 64 bits of both.
+		pattern = _mm256_permute4x64_epi64(_mm256_packus_epi16(pattern, pattern), 0x08);
+		_mm_storeu_si128((__m128i *)(patterns + i), _mm256_castsi256_si128(pattern));
+	}
+
+	hqxPatternsSSE2(patterns + i, src + i, pitch, count - i, bitFormat);
+}
+
+#else
+#define hqxPatternsAVX2 0
+#endif
+
+static inline AVX2_TARGET __m256i interpolate_1_1AVX2(__m256i a, __m256i b, __m256i lowBits) {
+	return _mm256_add_epi16(_mm256_and_si256(a, b), _mm256_srli_epi16(_mm256_andnot_si256(lowBits, _mm256_xor_si256(a, b)), 1));
+}
+
+static inline AVX2_TARGET __m256i interpolate_1_1_1_1AVX2(__m256i a, __m256i b, __m256i c, __m256i d, __m256i qlowBits) {
+	const __m256i high = _mm256_add_epi16(
+		_mm256_add_epi16(_mm256_srli_epi16(_mm256_andnot_si256(qlowBits, a), 2), _mm256_srli_epi16(_mm256_andnot_si256(qlowBits, b), 2)),
+		_mm256_add_epi16(_mm256_srli_epi16(_mm256_andnot_si256(qlowBits, c), 2), _mm256_srli_epi16(_mm256_andnot_si256(qlowBits, d), 2)));
+	const __m256i low = _mm256_add_epi16(
+		_mm256_add_epi16(_mm256_and_si256(qlowBits, a), _mm256_and_si256(qlowBits, b)),
+		_mm256_add_epi16(_mm256_and_si256(qlowBits, c), _mm256_and_si256(qlowBits, d)));
+	return _mm256_add_epi16(high, _mm256_and_si256(_mm256_srli_epi16(low, 2), qlowBits));
+}
+
+static inline AVX2_TARGET __m256i getResultAVX2(__m256i a, __m256i b, __m256i c, __m256i d) {
+	const __m256i ac = _mm256_cmpeq_epi16(a, c);
+	const __m256i ad = _mm256_cmpeq_epi16(a, d);
+	const __m256i x = _mm256_and_si256(ac, ad);
+	const __m256i y = _mm256_andnot_si256(_mm256_or_si256(ac, ad), _mm256_and_si256(_mm256_cmpeq_epi16(b, c), _mm256_cmpeq_epi16(b, d)));
+	return _mm256_sub_epi16(x, y);
+}
+
+static AVX2_TARGET void scale2xSaIAVX2(uint16 *dst0, uint16 *dst1, const uint16 *src, uint32 pitch, uint count, int bitFormat) {
+	const FormatMasks &masks = getFormatMasks(bitFormat);
+	const __m256i lowBits = _mm256_set1_epi16(masks.lowBits);
+	const __m256i qlowBits = _mm256_set1_epi16(masks.qlowBits);
+	uint i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		const uint16 *p = src + i;
+		const __m256i I = loadAVX2(p - pitch - 1);
+		const __m256i E = loadAVX2(p - pitch);
+		const __m256i F = loadAVX2(p - pitch + 1);
+		const __m256i J = loadAVX2(p - pitch + 2);
+		const __m256i G = loadAVX2(p - 1);
+		const __m256i A = loadAVX2(p);
+		const __m256i B = loadAVX2(p + 1);
+		const __m256i K = loadAVX2(p + 2);
+		const __m256i H = loadAVX2(p + pitch - 1);
+		const __m256i C = loadAVX2(p + pitch);
+		const __m256i D = loadAVX2(p + pitch + 1);
+		const __m256i L = loadAVX2(p + pitch + 2);
+		const __m256i M = loadAVX2(p + 2 * pitch - 1);
+		const __m256i N = loadAVX2(p + 2 * pitch);
+		const __m256i O = loadAVX2(p + 2 * pitch + 1);
+
+		const __m256i AD = _mm256_cmpeq_epi16(A, D);
+		const __m256i BC = _mm256_cmpeq_epi16(B, C);
+		const __m256i case1 = _mm256_andnot_si256(BC, AD);
+		const __m256i case2 = _mm256_andnot_si256(AD, BC);
+		const __m256i case3 = _mm256_and_si256(AD, BC);
+		const __m256i case4 = _mm256_xor_si256(_mm256_or_si256(AD, BC), _mm256_set1_epi16(-1));
+
+		const __m256i AE = _mm256_cmpeq_epi16(A, E);
+		const __m256i AF = _mm256_cmpeq_epi16(A, F);
+		const __m256i AH = _mm256_cmpeq_epi16(A, H);
+		const __m256i AI = _mm256_cmpeq_epi16(A, I);
+		const __m256i BE = _mm256_cmpeq_epi16(B, E);
+		const __m256i CG = _mm256_cmpeq_epi16(C, G);
+
+		const __m256i pA = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi16(A, C), AF), _mm256_andnot_si256(BE, _mm256_cmpeq_epi16(B, J)));
+		const __m256i pB = _mm256_and_si256(_mm256_and_si256(BE, _mm256_cmpeq_epi16(B, D)), _mm256_andnot_si256(AF, AI));
+		const __m256i qA = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi16(A, B), AH), _mm256_andnot_si256(CG, _mm256_cmpeq_epi16(C, M)));
+		const __m256i qC = _mm256_and_si256(_mm256_and_si256(CG, _mm256_cmpeq_epi16(C, D)), _mm256_andnot_si256(AH, AI));
+
+		const __m256i selA = _mm256_or_si256(_mm256_and_si256(case1, _mm256_and_si256(AE, _mm256_cmpeq_epi16(B, L))),
+		                                     _mm256_and_si256(_mm256_or_si256(case1, case4), pA));
+		const __m256i selB = _mm256_or_si256(_mm256_and_si256(case2, _mm256_and_si256(_mm256_cmpeq_epi16(B, F), AH)),
+		                                     _mm256_and_si256(_mm256_or_si256(case2, case4), pB));
+		const __m256i product = selectAVX2(selA, A, selectAVX2(selB, B, interpolate_1_1AVX2(A, B, lowBits)));
+
+		const __m256i selA1 = _mm256_or_si256(_mm256_and_si256(case1, _mm256_and_si256(_mm256_cmpeq_epi16(A, G), _mm256_cmpeq_epi16(C, O))),
+		                                      _mm256_and_si256(_mm256_or_si256(case1, case4), qA));
+		const __m256i selC1 = _mm256_or_si256(_mm256_and_si256(case2, _mm256_and_si256(_mm256_cmpeq_epi16(C, H), AF)),
+		                                      _mm256_and_si256(_mm256_or_si256(case2, case4), qC));
+		const __m256i product1 = selectAVX2(selA1, A, selectAVX2(selC1, C, interpolate_1_1AVX2(A, C, lowBits)));
+
+		__m256i r = getResultAVX2(A, B, G, E);
+		r = _mm256_sub_epi16(r, getResultAVX2(B, A, K, F));
+		r = _mm256_sub_epi16(r, getResultAVX2(B, A, H, N));
+		r = _mm256_add_epi16(r, getResultAVX2(A, B, L, O));
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i selA2 = _mm256_or_si256(case1, _mm256_and_si256(case3, _mm256_cmpgt_epi16(r, zero)));
+		const __m256i selB2 = _mm256_or_si256(case2, _mm256_and_si256(case3, _mm256_cmpgt_epi16(zero, r)));
+		const __m256i product2 = selectAVX2(selA2, A, selectAVX2(selB2, B, interpolate_1_1_1_1AVX2(A, B, C, D, qlowBits)));
+
+		interleave2AVX2(dst0 + 2 * i, A, product);
+		interleave2AVX2(dst1 + 2 * i, product1, product2);
+	}
+
+	scale2xSaISSE2(dst0 + 2 * i, dst1 + 2 * i, src + i, pitch, count - i, bitFormat);
+}
+
+const ScalerKernels g_scalerKernelsAVX2 = {
+	scale2xAVX2,
+	scale3xAVX2,
+	hqxPatternsAVX2,
+	scale2xSaIAVX2
+};
+
+#endif
@@ -87,6 +87,8 @@
 #include "common/singleton.h"
 
 #include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_kernels.h"
 
 namespace Graphics {
 
@@ -237,6 +239,50 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	}
 }
 
+const YUVToRGBKernels *getYUVToRGBKernels(Common::CPUFeature feature) {
+	if (!Common::hasCPUFeature(feature))
+		return 0;
+
+	switch (feature) {
+#ifdef USE_X86_SIMD
+	case Common::kCPUFeatureSSE2:
+		return &g_yuvToRGBKernelsSSE2;
+	case Common::kCPUFeatureAVX2:
+		return &g_yuvToRGBKernelsAVX2;
+#endif
+#ifdef USE_NEON
+	case Common::kCPUFeatureNEON:
+		return &g_yuvToRGBKernelsNEON;
+#endif
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+const YUVToRGBKernels *getYUVToRGBKernels() {
+	// Not cached, like getMixKernels(), so that benchmarks can switch
+	// kernels through Common::setCPUFeatureMask().
+	const YUVToRGBKernels *kernels = getYUVToRGBKernels(Common::kCPUFeatureAVX2);
+	if (!kernels)
+		kernels = getYUVToRGBKernels(Common::kCPUFeatureSSE2);
+	if (!kernels)
+		kernels = getYUVToRGBKernels(Common::kCPUFeatureNEON);
+	return kernels;
+}
+
+template<typename PixelInt>
+void convertYUV420ToRGB(byte *dstPtr, int dstPitch, void (*convert)(PixelInt *, PixelInt *, const byte *, const byte *, const byte *, const byte *, uint, const PixelFormat &), const PixelFormat &format, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	for (int h = 0; h < yHeight; h += 2) {
+		convert((PixelInt *)dstPtr, (PixelInt *)(dstPtr + dstPitch), ySrc, ySrc + yPitch, uSrc, vSrc, yWidth, format);
+		dstPtr += 2 * dstPitch;
+		ySrc += 2 * yPitch;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+}
+
 void convertYUV420ToRGB(Graphics::Surface *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Sanity checks
 	assert(dst && dst->pixels);
@@ -245,6 +291,17 @@ void convertYUV420ToRGB(Graphics::Surface *dst, const byte *ySrc, const byte *uS
 	assert((yWidth & 1) == 0);
 	assert((yHeight & 1) == 0);
 
+	// The SIMD kernels handle any format; the tables are only needed when
+	// there are none.
+	const YUVToRGBKernels *kernels = getYUVToRGBKernels();
+	if (kernels) {
+		if (dst->format.bytesPerPixel == 2)
+			convertYUV420ToRGB<uint16>((byte *)dst->pixels, dst->pitch, kernels->convert16, dst->format, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		else
+			convertYUV420ToRGB<uint32>((byte *)dst->pixels, dst->pitch, kernels->convert32, dst->format, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		return;
+	}
+
 	const YUVToRGBLookup *lookup = YUVToRGBMan.getLookup(dst->format);
 
 	// Use a templated function to avoid an if check on every pixel
@@ -0,0 +1,103 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef GRAPHICS_YUV_TO_RGB_KERNELS_H
+#define GRAPHICS_YUV_TO_RGB_KERNELS_H
+
+#include "common/scummsys.h"
+#include "common/cpudetect.h"
+#include "common/util.h"
+#include "graphics/pixelformat.h"
+
+namespace Graphics {
+
+/**
+ * Fixed point versions of the chroma factors of the lookup tables in
+ * yuv_to_rgb.cpp: the tables hold (int16)(factor * (c - 128)), i.e. the
+ * products truncated towards zero. For every chroma value,
+ *   |c - 128| * kYUVxxxInt + ((|c - 128| * kYUVxxxFrac) >> 16)
+ * gives the same magnitude, which is what the SIMD kernels compute.
+ */
+enum {
+	kYUVCrRInt = 1, kYUVCrRFrac = 26302, ///< 0.419 / 0.299
+	kYUVCrGInt = 0, kYUVCrGFrac = 46766, ///< 0.299 / 0.419, negated
+	kYUVCbGInt = 0, kYUVCbGFrac = 22570, ///< 0.114 / 0.331, negated
+	kYUVCbBInt = 1, kYUVCbBFrac = 50684  ///< 0.587 / 0.331
+};
+
+static inline int scaleChroma(int c, int intPart, int frac) {
+	const int a = ABS(c - 128);
+	const int t = a * intPart + ((a * frac) >> 16);
+	return c < 128 ? -t : t;
+}
+
+/**
+ * Convert a single pixel the way the lookup tables do; used for the parts
+ * of a row the SIMD loops leave over.
+ */
+static inline uint32 convertYUVPixel(byte y, byte u, byte v, const PixelFormat &format) {
+	const int r = y + scaleChroma(v, kYUVCrRInt, kYUVCrRFrac);
+	const int g = y - scaleChroma(v, kYUVCrGInt, kYUVCrGFrac) - scaleChroma(u, kYUVCbGInt, kYUVCbGFrac);
+	const int b = y + scaleChroma(u, kYUVCbBInt, kYUVCbBFrac);
+	return format.RGBToColor(CLIP(r, 0, 255), CLIP(g, 0, 255), CLIP(b, 0, 255));
+}
+
+/**
+ * SIMD versions of convertYUV420ToRGB(). Each kernel converts one pair of
+ * rows, which share a row of chroma samples: y0 and y1 hold count pixels
+ * (count is even), u and v count / 2 samples. The output is in the given
+ * format, which must have 2 resp. 4 bytes per pixel.
+ *
+ * All variants produce bit-identical output to the lookup tables.
+ */
+struct YUVToRGBKernels {
+	void (*convert16)(uint16 *dst0, uint16 *dst1, const byte *y0, const byte *y1, const byte *u, const byte *v, uint count, const PixelFormat &format);
+	void (*convert32)(uint32 *dst0, uint32 *dst1, const byte *y0, const byte *y1, const byte *u, const byte *v, uint count, const PixelFormat &format);
+};
+
+/**
+ * Return the kernels for the given instruction set extension, or 0 if the
+ * build or the host CPU does not support them.
+ */
+const YUVToRGBKernels *getYUVToRGBKernels(Common::CPUFeature feature);
+
+/**
+ * Return the fastest kernels the host CPU supports, or 0 if there are none
+ * and the lookup tables should be used.
+ */
+const YUVToRGBKernels *getYUVToRGBKernels();
+
+#ifdef USE_X86_SIMD
+// Implemented in yuv_to_rgb_x86.cpp
+extern const YUVToRGBKernels g_yuvToRGBKernelsSSE2;
+extern const YUVToRGBKernels g_yuvToRGBKernelsAVX2;
+#endif
+
+#ifdef USE_NEON
+// Implemented in yuv_to_rgb_neon.cpp
+extern const YUVToRGBKernels g_yuvToRGBKernelsNEON;
+#endif
+
+} // End of namespace Graphics
+
+#endif
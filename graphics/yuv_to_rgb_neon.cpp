@@ -0,0 +1,162 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/yuv_to_rgb_kernels.h"
+
+#ifdef USE_NEON
+
+#include <arm_neon.h>
+
+namespace Graphics {
+
+// See yuv_to_rgb_x86.cpp: all arithmetic is done on 16 bit lanes, and
+// clamping the sums to [0, 255] matches the spread out rgbToPix tables.
+
+/**
+ * scaleChroma() for eight chroma values minus 128: multiply the magnitude
+ * by intPart + frac / 65536, truncate and restore the sign.
+ */
+static inline int16x8_t scaleChromaNEON(int16x8_t c, int intPart, int frac) {
+	const uint16x8_t a = vreinterpretq_u16_s16(vabsq_s16(c));
+	const uint16x4_t m = vdup_n_u16(frac);
+	uint16x8_t t = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(a), m), 16),
+	                            vshrn_n_u32(vmull_u16(vget_high_u16(a), m), 16));
+	if (intPart)
+		t = vaddq_u16(t, a);
+	const int16x8_t s = vreinterpretq_s16_u16(t);
+	return vbslq_s16(vcltq_s16(c, vdupq_n_s16(0)), vnegq_s16(s), s);
+}
+
+static inline uint16x8_t clampNEON(int16x8_t x) {
+	return vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(x, vdupq_n_s16(0)), vdupq_n_s16(255)));
+}
+
+/** (c >> loss) << shift, with the shift counts as vshlq takes them. */
+struct PixelShiftsNEON {
+	int16x8_t rLoss, rShift, gLoss, gShift, bLoss, bShift;
+	int32x4_t rLoss32, rShift32, gLoss32, gShift32, bLoss32, bShift32;
+	uint32 alpha;
+
+	PixelShiftsNEON(const PixelFormat &format) {
+		rLoss = vdupq_n_s16(-format.rLoss);
+		rShift = vdupq_n_s16(format.rShift);
+		gLoss = vdupq_n_s16(-format.gLoss);
+		gShift = vdupq_n_s16(format.gShift);
+		bLoss = vdupq_n_s16(-format.bLoss);
+		bShift = vdupq_n_s16(format.bShift);
+		rLoss32 = vdupq_n_s32(-format.rLoss);
+		rShift32 = vdupq_n_s32(format.rShift);
+		gLoss32 = vdupq_n_s32(-format.gLoss);
+		gShift32 = vdupq_n_s32(format.gShift);
+		bLoss32 = vdupq_n_s32(-format.bLoss);
+		bShift32 = vdupq_n_s32(format.bShift);
+		alpha = (0xFF >> format.aLoss) << format.aShift;
+	}
+};
+
+static inline void storePixelsNEON(uint16 *dst, uint16x8_t r, uint16x8_t g, uint16x8_t b, const PixelShiftsNEON &shifts) {
+	uint16x8_t p = vdupq_n_u16(shifts.alpha);
+	p = vorrq_u16(p, vshlq_u16(vshlq_u16(r, shifts.rLoss), shifts.rShift));
+	p = vorrq_u16(p, vshlq_u16(vshlq_u16(g, shifts.gLoss), shifts.gShift));
+	p = vorrq_u16(p, vshlq_u16(vshlq_u16(b, shifts.bLoss), shifts.bShift));
+	vst1q_u16(dst, p);
+}
+
+static inline uint32x4_t packChannel32NEON(uint16x4_t c, int32x4_t loss, int32x4_t shift) {
+	return vshlq_u32(vshlq_u32(vmovl_u16(c), loss), shift);
+}
+
+static inline void storePixelsNEON(uint32 *dst, uint16x8_t r, uint16x8_t g, uint16x8_t b, const PixelShiftsNEON &shifts) {
+	const uint32x4_t alpha = vdupq_n_u32(shifts.alpha);
+
+	uint32x4_t p = vorrq_u32(alpha, packChannel32NEON(vget_low_u16(r), shifts.rLoss32, shifts.rShift32));
+	p = vorrq_u32(p, packChannel32NEON(vget_low_u16(g), shifts.gLoss32, shifts.gShift32));
+	p = vorrq_u32(p, packChannel32NEON(vget_low_u16(b), shifts.bLoss32, shifts.bShift32));
+	vst1q_u32(dst, p);
+
+	p = vorrq_u32(alpha, packChannel32NEON(vget_high_u16(r), shifts.rLoss32, shifts.rShift32));
+	p = vorrq_u32(p, packChannel32NEON(vget_high_u16(g), shifts.gLoss32, shifts.gShift32));
+	p = vorrq_u32(p, packChannel32NEON(vget_high_u16(b), shifts.bLoss32, shifts.bShift32));
+	vst1q_u32(dst + 4, p);
+}
+
+/** Convert eight pixels of a row, given the chroma terms for each pixel. */
+template<typename PixelInt>
+static inline void convertPixelsNEON(PixelInt *dst, uint8x8_t y, int16x8_t crR, int16x8_t crbG, int16x8_t cbB, const PixelShiftsNEON &shifts) {
+	const int16x8_t luma = vreinterpretq_s16_u16(vmovl_u8(y));
+	storePixelsNEON(dst, clampNEON(vaddq_s16(luma, crR)), clampNEON(vaddq_s16(luma, crbG)), clampNEON(vaddq_s16(luma, cbB)), shifts);
+}
+
+template<typename PixelInt>
+static void convertRowPairNEON(PixelInt *dst0, PixelInt *dst1, const byte *y0, const byte *y1, const byte *u, const byte *v, uint count, const PixelFormat &format) {
+	const PixelShiftsNEON shifts(format);
+	const int16x8_t bias = vdupq_n_s16(128);
+
+	// Sixteen pixels of each row per iteration
+	for (; count >= 16; count -= 16, dst0 += 16, dst1 += 16, y0 += 16, y1 += 16, u += 8, v += 8) {
+		const int16x8_t cb = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u))), bias);
+		const int16x8_t cr = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v))), bias);
+
+		const int16x8_t crR = scaleChromaNEON(cr, kYUVCrRInt, kYUVCrRFrac);
+		const int16x8_t crbG = vnegq_s16(vaddq_s16(scaleChromaNEON(cr, kYUVCrGInt, kYUVCrGFrac), scaleChromaNEON(cb, kYUVCbGInt, kYUVCbGFrac)));
+		const int16x8_t cbB = scaleChromaNEON(cb, kYUVCbBInt, kYUVCbBFrac);
+
+		// Each chroma sample covers two horizontally adjacent pixels
+		const int16x8x2_t crRDup = vzipq_s16(crR, crR);
+		const int16x8x2_t crbGDup = vzipq_s16(crbG, crbG);
+		const int16x8x2_t cbBDup = vzipq_s16(cbB, cbB);
+
+		const uint8x16_t luma0 = vld1q_u8(y0);
+		convertPixelsNEON(dst0, vget_low_u8(luma0), crRDup.val[0], crbGDup.val[0], cbBDup.val[0], shifts);
+		convertPixelsNEON(dst0 + 8, vget_high_u8(luma0), crRDup.val[1], crbGDup.val[1], cbBDup.val[1], shifts);
+
+		const uint8x16_t luma1 = vld1q_u8(y1);
+		convertPixelsNEON(dst1, vget_low_u8(luma1), crRDup.val[0], crbGDup.val[0], cbBDup.val[0], shifts);
+		convertPixelsNEON(dst1 + 8, vget_high_u8(luma1), crRDup.val[1], crbGDup.val[1], cbBDup.val[1], shifts);
+	}
+
+	for (uint i = 0; i < count; i += 2) {
+		const byte cb = u[i / 2], cr = v[i / 2];
+		dst0[i] = convertYUVPixel(y0[i], cb, cr, format);
+		dst0[i + 1] = convertYUVPixel(y0[i + 1], cb, cr, format);
+		dst1[i] = convertYUVPixel(y1[i], cb, cr, format);
+		dst1[i + 1] = convertYUVPixel(y1[i + 1], cb, cr, format);
+	}
+}
+
+static void convert16NEON(uint16 *dst0, uint16 *dst1, const byte *y0, const byte *y1, const byte *u, const byte *v, uint count, const PixelFormat &format) {
+	convertRowPairNEON(dst0, dst1, y0, y1, u, v, count, format);
+}
+
+static void convert32NEON(uint32 *dst0, uint32 *dst1, const byte *y0, const byte *y1, const byte *u, const byte *v, uint count, const PixelFormat &format) {
+	convertRowPairNEON(dst0, dst1, y0, y1, u, v, count, format);
+}
+
+const YUVToRGBKernels g_yuvToRGBKernelsNEON = {
+	convert16NEON,
+	convert32NEON
+};
+
+} // End of namespace Graphics
+
+#endif // #ifdef USE_NEON
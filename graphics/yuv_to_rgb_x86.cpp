@@ -0,0 +1,317 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/yuv_to_rgb_kernels.h"
+
+#ifdef USE_X86_SIMD
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+// The functions in this file are compiled for the instruction set given in
+// their target attribute, independent of the flags used for the rest of
+// the build. getYUVToRGBKernels() only picks them if the CPU supports it.
+//
+// All arithmetic is done on 16 bit lanes: luma plus chroma term stays
+// within [-256, 512], and clamping that to [0, 255] is what the spread out
+// rgbToPix tables do.
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+/**
+ * The shift counts of PixelFormat::RGBToColor() in the form the SSE2 and
+ * AVX2 shift instructions take them, and the constant alpha bits.
+ *
+ * For 32 bit pixels the SSE2 code also builds the low and high halves in
+ * 16 bit lanes, which saves most of the widening; the shifts into the half
+ * a channel is not in are 16, which clears all bits. This needs each
+ * channel to lie within one half, see splitHalves.
+ */
+struct PixelShifts {
+	__m128i rLoss, rShift, rShiftLo, rShiftHi;
+	__m128i gLoss, gShift, gShiftLo, gShiftHi;
+	__m128i bLoss, bShift, bShiftLo, bShiftHi;
+	uint32 alpha;
+	bool splitHalves;
+};
+
+static SSE2_TARGET void loadChannelShifts(__m128i &loss, __m128i &shift, __m128i &shiftLo, __m128i &shiftHi, bool &splitHalves, uint8 channelLoss, uint8 channelShift) {
+	loss = _mm_cvtsi32_si128(channelLoss);
+	shift = _mm_cvtsi32_si128(channelShift);
+	shiftLo = _mm_cvtsi32_si128(channelShift < 16 ? channelShift : 16);
+	shiftHi = _mm_cvtsi32_si128(channelShift < 16 ? 16 : channelShift - 16);
+	if (channelShift < 16 && channelShift + 8 - channelLoss > 16)
+		splitHalves = false;
+}
+
+static SSE2_TARGET void loadPixelShifts(PixelShifts &shifts, const PixelFormat &format) {
+	shifts.splitHalves = true;
+	loadChannelShifts(shifts.rLoss, shifts.rShift, shifts.rShiftLo, shifts.rShiftHi, shifts.splitHalves, format.rLoss, format.rShift);
+	loadChannelShifts(shifts.gLoss, shifts.gShift, shifts.gShiftLo, shifts.gShiftHi, shifts.splitHalves, format.gLoss, format.gShift);
+	loadChannelShifts(shifts.bLoss, shifts.bShift, shifts.bShiftLo, shifts.bShiftHi, shifts.splitHalves, format.bLoss, format.bShift);
+	shifts.alpha = (0xFF >> format.aLoss) << format.aShift;
+}
+
+/** Convert the pixels which are left over by the SIMD loops. */
+template<typename PixelInt>
+static void convertRowPairTail(PixelInt *dst0, PixelInt *dst1, const byte *y0, const byte *y1, const byte *u, const byte *v, uint count, const PixelFormat &format) {
+	for (uint i = 0; i < count; i += 2) {
+		const byte cb = u[i / 2], cr = v[i / 2];
+		dst0[i] = convertYUVPixel(y0[i], cb, cr, format);
+		dst0[i + 1] = convertYUVPixel(y0[i + 1], cb, cr, format);
+		dst1[i] = convertYUVPixel(y1[i], cb, cr, format);
+		dst1[i + 1] = convertYUVPixel(y1[i + 1], cb, cr, format);
+	}
+}
+
+#pragma mark -
+
+/**
+ * scaleChroma() for eight chroma values minus 128: multiply the magnitude
+ * by intPart + frac / 65536, truncate and restore the sign.
+ */
+static inline SSE2_TARGET __m128i scaleChromaSSE2(__m128i c, int intPart, int frac) {
+	const __m128i sign = _mm_srai_epi16(c, 15);
+	const __m128i a = _mm_sub_epi16(_mm_xor_si128(c, sign), sign);
+	__m128i t = _mm_mulhi_epu16(a, _mm_set1_epi16((int16)frac));
+	if (intPart)
+		t = _mm_add_epi16(t, a);
+	return _mm_sub_epi16(_mm_xor_si128(t, sign), sign);
+}
+
+static inline SSE2_TARGET __m128i clampSSE2(__m128i x) {
+	return _mm_min_epi16(_mm_max_epi16(x, _mm_setzero_si128()), _mm_set1_epi16(255));
+}
+
+static inline SSE2_TARGET __m128i packChannelSSE2(__m128i c, __m128i loss, __m128i shift) {
+	return _mm_sll_epi16(_mm_srl_epi16(c, loss), shift);
+}
+
+static inline SSE2_TARGET void storePixelsSSE2(uint16 *dst, __m128i r, __m128i g, __m128i b, const PixelShifts &shifts) {
+	__m128i p = _mm_set1_epi16((int16)shifts.alpha);
+	p = _mm_or_si128(p, packChannelSSE2(r, shifts.rLoss, shifts.rShift));
+	p = _mm_or_si128(p, packChannelSSE2(g, shifts.gLoss, shifts.gShift));
+	p = _mm_or_si128(p, packChannelSSE2(b, shifts.bLoss, shifts.bShift));
+	_mm_storeu_si128((__m128i *)dst, p);
+}
+
+static inline SSE2_TARGET __m128i packChannel32SSE2(__m128i c, __m128i loss, __m128i shift) {
+	return _mm_sll_epi32(_mm_srl_epi32(c, loss), shift);
+}
+
+static inline SSE2_TARGET void storePixelsSSE2(uint32 *dst, __m128i r, __m128i g, __m128i b, const PixelShifts &shifts) {
+	if (shifts.splitHalves) {
+		r = _mm_srl_epi16(r, shifts.rLoss);
+		g = _mm_srl_epi16(g, shifts.gLoss);
+		b = _mm_srl_epi16(b, shifts.bLoss);
+
+		__m128i lo = _mm_set1_epi16((int16)(shifts.alpha & 0xFFFF));
+		lo = _mm_or_si128(lo, _mm_sll_epi16(r, shifts.rShiftLo));
+		lo = _mm_or_si128(lo, _mm_sll_epi16(g, shifts.gShiftLo));
+		lo = _mm_or_si128(lo, _mm_sll_epi16(b, shifts.bShiftLo));
+
+		__m128i hi = _mm_set1_epi16((int16)(shifts.alpha >> 16));
+		hi = _mm_or_si128(hi, _mm_sll_epi16(r, shifts.rShiftHi));
+		hi = _mm_or_si128(hi, _mm_sll_epi16(g, shifts.gShiftHi));
+		hi = _mm_or_si128(hi, _mm_sll_epi16(b, shifts.bShiftHi));
+
+		_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(lo, hi));
+		_mm_storeu_si128((__m128i *)(dst + 4), _mm_unpackhi_epi16(lo, hi));
+		return;
+	}
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi32(shifts.alpha);
+
+	__m128i p = _mm_or_si128(alpha, packChannel32SSE2(_mm_unpacklo_epi16(r, zero), shifts.rLoss, shifts.rShift));
+	p = _mm_or_si128(p, packChannel32SSE2(_mm_unpacklo_epi16(g, zero), shifts.gLoss, shifts.gShift));
+	p = _mm_or_si128(p, packChannel32SSE2(_mm_unpacklo_epi16(b, zero), shifts.bLoss, shifts.bShift));
+	_mm_storeu_si128((__m128i *)dst, p);
+
+	p = _mm_or_si128(alpha, packChannel32SSE2(_mm_unpackhi_epi16(r, zero), shifts.rLoss, shifts.rShift));
+	p = _mm_or_si128(p, packChannel32SSE2(_mm_unpackhi_epi16(g, zero), shifts.gLoss, shifts.gShift));
+	p = _mm_or_si128(p, packChannel32SSE2(_mm_unpackhi_epi16(b, zero), shifts.bLoss, shifts.bShift));
+	_mm_storeu_si128((__m128i *)(dst + 4), p);
+}
+
+/** Convert eight pixels of a row, given the chroma terms for each pixel. */
+template<typename PixelInt>
+static inline SSE2_TARGET void convertPixelsSSE2(PixelInt *dst, __m128i y, __m128i crR, __m128i crbG, __m128i cbB, const PixelShifts &shifts) {
+	storePixelsSSE2(dst, clampSSE2(_mm_add_epi16(y, crR)), clampSSE2(_mm_add_epi16(y, crbG)), clampSSE2(_mm_add_epi16(y, cbB)), shifts);
+}
+
+template<typename PixelInt>
+static SSE2_TARGET void convertRowPairSSE2(PixelInt *dst0, PixelInt *dst1, const byte *y0, const byte *y1, const byte *u, const byte *v, uint count, const PixelFormat &format) {
+	PixelShifts shifts;
+	loadPixelShifts(shifts, format);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi16(128);
+
+	// Sixteen pixels of each row per iteration
+	for (; count >= 16; count -= 16, dst0 += 16, dst1 += 16, y0 += 16, y1 += 16, u += 8, v += 8) {
+		const __m128i cb = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)u), zero), bias);
+		const __m128i cr = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)v), zero), bias);
+
+		const __m128i crR = scaleChromaSSE2(cr, kYUVCrRInt, kYUVCrRFrac);
+		const __m128i crbG = _mm_sub_epi16(zero, _mm_add_epi16(scaleChromaSSE2(cr, kYUVCrGInt, kYUVCrGFrac), scaleChromaSSE2(cb, kYUVCbGInt, kYUVCbGFrac)));
+		const __m128i cbB = scaleChromaSSE2(cb, kYUVCbBInt, kYUVCbBFrac);
+
+		// Each chroma sample covers two horizontally adjacent pixels
+		const __m128i crRLo = _mm_unpacklo_epi16(crR, crR), crRHi = _mm_unpackhi_epi16(crR, crR);
+		const __m128i crbGLo = _mm_unpacklo_epi16(crbG, crbG), crbGHi = _mm_unpackhi_epi16(crbG, crbG);
+		const __m128i cbBLo = _mm_unpacklo_epi16(cbB, cbB), cbBHi = _mm_unpackhi_epi16(cbB, cbB);
+
+		const __m128i luma0 = _mm_loadu_si128((const __m128i *)y0);
+		convertPixelsSSE2(dst0, _mm_unpacklo_epi8(luma0, zero), crRLo, crbGLo, cbBLo, shifts);
+		convertPixelsSSE2(dst0 + 8, _mm_unpackhi_epi8(luma0, zero), crRHi, crbGHi, cbBHi, shifts);
+
+		const __m128i luma1 = _mm_loadu_si128((const __m128i *)y1);
+		convertPixelsSSE2(dst1, _mm_unpacklo_epi8(luma1, zero), crRLo, crbGLo, cbBLo, shifts);
+		convertPixelsSSE2(dst1 + 8, _mm_unpackhi_epi8(luma1, zero), crRHi, crbGHi, cbBHi, shifts);
+	}
+
+	convertRowPairTail(dst0, dst1, y0, y1, u, v, count, format);
+}
+
+static void convert16SSE2(uint16 *dst0, uint16 *dst1, const byte *y0, const byte *y1, const byte *u, const byte *v, uint count, const PixelFormat &format) {
+	convertRowPairSSE2(dst0, dst1, y0, y1, u, v, count, format);
+}
+
+static void convert32SSE2(uint32 *dst0, uint32 *dst1, const byte *y0, const byte *y1, const byte *u, const byte *v, uint count, const PixelFormat &format) {
+	convertRowPairSSE2(dst0, dst1, y0, y1, u, v, count, format);
+}
+
+const YUVToRGBKernels g_yuvToRGBKernelsSSE2 = {
+	convert16SSE2,
+	convert32SSE2
+};
+
+#pragma mark -
+
+static inline AVX2_TARGET __m256i scaleChromaAVX2(__m256i c, int intPart, int frac) {
+	const __m256i sign = _mm256_srai_epi16(c, 15);
+	const __m256i a = _mm256_sub_epi16(_mm256_xor_si256(c, sign), sign);
+	__m256i t = _mm256_mulhi_epu16(a, _mm256_set1_epi16((int16)frac));
+	if (intPart)
+		t = _mm256_add_epi16(t, a);
+	return _mm256_sub_epi16(_mm256_xor_si256(t, sign), sign);
+}
+
+static inline AVX2_TARGET __m256i clampAVX2(__m256i x) {
+	return _mm256_min_epi16(_mm256_max_epi16(x, _mm256_setzero_si256()), _mm256_set1_epi16(255));
+}
+
+static inline AVX2_TARGET void storePixelsAVX2(uint16 *dst, __m256i r, __m256i g, __m256i b, const PixelShifts &shifts) {
+	__m256i p = _mm256_set1_epi16((int16)shifts.alpha);
+	p = _mm256_or_si256(p, _mm256_sll_epi16(_mm256_srl_epi16(r, shifts.rLoss), shifts.rShift));
+	p = _mm256_or_si256(p, _mm256_sll_epi16(_mm256_srl_epi16(g, shifts.gLoss), shifts.gShift));
+	p = _mm256_or_si256(p, _mm256_sll_epi16(_mm256_srl_epi16(b, shifts.bLoss), shifts.bShift));
+	_mm256_storeu_si256((__m256i *)dst, p);
+}
+
+static inline AVX2_TARGET __m256i packChannel32AVX2(__m128i c, __m128i loss, __m128i shift) {
+	return _mm256_sll_epi32(_mm256_srl_epi32(_mm256_cvtepu16_epi32(c), loss), shift);
+}
+
+static inline AVX2_TARGET void storePixelsAVX2(uint32 *dst, __m256i r, __m256i g, __m256i b, const PixelShifts &shifts) {
+	const __m256i alpha = _mm256_set1_epi32(shifts.alpha);
+
+	__m256i p = _mm256_or_si256(alpha, packChannel32AVX2(_mm256_castsi256_si128(r), shifts.rLoss, shifts.rShift));
+	p = _mm256_or_si256(p, packChannel32AVX2(_mm256_castsi256_si128(g), shifts.gLoss, shifts.gShift));
+	p = _mm256_or_si256(p, packChannel32AVX2(_mm256_castsi256_si128(b), shifts.bLoss, shifts.bShift));
+	_mm256_storeu_si256((__m256i *)dst, p);
+
+	p = _mm256_or_si256(alpha, packChannel32AVX2(_mm256_extracti128_si256(r, 1), shifts.rLoss, shifts.rShift));
+	p = _mm256_or_si256(p, packChannel32AVX2(_mm256_extracti128_si256(g, 1), shifts.gLoss, shifts.gShift));
+	p = _mm256_or_si256(p, packChannel32AVX2(_mm256_extracti128_si256(b, 1), shifts.bLoss, shifts.bShift));
+	_mm256_storeu_si256((__m256i *)(dst + 8), p);
+}
+
+/** Convert sixteen pixels of a row, given the chroma terms for each pixel. */
+template<typename PixelInt>
+static inline AVX2_TARGET void convertPixelsAVX2(PixelInt *dst, __m128i y, __m256i crR, __m256i crbG, __m256i cbB, const PixelShifts &shifts) {
+	const __m256i luma = _mm256_cvtepu8_epi16(y);
+	storePixelsAVX2(dst, clampAVX2(_mm256_add_epi16(luma, crR)), clampAVX2(_mm256_add_epi16(luma, crbG)), clampAVX2(_mm256_add_epi16(luma, cbB)), shifts);
+}
+
+/**
+ * Duplicate each of sixteen chroma terms for two adjacent pixels; lo gets
+ * pixels 0 to 15, hi pixels 16 to 31. The unpack instructions work within
+ * 128 bit lanes, hence the permutes.
+ */
+static inline AVX2_TARGET void duplicateAVX2(__m256i c, __m256i &lo, __m256i &hi) {
+	const __m256i a = _mm256_unpacklo_epi16(c, c);
+	const __m256i b = _mm256_unpackhi_epi16(c, c);
+	lo = _mm256_permute2x128_si256(a, b, 0x20);
+	hi = _mm256_permute2x128_si256(a, b, 0x31);
+}
+
+template<typename PixelInt>
+static AVX2_TARGET void convertRowPairAVX2(PixelInt *dst0, PixelInt *dst1, const byte *y0, const byte *y1, const byte *u, const byte *v, uint count, const PixelFormat &format) {
+	PixelShifts shifts;
+	loadPixelShifts(shifts, format);
+	const __m256i bias = _mm256_set1_epi16(128);
+
+	// Thirty-two pixels of each row per iteration
+	for (; count >= 32; count -= 32, dst0 += 32, dst1 += 32, y0 += 32, y1 += 32, u += 16, v += 16) {
+		const __m256i cb = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)u)), bias);
+		const __m256i cr = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)v)), bias);
+
+		const __m256i crR = scaleChromaAVX2(cr, kYUVCrRInt, kYUVCrRFrac);
+		const __m256i crbG = _mm256_sub_epi16(_mm256_setzero_si256(), _mm256_add_epi16(scaleChromaAVX2(cr, kYUVCrGInt, kYUVCrGFrac), scaleChromaAVX2(cb, kYUVCbGInt, kYUVCbGFrac)));
+		const __m256i cbB = scaleChromaAVX2(cb, kYUVCbBInt, kYUVCbBFrac);
+
+		__m256i crRLo, crRHi, crbGLo, crbGHi, cbBLo, cbBHi;
+		duplicateAVX2(crR, crRLo, crRHi);
+		duplicateAVX2(crbG, crbGLo, crbGHi);
+		duplicateAVX2(cbB, cbBLo, cbBHi);
+
+		convertPixelsAVX2(dst0, _mm_loadu_si128((const __m128i *)y0), crRLo, crbGLo, cbBLo, shifts);
+		convertPixelsAVX2(dst0 + 16, _mm_loadu_si128((const __m128i *)(y0 + 16)), crRHi, crbGHi, cbBHi, shifts);
+		convertPixelsAVX2(dst1, _mm_loadu_si128((const __m128i *)y1), crRLo, crbGLo, cbBLo, shifts);
+		convertPixelsAVX2(dst1 + 16, _mm_loadu_si128((const __m128i *)(y1 + 16)), crRHi, crbGHi, cbBHi, shifts);
+	}
+
+	// The tail is done in C++ rather than by the SSE2 code, which would
+	// have to pay for the switch from AVX to SSE instructions.
+	convertRowPairTail(dst0, dst1, y0, y1, u, v, count, format);
+}
+
+static void convert16AVX2(uint16 *dst0, uint16 *dst1, const byte *y0, const byte *y1, const byte *u, const byte *v, uint count, const PixelFormat &format) {
+	convertRowPairAVX2(dst0, dst1, y0, y1, u, v, count, format);
+}
+
+static void convert32AVX2(uint32 *dst0, uint32 *dst1, const byte *y0, const byte *y1, const byte *u, const byte *v, uint count, const PixelFormat &format) {
+	convertRowPairAVX2(dst0, dst1, y0, y1, u, v, count, format);
+}
+
+const YUVToRGBKernels g_yuvToRGBKernelsAVX2 = {
+	convert16AVX2,
+	convert32AVX2
+};
+
+} // End of namespace Graphics
+
+#endif // #ifdef USE_X86_SIMD
@@ -0,0 +1,210 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "gui/ThemeDrawCache.h"
+
+#include "common/util.h"
+
+#include "graphics/surface.h"
+
+namespace GUI {
+
+bool ThemeDrawCache::Key::operator==(const Key &key) const {
+	return drawData == key.drawData && width == key.width && height == key.height &&
+		dynamicData == key.dynamicData && shadows == key.shadows &&
+		!memcmp(colors, key.colors, sizeof(colors));
+}
+
+uint ThemeDrawCache::KeyHash::operator()(const Key &key) const {
+	uint hash = (uint)(size_t)key.drawData;
+	hash = hash * 31 + ((key.width << 16) | key.height);
+	hash = hash * 31 + key.dynamicData;
+	hash = hash * 31 + key.shadows;
+	for (int i = 0; i < 5; i++)
+		hash = hash * 31 + key.colors[i];
+	return hash;
+}
+
+ThemeDrawCache::ThemeDrawCache(uint32 maxSize)
+	: _maxSize(maxSize), _size(0), _useCounter(0), _entryCount(0),
+	  _hits(0), _misses(0), _evictions(0), _pending(0), _pendingSize(0), _pendingCapacity(0) {
+}
+
+ThemeDrawCache::~ThemeDrawCache() {
+	clear();
+	delete[] _pending;
+}
+
+bool ThemeDrawCache::samePixels(const byte *pixels, const Graphics::Surface *surface, const Common::Rect &area) {
+	const uint rowSize = area.width() * surface->format.bytesPerPixel;
+	for (int y = area.top; y < area.bottom; y++) {
+		if (memcmp(pixels, surface->getBasePtr(area.left, y), rowSize))
+			return false;
+		pixels += rowSize;
+	}
+	return true;
+}
+
+void ThemeDrawCache::copyPixels(byte *dst, const Graphics::Surface *surface, const Common::Rect &area) {
+	const uint rowSize = area.width() * surface->format.bytesPerPixel;
+	for (int y = area.top; y < area.bottom; y++) {
+		memcpy(dst, surface->getBasePtr(area.left, y), rowSize);
+		dst += rowSize;
+	}
+}
+
+bool ThemeDrawCache::lookup(const Key &key, Graphics::Surface *surface, const Common::Rect &area) {
+	assert(area.left >= 0 && area.top >= 0 && area.right <= surface->w && area.bottom <= surface->h);
+
+	EntryMap::iterator it = _entries.find(key);
+	if (it != _entries.end()) {
+		for (Entry *entry = it->_value; entry; entry = entry->next) {
+			if (entry->width != area.width() || entry->height != area.height())
+				continue;
+			if (!samePixels(entry->before, surface, area))
+				continue;
+
+			const uint rowSize = area.width() * surface->format.bytesPerPixel;
+			const byte *src = entry->after;
+			for (int y = area.top; y < area.bottom; y++) {
+				memcpy(surface->getBasePtr(area.left, y), src, rowSize);
+				src += rowSize;
+			}
+
+			entry->lastUse = ++_useCounter;
+			_hits++;
+			return true;
+		}
+	}
+
+	_misses++;
+
+	const uint32 size = area.width() * area.height() * surface->format.bytesPerPixel;
+	if (size > _maxSize / 4) {
+		// Too large to be worth caching, e.g. a full screen background
+		_pendingSize = 0;
+		return false;
+	}
+
+	if (size > _pendingCapacity || !_pending) {
+		delete[] _pending;
+		_pending = new byte[MAX<uint32>(size, 1)];
+		_pendingCapacity = size;
+	}
+	_pendingSize = size;
+	copyPixels(_pending, surface, area);
+	return false;
+}
+
+void ThemeDrawCache::store(const Key &key, const Graphics::Surface *surface, const Common::Rect &area) {
+	const uint32 size = area.width() * area.height() * surface->format.bytesPerPixel;
+	if (!_pendingSize || size != _pendingSize)
+		return;
+
+	evict(2 * size);
+
+	Entry *entry = new Entry();
+	entry->width = area.width();
+	entry->height = area.height();
+	entry->size = size;
+	entry->lastUse = ++_useCounter;
+	entry->before = new byte[2 * size];
+	entry->after = entry->before + size;
+	memcpy(entry->before, _pending, size);
+	copyPixels(entry->after, surface, area);
+	_pendingSize = 0;
+
+	// Keep the most recent variants of the key
+	Entry *&first = _entries[key];
+	entry->next = first;
+	first = entry;
+	_size += 2 * size;
+	_entryCount++;
+
+	uint variants = 1;
+	for (Entry *e = entry; e->next; ) {
+		if (++variants > kMaxVariants) {
+			Entry *dropped = e->next;
+			e->next = dropped->next;
+			freeEntry(dropped);
+		} else {
+			e = e->next;
+		}
+	}
+}
+
+void ThemeDrawCache::freeEntry(Entry *entry) {
+	_size -= 2 * entry->size;
+	_entryCount--;
+	delete[] entry->before;
+	delete entry;
+}
+
+void ThemeDrawCache::evict(uint32 neededSize) {
+	while (_size + neededSize > _maxSize && !_entries.empty()) {
+		// Find the least recently used entry
+		EntryMap::iterator oldestKey = _entries.end();
+		Entry **oldest = 0;
+		for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+			for (Entry **entry = &it->_value; *entry; entry = &(*entry)->next) {
+				if (!oldest || (*entry)->lastUse < (*oldest)->lastUse) {
+					oldest = entry;
+					oldestKey = it;
+				}
+			}
+		}
+
+		Entry *dropped = *oldest;
+		*oldest = dropped->next;
+		freeEntry(dropped);
+		_evictions++;
+
+		if (!oldestKey->_value)
+			_entries.erase(oldestKey);
+	}
+}
+
+void ThemeDrawCache::clear() {
+	for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		Entry *entry = it->_value;
+		while (entry) {
+			Entry *next = entry->next;
+			freeEntry(entry);
+			entry = next;
+		}
+	}
+	_entries.clear();
+	_pendingSize = 0;
+}
+
+ThemeDrawCache::Stats ThemeDrawCache::getStats() const {
+	Stats stats;
+	stats.hits = _hits;
+	stats.misses = _misses;
+	stats.evictions = _evictions;
+	stats.entries = _entryCount;
+	stats.size = _size;
+	return stats;
+}
+
+} // End of namespace GUI
@@ -0,0 +1,146 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef GUI_THEME_DRAW_CACHE_H
+#define GUI_THEME_DRAW_CACHE_H
+
+#include "common/scummsys.h"
+#include "common/hashmap.h"
+#include "common/rect.h"
+
+namespace Graphics {
+struct Surface;
+}
+
+namespace GUI {
+
+/**
+ * Cache for the pixels produced by the draw steps of theme widgets.
+ *
+ * Rasterizing gradients, rounded corners and shadows is expensive, and the
+ * same widgets are drawn over and over again, e.g. when scrolling a list or
+ * moving the mouse over buttons. The cache remembers the pixels of the area
+ * a widget covers before and after its draw steps ran. When the same draw
+ * data is drawn with the same size on the same pixels again, the result is
+ * copied instead, wherever on the screen that happens.
+ *
+ * Entries are evicted least recently used first, once the memory budget is
+ * exceeded.
+ */
+class ThemeDrawCache {
+public:
+	enum {
+		/** Default memory budget, in bytes */
+		kDefaultMaxSize = 4 * 1024 * 1024,
+		/** Entries kept for the same key, for widgets on different backgrounds */
+		kMaxVariants = 4
+	};
+
+	/** Everything besides the background which influences the result. */
+	struct Key {
+		const void *drawData;	///< The draw data (i.e. the widget and its state)
+		uint16 width, height;	///< Size of the widget
+		uint32 dynamicData;		///< Dynamic data passed to the draw steps
+		bool shadows;			///< Whether shadows are drawn
+		uint32 colors[5];		///< Colors inherited from the previous draw steps
+
+		Key() : drawData(0), width(0), height(0), dynamicData(0), shadows(true) {
+			memset(colors, 0, sizeof(colors));
+		}
+
+		bool operator==(const Key &key) const;
+	};
+
+	struct Stats {
+		uint32 hits;			///< Lookups which found the pixels
+		uint32 misses;			///< Lookups which did not
+		uint32 evictions;		///< Entries dropped for lack of space
+		uint32 entries;			///< Entries currently cached
+		uint32 size;			///< Memory used by them, in bytes
+	};
+
+	ThemeDrawCache(uint32 maxSize = kDefaultMaxSize);
+	~ThemeDrawCache();
+
+	/**
+	 * Look for the result of drawing a widget. On a hit, the area of the
+	 * surface is replaced by the cached pixels. On a miss, the current
+	 * content of the area is remembered for the following store().
+	 *
+	 * @param key		the widget to draw
+	 * @param surface	the surface to draw on
+	 * @param area		the pixels the draw steps may change; needs to lie
+	 *					inside the surface
+	 * @return whether the cached pixels were used
+	 */
+	bool lookup(const Key &key, Graphics::Surface *surface, const Common::Rect &area);
+
+	/**
+	 * Add the result of drawing a widget after a failed lookup() with the
+	 * same arguments.
+	 */
+	void store(const Key &key, const Graphics::Surface *surface, const Common::Rect &area);
+
+	/** Drop all entries, e.g. when the theme or the screen format change. */
+	void clear();
+
+	/** Current statistics. */
+	Stats getStats() const;
+
+private:
+	struct Entry {
+		uint16 width, height;	///< Size of the area
+		uint32 size;			///< Bytes of each of the pixel buffers
+		uint32 lastUse;
+		byte *before;			///< The pixels before drawing...
+		byte *after;			///< ...and after, in the same buffer
+		Entry *next;			///< Next entry with the same key
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const;
+	};
+
+	typedef Common::HashMap<Key, Entry *, KeyHash> EntryMap;
+
+	EntryMap _entries;
+	uint32 _maxSize;
+	uint32 _size;
+	uint32 _useCounter;
+	uint32 _entryCount;
+	uint32 _hits, _misses, _evictions;
+
+	/** The pixels of the area at the last lookup() which missed */
+	byte *_pending;
+	uint32 _pendingSize;
+	uint32 _pendingCapacity;
+
+	static bool samePixels(const byte *pixels, const Graphics::Surface *surface, const Common::Rect &area);
+	static void copyPixels(byte *dst, const Graphics::Surface *surface, const Common::Rect &area);
+	void freeEntry(Entry *entry);
+	void evict(uint32 neededSize);
+};
+
+} // End of namespace GUI
+
+#endif
@@ -21,6 +21,7 @@
  */
 
 #include "common/system.h"
+#include "common/debug.h"
 #include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
@@ -217,11 +218,8 @@ void ThemeItemDrawData::drawSelf(bool draw, bool restore) {
 	if (restore)
 		_engine->restoreBackground(extendedRect);
 
-	if (draw) {
-		Common::List<Graphics::DrawStep>::const_iterator step;
-		for (step = _data->_steps.begin(); step != _data->_steps.end(); ++step)
-			_engine->renderer()->drawStep(_area, *step, _dynamicData);
-	}
+	if (draw)
+		_engine->drawDrawData(_data, _area, extendedRect, _dynamicData);
 
 	_engine->addDirtyRect(extendedRect);
 }
@@ -260,7 +258,7 @@ void ThemeItemBitmap::drawSelf(bool draw, bool restore) {
 ThemeEngine::ThemeEngine(Common::String id, GraphicsMode mode) :
 	_system(0), _vectorRenderer(0),
 	_buffering(false), _bytesPerPixel(0),  _graphicsMode(kGfxDisabled),
-	_font(0), _initOk(false), _themeOk(false), _enabled(false), _cursor(0) {
+	_font(0), _drawCacheReportedLookups(0), _initOk(false), _themeOk(false), _enabled(false), _cursor(0) {
 
 	_system = g_system;
 	_parser = new ThemeParser(this);
@@ -503,6 +501,8 @@ void ThemeEngine::setGraphicsMode(GraphicsMode mode) {
 	delete _vectorRenderer;
 	_vectorRenderer = Graphics::createRenderer(mode);
 	_vectorRenderer->setSurface(&_screen);
+
+	_drawCache.clear();
 }
 
 void WidgetDrawData::calcBackgroundOffset() {
@@ -524,6 +524,39 @@ void ThemeEngine::restoreBackground(Common::Rect r) {
 	_vectorRenderer->blitSurface(&_backBuffer, r);
 }
 
+void ThemeEngine::drawDrawData(const WidgetDrawData *data, const Common::Rect &area, const Common::Rect &extendedArea, uint32 dynamic) {
+	Graphics::Surface *surface = _vectorRenderer->getSurface();
+
+	// Near the edges of the screen, shadows are clipped depending on the
+	// position of the widget, so those are always drawn
+	const bool cacheable = extendedArea.left >= 0 && extendedArea.top >= 0 &&
+		extendedArea.right <= surface->w && extendedArea.bottom <= surface->h;
+
+	Common::List<Graphics::DrawStep>::const_iterator step;
+	ThemeDrawCache::Key key;
+	if (cacheable) {
+		key.drawData = data;
+		key.width = area.width();
+		key.height = area.height();
+		key.dynamicData = dynamic;
+		key.shadows = !_vectorRenderer->shadowsDisabled();
+		_vectorRenderer->getColors(key.colors);
+
+		if (_drawCache.lookup(key, surface, extendedArea)) {
+			// Leave the renderer in the state drawing the steps would
+			for (step = data->_steps.begin(); step != data->_steps.end(); ++step)
+				_vectorRenderer->setDrawStepState(*step, dynamic);
+			return;
+		}
+	}
+
+	for (step = data->_steps.begin(); step != data->_steps.end(); ++step)
+		_vectorRenderer->drawStep(area, *step, dynamic);
+
+	if (cacheable)
+		_drawCache.store(key, surface, extendedArea);
+}
+
 
 
 /**********************************************************
@@ -700,6 +733,7 @@ void ThemeEngine::unloadTheme() {
 		_textColors[i] = 0;
 	}
 
+	_drawCache.clear();
 	_themeEval->reset();
 	_themeOk = false;
 }
@@ -1178,6 +1212,40 @@ void ThemeEngine::drawChar(const Common::Rect &r, byte ch, const Graphics::Font
 	addDirtyRect(charArea);
 }
 
+void ThemeEngine::drawChars(const Common::Rect &r, const Common::String &str, const Graphics::Font *font, WidgetStateInfo state, FontColor color) {
+	if (!ready())
+		return;
+
+	Common::Rect area = r;
+	area.clip(_screen.w, _screen.h);
+
+	uint32 rgbColor = _overlayFormat.RGBToColor(_textColors[color]->r, _textColors[color]->g, _textColors[color]->b);
+
+	restoreBackground(area);
+
+	// The cell of each character is as wide as the widest one. If all of
+	// them fill their cell, drawString() places them at the same positions
+	// and can draw them as one cached run.
+	const int cellWidth = font->getMaxCharWidth();
+	uint length = str.size();
+	bool fixedWidth = true;
+	for (uint i = 0; i < length && fixedWidth; ++i)
+		fixedWidth = font->getCharWidth(str[i]) == cellWidth;
+
+	if (fixedWidth) {
+		// Trailing spaces only make the run longer
+		while (length > 0 && str[length - 1] == ' ')
+			--length;
+		font->drawString(&_screen, Common::String(str.c_str(), length), area.left, area.top, area.width(), rgbColor, Graphics::kTextAlignLeft, 0, false);
+	} else {
+		int x = area.left;
+		for (uint i = 0; i < length && x < area.right; ++i, x += cellWidth)
+			font->drawChar(&_screen, str[i], x, area.top, rgbColor);
+	}
+
+	addDirtyRect(area);
+}
+
 void ThemeEngine::debugWidgetPosition(const char *name, const Common::Rect &r) {
 	_font->drawString(&_screen, name, r.left, r.top, r.width(), 0xFFFF, Graphics::kTextAlignRight, 0, true);
 	_screen.hLine(r.left, r.top, r.right, 0xFFFF);
@@ -1214,6 +1282,13 @@ void ThemeEngine::updateScreen(bool render) {
 		_screenQueue.clear();
 	}
 
+	const ThemeDrawCache::Stats stats = _drawCache.getStats();
+	if (stats.hits + stats.misses != _drawCacheReportedLookups) {
+		_drawCacheReportedLookups = stats.hits + stats.misses;
+		debug(3, "ThemeEngine: Draw cache: %u hits, %u misses, %u evictions, %u entries (%u KB)",
+		      stats.hits, stats.misses, stats.evictions, stats.entries, stats.size / 1024);
+	}
+
 	if (render)
 		renderDirtyScreen();
 }
@@ -34,6 +34,8 @@
 #include "graphics/font.h"
 #include "graphics/pixelformat.h"
 
+#include "gui/ThemeDrawCache.h"
+
 
 #define SCUMMVM_THEME_VERSION_STR "SCUMMVM_STX0.8.3"
 
@@ -354,6 +356,13 @@ public:
 
 	void drawChar(const Common::Rect &r, byte ch, const Graphics::Font *font, WidgetStateInfo state = kStateEnabled, FontColor color = kFontColorNormal);
 
+	/**
+	 * Draw the characters of str like drawChar() would, one after another
+	 * in cells of the maximal character width of the font, starting at the
+	 * top left corner of r.
+	 */
+	void drawChars(const Common::Rect &r, const Common::String &str, const Graphics::Font *font, WidgetStateInfo state = kStateEnabled, FontColor color = kFontColorNormal);
+
 	//@}
 
 
@@ -499,6 +508,21 @@ public:
 	 */
 	void restoreBackground(Common::Rect r);
 
+	/**
+	 * Draws the draw steps of a DrawData item on the active surface of the
+	 * renderer, reusing the pixels of an earlier identical drawing if the
+	 * draw cache has them.
+	 *
+	 * @param data DrawData item to draw.
+	 * @param area Area of the widget.
+	 * @param extendedArea Area the draw steps may change, including shadows.
+	 * @param dynamic Dynamic data passed to the draw steps.
+	 */
+	void drawDrawData(const WidgetDrawData *data, const Common::Rect &area, const Common::Rect &extendedArea, uint32 dynamic);
+
+	/** Statistics of the cache used by drawDrawData(). */
+	ThemeDrawCache::Stats getDrawCacheStats() const { return _drawCache.getStats(); }
+
 	const Common::String &getThemeName() const { return _themeName; }
 	const Common::String &getThemeId() const { return _themeId; }
 	int getGraphicsMode() const { return _graphicsMode; }
@@ -635,6 +659,10 @@ protected:
 	TextColorData *_textColors[kTextColorMAX];
 
 	ImagesMap _bitmaps;
+
+	/** Pixels of recently drawn DrawData items */
+	ThemeDrawCache _drawCache;
+	uint32 _drawCacheReportedLookups;
 	Graphics::PixelFormat _overlayFormat;
 #ifdef USE_RGB_COLOR
 	Graphics::PixelFormat _cursorFormat;
@@ -191,16 +191,18 @@ void ConsoleDialog::drawLine(int line, bool restoreBg) {
 		g_gui.theme()->addDirtyRect(r);
 	}
 
+	// Draw the whole line at once, so that the theme can draw it from a
+	// cached run of glyphs
+	Common::String text;
 	for (int column = 0; column < limit; column++) {
 #if 0
 		int l = (start + line) % _linesInBuffer;
-		byte c = buffer(l * kCharsPerLine + column);
+		text += buffer(l * kCharsPerLine + column);
 #else
-		byte c = buffer((start + line) * kCharsPerLine + column);
+		text += buffer((start + line) * kCharsPerLine + column);
 #endif
-		g_gui.theme()->drawChar(Common::Rect(x, y, x+kConsoleCharWidth, y+kConsoleLineHeight), c, _font);
-		x += kConsoleCharWidth;
 	}
+	g_gui.theme()->drawChars(Common::Rect(x, y, x + limit * kConsoleCharWidth, y + kConsoleLineHeight), text, _font);
 
 	g_gui.theme()->updateScreen();
 }
@@ -15,6 +15,7 @@ MODULE_OBJS := \
 	options.o \
 	saveload.o \
 	themebrowser.o \
+	ThemeDrawCache.o \
 	ThemeEngine.o \
 	ThemeEval.o \
 	ThemeLayout.o \
@@ -0,0 +1,146 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixkernels.h"
+#include "audio/rate.h"
+#include "common/cpudetect.h"
+#include "common/memstream.h"
+
+#include "helper.h"
+
+class MixKernelsTestSuite : public CxxTest::TestSuite
+{
+private:
+	uint32 _seed;
+
+	int16 random16() {
+		_seed = _seed * 1103515245 + 12345;
+		return (int16)(_seed >> 16);
+	}
+
+	void fillRandom(int16 *buf, int len) {
+		for (int i = 0; i < len; ++i)
+			buf[i] = random16();
+
+		// Make sure the extremes are covered, too
+		if (len > 3) {
+			buf[0] = -32768;
+			buf[1] = 32767;
+			buf[2] = -1;
+		}
+	}
+
+	void compareKernels(const Audio::MixKernels &kernels) {
+		const Audio::MixKernels &reference = Audio::getScalarMixKernels();
+		// Odd lengths exercise the scalar tails of the SIMD loops
+		const int lengths[] = { 0, 1, 3, 7, 8, 15, 16, 33, 257 };
+		const Audio::st_volume_t volumes[] = { 0, 1, 100, 255, 256 };
+
+		int16 src[2 * 257], src2[2 * 257], expected[2 * 257], result[2 * 257];
+		uint16 pos[2 * 257];
+
+		for (int l = 0; l < ARRAYSIZE(lengths); ++l) {
+			const int len = lengths[l];
+
+			for (int v = 0; v < ARRAYSIZE(volumes); ++v) {
+				const Audio::st_volume_t volL = volumes[v];
+				const Audio::st_volume_t volR = volumes[ARRAYSIZE(volumes) - 1 - v];
+
+				for (int reverse = 0; reverse < 2; ++reverse) {
+					fillRandom(src, 2 * len);
+					fillRandom(expected, 2 * len);
+					memcpy(result, expected, sizeof(result));
+
+					reference.mixStereo(expected, src, len, volL, volR, reverse != 0);
+					kernels.mixStereo(result, src, len, volL, volR, reverse != 0);
+					TS_ASSERT_EQUALS(memcmp(expected, result, 2 * len * sizeof(int16)), 0);
+				}
+
+				fillRandom(src, len);
+				fillRandom(expected, 2 * len);
+				memcpy(result, expected, sizeof(result));
+
+				reference.mixMono(expected, src, len, volL, volR);
+				kernels.mixMono(result, src, len, volL, volR);
+				TS_ASSERT_EQUALS(memcmp(expected, result, 2 * len * sizeof(int16)), 0);
+			}
+
+			fillRandom(src, len);
+			fillRandom(src2, len);
+			fillRandom((int16 *)pos, len);
+
+			reference.interpolate(expected, src, src2, pos, len);
+			kernels.interpolate(result, src, src2, pos, len);
+			TS_ASSERT_EQUALS(memcmp(expected, result, len * sizeof(int16)), 0);
+		}
+	}
+
+	void compareConverter(int inRate, int outRate, bool isStereo, bool reverseStereo) {
+		const int outSamples = 4096;
+		int16 expected[2 * outSamples], result[2 * outSamples];
+
+		Audio::RateConverter *reference, *converter;
+		Audio::SeekableAudioStream *s1 = createSineStream<int16>(inRate, 1, 0, false, isStereo);
+		Audio::SeekableAudioStream *s2 = createSineStream<int16>(inRate, 1, 0, false, isStereo);
+
+		memset(expected, 0, sizeof(expected));
+		memset(result, 0, sizeof(result));
+
+		Common::setCPUFeatureMask(0);
+		reference = Audio::makeRateConverter(inRate, outRate, isStereo, reverseStereo);
+		const int expectedLen = reference->flow(*s1, expected, outSamples, 200, 150);
+
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		converter = Audio::makeRateConverter(inRate, outRate, isStereo, reverseStereo);
+		const int resultLen = converter->flow(*s2, result, outSamples, 200, 150);
+
+		TS_ASSERT_EQUALS(expectedLen, resultLen);
+		TS_ASSERT_EQUALS(memcmp(expected, result, sizeof(expected)), 0);
+
+		delete reference;
+		delete converter;
+		delete s1;
+		delete s2;
+	}
+
+public:
+	void setUp() {
+		_seed = 0x5CBB;
+	}
+
+	void test_sse2() {
+		const Audio::MixKernels *kernels = Audio::getMixKernels(Common::kCPUFeatureSSE2);
+		if (kernels)
+			compareKernels(*kernels);
+	}
+
+	void test_avx2() {
+		const Audio::MixKernels *kernels = Audio::getMixKernels(Common::kCPUFeatureAVX2);
+		if (kernels)
+			compareKernels(*kernels);
+	}
+
+	void test_neon() {
+		const Audio::MixKernels *kernels = Audio::getMixKernels(Common::kCPUFeatureNEON);
+		if (kernels)
+			compareKernels(*kernels);
+	}
+
+	void test_copy_converter() {
+		compareConverter(22050, 22050, false, false);
+		compareConverter(22050, 22050, true, false);
+		compareConverter(22050, 22050, true, true);
+	}
+
+	void test_simple_converter() {
+		compareConverter(44100, 22050, false, false);
+		compareConverter(44100, 22050, true, false);
+		compareConverter(44100, 22050, true, true);
+	}
+
+	void test_linear_converter() {
+		compareConverter(11025, 48000, false, false);
+		compareConverter(22050, 44100, true, false);
+		compareConverter(22050, 48000, true, true);
+	}
+};
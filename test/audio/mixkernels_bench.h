@@ -0,0 +1,96 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixkernels.h"
+#include "audio/rate.h"
+#include "common/cpudetect.h"
+#include "common/memstream.h"
+
+#include "helper.h"
+#include "../benchmark.h"
+
+class MixKernelsBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kPairs = 4096,
+		kIterations = 2000
+	};
+
+	int16 _src[2 * kPairs], _src2[2 * kPairs], _dst[2 * kPairs];
+	uint16 _pos[kPairs];
+
+	void benchKernels(const char *name, const Audio::MixKernels *kernels) {
+		if (!kernels)
+			return;
+
+		BenchmarkTimer timer;
+		for (int i = 0; i < kIterations; ++i)
+			kernels->mixStereo(_dst, _src, kPairs, 200, 150, false);
+		reportBenchmark(Common::String::format("%s mixStereo", name).c_str(), (uint32)kPairs * kIterations, timer.elapsedMicros(), "frames");
+
+		timer.start();
+		for (int i = 0; i < kIterations; ++i)
+			kernels->mixMono(_dst, _src, kPairs, 200, 150);
+		reportBenchmark(Common::String::format("%s mixMono", name).c_str(), (uint32)kPairs * kIterations, timer.elapsedMicros(), "frames");
+
+		timer.start();
+		for (int i = 0; i < kIterations; ++i)
+			kernels->interpolate(_dst, _src, _src2, _pos, kPairs);
+		reportBenchmark(Common::String::format("%s interpolate", name).c_str(), (uint32)kPairs * kIterations, timer.elapsedMicros(), "samples");
+	}
+
+	void benchConverter(const char *name, int inRate, int outRate, bool isStereo) {
+		const int seconds = 10;
+		Audio::SeekableAudioStream *stream = createSineStream<int16>(inRate, seconds, 0, false, isStereo);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, isStereo);
+
+		uint32 total = 0;
+		BenchmarkTimer timer;
+		int len;
+		while ((len = converter->flow(*stream, _dst, kPairs, 200, 150)) > 0)
+			total += len;
+		reportBenchmark(name, total, timer.elapsedMicros(), "frames");
+
+		delete converter;
+		delete stream;
+	}
+
+	void benchConverters(const char *kernelName) {
+		benchConverter(Common::String::format("%s copy 44100->44100", kernelName).c_str(), 44100, 44100, true);
+		benchConverter(Common::String::format("%s simple 44100->22050", kernelName).c_str(), 44100, 22050, true);
+		benchConverter(Common::String::format("%s linear 22050->48000", kernelName).c_str(), 22050, 48000, true);
+		benchConverter(Common::String::format("%s linear mono 11025->44100", kernelName).c_str(), 11025, 44100, false);
+	}
+
+public:
+	void setUp() {
+		uint32 seed = 1;
+		for (int i = 0; i < 2 * kPairs; ++i) {
+			seed = seed * 1103515245 + 12345;
+			_src[i] = (int16)(seed >> 16);
+			_src2[i] = (int16)seed;
+		}
+		for (int i = 0; i < kPairs; ++i)
+			_pos[i] = (uint16)(i * 40503);
+		memset(_dst, 0, sizeof(_dst));
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+	}
+
+	void test_kernels() {
+		benchKernels("scalar", &Audio::getScalarMixKernels());
+		benchKernels("SSE2", Audio::getMixKernels(Common::kCPUFeatureSSE2));
+		benchKernels("AVX2", Audio::getMixKernels(Common::kCPUFeatureAVX2));
+		benchKernels("NEON", Audio::getMixKernels(Common::kCPUFeatureNEON));
+	}
+
+	void test_converters() {
+		Common::setCPUFeatureMask(0);
+		benchConverters("scalar");
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		benchConverters("best");
+	}
+};
@@ -0,0 +1,103 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/decoders/raw.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+#include "common/math.h"
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kOutSamples = 8192
+	};
+
+	int16 _out[2 * kOutSamples];
+
+	static Audio::SeekableAudioStream *createToneStream(int rate, int frequency, int amplitude, int samples) {
+		int16 *buffer = (int16 *)malloc(samples * sizeof(int16));
+		for (int i = 0; i < samples; ++i) {
+			if (frequency)
+				buffer[i] = (int16)(sin(2 * M_PI * frequency * i / rate) * amplitude);
+			else
+				buffer[i] = amplitude;
+		}
+
+		return Audio::makeRawStream((const byte *)buffer, samples * sizeof(int16), rate,
+		                            Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN, DisposeAfterUse::YES);
+	}
+
+	int convert(Audio::ResamplerType resampler, int inRate, int outRate, int frequency, int amplitude) {
+		Audio::SeekableAudioStream *stream = createToneStream(inRate, frequency, amplitude, inRate);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, false, false, resampler);
+
+		memset(_out, 0, sizeof(_out));
+		const int len = converter->flow(*stream, _out, kOutSamples, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+
+		delete converter;
+		delete stream;
+		return len;
+	}
+
+	/** Peak of the left channel, skipping the filter's startup. */
+	int peak(int len) {
+		int result = 0;
+		for (int i = 64; i < len; ++i)
+			result = MAX<int>(result, ABS<int>(_out[2 * i]));
+		return result;
+	}
+
+public:
+	void test_polyphase_dc() {
+		const int len = convert(Audio::kResamplerPolyphase, 22050, 48000, 0, 10000);
+		TS_ASSERT_EQUALS(len, kOutSamples);
+
+		// Constant input has to give exactly the same constant output
+		for (int i = 64; i < len; ++i) {
+			TS_ASSERT_EQUALS(_out[2 * i], 10000);
+			TS_ASSERT_EQUALS(_out[2 * i + 1], 10000);
+		}
+	}
+
+	void test_polyphase_passband() {
+		// A tone well below the Nyquist frequency keeps its amplitude
+		convert(Audio::kResamplerPolyphase, 11025, 44100, 1000, 16000);
+		TS_ASSERT_DELTA(peak(kOutSamples), 16000, 400);
+
+		convert(Audio::kResamplerPolyphase, 44100, 22050, 1000, 16000);
+		TS_ASSERT_DELTA(peak(kOutSamples), 16000, 400);
+	}
+
+	void test_polyphase_antialiasing() {
+		// A 15 kHz tone can not be represented at 22050 Hz. Dropping
+		// samples aliases it to 7050 Hz, the filter has to remove it.
+		convert(Audio::kResamplerLinear, 44100, 22050, 15000, 16000);
+		TS_ASSERT_LESS_THAN(8000, peak(kOutSamples));
+
+		convert(Audio::kResamplerPolyphase, 44100, 22050, 15000, 16000);
+		TS_ASSERT_LESS_THAN(peak(kOutSamples), 800);
+	}
+
+	void test_polyphase_length() {
+		// The same input has to produce as many output samples as with the
+		// linear converter.
+		Audio::SeekableAudioStream *stream = createToneStream(22050, 440, 8000, 22050);
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 48000, false, false, Audio::kResamplerPolyphase);
+		int polyphaseLen = 0, len;
+		while ((len = converter->flow(*stream, _out, kOutSamples, 256, 256)) > 0)
+			polyphaseLen += len;
+		delete converter;
+		delete stream;
+
+		stream = createToneStream(22050, 440, 8000, 22050);
+		converter = Audio::makeRateConverter(22050, 48000, false, false, Audio::kResamplerLinear);
+		int linearLen = 0;
+		while ((len = converter->flow(*stream, _out, kOutSamples, 256, 256)) > 0)
+			linearLen += len;
+		delete converter;
+		delete stream;
+
+		TS_ASSERT_EQUALS(polyphaseLen, linearLen);
+	}
+};
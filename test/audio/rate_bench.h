@@ -0,0 +1,70 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+#include "common/memstream.h"
+
+#include "helper.h"
+#include "../benchmark.h"
+
+class RateConverterBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kOutSamples = 4096,
+		kOutRate = 48000
+	};
+
+	int16 _out[2 * kOutSamples];
+
+	void benchConverter(Audio::ResamplerType resampler, const char *resamplerName, int inRate, bool isStereo) {
+		const int seconds = 10;
+		Audio::SeekableAudioStream *stream = createSineStream<int16>(inRate, seconds, 0, false, isStereo);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, kOutRate, isStereo, false, resampler);
+
+		uint32 total = 0;
+		BenchmarkTimer timer;
+		int len;
+		while ((len = converter->flow(*stream, _out, kOutSamples, 200, 150)) > 0)
+			total += len;
+		const uint32 micros = timer.elapsedMicros();
+
+		reportBenchmark(Common::String::format("%s %s %d->%d", resamplerName, isStereo ? "stereo" : "mono", inRate, (int)kOutRate).c_str(),
+		                total, micros, "frames");
+
+		// How much of this core 16 channels playing at the same time need
+		if (total) {
+			const double load = 16.0 * kOutRate * micros / total / 10000.0;
+			TS_TRACE(Common::String::format("    16 channels: %.2f%% CPU", load).c_str());
+		}
+
+		delete converter;
+		delete stream;
+	}
+
+	void benchRates(Audio::ResamplerType resampler, const char *resamplerName) {
+		benchConverter(resampler, resamplerName, 11025, false);
+		benchConverter(resampler, resamplerName, 22050, false);
+		benchConverter(resampler, resamplerName, 22050, true);
+		benchConverter(resampler, resamplerName, 44100, true);
+	}
+
+public:
+	void test_linear() {
+		benchRates(Audio::kResamplerLinear, "linear");
+	}
+
+	void test_polyphase() {
+		benchRates(Audio::kResamplerPolyphase, "polyphase");
+	}
+
+	void test_polyphase_setup() {
+		// Creating the converter computes the filter table, which happens
+		// whenever a sound is started.
+		const int iterations = 100;
+		BenchmarkTimer timer;
+		for (int i = 0; i < iterations; ++i)
+			delete Audio::makeRateConverter(22050, kOutRate, true, false, Audio::kResamplerPolyphase);
+		reportBenchmark("polyphase converter setup", iterations, timer.elapsedMicros(), "converters");
+	}
+};
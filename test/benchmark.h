@@ -0,0 +1,43 @@
+#ifndef TEST_BENCHMARK_H
+#define TEST_BENCHMARK_H
+
+#include <sys/time.h>
+
+#include "common/str.h"
+
+/**
+ * Simple wall clock timer for the benchmark suites (the *_bench.h files).
+ * These are built and run by the 'bench' target instead of the 'test'
+ * target, since their results are only meaningful in optimized builds.
+ */
+class BenchmarkTimer {
+public:
+	BenchmarkTimer() { start(); }
+
+	void start() {
+		gettimeofday(&_start, 0);
+	}
+
+	/** Returns the number of microseconds since the last start(). */
+	uint32 elapsedMicros() const {
+		struct timeval now;
+		gettimeofday(&now, 0);
+		return (uint32)(now.tv_sec - _start.tv_sec) * 1000000 + (now.tv_usec - _start.tv_usec);
+	}
+
+private:
+	struct timeval _start;
+};
+
+/**
+ * Prints one benchmark result line. 'units' is the amount of work which
+ * was done in 'micros' microseconds, e.g. the number of samples or pixels.
+ */
+static inline void reportBenchmark(const char *name, uint32 units, uint32 micros, const char *unitName) {
+	const double seconds = micros ? micros / 1000000.0 : 0.000001;
+	Common::String line = Common::String::format("%-40s %10.2f M%s/s (%u us)",
+	                                             name, units / seconds / 1000000.0, unitName, micros);
+	TS_TRACE(line.c_str());
+}
+
+#endif
@@ -0,0 +1,176 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/flat-hashmap.h"
+#include "common/hash-str.h"
+
+class FlatHashMapTestSuite : public CxxTest::TestSuite
+{
+	typedef Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> StringMap;
+
+	// Simple LCG, so that the test is reproducible.
+	static uint nextRandom(uint &seed) {
+		seed = seed * 1103515245 + 12345;
+		return (seed >> 16) & 0x7FFF;
+	}
+
+	public:
+	void test_empty_clear() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(!container.empty());
+		container.clear();
+		TS_ASSERT(container.empty());
+
+		StringMap container2;
+		TS_ASSERT(container2.empty());
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(!container2.empty());
+		container2.clear(true);
+		TS_ASSERT(container2.empty());
+		TS_ASSERT(!container2.contains("foo"));
+	}
+
+	void test_contains() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(container.contains(0));
+		TS_ASSERT(container.contains(1));
+		TS_ASSERT(!container.contains(17));
+		TS_ASSERT(!container.contains(-1));
+
+		StringMap container2;
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(container2.contains("foo"));
+		TS_ASSERT(container2.contains("QUUX"));
+		TS_ASSERT(!container2.contains("bar"));
+		TS_ASSERT(!container2.contains("asdf"));
+	}
+
+	void test_add_remove() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		TS_ASSERT(container.contains(1));
+		container.erase(1);
+		TS_ASSERT(!container.contains(1));
+		container[1] = 42;
+		TS_ASSERT(container.contains(1));
+		TS_ASSERT_EQUALS(container[1], 42);
+		container.erase(container.find(0));
+		container.erase(container.find(1));
+		container.erase(2);
+		TS_ASSERT(container.empty());
+		container.erase(2);
+		TS_ASSERT(container.empty());
+	}
+
+	void test_lookup_with_default() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = -1;
+
+		const Common::FlatHashMap<int, int> &containerRef = container;
+
+		TS_ASSERT_EQUALS(containerRef[1], -1);
+		TS_ASSERT_EQUALS(containerRef.getVal(0), 17);
+		TS_ASSERT_EQUALS(containerRef.getVal(17), 0);
+		TS_ASSERT_EQUALS(containerRef.getVal(0, -10), 17);
+		TS_ASSERT_EQUALS(containerRef.getVal(17, -10), -10);
+		TS_ASSERT_EQUALS(container.size(), 2u);
+	}
+
+	void test_copy() {
+		Common::FlatHashMap<int, int> map1, container2;
+		for (int i = 0; i < 100; ++i)
+			map1[i * 7] = i;
+		map1.erase(7);
+		container2 = map1;
+		Common::FlatHashMap<int, int> container3(map1);
+		map1.clear();
+		TS_ASSERT_EQUALS(container2.size(), 99u);
+		TS_ASSERT_EQUALS(container3.size(), 99u);
+		TS_ASSERT(!container2.contains(7));
+		TS_ASSERT_EQUALS(container2[14], 2);
+		TS_ASSERT_EQUALS(container3[693], 99);
+	}
+
+	void test_collision() {
+		// Keys which are equal in their low bits end up in the same slot
+		// without the hash spreading in FlatHashMap.
+		Common::FlatHashMap<int, int> h;
+		for (int i = 0; i < 8; ++i)
+			h[(i << 10) + 5] = i;
+		for (int i = 0; i < 8; ++i)
+			TS_ASSERT_EQUALS(h[(i << 10) + 5], i);
+		h.erase((3 << 10) + 5);
+		for (int i = 0; i < 8; ++i)
+			TS_ASSERT_EQUALS(h.contains((i << 10) + 5), i != 3);
+	}
+
+	void test_iterator_erase() {
+		Common::FlatHashMap<int, int> container;
+		for (int i = 0; i < 50; ++i)
+			container[i] = i;
+
+		// Erasing the current entry must not disturb the iteration.
+		int visited = 0;
+		for (Common::FlatHashMap<int, int>::iterator i = container.begin(); i != container.end(); ++i) {
+			TS_ASSERT_EQUALS(i->_key, i->_value);
+			if (i->_key & 1)
+				container.erase(i);
+			++visited;
+		}
+		TS_ASSERT_EQUALS(visited, 50);
+		TS_ASSERT_EQUALS(container.size(), 25u);
+
+		int found = 0;
+		Common::FlatHashMap<int, int>::const_iterator j;
+		for (j = container.begin(); j != container.end(); ++j) {
+			TS_ASSERT_EQUALS(j->_key & 1, 0);
+			++found;
+		}
+		TS_ASSERT_EQUALS(found, 25);
+	}
+
+	void test_against_hashmap() {
+		// Apply the same random inserts and erases to both map types, with
+		// enough churn to make FlatHashMap rehash away its deleted slots.
+		Common::HashMap<int, int> reference;
+		Common::FlatHashMap<int, int> container;
+		uint seed = 1;
+		for (int n = 0; n < 20000; ++n) {
+			const int key = nextRandom(seed) % 300;
+			if (nextRandom(seed) & 1) {
+				reference[key] = n;
+				container[key] = n;
+			} else {
+				reference.erase(key);
+				container.erase(key);
+			}
+		}
+
+		TS_ASSERT_EQUALS(container.size(), reference.size());
+		for (Common::HashMap<int, int>::const_iterator i = reference.begin(); i != reference.end(); ++i)
+			TS_ASSERT_EQUALS(container.getVal(i->_key, -1), i->_value);
+		for (int key = 0; key < 300; ++key)
+			TS_ASSERT_EQUALS(container.contains(key), reference.contains(key));
+	}
+
+	void test_string_values() {
+		StringMap container;
+		for (int i = 0; i < 200; ++i)
+			container[Common::String::format("key_with_a_rather_long_name_%d", i)] = Common::String::format("value_with_a_rather_long_text_%d", i);
+		for (int i = 0; i < 200; i += 2)
+			container.erase(Common::String::format("KEY_WITH_A_RATHER_LONG_NAME_%d", i));
+
+		TS_ASSERT_EQUALS(container.size(), 100u);
+		TS_ASSERT_EQUALS(container["key_with_a_rather_long_name_51"], "value_with_a_rather_long_text_51");
+		TS_ASSERT(!container.contains("key_with_a_rather_long_name_50"));
+	}
+};
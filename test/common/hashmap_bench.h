@@ -0,0 +1,74 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/flat-hashmap.h"
+#include "common/hash-str.h"
+#include "common/str.h"
+
+#include "../benchmark.h"
+
+class HashMapBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kKeys = 2000,
+		kRounds = 200
+	};
+
+	template<class Map>
+	void benchStringLookups(const char *name) {
+		Common::Array<Common::String> keys;
+		for (int i = 0; i < kKeys; ++i)
+			keys.push_back(Common::String::format("Game_Option_%d", i * 37));
+
+		Map map;
+		for (uint i = 0; i < keys.size(); ++i)
+			map[keys[i]] = keys[i];
+
+		// Every other lookup misses.
+		Common::Array<Common::String> misses;
+		for (int i = 0; i < kKeys; ++i)
+			misses.push_back(Common::String::format("game_option_%d", i * 37 + 1));
+
+		uint found = 0;
+		BenchmarkTimer timer;
+		for (int r = 0; r < kRounds; ++r) {
+			for (uint i = 0; i < keys.size(); ++i) {
+				found += map.contains(keys[i]);
+				found += map.contains(misses[i]);
+			}
+		}
+		reportBenchmark(name, 2 * kKeys * kRounds, timer.elapsedMicros(), "lookups");
+		TS_ASSERT_EQUALS(found, (uint)kKeys * kRounds);
+	}
+
+	template<class Map>
+	void benchIntChurn(const char *name) {
+		Map map;
+		uint seed = 1;
+		int sum = 0;
+		BenchmarkTimer timer;
+		for (int n = 0; n < kKeys * kRounds; ++n) {
+			seed = seed * 1103515245 + 12345;
+			const int key = (seed >> 16) & 0x3FF;
+			if (n & 1)
+				map.erase(key);
+			else
+				map[key] = n;
+			sum += map.getVal(key ^ 1, 0);
+		}
+		reportBenchmark(name, kKeys * kRounds, timer.elapsedMicros(), "ops");
+		TS_ASSERT(sum != 1);
+	}
+
+public:
+	void test_string_lookups() {
+		benchStringLookups<Common::HashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> >("HashMap string lookups");
+		benchStringLookups<Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> >("FlatHashMap string lookups");
+	}
+
+	void test_int_churn() {
+		benchIntChurn<Common::HashMap<int, int> >("HashMap int insert/erase");
+		benchIntChurn<Common::FlatHashMap<int, int> >("FlatHashMap int insert/erase");
+	}
+};
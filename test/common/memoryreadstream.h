@@ -84,4 +84,13 @@ class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
 		TS_ASSERT_EQUALS(ms.pos(), 7);
 		TS_ASSERT(!ms.eos());
 	}
+
+	void test_raw_pointer() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6, 7 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		ms.readByte();
+		TS_ASSERT_EQUALS(ms.getRawPointer(), contents);
+		TS_ASSERT(ms.isResident());
+	}
 };
@@ -0,0 +1,128 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/readaheadstream.h"
+
+class AsyncReadAheadStreamTestSuite : public CxxTest::TestSuite {
+	byte _contents[1000];
+
+	void fillContents() {
+		for (int i = 0; i < 1000; ++i)
+			_contents[i] = (byte)(i * 7 + (i >> 8));
+	}
+
+	public:
+	void test_traverse() {
+		fillContents();
+		Common::MemoryReadStream ms(_contents, 1000);
+		Common::AsyncReadAheadStream stream(&ms, 64, 4, DisposeAfterUse::NO);
+
+		TS_ASSERT_EQUALS(stream.size(), 1000);
+
+		for (int i = 0; i < 1000; ++i) {
+			TS_ASSERT_EQUALS(stream.pos(), i);
+			TS_ASSERT_EQUALS(stream.readByte(), _contents[i]);
+		}
+
+		TS_ASSERT(!stream.eos());
+		byte b;
+		TS_ASSERT_EQUALS(stream.read(&b, 1), (uint32)0);
+		TS_ASSERT(stream.eos());
+		TS_ASSERT(!stream.err());
+
+		// Nothing loads in the background here, so every block stalls once.
+		Common::AsyncReadAheadStream::Stats stats = stream.getStats();
+		TS_ASSERT_EQUALS(stats.stalls, (uint32)16);
+		TS_ASSERT_EQUALS(stats.hits, (uint32)0);
+	}
+
+	void test_large_reads() {
+		fillContents();
+		Common::MemoryReadStream ms(_contents, 1000);
+		Common::AsyncReadAheadStream stream(&ms, 64, 3, DisposeAfterUse::NO);
+
+		byte buffer[1000];
+		TS_ASSERT(stream.seek(10));
+		TS_ASSERT_EQUALS(stream.read(buffer, 500), (uint32)500);
+		TS_ASSERT_EQUALS(memcmp(buffer, _contents + 10, 500), 0);
+
+		TS_ASSERT_EQUALS(stream.read(buffer, 1000), (uint32)490);
+		TS_ASSERT_EQUALS(memcmp(buffer, _contents + 510, 490), 0);
+		TS_ASSERT(stream.eos());
+	}
+
+	void test_seek() {
+		fillContents();
+		Common::MemoryReadStream ms(_contents, 1000);
+		Common::AsyncReadAheadStream stream(&ms, 100, 2, DisposeAfterUse::NO);
+
+		TS_ASSERT(stream.seek(-1, SEEK_END));
+		TS_ASSERT_EQUALS(stream.pos(), 999);
+		TS_ASSERT_EQUALS(stream.readByte(), _contents[999]);
+
+		TS_ASSERT(stream.seek(-500, SEEK_CUR));
+		TS_ASSERT_EQUALS(stream.pos(), 500);
+		TS_ASSERT(!stream.seek(1001));
+		TS_ASSERT(!stream.seek(-1));
+		TS_ASSERT_EQUALS(stream.pos(), 500);
+
+		uint32 seed = 1234;
+		for (int i = 0; i < 200; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const int32 pos = (seed >> 8) % 1000;
+			TS_ASSERT(stream.seek(pos));
+			TS_ASSERT_EQUALS(stream.readByte(), _contents[pos]);
+		}
+	}
+
+	void test_read_ahead() {
+		fillContents();
+		Common::MemoryReadStream ms(_contents, 1000);
+		Common::AsyncReadAheadStream stream(&ms, 64, 4, DisposeAfterUse::NO);
+
+		// Fills the first four blocks, then runs out of buffers.
+		while (stream.fillNextBlock())
+			;
+		TS_ASSERT_EQUALS(stream.getStats().prefetched, (uint32)4);
+
+		byte buffer[256];
+		TS_ASSERT_EQUALS(stream.read(buffer, 256), (uint32)256);
+		TS_ASSERT_EQUALS(memcmp(buffer, _contents, 256), 0);
+
+		Common::AsyncReadAheadStream::Stats stats = stream.getStats();
+		TS_ASSERT_EQUALS(stats.hits, (uint32)4);
+		TS_ASSERT_EQUALS(stats.stalls, (uint32)0);
+
+		// The window moves along with the reader.
+		TS_ASSERT(stream.fillNextBlock());
+		TS_ASSERT_EQUALS(stream.readByte(), _contents[256]);
+		TS_ASSERT_EQUALS(stream.getStats().stalls, (uint32)0);
+	}
+
+	void test_will_need() {
+		fillContents();
+		Common::MemoryReadStream ms(_contents, 1000);
+		Common::AsyncReadAheadStream stream(&ms, 64, 4, DisposeAfterUse::NO);
+
+		while (stream.fillNextBlock())
+			;
+		stream.resetStats();
+
+		// The hinted range is loaded even though all buffers are in use.
+		stream.willNeed(704, 128);
+		TS_ASSERT(stream.fillNextBlock());
+		TS_ASSERT(stream.fillNextBlock());
+
+		TS_ASSERT(!stream.fillNextBlock());
+
+		byte buffer[128];
+		TS_ASSERT(stream.seek(704));
+		TS_ASSERT_EQUALS(stream.read(buffer, 128), (uint32)128);
+		TS_ASSERT_EQUALS(memcmp(buffer, _contents + 704, 128), 0);
+
+		Common::AsyncReadAheadStream::Stats stats = stream.getStats();
+		TS_ASSERT_EQUALS(stats.prefetched, (uint32)2);
+		TS_ASSERT_EQUALS(stats.hits, (uint32)2);
+		TS_ASSERT_EQUALS(stats.stalls, (uint32)0);
+	}
+};
@@ -70,4 +70,15 @@ class SeekableSubReadStreamTestSuite : public CxxTest::TestSuite {
 		b = ssrs.readByte();
 		TS_ASSERT_EQUALS(b, 1);
 	}
+
+	void test_raw_pointer() {
+		byte contents[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+		Common::SeekableSubReadStream ssrs(&ms, 3, 8);
+		TS_ASSERT_EQUALS(ssrs.getRawPointer(), contents + 3);
+
+		Common::SeekableSubReadStream nested(&ssrs, 2, 4);
+		TS_ASSERT_EQUALS(nested.getRawPointer(), contents + 5);
+		TS_ASSERT(nested.isResident());
+	}
 };
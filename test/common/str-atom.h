@@ -0,0 +1,129 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/config-manager.h"
+#include "common/memstream.h"
+#include "common/str-atom.h"
+
+class StringAtomTestSuite : public CxxTest::TestSuite
+{
+	// An archive which contains the given names, and counts the lookups.
+	class NameArchive : public Common::Archive {
+	public:
+		Common::StringMap _names;
+		int _lookups;
+
+		NameArchive() : _lookups(0) {}
+
+		virtual bool hasFile(const Common::String &name) {
+			++_lookups;
+			return _names.contains(name);
+		}
+		virtual int listMembers(Common::ArchiveMemberList &list) {
+			return 0;
+		}
+		virtual Common::ArchiveMemberPtr getMember(const Common::String &name) {
+			return Common::ArchiveMemberPtr();
+		}
+		virtual Common::SeekableReadStream *createReadStreamForMember(const Common::String &name) const {
+			if (!_names.contains(name))
+				return 0;
+			return new Common::MemoryReadStream((const byte *)_names[name].c_str(), _names[name].size());
+		}
+	};
+
+	public:
+	void test_interning() {
+		Common::StringAtom a("Subtitles");
+		Common::StringAtom b(Common::String("subtitles"));
+		Common::StringAtom c("SUBTITLES");
+		Common::StringAtom d("music_volume");
+
+		TS_ASSERT(a == b);
+		TS_ASSERT(a == c);
+		TS_ASSERT(a != d);
+		TS_ASSERT_EQUALS(a.c_str(), b.c_str());
+		TS_ASSERT_EQUALS(a.string(), "Subtitles");
+		TS_ASSERT_EQUALS(a.hash(), Common::hashit_lower("subtitles"));
+		TS_ASSERT_EQUALS(d.hash(), Common::IgnoreCase_Hash()(Common::String("Music_Volume")));
+
+		Common::StringAtom empty;
+		TS_ASSERT(empty.empty());
+		TS_ASSERT(empty == Common::StringAtom(""));
+		TS_ASSERT(!a.empty());
+	}
+
+	void test_atom_keys() {
+		Common::HashMap<Common::StringAtom, int> map;
+		map[Common::StringAtom("one")] = 1;
+		map[Common::StringAtom("two")] = 2;
+		TS_ASSERT_EQUALS(map[Common::StringAtom("ONE")], 1);
+		TS_ASSERT_EQUALS(map.getVal(Common::StringAtom("Two"), 0), 2);
+		TS_ASSERT(!map.contains(Common::StringAtom("three")));
+	}
+
+	void test_string_map_lookup() {
+		Common::StringMap map;
+		map["talkspeed"] = "60";
+		map["LongerKeyWhichIsNotStoredInline"] = "x";
+
+		Common::StringMap::const_iterator i = map.findEquivalent(Common::StringAtom("TalkSpeed"));
+		TS_ASSERT(i != map.end());
+		TS_ASSERT_EQUALS(i->_value, "60");
+		TS_ASSERT(map.findEquivalent(Common::StringAtom("longerkeywhichisnotstoredinline")) != map.end());
+		TS_ASSERT(map.findEquivalent(Common::StringAtom("speech_mute")) == map.end());
+
+		Common::ConfigManager::Domain domain;
+		domain["fullscreen"] = "true";
+		TS_ASSERT(domain.contains(Common::StringAtom("FullScreen")));
+		TS_ASSERT(domain.contains("fullscreen"));
+		TS_ASSERT(!domain.contains(Common::StringAtom("aspect_ratio")));
+	}
+
+	void test_search_set() {
+		NameArchive *arc1 = new NameArchive();
+		NameArchive *arc2 = new NameArchive();
+		arc1->_names["resource.map"] = "map1";
+		arc2->_names["resource.map"] = "map2";
+		arc2->_names["resource.000"] = "res";
+
+		Common::SearchSet set;
+		set.add("arc1", arc1, 0);
+		set.add("arc2", arc2, 1);
+
+		const Common::StringAtom map("RESOURCE.MAP");
+		const Common::StringAtom res("resource.000");
+		TS_ASSERT(set.hasFile(res));
+		TS_ASSERT(set.hasFile(map));
+		TS_ASSERT(!set.hasFile(Common::StringAtom("resource.001")));
+		TS_ASSERT(!set.hasFile(Common::StringAtom()));
+
+		// The second lookup only asks the archive which had the file.
+		arc1->_lookups = arc2->_lookups = 0;
+		Common::SeekableReadStream *stream = set.createReadStreamForMember(res);
+		TS_ASSERT(stream);
+		delete stream;
+		TS_ASSERT_EQUALS(arc1->_lookups + arc2->_lookups, 0);
+
+		// Higher priority archives are searched first ...
+		stream = set.createReadStreamForMember(map);
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), 4);
+		stream->seek(3);
+		TS_ASSERT_EQUALS(stream->readByte(), '2');
+		delete stream;
+
+		// ... also after changing the priorities.
+		set.setPriority("arc1", 2);
+		stream = set.createReadStreamForMember(map);
+		TS_ASSERT(stream);
+		stream->seek(3);
+		TS_ASSERT_EQUALS(stream->readByte(), '1');
+		delete stream;
+
+		set.remove("arc1");
+		TS_ASSERT(set.hasFile(map));
+		set.remove("arc2");
+		TS_ASSERT(!set.hasFile(map));
+	}
+};
@@ -0,0 +1,99 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/config-manager.h"
+#include "common/memstream.h"
+#include "common/str-atom.h"
+
+#include "../benchmark.h"
+
+class StringAtomBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kLookups = 1000000
+	};
+
+	// An archive containing a fixed list of empty files.
+	class NameArchive : public Common::Archive {
+	public:
+		Common::StringMap _names;
+
+		virtual bool hasFile(const Common::String &name) {
+			return _names.contains(name);
+		}
+		virtual int listMembers(Common::ArchiveMemberList &list) {
+			return 0;
+		}
+		virtual Common::ArchiveMemberPtr getMember(const Common::String &name) {
+			return Common::ArchiveMemberPtr();
+		}
+		virtual Common::SeekableReadStream *createReadStreamForMember(const Common::String &name) const {
+			if (!_names.contains(name))
+				return 0;
+			return new Common::MemoryReadStream((const byte *)"", 0);
+		}
+	};
+
+	void setUpConfMan() {
+		ConfMan.registerDefault("subtitles", false);
+		ConfMan.registerDefault("music_volume", 192);
+		for (int i = 0; i < 40; ++i)
+			ConfMan.set(Common::String::format("option_%d", i), "1", Common::ConfigManager::kApplicationDomain);
+		ConfMan.addGameDomain("benchgame");
+		ConfMan.set("subtitles", "true", "benchgame");
+		ConfMan.setActiveDomain("benchgame");
+	}
+
+public:
+	void test_confman() {
+		setUpConfMan();
+
+		// "subtitles" is found in the active domain, "music_volume" only
+		// in the defaults.
+		int sum = 0;
+		BenchmarkTimer timer;
+		for (int i = 0; i < kLookups; ++i)
+			sum += ConfMan.getBool("subtitles") + ConfMan.getInt("music_volume");
+		reportBenchmark("ConfMan String lookups", 2 * kLookups, timer.elapsedMicros(), "lookups");
+		TS_ASSERT_EQUALS(sum, 193 * kLookups);
+
+		static const Common::StringAtom kSubtitles("subtitles");
+		static const Common::StringAtom kMusicVolume("music_volume");
+		sum = 0;
+		timer.start();
+		for (int i = 0; i < kLookups; ++i)
+			sum += ConfMan.getBool(kSubtitles) + ConfMan.getInt(kMusicVolume);
+		reportBenchmark("ConfMan StringAtom lookups", 2 * kLookups, timer.elapsedMicros(), "lookups");
+		TS_ASSERT_EQUALS(sum, 193 * kLookups);
+
+		ConfMan.setActiveDomain("");
+		ConfMan.removeGameDomain("benchgame");
+	}
+
+	void test_searchman() {
+		// Typical setup while a game runs: the game directory, a few of its
+		// sub directories, and the system archives.
+		Common::SearchSet set;
+		for (int a = 0; a < 6; ++a) {
+			NameArchive *arc = new NameArchive();
+			for (int i = 0; i < 300; ++i)
+				arc->_names[Common::String::format("archive%d_file%03d.dat", a, i)] = "";
+			set.add(Common::String::format("archive%d", a), arc, -a);
+		}
+
+		const char *const name = "ARCHIVE5_FILE123.DAT";
+		int found = 0;
+		BenchmarkTimer timer;
+		for (int i = 0; i < kLookups / 10; ++i)
+			found += set.hasFile(name);
+		reportBenchmark("SearchSet String lookups", kLookups / 10, timer.elapsedMicros(), "lookups");
+
+		const Common::StringAtom atom(name);
+		timer.start();
+		for (int i = 0; i < kLookups / 10; ++i)
+			found += set.hasFile(atom);
+		reportBenchmark("SearchSet StringAtom lookups", kLookups / 10, timer.elapsedMicros(), "lookups");
+		TS_ASSERT_EQUALS(found, 2 * (kLookups / 10));
+	}
+};
@@ -0,0 +1,197 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "common/unzip.h"
+
+/** A stream counting the reads done on it. */
+class CountingReadStream : public Common::MemoryReadStream {
+public:
+	CountingReadStream(const byte *data, uint32 size, int *reads)
+		: Common::MemoryReadStream(data, size, DisposeAfterUse::YES), _reads(reads) {}
+
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		++*_reads;
+		return Common::MemoryReadStream::read(dataPtr, dataSize);
+	}
+
+private:
+	int *_reads;
+};
+
+/**
+ * Builds a ZIP file with uncompressed members, which the unzip code can
+ * read even without zlib.
+ */
+class ZipBuilder {
+public:
+	ZipBuilder() : _stream(DisposeAfterUse::NO), _directory(DisposeAfterUse::YES), _count(0) {}
+
+	void add(const char *name, const byte *data, uint32 size) {
+		const uint32 nameSize = strlen(name);
+		const uint32 crc = crc32(data, size);
+		const uint32 offset = _stream.size();
+
+		_stream.writeUint32LE(0x04034b50);
+		_stream.writeUint16LE(10);    // version needed
+		_stream.writeUint16LE(0);     // flags
+		_stream.writeUint16LE(0);     // stored
+		_stream.writeUint32LE(0);     // date and time
+		_stream.writeUint32LE(crc);
+		_stream.writeUint32LE(size);
+		_stream.writeUint32LE(size);
+		_stream.writeUint16LE(nameSize);
+		_stream.writeUint16LE(0);     // extra field
+		_stream.write(name, nameSize);
+		_stream.write(data, size);
+
+		_directory.writeUint32LE(0x02014b50);
+		_directory.writeUint16LE(20); // version made by
+		_directory.writeUint16LE(10); // version needed
+		_directory.writeUint16LE(0);  // flags
+		_directory.writeUint16LE(0);  // stored
+		_directory.writeUint32LE(0);  // date and time
+		_directory.writeUint32LE(crc);
+		_directory.writeUint32LE(size);
+		_directory.writeUint32LE(size);
+		_directory.writeUint16LE(nameSize);
+		_directory.writeUint16LE(0);  // extra field
+		_directory.writeUint16LE(0);  // comment
+		_directory.writeUint16LE(0);  // disk
+		_directory.writeUint16LE(0);  // internal attributes
+		_directory.writeUint32LE(0);  // external attributes
+		_directory.writeUint32LE(offset);
+		_directory.write(name, nameSize);
+
+		++_count;
+	}
+
+	Common::SeekableReadStream *finish(int *reads) {
+		const uint32 directoryOffset = _stream.size();
+		_stream.write(_directory.getData(), _directory.size());
+
+		_stream.writeUint32LE(0x06054b50);
+		_stream.writeUint16LE(0);     // disk
+		_stream.writeUint16LE(0);     // disk with the directory
+		_stream.writeUint16LE(_count);
+		_stream.writeUint16LE(_count);
+		_stream.writeUint32LE(_directory.size());
+		_stream.writeUint32LE(directoryOffset);
+		_stream.writeUint16LE(0);     // comment
+
+		return new CountingReadStream(_stream.getData(), _stream.size(), reads);
+	}
+
+private:
+	Common::MemoryWriteStreamDynamic _stream;
+	Common::MemoryWriteStreamDynamic _directory;
+	uint16 _count;
+
+	static uint32 crc32(const byte *data, uint32 size) {
+		uint32 crc = 0xFFFFFFFF;
+		for (uint32 i = 0; i < size; ++i) {
+			crc ^= data[i];
+			for (int bit = 0; bit < 8; ++bit)
+				crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+		}
+		return ~crc;
+	}
+};
+
+class ZipArchiveTestSuite : public CxxTest::TestSuite {
+	byte _data[3][1000];
+	int _reads;
+
+	Common::ZipArchive *makeArchive() {
+		for (int i = 0; i < 3; ++i) {
+			for (int j = 0; j < 1000; ++j)
+				_data[i][j] = (byte)(i * 31 + j * 7);
+		}
+
+		ZipBuilder builder;
+		builder.add("one.dat", _data[0], 1000);
+		builder.add("dir/two.dat", _data[1], 1000);
+		builder.add("three.dat", _data[2], 500);
+		return Common::makeZipArchive(builder.finish(&_reads));
+	}
+
+	bool checkMember(Common::Archive *archive, const char *name, const byte *data, uint32 size) {
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember(name);
+		if (!stream)
+			return false;
+
+		byte buffer[1000];
+		const bool ok = stream->size() == (int32)size && stream->read(buffer, size) == size
+		                && memcmp(buffer, data, size) == 0;
+		delete stream;
+		return ok;
+	}
+
+	public:
+	void test_index() {
+		Common::ZipArchive *archive = makeArchive();
+		TS_ASSERT(archive);
+
+		TS_ASSERT(archive->hasFile("one.dat"));
+		TS_ASSERT(archive->hasFile("DIR/Two.dat"));
+		TS_ASSERT(!archive->hasFile("two.dat"));
+
+		Common::ArchiveMemberList list;
+		TS_ASSERT_EQUALS(archive->listMembers(list), 3);
+		TS_ASSERT_EQUALS(list.size(), (uint)3);
+
+		TS_ASSERT(checkMember(archive, "one.dat", _data[0], 1000));
+		TS_ASSERT(checkMember(archive, "dir/two.dat", _data[1], 1000));
+		TS_ASSERT(checkMember(archive, "THREE.DAT", _data[2], 500));
+		TS_ASSERT(!archive->createReadStreamForMember("four.dat"));
+
+		delete archive;
+	}
+
+	void test_cache() {
+		Common::ZipArchive *archive = makeArchive();
+		archive->setCacheSize(2000);
+
+		_reads = 0;
+		TS_ASSERT(checkMember(archive, "one.dat", _data[0], 1000));
+		TS_ASSERT(_reads > 0);
+		_reads = 0;
+		TS_ASSERT(checkMember(archive, "one.dat", _data[0], 1000));
+		TS_ASSERT_EQUALS(_reads, 0);
+
+		// Streams keep their data, even when it is evicted from the cache.
+		Common::SeekableReadStream *first = archive->createReadStreamForMember("one.dat");
+		TS_ASSERT(checkMember(archive, "dir/two.dat", _data[1], 1000));
+		TS_ASSERT(checkMember(archive, "three.dat", _data[2], 500));
+		TS_ASSERT(checkMember(archive, "one.dat", _data[0], 1000));
+		archive->setCacheSize(0);
+
+		byte buffer[1000];
+		TS_ASSERT_EQUALS(first->read(buffer, 1000), (uint32)1000);
+		TS_ASSERT_EQUALS(memcmp(buffer, _data[0], 1000), 0);
+		delete first;
+
+		TS_ASSERT(checkMember(archive, "one.dat", _data[0], 1000));
+		delete archive;
+	}
+
+	void test_preload() {
+		Common::ZipArchive *archive = makeArchive();
+		archive->setCacheSize(1500);
+
+		Common::StringArray names;
+		names.push_back("three.dat");
+		names.push_back("missing.dat");
+		names.push_back("one.dat");
+		names.push_back("dir/two.dat");
+		TS_ASSERT_EQUALS(archive->preloadMembers(names), 2);
+
+		_reads = 0;
+		TS_ASSERT(checkMember(archive, "three.dat", _data[2], 500));
+		TS_ASSERT(checkMember(archive, "one.dat", _data[0], 1000));
+		TS_ASSERT_EQUALS(_reads, 0);
+		TS_ASSERT(checkMember(archive, "dir/two.dat", _data[1], 1000));
+		TS_ASSERT(_reads > 0);
+		delete archive;
+	}
+};
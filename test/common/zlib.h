@@ -0,0 +1,83 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/zlib.h"
+
+class ZlibTestSuite : public CxxTest::TestSuite {
+	enum {
+		kDataSize = 1536 * 1024
+	};
+
+	byte *_data;
+	byte *_compressed;
+	uint32 _compressedSize;
+
+	void compress() {
+		_data = new byte[kDataSize];
+		uint32 seed = 42;
+		for (uint32 i = 0; i < kDataSize; ++i) {
+			seed = seed * 1103515245 + 12345;
+			// Compressible, but not too much
+			_data[i] = (i & 64) ? (byte)(seed >> 29) : (byte)(i >> 10);
+		}
+
+		Common::MemoryWriteStreamDynamic *target = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+		Common::WriteStream *out = Common::wrapCompressedWriteStream(target);
+		out->write(_data, kDataSize);
+		out->finalize();
+		_compressedSize = target->size();
+		_compressed = new byte[_compressedSize];
+		memcpy(_compressed, target->getData(), _compressedSize);
+		delete out;
+	}
+
+	void cleanUp() {
+		delete[] _data;
+		delete[] _compressed;
+	}
+
+	public:
+	void test_read() {
+		compress();
+		Common::SeekableReadStream *in = Common::wrapCompressedReadStream(new Common::MemoryReadStream(_compressed, _compressedSize));
+		TS_ASSERT_EQUALS(in->size(), kDataSize);
+
+		byte *buffer = new byte[kDataSize];
+		TS_ASSERT_EQUALS(in->read(buffer, kDataSize), (uint32)kDataSize);
+		TS_ASSERT_EQUALS(memcmp(buffer, _data, kDataSize), 0);
+		TS_ASSERT(!in->eos());
+		TS_ASSERT_EQUALS(in->read(buffer, 1), (uint32)0);
+		TS_ASSERT(in->eos());
+		TS_ASSERT(!in->err());
+
+		delete[] buffer;
+		delete in;
+		cleanUp();
+	}
+
+	void test_seek() {
+		compress();
+		Common::SeekableReadStream *in = Common::wrapCompressedReadStream(new Common::MemoryReadStream(_compressed, _compressedSize));
+
+		byte buffer[300];
+		uint32 seed = 7;
+		for (int i = 0; i < 40; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const uint32 pos = (seed >> 4) % (kDataSize - sizeof(buffer));
+			TS_ASSERT(in->seek(pos));
+			TS_ASSERT_EQUALS(in->pos(), (int32)pos);
+			TS_ASSERT_EQUALS(in->read(buffer, sizeof(buffer)), sizeof(buffer));
+			TS_ASSERT_EQUALS(memcmp(buffer, _data + pos, sizeof(buffer)), 0);
+		}
+
+		// Reading on to the end still works after seeking around.
+		TS_ASSERT(in->seek(kDataSize - 10));
+		TS_ASSERT_EQUALS(in->read(buffer, sizeof(buffer)), (uint32)10);
+		TS_ASSERT_EQUALS(memcmp(buffer, _data + kDataSize - 10, 10), 0);
+		TS_ASSERT(in->eos());
+		TS_ASSERT(!in->err());
+
+		delete in;
+		cleanUp();
+	}
+};
@@ -0,0 +1,113 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/util.h"
+#include "common/zlib.h"
+
+#include "../benchmark.h"
+
+class ZlibBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kSaveSize = 8 * 1024 * 1024,
+		kChunkSize = 4096,
+		kSeeks = 200
+	};
+
+	byte *_original;
+	Common::MemoryWriteStreamDynamic *_compressed;
+
+	// Compresses something resembling a large savegame: runs of small
+	// integers, object tables and some noise.
+	void createSave() {
+		_original = new byte[kSaveSize];
+		uint32 seed = 1;
+		for (uint32 i = 0; i < kSaveSize; ) {
+			seed = seed * 1103515245 + 12345;
+			const uint32 run = MIN<uint32>(((seed >> 16) & 255) + 1, kSaveSize - i);
+			const byte kind = (seed >> 8) & 3;
+			for (uint32 j = 0; j < run; ++j, ++i) {
+				if (kind == 0)
+					_original[i] = 0;
+				else if (kind == 1)
+					_original[i] = (byte)(j & 15);
+				else if (kind == 2)
+					_original[i] = (byte)(i >> 8);
+				else
+					_original[i] = (byte)((seed = seed * 1103515245 + 12345) >> 24);
+			}
+		}
+
+		// The compressing stream owns its target, so copy the data out
+		// before deleting it.
+		Common::MemoryWriteStreamDynamic *target = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+		Common::WriteStream *out = Common::wrapCompressedWriteStream(target);
+		out->write(_original, kSaveSize);
+		out->finalize();
+		_compressed = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+		_compressed->write(target->getData(), target->size());
+		delete out;
+	}
+
+	void destroySave() {
+		delete[] _original;
+		delete _compressed;
+	}
+
+	Common::SeekableReadStream *openSave() {
+		return Common::wrapCompressedReadStream(new Common::MemoryReadStream(_compressed->getData(), _compressed->size()));
+	}
+
+public:
+	void test_sequential() {
+		createSave();
+
+		Common::SeekableReadStream *in = openSave();
+		byte *buffer = new byte[kChunkSize];
+		bool ok = true;
+
+		BenchmarkTimer timer;
+		for (uint32 pos = 0; pos < kSaveSize; pos += kChunkSize) {
+			if (in->read(buffer, kChunkSize) != kChunkSize)
+				ok = false;
+		}
+		reportBenchmark("Savegame inflate, 4 KB reads", kSaveSize, timer.elapsedMicros(), "B");
+
+		in->seek(kSaveSize - kChunkSize);
+		in->read(buffer, kChunkSize);
+		TS_ASSERT(ok);
+		TS_ASSERT_EQUALS(memcmp(buffer, _original + kSaveSize - kChunkSize, kChunkSize), 0);
+
+		delete[] buffer;
+		delete in;
+		destroySave();
+	}
+
+	void test_random_seeks() {
+		createSave();
+
+		// Read the file once, as loading code checking a header first would.
+		Common::SeekableReadStream *in = openSave();
+		byte *buffer = new byte[kChunkSize];
+		while (in->read(buffer, kChunkSize) == kChunkSize)
+			;
+
+		uint32 seed = 1234;
+		bool ok = true;
+		BenchmarkTimer timer;
+		for (int i = 0; i < kSeeks; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const uint32 pos = (seed >> 4) % (kSaveSize - 256);
+			in->seek(pos);
+			if (in->read(buffer, 256) != 256 || memcmp(buffer, _original + pos, 256))
+				ok = false;
+		}
+		reportBenchmark("Savegame random seeks, 256 byte reads", kSeeks * 256, timer.elapsedMicros(), "B");
+		TS_ASSERT(ok);
+
+		delete[] buffer;
+		delete in;
+		destroySave();
+	}
+};
@@ -0,0 +1,216 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "graphics/conversion.h"
+#include "graphics/conversion_kernels.h"
+#include "graphics/pixelformat.h"
+
+class ConversionTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 37,
+		kHeight = 5,
+		kSrcPitch = 4 * kWidth + 12,
+		kDstPitch = 4 * kWidth + 8
+	};
+
+	uint32 _seed;
+	byte _src[kHeight * kSrcPitch];
+	byte _expected[kHeight * kDstPitch];
+	byte _result[kHeight * kDstPitch];
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	void fillSource() {
+		for (int i = 0; i < ARRAYSIZE(_src); ++i)
+			_src[i] = (byte)nextRandom();
+	}
+
+	/** The bytes of a 24 bit pixel within a uint32, like crossBlit() uses them. */
+	static byte *colorBytes(uint32 &color) {
+#ifdef SCUMM_BIG_ENDIAN
+		return (byte *)&color + 1;
+#else
+		return (byte *)&color;
+#endif
+	}
+
+	static uint32 readPixel(const byte *p, int bpp) {
+		if (bpp == 2)
+			return *(const uint16 *)p;
+		if (bpp == 4)
+			return *(const uint32 *)p;
+		uint32 color = 0;
+		memcpy(colorBytes(color), p, 3);
+		return color;
+	}
+
+	static void writePixel(byte *p, int bpp, uint32 color) {
+		if (bpp == 2)
+			*(uint16 *)p = color;
+		else if (bpp == 4)
+			*(uint32 *)p = color;
+		else
+			memcpy(p, colorBytes(color), 3);
+	}
+
+	/** The conversion done pixel by pixel, as crossBlit() describes it. */
+	void convertReference(const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+		memset(_expected, 0xCC, sizeof(_expected));
+		for (int y = 0; y < kHeight; ++y) {
+			for (int x = 0; x < kWidth; ++x) {
+				uint8 a, r, g, b;
+				srcFmt.colorToARGB(readPixel(_src + y * kSrcPitch + x * srcFmt.bytesPerPixel, srcFmt.bytesPerPixel), a, r, g, b);
+				writePixel(_expected + y * kDstPitch + x * dstFmt.bytesPerPixel, dstFmt.bytesPerPixel, dstFmt.ARGBToColor(a, r, g, b));
+			}
+		}
+	}
+
+	void compareCrossBlit(const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+		static const uint32 masks[] = { 0, Common::kCPUFeatureSSE2, Common::kCPUFeatureSSE2 | Common::kCPUFeatureSSSE3, 0xFFFFFFFF };
+
+		fillSource();
+		convertReference(dstFmt, srcFmt);
+		for (int i = 0; i < ARRAYSIZE(masks); ++i) {
+			Common::setCPUFeatureMask(masks[i]);
+			memset(_result, 0xCC, sizeof(_result));
+			TS_ASSERT(Graphics::crossBlit(_result, _src, kDstPitch, kSrcPitch, kWidth, kHeight, dstFmt, srcFmt));
+			TS_ASSERT_EQUALS(memcmp(_expected, _result, sizeof(_expected)), 0);
+		}
+	}
+
+	void compareKernels(Common::CPUFeature feature, const Graphics::ConversionKernels &kernels) {
+		if (!Common::hasCPUFeature(feature))
+			return;
+
+		const Graphics::ConversionKernels &reference = Graphics::getScalarConversionKernels();
+		// Odd lengths exercise the scalar tails of the SIMD loops
+		const uint lengths[] = { 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, kWidth };
+
+		uint32 map[256];
+		uint16 map16[256];
+		for (int i = 0; i < 256; ++i)
+			map16[i] = map[i] = nextRandom();
+
+		Graphics::ConversionChannels rgb565, bgra;
+		rgb565.count = 3;
+		const Graphics::ConversionChannel rgb565Channels[] = {
+			{ 11, 3 + 16, 0xFF0000 }, { 5, 2 + 8, 0xFF00 }, { 0, 3, 0xFF }
+		};
+		memcpy(rgb565.channel, rgb565Channels, sizeof(rgb565Channels));
+		bgra.count = 4;
+		const Graphics::ConversionChannel bgraChannels[] = {
+			{ 0, 24, 0xFF000000 }, { 8, 16, 0xFF0000 }, { 16, 8, 0xFF00 }, { 24, 0, 0xFF }
+		};
+		memcpy(bgra.channel, bgraChannels, sizeof(bgraChannels));
+
+		for (int l = 0; l < ARRAYSIZE(lengths); ++l) {
+			const uint len = lengths[l];
+			fillSource();
+
+			memset(_expected, 0, sizeof(_expected));
+			memset(_result, 0, sizeof(_result));
+			reference.clut8To16((uint16 *)_expected, _src, map16, len);
+			kernels.clut8To16((uint16 *)_result, _src, map16, len);
+			TS_ASSERT_EQUALS(memcmp(_expected, _result, sizeof(_expected)), 0);
+
+			reference.clut8To32((uint32 *)_expected, _src, map, len);
+			kernels.clut8To32((uint32 *)_result, _src, map, len);
+			TS_ASSERT_EQUALS(memcmp(_expected, _result, sizeof(_expected)), 0);
+
+			reference.rgb555To565((uint16 *)_expected, (const uint16 *)_src, len);
+			kernels.rgb555To565((uint16 *)_result, (const uint16 *)_src, len);
+			TS_ASSERT_EQUALS(memcmp(_expected, _result, sizeof(_expected)), 0);
+
+			reference.rgb565To555((uint16 *)_expected, (const uint16 *)_src, len);
+			kernels.rgb565To555((uint16 *)_result, (const uint16 *)_src, len);
+			TS_ASSERT_EQUALS(memcmp(_expected, _result, sizeof(_expected)), 0);
+
+			reference.rgb16To32((uint32 *)_expected, (const uint16 *)_src, len, rgb565);
+			kernels.rgb16To32((uint32 *)_result, (const uint16 *)_src, len, rgb565);
+			TS_ASSERT_EQUALS(memcmp(_expected, _result, sizeof(_expected)), 0);
+
+			reference.swizzle32((uint32 *)_expected, (const uint32 *)_src, len, bgra);
+			kernels.swizzle32((uint32 *)_result, (const uint32 *)_src, len, bgra);
+			TS_ASSERT_EQUALS(memcmp(_expected, _result, sizeof(_expected)), 0);
+		}
+	}
+
+public:
+	void setUp() {
+		_seed = 0x1C0DE;
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+	}
+
+	void test_kernels() {
+#ifdef USE_X86_SIMD
+		compareKernels(Common::kCPUFeatureSSE2, Graphics::g_conversionKernelsSSE2);
+		compareKernels(Common::kCPUFeatureSSSE3, Graphics::g_conversionKernelsSSSE3);
+		compareKernels(Common::kCPUFeatureAVX2, Graphics::g_conversionKernelsAVX2);
+#endif
+	}
+
+	void test_cross_blit() {
+		const Graphics::PixelFormat rgb555(2, 5, 5, 5, 0, 10, 5, 0, 0);
+		const Graphics::PixelFormat rgb565(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		const Graphics::PixelFormat argb4444(2, 4, 4, 4, 4, 8, 4, 0, 12);
+		const Graphics::PixelFormat rgb888(3, 8, 8, 8, 0, 16, 8, 0, 0);
+		const Graphics::PixelFormat argb8888(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		const Graphics::PixelFormat rgba8888(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		const Graphics::PixelFormat abgr8888(4, 8, 8, 8, 8, 0, 8, 16, 24);
+		const Graphics::PixelFormat xrgb8888(4, 8, 8, 8, 0, 16, 8, 0, 0);
+
+		compareCrossBlit(rgb565, rgb555);
+		compareCrossBlit(rgb555, rgb565);
+		compareCrossBlit(rgb565, argb4444);
+		compareCrossBlit(argb8888, rgb565);
+		compareCrossBlit(rgba8888, rgb555);
+		compareCrossBlit(abgr8888, argb4444);
+		compareCrossBlit(rgba8888, argb8888);
+		compareCrossBlit(abgr8888, argb8888);
+		compareCrossBlit(xrgb8888, rgba8888);
+		compareCrossBlit(rgba8888, xrgb8888);
+		compareCrossBlit(argb8888, rgb888);
+	}
+
+	void test_cross_blit_in_place() {
+		const Graphics::PixelFormat argb8888(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		const Graphics::PixelFormat abgr8888(4, 8, 8, 8, 8, 0, 8, 16, 24);
+
+		fillSource();
+		convertReference(abgr8888, argb8888);
+		memset(_result, 0xCC, sizeof(_result));
+		for (int y = 0; y < kHeight; ++y)
+			memcpy(_result + y * kDstPitch, _src + y * kSrcPitch, 4 * kWidth);
+		TS_ASSERT(Graphics::crossBlit(_result, _result, kDstPitch, kDstPitch, kWidth, kHeight, abgr8888, argb8888));
+		TS_ASSERT_EQUALS(memcmp(_expected, _result, sizeof(_expected)), 0);
+	}
+
+	void test_cross_blit_map() {
+		uint32 map[256];
+		for (int i = 0; i < 256; ++i)
+			map[i] = nextRandom();
+		fillSource();
+
+		for (uint bpp = 2; bpp <= 4; ++bpp) {
+			memset(_expected, 0xCC, sizeof(_expected));
+			for (int y = 0; y < kHeight; ++y) {
+				for (int x = 0; x < kWidth; ++x)
+					writePixel(_expected + y * kDstPitch + x * bpp, bpp, map[_src[y * kSrcPitch + x]]);
+			}
+
+			memset(_result, 0xCC, sizeof(_result));
+			TS_ASSERT(Graphics::crossBlitMap(_result, _src, kDstPitch, kSrcPitch, kWidth, kHeight, bpp, map));
+			TS_ASSERT_EQUALS(memcmp(_expected, _result, sizeof(_expected)), 0);
+		}
+
+		TS_ASSERT(!Graphics::crossBlitMap(_result, _src, kDstPitch, kSrcPitch, kWidth, kHeight, 1, map));
+	}
+};
@@ -0,0 +1,84 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "common/util.h"
+#include "graphics/conversion.h"
+#include "graphics/pixelformat.h"
+
+#include "../benchmark.h"
+
+class ConversionBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 640,
+		kHeight = 480,
+		kIterations = 100
+	};
+
+	byte _src[kWidth * kHeight * 4];
+	byte _dst[kWidth * kHeight * 4];
+	uint32 _map[256];
+
+	void benchCrossBlit(const char *name, const char *kernelName, const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+		BenchmarkTimer timer;
+		for (int i = 0; i < kIterations; ++i)
+			Graphics::crossBlit(_dst, _src, kWidth * dstFmt.bytesPerPixel, kWidth * srcFmt.bytesPerPixel, kWidth, kHeight, dstFmt, srcFmt);
+		reportBenchmark(Common::String::format("%s %s", kernelName, name).c_str(), (uint32)kWidth * kHeight * kIterations, timer.elapsedMicros(), "pixels");
+	}
+
+	void benchCrossBlitMap(const char *name, const char *kernelName, uint dstBpp) {
+		BenchmarkTimer timer;
+		for (int i = 0; i < kIterations; ++i)
+			Graphics::crossBlitMap(_dst, _src, kWidth * dstBpp, kWidth, kWidth, kHeight, dstBpp, _map);
+		reportBenchmark(Common::String::format("%s %s", kernelName, name).c_str(), (uint32)kWidth * kHeight * kIterations, timer.elapsedMicros(), "pixels");
+	}
+
+	void benchConversions(const char *kernelName, uint32 featureMask) {
+		const Graphics::PixelFormat rgb555(2, 5, 5, 5, 0, 10, 5, 0, 0);
+		const Graphics::PixelFormat rgb565(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		const Graphics::PixelFormat argb8888(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		const Graphics::PixelFormat rgba8888(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		const Graphics::PixelFormat abgr8888(4, 8, 8, 8, 8, 0, 8, 16, 24);
+
+		Common::setCPUFeatureMask(featureMask);
+
+		benchCrossBlitMap("CLUT8 to 565", kernelName, 2);
+		benchCrossBlitMap("CLUT8 to 8888", kernelName, 4);
+		benchCrossBlit("555 to 565", kernelName, rgb565, rgb555);
+		benchCrossBlit("565 to 555", kernelName, rgb555, rgb565);
+		benchCrossBlit("565 to ARGB8888", kernelName, argb8888, rgb565);
+		benchCrossBlit("555 to RGBA8888", kernelName, rgba8888, rgb555);
+		benchCrossBlit("ARGB8888 to ABGR8888", kernelName, abgr8888, argb8888);
+		benchCrossBlit("ARGB8888 to RGBA8888", kernelName, rgba8888, argb8888);
+	}
+
+public:
+	void setUp() {
+		uint32 seed = 1;
+		for (int i = 0; i < ARRAYSIZE(_src); ++i) {
+			seed = seed * 1103515245 + 12345;
+			_src[i] = seed >> 16;
+		}
+		for (int i = 0; i < 256; ++i)
+			_map[i] = (uint32)i * 0x01010101;
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+	}
+
+	void test_conversions() {
+		const bool hasSSE2 = Common::hasCPUFeature(Common::kCPUFeatureSSE2);
+		const bool hasSSSE3 = Common::hasCPUFeature(Common::kCPUFeatureSSSE3);
+		const bool hasAVX2 = Common::hasCPUFeature(Common::kCPUFeatureAVX2);
+
+		benchConversions("C++", 0);
+		if (hasSSE2)
+			benchConversions("SSE2", Common::kCPUFeatureSSE2);
+		if (hasSSSE3)
+			benchConversions("SSSE3", Common::kCPUFeatureSSE2 | Common::kCPUFeatureSSSE3);
+		if (hasAVX2)
+			benchConversions("AVX2", 0xFFFFFFFF);
+	}
+};
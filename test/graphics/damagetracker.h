@@ -0,0 +1,125 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/damagetracker.h"
+
+class DamageTrackerTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_merge_adjacent() {
+		Graphics::DamageTracker tracker(16);
+		tracker.addRect(Common::Rect(0, 0, 16, 16));
+		tracker.addRect(Common::Rect(16, 0, 32, 16));
+		tracker.addRect(Common::Rect(0, 16, 32, 32));
+
+		TS_ASSERT_EQUALS(tracker.getRects().size(), 1U);
+		TS_ASSERT_EQUALS(tracker.getRects()[0], Common::Rect(0, 0, 32, 32));
+	}
+
+	void test_merge_overlapping() {
+		Graphics::DamageTracker tracker(16);
+		tracker.addRect(Common::Rect(10, 10, 50, 50));
+		tracker.addRect(Common::Rect(20, 20, 60, 60));
+		tracker.addRect(Common::Rect(30, 30, 40, 40));
+
+		TS_ASSERT_EQUALS(tracker.getRects().size(), 1U);
+		TS_ASSERT_EQUALS(tracker.getRects()[0], Common::Rect(10, 10, 60, 60));
+	}
+
+	void test_keep_distant() {
+		Graphics::DamageTracker tracker(16);
+		tracker.addRect(Common::Rect(0, 0, 8, 8));
+		tracker.addRect(Common::Rect(300, 180, 320, 200));
+		tracker.addRect(Common::Rect());
+
+		TS_ASSERT_EQUALS(tracker.getRects().size(), 2U);
+
+		// The merged rect would cover the whole screen for 464 pixels
+		Graphics::DamageTracker cheap(16, 100000);
+		cheap.addRect(Common::Rect(0, 0, 8, 8));
+		cheap.addRect(Common::Rect(300, 180, 320, 200));
+		TS_ASSERT_EQUALS(cheap.getRects().size(), 1U);
+	}
+
+	void test_overflow() {
+		Graphics::DamageTracker tracker(4);
+		Common::Rect all;
+		for (int i = 0; i < 10; ++i) {
+			const Common::Rect r(i * 100, i * 40, i * 100 + 10, i * 40 + 10);
+			tracker.addRect(r);
+			if (i == 0)
+				all = r;
+			else
+				all.extend(r);
+		}
+
+		const Common::Array<Common::Rect> &rects = tracker.getRects();
+		TS_ASSERT(rects.size() <= 4U);
+
+		// Every added rect must still be covered
+		for (int i = 0; i < 10; ++i) {
+			const Common::Rect r(i * 100, i * 40, i * 100 + 10, i * 40 + 10);
+			bool covered = false;
+			for (uint j = 0; j < rects.size(); ++j)
+				covered = covered || rects[j].contains(r);
+			TS_ASSERT(covered);
+		}
+	}
+
+	void test_diff() {
+		enum { kWidth = 64, kHeight = 48 };
+		byte oldPixels[kWidth * kHeight * 2];
+		byte newPixels[kWidth * kHeight * 2];
+		for (int i = 0; i < kWidth * kHeight * 2; ++i)
+			oldPixels[i] = newPixels[i] = (byte)(i * 13);
+
+		Graphics::DamageTracker tracker(16);
+		Common::Array<Common::Rect> changed;
+
+		tracker.diffRect(newPixels, kWidth * 2, oldPixels, kWidth * 2, 2, Common::Rect(kWidth, kHeight), changed);
+		TS_ASSERT(changed.empty());
+
+		// Two pixels in neighbouring tiles and one further down
+		newPixels[(5 * kWidth + 20) * 2] ^= 1;
+		newPixels[(9 * kWidth + 40) * 2 + 1] ^= 1;
+		newPixels[(40 * kWidth + 5) * 2] ^= 1;
+
+		tracker.diffRect(newPixels, kWidth * 2, oldPixels, kWidth * 2, 2, Common::Rect(kWidth, kHeight), changed);
+		TS_ASSERT_EQUALS(changed.size(), 2U);
+		TS_ASSERT_EQUALS(changed[0], Common::Rect(16, 0, 48, 16));
+		TS_ASSERT_EQUALS(changed[1], Common::Rect(0, 32, 16, 48));
+
+		// A rect which is not aligned to the tiles gets clipped tiles
+		changed.clear();
+		const Common::Rect area(10, 3, 30, 20);
+		const int offset = (area.top * kWidth + area.left) * 2;
+		tracker.diffRect(newPixels + offset, kWidth * 2, oldPixels + offset, kWidth * 2, 2, area, changed);
+		TS_ASSERT_EQUALS(changed.size(), 1U);
+		TS_ASSERT_EQUALS(changed[0], Common::Rect(16, 3, 30, 16));
+	}
+
+	void test_stats() {
+		Graphics::DamageTracker tracker(16);
+		tracker.setScreenSize(320, 200);
+
+		tracker.submit(Common::Rect(320, 200));
+		tracker.addRect(Common::Rect(0, 0, 16, 16));
+		tracker.addRect(Common::Rect(100, 100, 132, 116));
+		tracker.endFrame();
+
+		const Graphics::DamageTracker::Stats &stats = tracker.getLastFrameStats();
+		TS_ASSERT_EQUALS(stats.submittedRects, 1U);
+		TS_ASSERT_EQUALS(stats.submittedPixels, 320U * 200U);
+		TS_ASSERT_EQUALS(stats.dirtyRects, 2U);
+		TS_ASSERT_EQUALS(stats.dirtyPixels, 16U * 16U + 32U * 16U);
+		TS_ASSERT(!stats.full);
+		TS_ASSERT(tracker.isEmpty());
+
+		tracker.addRect(Common::Rect(0, 0, 16, 16));
+		tracker.markFull();
+		TS_ASSERT(tracker.getRects().empty());
+		tracker.endFrame();
+		TS_ASSERT(tracker.getLastFrameStats().full);
+		TS_ASSERT_EQUALS(tracker.getLastFrameStats().dirtyPixels, 320U * 200U);
+		TS_ASSERT_EQUALS(tracker.getLastFrameStats().submittedPixels, 0U);
+	}
+};
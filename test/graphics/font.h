@@ -0,0 +1,187 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "graphics/font.h"
+#include "graphics/fontcache.h"
+#include "graphics/fontman.h"
+#include "graphics/surface.h"
+
+class FontTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 160,
+		kHeight = 40
+	};
+
+	/** Fill the surface with a pattern, so that untouched pixels are noticed. */
+	static void fillBackground(Graphics::Surface &surface) {
+		for (int y = 0; y < surface.h; y++) {
+			byte *row = (byte *)surface.getBasePtr(0, y);
+			for (int i = 0; i < surface.w * surface.format.bytesPerPixel; i++)
+				row[i] = (byte)((i * 7 + y * 13) & 0x7F);
+		}
+	}
+
+
+	/** The uncached drawString(): drawChar() for every character which fits. */
+	static void drawReference(const Graphics::Font *font, Graphics::Surface *dst, const Common::String &str, int x, int y, int w, uint32 color, Graphics::TextAlign align, int deltax) {
+		const int leftX = x, rightX = x + w;
+		const int width = font->getStringWidth(str);
+		if (align == Graphics::kTextAlignCenter)
+			x = x + (w - width) / 2;
+		else if (align == Graphics::kTextAlignRight)
+			x = x + w - width;
+		x += deltax;
+
+		for (uint i = 0; i < str.size(); ++i) {
+			const int charWidth = font->getCharWidth(str[i]);
+			if (x + charWidth > rightX)
+				break;
+			if (x >= leftX)
+				font->drawChar(dst, str[i], x, y, color);
+			x += charWidth;
+		}
+	}
+
+	static bool sameSurfaces(const Graphics::Surface &a, const Graphics::Surface &b) {
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+	void checkString(const Graphics::Font *font, const Graphics::PixelFormat &format, const Common::String &str, int x, int y, int w, Graphics::TextAlign align, int deltax) {
+		Graphics::Surface expected, result;
+		expected.create(kWidth, kHeight, format);
+		result.create(kWidth, kHeight, format);
+		fillBackground(expected);
+		fillBackground(result);
+
+		const uint32 color = format.bytesPerPixel == 1 ? 0xF1 : 0xF00F;
+		drawReference(font, &expected, str, x, y, w, color, align, deltax);
+		// Draw twice, to also go through the cached run
+		font->drawString(&result, str, x, y, w, color, align, deltax, false);
+		fillBackground(result);
+		font->drawString(&result, str, x, y, w, color, align, deltax, false);
+
+		TS_ASSERT(sameSurfaces(expected, result));
+
+		expected.free();
+		result.free();
+	}
+
+	void checkFont(const Graphics::Font *font) {
+		const Graphics::PixelFormat formats[2] = {
+			Graphics::PixelFormat::createFormatCLUT8(),
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0)
+		};
+
+		for (int f = 0; f < 2; f++) {
+			checkString(font, formats[f], "Hello, World!", 3, 2, 150, Graphics::kTextAlignLeft, 0);
+			checkString(font, formats[f], "Centered gjpqy", 0, 10, kWidth, Graphics::kTextAlignCenter, 0);
+			checkString(font, formats[f], "Aligned to the right", 0, 5, kWidth, Graphics::kTextAlignRight, 0);
+			// Characters which do not fit are left out
+			checkString(font, formats[f], "Too long to fit into the width", 10, 3, 60, Graphics::kTextAlignLeft, 0);
+			checkString(font, formats[f], "Scrolled to the left", 10, 3, 100, Graphics::kTextAlignLeft, -17);
+			// Clipped at the bottom and right edges of the surface
+			checkString(font, formats[f], "Bottom edge", 5, kHeight - 4, 100, Graphics::kTextAlignLeft, 0);
+			checkString(font, formats[f], "Right edge", kWidth - 30, 3, 33, Graphics::kTextAlignLeft, 0);
+			checkString(font, formats[f], "", 5, 5, 100, Graphics::kTextAlignLeft, 0);
+			checkString(font, formats[f], "   ", 5, 5, 100, Graphics::kTextAlignLeft, 0);
+		}
+	}
+
+public:
+	void test_blit_kernels_sse2() {
+		const Graphics::FontBlitKernels *sse2 = Graphics::getFontBlitKernels(Common::kCPUFeatureSSE2);
+		if (!sse2)
+			return;
+
+		const Graphics::FontBlitKernels &scalar = Graphics::getScalarFontBlitKernels();
+		uint32 seed = 0x51F7;
+		byte mask[3 * 40], expected[3 * 43], result[3 * 43];
+		const byte color[16] = { 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4 };
+
+		for (uint length = 1; length <= 40; length++) {
+			for (uint i = 0; i < sizeof(expected); i++) {
+				seed = seed * 1103515245 + 12345;
+				expected[i] = result[i] = seed >> 16;
+				if (i < sizeof(mask))
+					mask[i] = (seed >> 28) & 1 ? 0xFF : 0;
+			}
+
+			// Three rows, with a pitch larger than the length
+			scalar.blitMask(expected + 1, 43, mask, 40, length, 3, color);
+			sse2->blitMask(result + 1, 43, mask, 40, length, 3, color);
+			TS_ASSERT_EQUALS(memcmp(expected, result, sizeof(expected)), 0);
+		}
+	}
+
+	void test_draw_string() {
+		checkFont(FontMan.getFontByUsage(Graphics::FontManager::kGUIFont));
+		checkFont(FontMan.getFontByUsage(Graphics::FontManager::kBigGUIFont));
+		checkFont(FontMan.getFontByUsage(Graphics::FontManager::kConsoleFont));
+	}
+
+	void test_draw_string_32bpp() {
+		// Fonts cannot draw into 32 bit surfaces themselves, so compare with a
+		// string drawn into a 8 bit surface
+		const Graphics::Font *font = FontMan.getFontByUsage(Graphics::FontManager::kGUIFont);
+		Graphics::Surface expected, result;
+		expected.create(kWidth, kHeight, Graphics::PixelFormat::createFormatCLUT8());
+		result.create(kWidth, kHeight, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+		memset(expected.pixels, 0, expected.pitch * expected.h);
+		memset(result.pixels, 0x5A, result.pitch * result.h);
+
+		font->drawString(&expected, "32 bits per pixel", 7, 9, 140, 1);
+		font->drawString(&result, "32 bits per pixel", 7, 9, 140, 0x12345678);
+
+		uint32 errors = 0;
+		for (int y = 0; y < kHeight; y++) {
+			for (int x = 0; x < kWidth; x++) {
+				const uint32 pixel = *(const uint32 *)result.getBasePtr(x, y);
+				if (pixel != (*(const byte *)expected.getBasePtr(x, y) ? 0x12345678 : 0x5A5A5A5A))
+					errors++;
+			}
+		}
+		TS_ASSERT_EQUALS(errors, 0u);
+
+		expected.free();
+		result.free();
+	}
+
+	void test_run_cache_limit() {
+		const Graphics::Font *font = FontMan.getFontByUsage(Graphics::FontManager::kGUIFont);
+		Graphics::FontCache cache(*font, 4096);
+
+		Graphics::Surface surface;
+		surface.create(kWidth, kHeight, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+
+		for (int i = 0; i < 100; i++) {
+			cache.drawString(&surface, Common::String::format("List entry %d", i), 0, 0, 0xFFFF);
+			TS_ASSERT_LESS_THAN_EQUALS(cache.getRunCacheSize(), 4096u);
+		}
+		TS_ASSERT_LESS_THAN(cache.getRunCount(), 100u);
+		TS_ASSERT_LESS_THAN(0u, cache.getRunCount());
+
+		// Drawing a cached string again does not add a run
+		const uint count = cache.getRunCount();
+		cache.drawString(&surface, "List entry 99", 0, 0, 0xFFFF);
+		TS_ASSERT_EQUALS(cache.getRunCount(), count);
+
+		// Strings larger than the whole cache are drawn, but not cached
+		Common::String longString;
+		for (int i = 0; i < 40; i++)
+			longString += "Wide ";
+		cache.drawString(&surface, longString, 0, 0, 0xFFFF);
+		TS_ASSERT_EQUALS(cache.getRunCount(), count);
+
+		cache.clearRuns();
+		TS_ASSERT_EQUALS(cache.getRunCount(), 0u);
+		TS_ASSERT_EQUALS(cache.getRunCacheSize(), 0u);
+
+		surface.free();
+	}
+};
@@ -0,0 +1,68 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/font.h"
+#include "graphics/fontman.h"
+#include "graphics/surface.h"
+
+#include "../benchmark.h"
+
+class FontBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 640,
+		kHeight = 480,
+		kRows = 30,
+		kIterations = 200
+	};
+
+	Graphics::Surface _surface;
+	Common::String _rows[kRows];
+
+	/** What drawString() did before the cache: drawChar() for every character. */
+	static void drawChars(const Graphics::Font *font, Graphics::Surface *dst, const Common::String &str, int x, int y, uint32 color) {
+		for (uint i = 0; i < str.size(); ++i) {
+			font->drawChar(dst, str[i], x, y, color);
+			x += font->getCharWidth(str[i]);
+		}
+	}
+
+	/** Redraw a list of strings, like a ListWidget does. */
+	void benchFont(const char *fontName, const Graphics::Font *font) {
+		const int lineHeight = font->getFontHeight();
+		uint32 chars = 0;
+		for (int row = 0; row < kRows; row++)
+			chars += _rows[row].size();
+
+		BenchmarkTimer timer;
+		for (int i = 0; i < kIterations; i++) {
+			for (int row = 0; row < kRows; row++)
+				drawChars(font, &_surface, _rows[row], 4, 2 + row * lineHeight, 0xFFFF);
+		}
+		reportBenchmark(Common::String::format("%s drawChar", fontName).c_str(), chars * kIterations, timer.elapsedMicros(), "chars");
+
+		BenchmarkTimer cachedTimer;
+		for (int i = 0; i < kIterations; i++) {
+			for (int row = 0; row < kRows; row++)
+				font->drawString(&_surface, _rows[row], 4, 2 + row * lineHeight, kWidth - 8, 0xFFFF);
+		}
+		reportBenchmark(Common::String::format("%s drawString (cached)", fontName).c_str(), chars * kIterations, cachedTimer.elapsedMicros(), "chars");
+	}
+
+public:
+	void setUp() {
+		_surface.create(kWidth, kHeight, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		for (int row = 0; row < kRows; row++)
+			_rows[row] = Common::String::format("Game %02d: The Secret of Monkey Island (DOS/English)", row);
+	}
+
+	void tearDown() {
+		_surface.free();
+	}
+
+	void test_font() {
+		benchFont("GUI font", FontMan.getFontByUsage(Graphics::FontManager::kGUIFont));
+		benchFont("Big GUI font", FontMan.getFontByUsage(Graphics::FontManager::kBigGUIFont));
+		benchFont("Console font", FontMan.getFontByUsage(Graphics::FontManager::kConsoleFont));
+	}
+};
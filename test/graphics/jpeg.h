@@ -0,0 +1,298 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "graphics/jpeg.h"
+#include "graphics/jpeg_idct.h"
+#include "graphics/surface.h"
+
+#include "jpeg_helper.h"
+
+class JPEGTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		// Not a multiple of the MCU size, to exercise the edges
+		kWidth = 77,
+		kHeight = 45
+	};
+
+	byte *_planes[3];
+	uint32 _seed;
+
+	int nextRandom(int range) {
+		_seed = _seed * 1103515245 + 12345;
+		return (int)((_seed >> 8) % range);
+	}
+
+	/** Scale quantized coefficients like the decoder does. */
+	static void scaleCoefficients(int16 *dst, const int *coeffs, const int *quant) {
+		for (int i = 0; i < 64; i++)
+			dst[i] = (int16)((coeffs[i] * quant[i] * Graphics::g_jpegIDCTScales[i] + (1 << 11)) >> 12);
+	}
+
+	void randomCoefficients(int *coeffs, int *quant, int maxValue) {
+		for (int i = 0; i < 64; i++) {
+			quant[i] = 1 + nextRandom(16);
+			// Real images mostly have small high frequency coefficients
+			const int range = maxValue / quant[i] / (1 + (i & 7) + (i >> 3)) + 1;
+			coeffs[i] = nextRandom(2 * range + 1) - range;
+		}
+
+		// Leave some columns without AC coefficients
+		for (int x = nextRandom(8); x < 8; x += 1 + nextRandom(4))
+			for (int y = 1; y < 8; y++)
+				coeffs[y * 8 + x] = 0;
+	}
+
+	static int planeError(const byte *expected, const Graphics::Surface *plane, double &meanError) {
+		int maxError = 0;
+		uint32 sum = 0;
+		for (int y = 0; y < kHeight; y++) {
+			const byte *row = (const byte *)plane->getBasePtr(0, y);
+			for (int x = 0; x < kWidth; x++) {
+				const int error = ABS(row[x] - expected[y * kWidth + x]);
+				maxError = MAX(maxError, error);
+				sum += error;
+			}
+		}
+
+		meanError = (double)sum / (kWidth * kHeight);
+		return maxError;
+	}
+
+	void checkDecode(bool subsample, double maxMeanError) {
+		byte *expected[3];
+		for (int c = 0; c < 3; c++)
+			expected[c] = new byte[kWidth * kHeight];
+
+		Common::SeekableReadStream *stream = JPEGTestEncoder::encode(_planes, kWidth, kHeight, subsample, expected);
+
+		Graphics::JPEG jpeg;
+		TS_ASSERT(jpeg.read(stream));
+		TS_ASSERT_EQUALS(jpeg.getWidth(), kWidth);
+		TS_ASSERT_EQUALS(jpeg.getHeight(), kHeight);
+
+		// The whole stream has to be consumed
+		TS_ASSERT_EQUALS(stream->pos(), stream->size());
+
+		for (int c = 0; c < 3; c++) {
+			// The integer IDCT is close to the exact one, and the image to
+			// the source
+			double meanError;
+			TS_ASSERT_LESS_THAN_EQUALS(planeError(expected[c], jpeg.getComponent(c + 1), meanError), 1);
+			planeError(_planes[c], jpeg.getComponent(c + 1), meanError);
+			TS_ASSERT_LESS_THAN(meanError, maxMeanError);
+			delete[] expected[c];
+		}
+
+		// The SIMD kernels have to produce the same image as the C++ ones
+		// The component planes are wider than the image, so they are copied
+		// row by row
+		byte *reference[3];
+		for (int c = 0; c < 3; c++) {
+			reference[c] = new byte[kWidth * kHeight];
+			for (int y = 0; y < kHeight; y++)
+				memcpy(reference[c] + y * kWidth, jpeg.getComponent(c + 1)->getBasePtr(0, y), kWidth);
+		}
+
+		Common::setCPUFeatureMask(0);
+		stream->seek(0);
+		TS_ASSERT(jpeg.read(stream));
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+
+		for (int c = 0; c < 3; c++) {
+			const Graphics::Surface *plane = jpeg.getComponent(c + 1);
+			for (int y = 0; y < kHeight; y++)
+				TS_ASSERT_EQUALS(memcmp(plane->getBasePtr(0, y), reference[c] + y * kWidth, kWidth), 0);
+			delete[] reference[c];
+		}
+
+		delete stream;
+	}
+
+public:
+	void setUp() {
+		_seed = 0x1DC7;
+
+		// Smooth gradients, with some noise on the right side to produce
+		// large coefficients and long Huffman codes
+		for (int c = 0; c < 3; c++) {
+			_planes[c] = new byte[kWidth * kHeight];
+			for (int y = 0; y < kHeight; y++) {
+				for (int x = 0; x < kWidth; x++) {
+					int value = c == 0 ? 16 + x * 2 + y : 128 + (c == 1 ? x - y : y - x);
+					if (x > kWidth / 2)
+						value += nextRandom(64) - 32;
+					_planes[c][y * kWidth + x] = CLIP(value, 0, 255);
+				}
+			}
+		}
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		for (int c = 0; c < 3; c++)
+			delete[] _planes[c];
+	}
+
+	void test_idct_accuracy() {
+		const Graphics::JPEGIDCTKernels &kernels = Graphics::getScalarJPEGIDCTKernels();
+
+		int maxError = 0;
+		for (int block = 0; block < 2000; block++) {
+			int coeffs[64], quant[64], dequantized[64];
+			randomCoefficients(coeffs, quant, 1024);
+			for (int i = 0; i < 64; i++)
+				dequantized[i] = coeffs[i] * quant[i];
+
+			int16 scaled[64];
+			scaleCoefficients(scaled, coeffs, quant);
+
+			byte expected[64], result[64];
+			JPEGTestEncoder::referenceIDCT(expected, 8, dequantized);
+			kernels.idct8x8(result, 8, scaled);
+
+			for (int i = 0; i < 64; i++)
+				maxError = MAX(maxError, ABS(result[i] - expected[i]));
+		}
+
+		TS_ASSERT_LESS_THAN_EQUALS(maxError, 1);
+	}
+
+	void test_idct_dc_only() {
+		const Graphics::JPEGIDCTKernels &kernels = Graphics::getScalarJPEGIDCTKernels();
+
+		for (int dc = -1100; dc <= 1100; dc++) {
+			int16 coeffs[64];
+			memset(coeffs, 0, sizeof(coeffs));
+			coeffs[0] = (int16)((dc * Graphics::g_jpegIDCTScales[0] + (1 << 11)) >> 12);
+
+			byte result[64];
+			kernels.idct8x8(result, 8, coeffs);
+			TS_ASSERT_EQUALS(result[0], Graphics::jpegIDCTDCOnly(coeffs[0]));
+			TS_ASSERT_EQUALS(result[63], Graphics::jpegIDCTDCOnly(coeffs[0]));
+		}
+	}
+
+	void test_idct_sse2() {
+		const Graphics::JPEGIDCTKernels *sse2 = Graphics::getJPEGIDCTKernels(Common::kCPUFeatureSSE2);
+		if (!sse2)
+			return;
+
+		const Graphics::JPEGIDCTKernels &scalar = Graphics::getScalarJPEGIDCTKernels();
+		for (int block = 0; block < 5000; block++) {
+			int coeffs[64], quant[64];
+			randomCoefficients(coeffs, quant, block & 1 ? 1024 : 4096);
+
+			int16 scaled[64];
+			scaleCoefficients(scaled, coeffs, quant);
+
+			// Odd pitch, to check for alignment assumptions
+			byte expected[8 * 11], result[8 * 11];
+			scalar.idct8x8(expected, 11, scaled);
+			sse2->idct8x8(result, 11, scaled);
+
+			for (int y = 0; y < 8; y++)
+				TS_ASSERT_EQUALS(memcmp(expected + y * 11, result + y * 11, 8), 0);
+		}
+	}
+
+	void test_decode() {
+		checkDecode(false, 4.0);
+	}
+
+	void test_decode_subsampled() {
+		// Subsampling loses detail in the noisy part of the chroma planes
+		checkDecode(true, 9.0);
+	}
+
+	void test_convert_to() {
+		Common::SeekableReadStream *stream = JPEGTestEncoder::encode(_planes, kWidth, kHeight, true);
+
+		Graphics::JPEG jpeg;
+		TS_ASSERT(jpeg.read(stream));
+		delete stream;
+
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		for (int f = 0; f < ARRAYSIZE(formats); f++) {
+			Graphics::Surface *expected = jpeg.getSurface(formats[f]);
+			TS_ASSERT(expected);
+
+			// A larger surface only gets the image in its top left corner
+			Graphics::Surface result;
+			result.create(kWidth + 3, kHeight + 1, formats[f]);
+			TS_ASSERT(jpeg.convertTo(&result));
+
+			for (int y = 0; y < kHeight; y++)
+				TS_ASSERT_EQUALS(memcmp(expected->getBasePtr(0, y), result.getBasePtr(0, y), kWidth * formats[f].bytesPerPixel), 0);
+
+			expected->free();
+			delete expected;
+			result.free();
+		}
+
+		// Too small surfaces and CLUT8 are rejected
+		Graphics::Surface small;
+		small.create(kWidth - 1, kHeight, formats[0]);
+		TS_ASSERT(!jpeg.convertTo(&small));
+		small.free();
+
+		TS_ASSERT(!jpeg.getSurface(Graphics::PixelFormat::createFormatCLUT8()));
+	}
+
+	void test_read_into_surface() {
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		for (int subsample = 0; subsample < 2; subsample++) {
+			Common::SeekableReadStream *stream = JPEGTestEncoder::encode(_planes, kWidth, kHeight, subsample != 0);
+
+			for (int f = 0; f < ARRAYSIZE(formats); f++) {
+				Graphics::JPEG jpeg;
+				stream->seek(0);
+				TS_ASSERT(jpeg.read(stream));
+				Graphics::Surface *expected = jpeg.getSurface(formats[f]);
+				TS_ASSERT(expected);
+
+				// Decoding row by row gives the same image
+				Graphics::Surface result;
+				result.create(kWidth + 3, kHeight + 1, formats[f]);
+				stream->seek(0);
+				TS_ASSERT(jpeg.read(stream, &result));
+				TS_ASSERT_EQUALS(stream->pos(), stream->size());
+
+				for (int y = 0; y < kHeight; y++)
+					TS_ASSERT_EQUALS(memcmp(expected->getBasePtr(0, y), result.getBasePtr(0, y), kWidth * formats[f].bytesPerPixel), 0);
+
+				// The planes are gone afterwards
+				TS_ASSERT(!jpeg.convertTo(&result));
+
+				expected->free();
+				delete expected;
+				result.free();
+			}
+
+			// Too small surfaces and CLUT8 are rejected
+			Graphics::JPEG jpeg;
+			Graphics::Surface small;
+			small.create(kWidth, kHeight - 1, formats[0]);
+			stream->seek(0);
+			TS_ASSERT(!jpeg.read(stream, &small));
+			small.free();
+
+			Graphics::Surface clut8;
+			clut8.create(kWidth, kHeight, Graphics::PixelFormat::createFormatCLUT8());
+			stream->seek(0);
+			TS_ASSERT(!jpeg.read(stream, &clut8));
+			clut8.free();
+
+			delete stream;
+		}
+	}
+};
@@ -0,0 +1,84 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "graphics/jpeg.h"
+#include "graphics/surface.h"
+
+#include "jpeg_helper.h"
+#include "../benchmark.h"
+
+class JPEGBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 640,
+		kHeight = 480,
+		kIterations = 20
+	};
+
+	Common::SeekableReadStream *_stream;
+
+	void benchDecode(const char *kernelName, uint32 featureMask) {
+		Common::setCPUFeatureMask(featureMask);
+
+		Graphics::JPEG jpeg;
+		Graphics::Surface surface;
+		surface.create(kWidth, kHeight, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+
+		BenchmarkTimer timer;
+		for (int i = 0; i < kIterations; ++i) {
+			_stream->seek(0);
+			jpeg.read(_stream);
+		}
+		reportBenchmark(Common::String::format("%s JPEG decode", kernelName).c_str(), (uint32)kWidth * kHeight * kIterations, timer.elapsedMicros(), "pixels");
+
+		BenchmarkTimer convertTimer;
+		for (int i = 0; i < kIterations; ++i)
+			jpeg.convertTo(&surface);
+		reportBenchmark(Common::String::format("%s JPEG convert to 565", kernelName).c_str(), (uint32)kWidth * kHeight * kIterations, convertTimer.elapsedMicros(), "pixels");
+
+		BenchmarkTimer directTimer;
+		for (int i = 0; i < kIterations; ++i) {
+			_stream->seek(0);
+			jpeg.read(_stream, &surface);
+		}
+		reportBenchmark(Common::String::format("%s JPEG decode into 565", kernelName).c_str(), (uint32)kWidth * kHeight * kIterations, directTimer.elapsedMicros(), "pixels");
+
+		surface.free();
+	}
+
+public:
+	void setUp() {
+		// A photograph-like image: smooth gradients with some noise
+		byte *planes[3];
+		uint32 seed = 1;
+		for (int c = 0; c < 3; c++) {
+			planes[c] = new byte[kWidth * kHeight];
+			for (int y = 0; y < kHeight; y++) {
+				for (int x = 0; x < kWidth; x++) {
+					seed = seed * 1103515245 + 12345;
+					const int value = (c == 0 ? (x + y) / 5 + 32 : 128 + ((x - y) >> 3)) + (int)((seed >> 16) & 15) - 8;
+					planes[c][y * kWidth + x] = CLIP(value, 0, 255);
+				}
+			}
+		}
+
+		_stream = JPEGTestEncoder::encode(planes, kWidth, kHeight, true);
+
+		for (int c = 0; c < 3; c++)
+			delete[] planes[c];
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		delete _stream;
+	}
+
+	void test_jpeg() {
+		const bool hasSSE2 = Common::hasCPUFeature(Common::kCPUFeatureSSE2);
+
+		benchDecode("C++", 0);
+		if (hasSSE2)
+			benchDecode("SSE2", Common::kCPUFeatureSSE2);
+	}
+};
@@ -0,0 +1,331 @@
+#ifndef TEST_GRAPHICS_JPEG_HELPER_H
+#define TEST_GRAPHICS_JPEG_HELPER_H
+
+#include "common/memstream.h"
+#include "common/stream.h"
+#include "common/util.h"
+
+#include <math.h>
+
+/**
+ * A minimal baseline JPEG encoder, used to produce test images for the
+ * decoder without shipping binary files.
+ */
+class JPEGTestEncoder {
+public:
+	/**
+	 * Encode the given w * h Y, Cb and Cr planes. With subsampling, the
+	 * chroma planes are averaged over 2x2 pixels (4:2:0). If given, the
+	 * decoded planes receive what an exact decoder produces.
+	 */
+	static Common::SeekableReadStream *encode(const byte *const planes[3], int w, int h, bool subsample, byte *const decoded[3] = 0) {
+		JPEGTestEncoder encoder(w, h, subsample);
+		encoder.writeHeaders();
+		encoder.writeScan(planes, decoded);
+		encoder.writeMarker(0xD9);
+
+		uint32 size = encoder._out.size();
+		return new Common::MemoryReadStream(encoder._out.getData(), size, DisposeAfterUse::YES);
+	}
+
+	/** The quantizer of the coefficient (u, v) of the given component. */
+	static int quantizer(int comp, int u, int v) {
+		return comp ? 3 + (u + v) * 3 : 2 + (u + v) * 2;
+	}
+
+	/** The exact IDCT of dequantized coefficients given in natural order. */
+	static void referenceIDCT(byte *dst, int pitch, const int *coeffs) {
+		for (int y = 0; y < 8; y++) {
+			for (int x = 0; x < 8; x++) {
+				double sum = 0;
+				for (int v = 0; v < 8; v++)
+					for (int u = 0; u < 8; u++)
+						sum += scale(u) * scale(v) * coeffs[v * 8 + u] * cos((2 * x + 1) * u * M_PI / 16) * cos((2 * y + 1) * v * M_PI / 16);
+
+				const int sample = (int)floor(sum / 4 + 128.5);
+				dst[y * pitch + x] = sample < 0 ? 0 : (sample > 255 ? 255 : sample);
+			}
+		}
+	}
+
+	/** The exact forward DCT of the samples of a block. */
+	static void referenceFDCT(double *coeffs, const byte *src, int pitch) {
+		for (int v = 0; v < 8; v++) {
+			for (int u = 0; u < 8; u++) {
+				double sum = 0;
+				for (int y = 0; y < 8; y++)
+					for (int x = 0; x < 8; x++)
+						sum += (src[y * pitch + x] - 128) * cos((2 * x + 1) * u * M_PI / 16) * cos((2 * y + 1) * v * M_PI / 16);
+
+				coeffs[v * 8 + u] = scale(u) * scale(v) * sum / 4;
+			}
+		}
+	}
+
+	/** Zig-Zag index to natural order index. */
+	static int zigZag(int i) {
+		static const byte order[64] = {
+			 0,  1,  8, 16,  9,  2,  3, 10,
+			17, 24, 32, 25, 18, 11,  4,  5,
+			12, 19, 26, 33, 40, 48, 41, 34,
+			27, 20, 13,  6,  7, 14, 21, 28,
+			35, 42, 49, 56, 57, 50, 43, 36,
+			29, 22, 15, 23, 30, 37, 44, 51,
+			58, 59, 52, 45, 38, 31, 39, 46,
+			53, 60, 61, 54, 47, 55, 62, 63
+		};
+		return order[i];
+	}
+
+private:
+	enum {
+		kDCSymbols = 12,
+		kACSymbols = 162
+	};
+
+	Common::MemoryWriteStreamDynamic _out;
+	int _w, _h;
+	bool _subsample;
+
+	// The Huffman codes, indexed by symbol
+	uint16 _dcCode[256], _acCode[256];
+	byte _dcSize[256], _acSize[256];
+
+	// The Huffman table definitions
+	byte _dcBits[16], _acBits[16];
+	byte _dcValues[kDCSymbols], _acValues[kACSymbols];
+
+	// Entropy coder state
+	uint32 _bitBuffer;
+	int _bitCount;
+	int _predictor[3];
+
+	JPEGTestEncoder(int w, int h, bool subsample) : _out(DisposeAfterUse::NO), _w(w), _h(h), _subsample(subsample), _bitBuffer(0), _bitCount(0) {
+		// The usual luminance DC table
+		static const byte dcBits[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+		memcpy(_dcBits, dcBits, sizeof(_dcBits));
+		for (int i = 0; i < kDCSymbols; i++)
+			_dcValues[i] = i;
+
+		// The code lengths of the usual luminance AC table, which assigns
+		// 16 bits to 125 symbols. The symbols are ordered by the sum of the
+		// run length and the size, as a rough estimate of their frequency.
+		static const byte acBits[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 125 };
+		memcpy(_acBits, acBits, sizeof(_acBits));
+		int n = 0;
+		_acValues[n++] = 0x00;
+		for (int sum = 1; sum <= 25; sum++)
+			for (int run = 0; run < 16; run++)
+				if (sum - run >= 1 && sum - run <= 10)
+					_acValues[n++] = (run << 4) | (sum - run);
+		_acValues[n++] = 0xF0;
+
+		buildCodes(_dcBits, _dcValues, _dcCode, _dcSize);
+		buildCodes(_acBits, _acValues, _acCode, _acSize);
+	}
+
+	static double scale(int u) {
+		return u ? 1.0 : 1.0 / sqrt(2.0);
+	}
+
+	static void buildCodes(const byte *bits, const byte *values, uint16 *codes, byte *sizes) {
+		uint16 code = 0;
+		int cur = 0;
+		for (int len = 1; len <= 16; len++) {
+			for (int i = 0; i < bits[len - 1]; i++, cur++, code++) {
+				codes[values[cur]] = code;
+				sizes[values[cur]] = len;
+			}
+			code <<= 1;
+		}
+	}
+
+	void writeMarker(byte marker) {
+		_out.writeByte(0xFF);
+		_out.writeByte(marker);
+	}
+
+	void writeHuffmanTable(byte id, const byte *bits, const byte *values, int count) {
+		_out.write(&id, 1);
+		_out.write(bits, 16);
+		_out.write(values, count);
+	}
+
+	void writeHeaders() {
+		// Start Of Image
+		writeMarker(0xD8);
+
+		// Define Quantization Tables
+		writeMarker(0xDB);
+		_out.writeUint16BE(2 + 2 * 65);
+		for (int comp = 0; comp < 2; comp++) {
+			_out.writeByte(comp);
+			for (int i = 0; i < 64; i++)
+				_out.writeByte(quantizer(comp, zigZag(i) & 7, zigZag(i) >> 3));
+		}
+
+		// Start Of Frame
+		writeMarker(0xC0);
+		_out.writeUint16BE(8 + 3 * 3);
+		_out.writeByte(8);
+		_out.writeUint16BE(_h);
+		_out.writeUint16BE(_w);
+		_out.writeByte(3);
+		for (int comp = 0; comp < 3; comp++) {
+			_out.writeByte(comp + 1);
+			_out.writeByte(comp == 0 && _subsample ? 0x22 : 0x11);
+			_out.writeByte(comp ? 1 : 0);
+		}
+
+		// Define Huffman Tables
+		writeMarker(0xC4);
+		_out.writeUint16BE(2 + 17 + kDCSymbols + 17 + kACSymbols);
+		writeHuffmanTable(0x00, _dcBits, _dcValues, kDCSymbols);
+		writeHuffmanTable(0x10, _acBits, _acValues, kACSymbols);
+	}
+
+	void writeBits(uint32 bits, int count) {
+		for (int i = count - 1; i >= 0; i--) {
+			_bitBuffer = (_bitBuffer << 1) | ((bits >> i) & 1);
+			if (++_bitCount == 8) {
+				_out.writeByte(_bitBuffer);
+				if (_bitBuffer == 0xFF)
+					_out.writeByte(0);
+				_bitBuffer = 0;
+				_bitCount = 0;
+			}
+		}
+	}
+
+	void writeValue(int value, int size) {
+		if (value < 0)
+			value += (1 << size) - 1;
+		writeBits(value, size);
+	}
+
+	static int valueSize(int value) {
+		int size = 0;
+		for (value = ABS(value); value; value >>= 1)
+			size++;
+		return size;
+	}
+
+	void writeBlock(int comp, const byte *src, byte *decoded, int pitch) {
+		double coeffs[64];
+		referenceFDCT(coeffs, src, pitch);
+
+		int quantized[64];
+		for (int i = 0; i < 64; i++) {
+			const int index = zigZag(i);
+			quantized[i] = (int)floor(coeffs[index] / quantizer(comp, index & 7, index >> 3) + 0.5);
+		}
+
+		// Decode the block again
+		int dequantized[64];
+		for (int i = 0; i < 64; i++) {
+			const int index = zigZag(i);
+			dequantized[index] = quantized[i] * quantizer(comp, index & 7, index >> 3);
+		}
+		referenceIDCT(decoded, pitch, dequantized);
+
+		// DC difference
+		const int diff = quantized[0] - _predictor[comp];
+		_predictor[comp] = quantized[0];
+		const int dcSize = valueSize(diff);
+		writeBits(_dcCode[dcSize], _dcSize[dcSize]);
+		writeValue(diff, dcSize);
+
+		// AC run lengths
+		int run = 0;
+		for (int i = 1; i < 64; i++) {
+			if (!quantized[i]) {
+				run++;
+				continue;
+			}
+
+			for (; run >= 16; run -= 16)
+				writeBits(_acCode[0xF0], _acSize[0xF0]);
+
+			const int size = valueSize(quantized[i]);
+			const byte symbol = (run << 4) | size;
+			writeBits(_acCode[symbol], _acSize[symbol]);
+			writeValue(quantized[i], size);
+			run = 0;
+		}
+
+		if (run)
+			writeBits(_acCode[0x00], _acSize[0x00]);
+	}
+
+	void writeScan(const byte *const planes[3], byte *const decoded[3]) {
+		const int factor = _subsample ? 2 : 1;
+		const int mcuSize = 8 * factor;
+		const int mcusX = (_w + mcuSize - 1) / mcuSize;
+		const int mcusY = (_h + mcuSize - 1) / mcuSize;
+		const int paddedW = mcusX * mcuSize;
+		const int paddedH = mcusY * mcuSize;
+
+		// Pad the planes to whole MCUs by repeating the edges, then
+		// subsample the chroma planes
+		byte *padded[3], *paddedDecoded[3];
+		for (int comp = 0; comp < 3; comp++) {
+			padded[comp] = new byte[paddedW * paddedH];
+			paddedDecoded[comp] = new byte[paddedW * paddedH];
+			for (int y = 0; y < paddedH; y++)
+				for (int x = 0; x < paddedW; x++)
+					padded[comp][y * paddedW + x] = planes[comp][MIN(y, _h - 1) * _w + MIN(x, _w - 1)];
+
+			if (comp && _subsample) {
+				for (int y = 0; y < paddedH / 2; y++) {
+					for (int x = 0; x < paddedW / 2; x++) {
+						const byte *src = padded[comp] + 2 * y * paddedW + 2 * x;
+						padded[comp][y * paddedW + x] = (src[0] + src[1] + src[paddedW] + src[paddedW + 1] + 2) / 4;
+					}
+				}
+			}
+		}
+
+		// Start Of Scan
+		writeMarker(0xDA);
+		_out.writeUint16BE(6 + 2 * 3);
+		_out.writeByte(3);
+		for (int comp = 0; comp < 3; comp++) {
+			_out.writeByte(comp + 1);
+			_out.writeByte(0x00);
+		}
+		_out.writeByte(0);
+		_out.writeByte(63);
+		_out.writeByte(0);
+
+		_predictor[0] = _predictor[1] = _predictor[2] = 0;
+		for (int mcuY = 0; mcuY < mcusY; mcuY++) {
+			for (int mcuX = 0; mcuX < mcusX; mcuX++) {
+				for (int y = 0; y < factor; y++)
+					for (int x = 0; x < factor; x++)
+						writeBlock(0, padded[0] + (mcuY * mcuSize + y * 8) * paddedW + mcuX * mcuSize + x * 8, paddedDecoded[0] + (mcuY * mcuSize + y * 8) * paddedW + mcuX * mcuSize + x * 8, paddedW);
+
+				for (int comp = 1; comp < 3; comp++)
+					writeBlock(comp, padded[comp] + mcuY * 8 * paddedW + mcuX * 8, paddedDecoded[comp] + mcuY * 8 * paddedW + mcuX * 8, paddedW);
+			}
+		}
+
+		// Pad the last byte with ones
+		if (_bitCount)
+			writeBits(0xFF, 8 - _bitCount);
+
+		// Upsample the decoded chroma planes by repeating the samples
+		for (int comp = 0; decoded && comp < 3; comp++) {
+			const int shift = comp && _subsample ? 1 : 0;
+			for (int y = 0; y < _h; y++)
+				for (int x = 0; x < _w; x++)
+					decoded[comp][y * _w + x] = paddedDecoded[comp][(y >> shift) * paddedW + (x >> shift)];
+		}
+
+		for (int comp = 0; comp < 3; comp++) {
+			delete[] padded[comp];
+			delete[] paddedDecoded[comp];
+		}
+	}
+};
+
+#endif
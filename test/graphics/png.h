@@ -0,0 +1,228 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "graphics/pixelformat.h"
+#include "graphics/png.h"
+#include "graphics/png_filters.h"
+#include "graphics/surface.h"
+
+#include "png_helper.h"
+
+class PNGTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 37,
+		kHeight = 23
+	};
+
+	uint32 _seed;
+
+	byte nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	byte *randomData(uint32 size) {
+		byte *data = new byte[size];
+		for (uint32 i = 0; i < size; i++)
+			data[i] = nextRandom();
+		return data;
+	}
+
+	/** The color the decoder should produce for a pixel of the image. */
+	static uint32 expectedColor(const PNGTestImage &image, uint32 x, uint32 y, const Graphics::PixelFormat &format) {
+		const byte *row = image.data + y * image.scanLineWidth();
+		const byte *p = row + x * image.channels() * image.bitDepth / 8;
+
+		byte sample = row[x];
+		if (image.bitDepth < 8) {
+			const uint32 bit = x * image.bitDepth;
+			sample = (row[bit / 8] >> (8 - image.bitDepth - bit % 8)) & ((1 << image.bitDepth) - 1);
+		}
+
+		switch (image.colorType) {
+		case 0: {
+			const byte gray = sample * 255 / ((1 << image.bitDepth) - 1);
+			const bool transparent = image.transparency && READ_BE_UINT16(image.transparency) == sample;
+			return format.ARGBToColor(transparent ? 0 : 0xFF, gray, gray, gray);
+		}
+		case 2: {
+			const bool transparent = image.transparency && READ_BE_UINT16(image.transparency) == p[0] &&
+				READ_BE_UINT16(image.transparency + 2) == p[1] && READ_BE_UINT16(image.transparency + 4) == p[2];
+			return format.ARGBToColor(transparent ? 0 : 0xFF, p[0], p[1], p[2]);
+		}
+		case 3: {
+			const byte *color = image.palette + sample * 3;
+			const byte a = sample < image.transparencySize ? image.transparency[sample] : 0xFF;
+			return format.ARGBToColor(a, color[0], color[1], color[2]);
+		}
+		case 4:
+			return format.ARGBToColor(p[1], p[0], p[0], p[0]);
+		default:
+			return format.ARGBToColor(p[3], p[0], p[1], p[2]);
+		}
+	}
+
+	void checkSurface(const PNGTestImage &image, const Graphics::PixelFormat &format) {
+		Common::SeekableReadStream *stream = PNGTestEncoder::encode(image);
+
+		Graphics::PNG png;
+		TS_ASSERT(png.read(stream));
+
+		Graphics::Surface *surface = png.getSurface(format);
+		TS_ASSERT(surface);
+		TS_ASSERT_EQUALS(surface->w, (int)image.width);
+		TS_ASSERT_EQUALS(surface->h, (int)image.height);
+
+		uint32 errors = 0;
+		for (uint32 y = 0; y < image.height; y++) {
+			for (uint32 x = 0; x < image.width; x++) {
+				const byte *pixel = (const byte *)surface->getBasePtr(x, y);
+				const uint32 color = format.bytesPerPixel == 2 ? *(const uint16 *)pixel : *(const uint32 *)pixel;
+				if (color != expectedColor(image, x, y, format))
+					errors++;
+			}
+		}
+		TS_ASSERT_EQUALS(errors, 0u);
+
+		surface->free();
+		delete surface;
+	}
+
+	/** Decode the image to a 16 and a 32 bit format, with and without SIMD. */
+	void checkImage(const PNGTestImage &image) {
+		static const uint32 masks[2] = { 0, 0xFFFFFFFF };
+		for (int i = 0; i < 2; i++) {
+			Common::setCPUFeatureMask(masks[i]);
+			checkSurface(image, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+			checkSurface(image, Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24));
+			checkSurface(image, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+		}
+	}
+
+	void checkKernel(void (*expected)(byte *, const byte *, uint32, uint), void (*kernel)(byte *, const byte *, uint32, uint), uint bpp, uint32 length) {
+		enum { kPadding = Graphics::kPNGRowPadding, kSlack = Graphics::kPNGRowSlack };
+		byte prevRow[kPadding + 100 + kSlack], row[kPadding + 100 + kSlack], result[kPadding + 100 + kSlack];
+
+		for (uint32 i = 0; i < sizeof(row); i++) {
+			prevRow[i] = i < kPadding ? 0 : nextRandom();
+			row[i] = i < kPadding ? 0 : nextRandom();
+		}
+		memcpy(result, row, sizeof(row));
+
+		expected(row + kPadding, prevRow + kPadding, length, bpp);
+		kernel(result + kPadding, prevRow + kPadding, length, bpp);
+		TS_ASSERT_EQUALS(memcmp(row, result, sizeof(row)), 0);
+	}
+
+public:
+	void setUp() {
+		_seed = 0x9E37;
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+	}
+
+	void test_filter_kernels_sse2() {
+		const Graphics::PNGFilterKernels *sse2 = Graphics::getPNGFilterKernels(Common::kCPUFeatureSSE2);
+		if (!sse2)
+			return;
+
+		const Graphics::PNGFilterKernels &scalar = Graphics::getScalarPNGFilterKernels();
+		for (uint bpp = 1; bpp <= 4; bpp++) {
+			for (uint32 pixels = 1; pixels * bpp <= 100; pixels += 3) {
+				const uint32 length = pixels * bpp;
+				checkKernel(scalar.unfilterSub, sse2->unfilterSub, bpp, length);
+				checkKernel(scalar.unfilterUp, sse2->unfilterUp, bpp, length);
+				checkKernel(scalar.unfilterAverage, sse2->unfilterAverage, bpp, length);
+				checkKernel(scalar.unfilterPaeth, sse2->unfilterPaeth, bpp, length);
+			}
+		}
+	}
+
+	void test_truecolor() {
+		byte *data = randomData(kWidth * kHeight * 4);
+
+		checkImage(PNGTestImage(kWidth, kHeight, 6, 8, data));
+		checkImage(PNGTestImage(kWidth, kHeight, 2, 8, data));
+
+		// Make the color of the first pixel transparent
+		PNGTestImage image(kWidth, kHeight, 2, 8, data);
+		const byte transparency[6] = { 0, data[0], 0, data[1], 0, data[2] };
+		image.transparency = transparency;
+		image.transparencySize = 6;
+		checkImage(image);
+
+		delete[] data;
+	}
+
+	void test_grayscale() {
+		byte *data = randomData(kWidth * kHeight * 2);
+
+		checkImage(PNGTestImage(kWidth, kHeight, 4, 8, data));
+
+		const byte transparency[2] = { 0, 3 };
+		for (int depth = 1; depth <= 8; depth *= 2) {
+			PNGTestImage image(kWidth, kHeight, 0, depth, data);
+			checkImage(image);
+			image.transparency = transparency;
+			image.transparencySize = 2;
+			checkImage(image);
+		}
+
+		delete[] data;
+	}
+
+	void test_indexed() {
+		byte *data = randomData(kWidth * kHeight);
+		byte *palette = randomData(256 * 3);
+		byte *transparency = randomData(100);
+
+		for (int depth = 1; depth <= 8; depth *= 2) {
+			PNGTestImage image(kWidth, kHeight, 3, depth, data);
+			image.palette = palette;
+			image.paletteEntries = 1 << depth;
+			image.transparency = transparency;
+			image.transparencySize = MIN(100, 1 << depth);
+			checkImage(image);
+
+			// The indexed surface has the unfiltered data as is
+			Common::SeekableReadStream *stream = PNGTestEncoder::encode(image);
+			Graphics::PNG png;
+			TS_ASSERT(png.read(stream));
+
+			const Graphics::Surface *surface = png.getIndexedSurface();
+			for (int y = 0; y < kHeight; y++)
+				TS_ASSERT_EQUALS(memcmp(surface->getBasePtr(0, y), data + y * image.scanLineWidth(), image.scanLineWidth()), 0);
+		}
+
+		delete[] data;
+		delete[] palette;
+		delete[] transparency;
+	}
+
+	void test_idat_chunks() {
+		byte *data = randomData(kWidth * kHeight * 4);
+		PNGTestImage image(kWidth, kHeight, 6, 8, data);
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 16, 8, 0, 24);
+
+		// From one byte per IDAT chunk to a single chunk
+		static const uint32 chunkSizes[3] = { 1, 77, 100000 };
+		for (int i = 0; i < 3; i++) {
+			Graphics::PNG png;
+			TS_ASSERT(png.read(PNGTestEncoder::encode(image, chunkSizes[i])));
+
+			// The image can be requested more than once
+			for (int j = 0; j < 2; j++) {
+				Graphics::Surface *surface = png.getSurface(format);
+				TS_ASSERT_EQUALS(*(const uint32 *)surface->getBasePtr(kWidth - 1, kHeight - 1), expectedColor(image, kWidth - 1, kHeight - 1, format));
+				surface->free();
+				delete surface;
+			}
+		}
+
+		delete[] data;
+	}
+};
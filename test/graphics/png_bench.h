@@ -0,0 +1,77 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "graphics/pixelformat.h"
+#include "graphics/png.h"
+#include "graphics/surface.h"
+
+#include "png_helper.h"
+#include "../benchmark.h"
+
+class PNGBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 640,
+		kHeight = 480,
+		kIterations = 20
+	};
+
+	byte *_data;
+
+	void benchDecode(const char *name, const char *kernelName, byte colorType) {
+		const PNGTestImage image(kWidth, kHeight, colorType, 8, _data);
+		Common::SeekableReadStream *stream = PNGTestEncoder::encode(image, 8192);
+		const uint32 size = stream->size();
+		byte *file = new byte[size];
+		stream->read(file, size);
+		delete stream;
+
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 16, 8, 0, 24);
+
+		BenchmarkTimer timer;
+		for (int i = 0; i < kIterations; ++i) {
+			Graphics::PNG png;
+			png.read(new Common::MemoryReadStream(file, size));
+			Graphics::Surface *surface = png.getSurface(format);
+			surface->free();
+			delete surface;
+		}
+		reportBenchmark(Common::String::format("%s PNG %s to ARGB8888", kernelName, name).c_str(), (uint32)kWidth * kHeight * kIterations, timer.elapsedMicros(), "pixels");
+
+		delete[] file;
+	}
+
+	void benchFormats(const char *kernelName, uint32 featureMask) {
+		Common::setCPUFeatureMask(featureMask);
+
+		benchDecode("RGB", kernelName, 2);
+		benchDecode("RGBA", kernelName, 6);
+	}
+
+public:
+	void setUp() {
+		// Gradients with some noise, like in photographs
+		_data = new byte[kWidth * kHeight * 4];
+		uint32 seed = 1;
+		for (int y = 0; y < kHeight; y++) {
+			for (int x = 0; x < kWidth * 4; x++) {
+				seed = seed * 1103515245 + 12345;
+				_data[y * kWidth * 4 + x] = (x / 4 + y + (x & 3) * 64) / 2 + ((seed >> 16) & 7);
+			}
+		}
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		delete[] _data;
+	}
+
+	void test_png() {
+		const bool hasSSE2 = Common::hasCPUFeature(Common::kCPUFeatureSSE2);
+
+		benchFormats("C++", 0);
+		if (hasSSE2)
+			benchFormats("SSE2", Common::kCPUFeatureSSE2);
+	}
+};
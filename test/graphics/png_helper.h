@@ -0,0 +1,178 @@
+#ifndef TEST_GRAPHICS_PNG_HELPER_H
+#define TEST_GRAPHICS_PNG_HELPER_H
+
+#include "common/endian.h"
+#include "common/memstream.h"
+#include "common/stream.h"
+#include "common/util.h"
+
+/**
+ * The contents of a PNG image to encode. The scan lines are packed like in
+ * the PNG data, but not filtered.
+ */
+struct PNGTestImage {
+	uint32 width, height;
+	byte colorType, bitDepth;
+	const byte *data;
+
+	const byte *palette;			///< RGB triplets, for indexed images
+	uint paletteEntries;
+	const byte *transparency;		///< The contents of the tRNS chunk
+	uint transparencySize;
+
+	PNGTestImage(uint32 w, uint32 h, byte type, byte depth, const byte *d) :
+		width(w), height(h), colorType(type), bitDepth(depth), data(d),
+		palette(0), paletteEntries(0), transparency(0), transparencySize(0) {
+	}
+
+	uint channels() const {
+		static const byte channelCount[7] = { 1, 0, 3, 1, 2, 0, 4 };
+		return channelCount[colorType];
+	}
+
+	uint32 scanLineWidth() const {
+		return (width * channels() * bitDepth + 7) / 8;
+	}
+};
+
+/**
+ * A minimal PNG encoder, used to produce test images for the decoder
+ * without shipping binary files. It applies the filters to the rows in
+ * turn, and stores the data without compression, split into several IDAT
+ * chunks.
+ */
+class PNGTestEncoder {
+public:
+	static Common::SeekableReadStream *encode(const PNGTestImage &image, uint32 idatSize = 1000) {
+		PNGTestEncoder encoder;
+
+		static const byte signature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+		encoder._out.write(signature, 8);
+
+		byte header[13];
+		WRITE_BE_UINT32(header, image.width);
+		WRITE_BE_UINT32(header + 4, image.height);
+		header[8] = image.bitDepth;
+		header[9] = image.colorType;
+		header[10] = header[11] = header[12] = 0;
+		encoder.writeChunk(MKTAG('I','H','D','R'), header, 13);
+
+		if (image.palette)
+			encoder.writeChunk(MKTAG('P','L','T','E'), image.palette, image.paletteEntries * 3);
+		if (image.transparency)
+			encoder.writeChunk(MKTAG('t','R','N','S'), image.transparency, image.transparencySize);
+
+		// An ancillary chunk, which the decoder has to skip
+		encoder.writeChunk(MKTAG('t','E','X','t'), (const byte *)"Title\0Test", 10);
+
+		uint32 size;
+		byte *data = deflateStored(filter(image), image.height * (image.scanLineWidth() + 1), size);
+		for (uint32 pos = 0; pos < size; pos += idatSize)
+			encoder.writeChunk(MKTAG('I','D','A','T'), data + pos, MIN(idatSize, size - pos));
+		delete[] data;
+
+		encoder.writeChunk(MKTAG('I','E','N','D'), 0, 0);
+
+		uint32 fileSize = encoder._out.size();
+		return new Common::MemoryReadStream(encoder._out.getData(), fileSize, DisposeAfterUse::YES);
+	}
+
+private:
+	Common::MemoryWriteStreamDynamic _out;
+
+	PNGTestEncoder() : _out(DisposeAfterUse::NO) {}
+
+	static uint32 crc32(uint32 crc, const byte *data, uint32 size) {
+		for (uint32 i = 0; i < size; i++) {
+			crc ^= data[i];
+			for (int bit = 0; bit < 8; bit++)
+				crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+		}
+		return crc;
+	}
+
+	void writeChunk(uint32 type, const byte *data, uint32 size) {
+		byte typeBytes[4];
+		WRITE_BE_UINT32(typeBytes, type);
+
+		_out.writeUint32BE(size);
+		_out.write(typeBytes, 4);
+		if (size)
+			_out.write(data, size);
+		_out.writeUint32BE(crc32(crc32(0xFFFFFFFF, typeBytes, 4), data, size) ^ 0xFFFFFFFF);
+	}
+
+	static int paeth(int a, int b, int c) {
+		const int p = a + b - c;
+		const int pa = ABS(p - a), pb = ABS(p - b), pc = ABS(p - c);
+		if (pa <= pb && pa <= pc)
+			return a;
+		return pb <= pc ? b : c;
+	}
+
+	/** Prepend each row with its filter type, and apply the filter. */
+	static byte *filter(const PNGTestImage &image) {
+		const uint32 width = image.scanLineWidth();
+		const uint bpp = MAX<uint>(1, image.channels() * image.bitDepth / 8);
+		byte *filtered = new byte[image.height * (width + 1)];
+
+		for (uint32 y = 0; y < image.height; y++) {
+			const byte *row = image.data + y * width;
+			const byte *prevRow = y ? row - width : 0;
+			byte *dst = filtered + y * (width + 1);
+			const byte filterType = (y * 3) % 5;
+
+			*dst++ = filterType;
+			for (uint32 i = 0; i < width; i++) {
+				const int a = i >= bpp ? row[i - bpp] : 0;
+				const int b = prevRow ? prevRow[i] : 0;
+				const int c = (prevRow && i >= bpp) ? prevRow[i - bpp] : 0;
+
+				int predictor = 0;
+				switch (filterType) {
+				case 1: predictor = a; break;
+				case 2: predictor = b; break;
+				case 3: predictor = (a + b) >> 1; break;
+				case 4: predictor = paeth(a, b, c); break;
+				}
+				dst[i] = row[i] - predictor;
+			}
+		}
+
+		return filtered;
+	}
+
+	/** Wrap the data into a zlib stream of uncompressed deflate blocks. */
+	static byte *deflateStored(byte *data, uint32 size, uint32 &outSize) {
+		const uint32 blocks = MAX<uint32>(1, (size + 65534) / 65535);
+		byte *out = new byte[2 + blocks * 5 + size + 4];
+		byte *dst = out;
+
+		*dst++ = 0x78;
+		*dst++ = 0x01;
+
+		uint32 s1 = 1, s2 = 0;
+		for (uint32 i = 0; i < size; i++) {
+			s1 = (s1 + data[i]) % 65521;
+			s2 = (s2 + s1) % 65521;
+		}
+
+		for (uint32 pos = 0, block = 0; block < blocks; block++) {
+			const uint16 length = MIN<uint32>(65535, size - pos);
+			*dst++ = (block == blocks - 1) ? 1 : 0;
+			WRITE_LE_UINT16(dst, length);
+			WRITE_LE_UINT16(dst + 2, (uint16)~length);
+			memcpy(dst + 4, data + pos, length);
+			dst += 4 + length;
+			pos += length;
+		}
+
+		WRITE_BE_UINT32(dst, (s2 << 16) | s1);
+		outSize = dst + 4 - out;
+
+		delete[] data;
+		return out;
+	}
+};
+
+#endif
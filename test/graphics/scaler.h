@@ -0,0 +1,261 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "common/rect.h"
+#include "graphics/scaler.h"
+#include "graphics/scaler/aspect.h"
+#include "graphics/scaler/kernels.h"
+
+class ScalerTestSuite : public CxxTest::TestSuite
+{
+#ifdef USE_SCALERS
+private:
+	enum {
+		// The source image includes a border of two pixels, which the
+		// scalers read from.
+		kWidth = 100,
+		kHeight = 12,
+		kPitch = kWidth + 4,
+
+		// The screen used to compare banded and unbanded scaling. Its
+		// height is a multiple of 5 for the aspect ratio correction.
+		kScreenWidth = 48,
+		kScreenHeight = 60,
+		kScreenPitch = kScreenWidth + 4,
+		kDstWidth = 3 * kScreenWidth,
+		kDstHeight = 3 * kScreenHeight * 6 / 5
+	};
+
+	uint32 _seed;
+	uint16 _src[(kHeight + 4) * kPitch];
+	uint16 _expected[3 * kHeight * 3 * kWidth];
+	uint16 _result[3 * kHeight * 3 * kWidth];
+
+	uint16 _screen[(kScreenHeight + 4) * kScreenPitch];
+	uint16 _unbanded[kDstHeight * kDstWidth];
+	uint16 _banded[kDstHeight * kDstWidth];
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	/**
+	 * Fill the source with pixels from a small palette, so that the edge
+	 * detection of the scalers sees lots of equal neighbours. With
+	 * noiseBits set, the colors also get small random differences, which
+	 * exercises the thresholds of the HQ scalers.
+	 */
+	void fillSource(int paletteSize, uint16 noiseBits) {
+		uint16 palette[8];
+		for (int i = 0; i < paletteSize; ++i)
+			palette[i] = (uint16)nextRandom();
+
+		for (int i = 0; i < ARRAYSIZE(_src); ++i)
+			_src[i] = palette[nextRandom() % paletteSize] ^ (nextRandom() & noiseBits);
+	}
+
+	const uint16 *sourceRow(int y) const {
+		return _src + (y + 2) * kPitch + 2;
+	}
+
+	void compareKernels(const ScalerKernels &kernels, int bitFormat) {
+		const ScalerKernels &reference = getScalarScalerKernels();
+		// Odd lengths exercise the scalar tails of the SIMD loops
+		const uint lengths[] = { 1, 7, 8, 9, 15, 16, 17, 33, kWidth };
+
+		for (int fill = 0; fill < 4; ++fill) {
+			if (fill == 3)
+				fillSource(1, 0xFFFF);
+			else
+				fillSource(2 + 3 * fill, fill ? 0x0821 : 0);
+
+			for (int l = 0; l < ARRAYSIZE(lengths); ++l) {
+				const uint len = lengths[l];
+
+				for (int y = 0; y < kHeight; ++y) {
+					const uint16 *src0 = sourceRow(y - 1), *src1 = sourceRow(y), *src2 = sourceRow(y + 1);
+
+					memset(_expected, 0, sizeof(_expected));
+					memset(_result, 0, sizeof(_result));
+					reference.scale2x(_expected, _expected + 2 * len, src0, src1, src2, len);
+					kernels.scale2x(_result, _result + 2 * len, src0, src1, src2, len);
+					TS_ASSERT_EQUALS(memcmp(_expected, _result, 4 * len * sizeof(uint16)), 0);
+
+					reference.scale3x(_expected, _expected + 3 * len, _expected + 6 * len, src0, src1, src2, len);
+					kernels.scale3x(_result, _result + 3 * len, _result + 6 * len, src0, src1, src2, len);
+					TS_ASSERT_EQUALS(memcmp(_expected, _result, 9 * len * sizeof(uint16)), 0);
+
+					reference.scale2xSaI(_expected, _expected + 2 * len, src1, kPitch, len, bitFormat);
+					kernels.scale2xSaI(_result, _result + 2 * len, src1, kPitch, len, bitFormat);
+					TS_ASSERT_EQUALS(memcmp(_expected, _result, 4 * len * sizeof(uint16)), 0);
+
+#if defined(USE_HQ_SCALERS) && !defined(USE_NASM)
+					reference.hqxPatterns((uint8 *)_expected, src1, kPitch, len, bitFormat);
+					kernels.hqxPatterns((uint8 *)_result, src1, kPitch, len, bitFormat);
+					TS_ASSERT_EQUALS(memcmp(_expected, _result, len), 0);
+#endif
+				}
+			}
+		}
+	}
+
+	void compareKernels(Common::CPUFeature feature, const ScalerKernels &kernels) {
+		if (!Common::hasCPUFeature(feature))
+			return;
+
+		// The YUV table used by the C++ code depends on the format.
+		InitScalers(565);
+		compareKernels(kernels, 565);
+		InitScalers(555);
+		compareKernels(kernels, 555);
+	}
+
+	void compareScaler(ScalerProc *scaler, int factor) {
+		fillSource(4, 0x0821);
+
+		const uint8 *src = (const uint8 *)sourceRow(0);
+		const uint32 srcPitch = kPitch * sizeof(uint16);
+		const uint32 dstPitch = factor * kWidth * sizeof(uint16);
+
+		Common::setCPUFeatureMask(0);
+		InitScalers(565);
+		memset(_expected, 0, sizeof(_expected));
+		scaler(src, srcPitch, (uint8 *)_expected, dstPitch, kWidth, kHeight);
+
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		InitScalers(565);
+		memset(_result, 0, sizeof(_result));
+		scaler(src, srcPitch, (uint8 *)_result, dstPitch, kWidth, kHeight);
+
+		TS_ASSERT_EQUALS(memcmp(_expected, _result, sizeof(_expected)), 0);
+	}
+
+	/**
+	 * Scale a set of dirty rects from _screen to dst the way the SDL
+	 * backend does, splitting each rect into bands for at most numBands
+	 * threads. The bands are scaled last to first, so a band depending on
+	 * the output of another one shows up as a difference.
+	 */
+	void scaleRects(ScalerProc *scaler, int factor, bool aspect, int numBands, uint16 *dst) {
+		static const Common::Rect rects[] = {
+			Common::Rect(0, 0, kScreenWidth, kScreenHeight),
+			Common::Rect(5, 7, 25, 48),
+			Common::Rect(30, 20, 41, 53),
+			Common::Rect(1, 49, 47, 60),
+			Common::Rect(12, 13, 20, 16)
+		};
+
+		const uint32 srcPitch = kScreenPitch * sizeof(uint16);
+		const uint32 dstPitch = kDstWidth * sizeof(uint16);
+
+		memset(dst, 0, kDstHeight * dstPitch);
+
+		for (int i = 0; i < ARRAYSIZE(rects); ++i) {
+			int x = rects[i].left, y = rects[i].top;
+			int w = rects[i].width(), h = rects[i].height();
+			if (aspect)
+				makeRectStretchable(x, y, w, h);
+
+			int dstY = y * factor;
+			if (aspect)
+				dstY = real2Aspect(dstY);
+
+			const uint8 *src = (const uint8 *)(_screen + (y + 2) * kScreenPitch + x + 2);
+			uint8 *dstRect = (uint8 *)(dst + dstY * kDstWidth + x * factor);
+			const int bandHeight = getScalerBandHeight(h, numBands);
+
+			for (int bandY = (h - 1) / bandHeight * bandHeight; bandY >= 0; bandY -= bandHeight) {
+				scaler(src + bandY * srcPitch, srcPitch, dstRect + bandY * factor * dstPitch, dstPitch,
+					w, MIN(bandHeight, h - bandY));
+			}
+
+			if (aspect)
+				stretch200To240((uint8 *)dst, dstPitch, w * factor, h * factor, x * factor, dstY, y * factor);
+		}
+	}
+
+	void compareBanding(ScalerProc *scaler, int factor) {
+		for (int bitFormat = 555; bitFormat <= 565; bitFormat += 10) {
+			InitScalers(bitFormat);
+			for (int i = 0; i < ARRAYSIZE(_screen); ++i)
+				_screen[i] = (uint16)nextRandom() & (nextRandom() % 3 ? 0xF7DE : 0xFFFF);
+
+			for (int aspect = 0; aspect < 2; ++aspect) {
+				scaleRects(scaler, factor, aspect != 0, 1, _unbanded);
+				for (int numBands = 2; numBands <= 5; ++numBands) {
+					scaleRects(scaler, factor, aspect != 0, numBands, _banded);
+					TS_ASSERT_EQUALS(memcmp(_unbanded, _banded, sizeof(_banded)), 0);
+				}
+			}
+		}
+	}
+
+public:
+	void setUp() {
+		_seed = 0x5CBB;
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		DestroyScalers();
+	}
+#endif
+
+	void test_sse2() {
+#if defined(USE_SCALERS) && defined(USE_X86_SIMD)
+		compareKernels(Common::kCPUFeatureSSE2, g_scalerKernelsSSE2);
+#endif
+	}
+
+	void test_ssse3() {
+#if defined(USE_SCALERS) && defined(USE_X86_SIMD)
+		compareKernels(Common::kCPUFeatureSSSE3, g_scalerKernelsSSSE3);
+#endif
+	}
+
+	void test_avx2() {
+#if defined(USE_SCALERS) && defined(USE_X86_SIMD)
+		compareKernels(Common::kCPUFeatureAVX2, g_scalerKernelsAVX2);
+#endif
+	}
+
+	void test_scalers() {
+#ifdef USE_SCALERS
+		compareScaler(AdvMame2x, 2);
+		compareScaler(AdvMame3x, 3);
+		compareScaler(_2xSaI, 2);
+#ifdef USE_HQ_SCALERS
+		compareScaler(HQ2x, 2);
+		compareScaler(HQ3x, 3);
+#endif
+#endif
+	}
+
+	void test_band_height() {
+		TS_ASSERT_EQUALS(getScalerBandHeight(200, 1), 200);
+		TS_ASSERT_EQUALS(getScalerBandHeight(200, 4), 50);
+		TS_ASSERT_EQUALS(getScalerBandHeight(200, 3), 68);
+		TS_ASSERT_EQUALS(getScalerBandHeight(20, 4), (int)kMinScalerBandHeight);
+		TS_ASSERT_EQUALS(getScalerBandHeight(7, 2), (int)kMinScalerBandHeight);
+	}
+
+	void test_banding() {
+#ifdef USE_SCALERS
+		compareBanding(Normal1x, 1);
+		compareBanding(Normal2x, 2);
+		compareBanding(Normal3x, 3);
+		compareBanding(_2xSaI, 2);
+		compareBanding(Super2xSaI, 2);
+		compareBanding(SuperEagle, 2);
+		compareBanding(AdvMame2x, 2);
+		compareBanding(AdvMame3x, 3);
+		compareBanding(TV2x, 2);
+		compareBanding(DotMatrix, 2);
+#ifdef USE_HQ_SCALERS
+		compareBanding(HQ2x, 2);
+		compareBanding(HQ3x, 3);
+#endif
+#endif
+	}
+};
@@ -0,0 +1,83 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "common/util.h"
+#include "graphics/scaler.h"
+
+#include "../benchmark.h"
+
+class ScalerBenchmarkSuite : public CxxTest::TestSuite
+{
+#ifdef USE_SCALERS
+private:
+	enum {
+		kWidth = 320,
+		kHeight = 200,
+		kPitch = kWidth + 4,
+		kIterations = 200
+	};
+
+	uint16 _src[(kHeight + 4) * kPitch];
+	uint16 _dst[3 * kHeight * 3 * kWidth];
+
+	void benchScaler(const char *name, const char *kernelName, ScalerProc *scaler, int factor) {
+		const uint8 *src = (const uint8 *)(_src + 2 * kPitch + 2);
+		const uint32 srcPitch = kPitch * sizeof(uint16);
+		const uint32 dstPitch = factor * kWidth * sizeof(uint16);
+
+		BenchmarkTimer timer;
+		for (int i = 0; i < kIterations; ++i)
+			scaler(src, srcPitch, (uint8 *)_dst, dstPitch, kWidth, kHeight);
+		reportBenchmark(Common::String::format("%s %s", kernelName, name).c_str(), (uint32)kWidth * kHeight * kIterations, timer.elapsedMicros(), "pixels");
+	}
+
+	void benchScalers(const char *kernelName, uint32 featureMask) {
+		Common::setCPUFeatureMask(featureMask);
+		InitScalers(565);
+
+		benchScaler("AdvMame2x", kernelName, AdvMame2x, 2);
+		benchScaler("AdvMame3x", kernelName, AdvMame3x, 3);
+		benchScaler("2xSaI", kernelName, _2xSaI, 2);
+#ifdef USE_HQ_SCALERS
+		benchScaler("HQ2x", kernelName, HQ2x, 2);
+		benchScaler("HQ3x", kernelName, HQ3x, 3);
+#endif
+	}
+
+public:
+	void setUp() {
+		// Game graphics: runs of a few colors with some dithering, so that
+		// the edge detection of the scalers has something to do.
+		const uint16 palette[] = { 0x0000, 0x18E3, 0x7BEF, 0xF800, 0xFFE0, 0x07FF, 0x8410, 0xFFFF };
+		uint32 seed = 1;
+		for (int i = 0; i < ARRAYSIZE(_src); ++i) {
+			seed = seed * 1103515245 + 12345;
+			if ((seed >> 16) % 4 == 0)
+				_src[i] = palette[(seed >> 20) % ARRAYSIZE(palette)];
+			else
+				_src[i] = i ? _src[i - 1] : 0;
+		}
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		DestroyScalers();
+	}
+#endif
+
+	void test_scalers() {
+#ifdef USE_SCALERS
+		const bool hasSSE2 = Common::hasCPUFeature(Common::kCPUFeatureSSE2);
+		const bool hasSSSE3 = Common::hasCPUFeature(Common::kCPUFeatureSSSE3);
+		const bool hasAVX2 = Common::hasCPUFeature(Common::kCPUFeatureAVX2);
+
+		benchScalers("C++", 0);
+		if (hasSSE2)
+			benchScalers("SSE2", Common::kCPUFeatureSSE2);
+		if (hasSSSE3)
+			benchScalers("SSSE3", Common::kCPUFeatureSSE2 | Common::kCPUFeatureSSSE3);
+		if (hasAVX2)
+			benchScalers("AVX2", 0xFFFFFFFF);
+#endif
+	}
+};
@@ -0,0 +1,91 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_kernels.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		// Every chroma value pairs with every other one; the extra pixels
+		// exercise the C++ tails of the SIMD loops.
+		kWidth = 2 * 256 + 6,
+		kHeight = 2 * 256,
+		kYPitch = kWidth + 10,
+		kUVPitch = kWidth / 2 + 3
+	};
+
+	byte *_y, *_u, *_v;
+
+	void compareKernels(Common::CPUFeature feature, const Graphics::PixelFormat &format) {
+		const Graphics::YUVToRGBKernels *kernels = Graphics::getYUVToRGBKernels(feature);
+		if (!kernels)
+			return;
+
+		Graphics::Surface expected, result;
+		expected.create(kWidth, kHeight, format);
+		result.create(kWidth, kHeight, format);
+
+		// Without SIMD kernels, the lookup tables are used
+		Common::setCPUFeatureMask(0);
+		Graphics::convertYUV420ToRGB(&expected, _y, _u, _v, kWidth, kHeight, kYPitch, kUVPitch);
+
+		Common::setCPUFeatureMask(feature);
+		TS_ASSERT_EQUALS(Graphics::getYUVToRGBKernels(), kernels);
+		Graphics::convertYUV420ToRGB(&result, _y, _u, _v, kWidth, kHeight, kYPitch, kUVPitch);
+
+		TS_ASSERT_EQUALS(memcmp(expected.pixels, result.pixels, kHeight * expected.pitch), 0);
+
+		expected.free();
+		result.free();
+	}
+
+	void compareKernels(Common::CPUFeature feature) {
+		compareKernels(feature, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		compareKernels(feature, Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0));
+		compareKernels(feature, Graphics::PixelFormat(2, 4, 4, 4, 4, 8, 4, 0, 12));
+		compareKernels(feature, Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24));
+		compareKernels(feature, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+		compareKernels(feature, Graphics::PixelFormat(4, 8, 8, 8, 0, 0, 8, 16, 0));
+	}
+
+public:
+	void setUp() {
+		_y = new byte[kHeight * kYPitch];
+		_u = new byte[kHeight / 2 * kUVPitch];
+		_v = new byte[kHeight / 2 * kUVPitch];
+
+		uint32 seed = 0xB1A5;
+		for (int i = 0; i < kHeight * kYPitch; ++i) {
+			seed = seed * 1103515245 + 12345;
+			_y[i] = seed >> 16;
+		}
+		for (int y = 0; y < kHeight / 2; ++y) {
+			for (int x = 0; x < kUVPitch; ++x) {
+				_u[y * kUVPitch + x] = x;
+				_v[y * kUVPitch + x] = y;
+			}
+		}
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		delete[] _y;
+		delete[] _u;
+		delete[] _v;
+	}
+
+	void test_sse2() {
+		compareKernels(Common::kCPUFeatureSSE2);
+	}
+
+	void test_avx2() {
+		compareKernels(Common::kCPUFeatureAVX2);
+	}
+
+	void test_neon() {
+		compareKernels(Common::kCPUFeatureNEON);
+	}
+};
@@ -0,0 +1,75 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+#include "../benchmark.h"
+
+class YUVToRGBBenchmarkSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 640,
+		kHeight = 480,
+		kIterations = 200
+	};
+
+	byte _y[kWidth * kHeight];
+	byte _u[kWidth * kHeight / 4];
+	byte _v[kWidth * kHeight / 4];
+
+	void benchFormat(const char *name, const char *kernelName, const Graphics::PixelFormat &format) {
+		Graphics::Surface surface;
+		surface.create(kWidth, kHeight, format);
+
+		// Build the lookup tables outside of the timed loop
+		Graphics::convertYUV420ToRGB(&surface, _y, _u, _v, kWidth, kHeight, kWidth, kWidth / 2);
+
+		BenchmarkTimer timer;
+		for (int i = 0; i < kIterations; ++i)
+			Graphics::convertYUV420ToRGB(&surface, _y, _u, _v, kWidth, kHeight, kWidth, kWidth / 2);
+		reportBenchmark(Common::String::format("%s YUV420 to %s", kernelName, name).c_str(), (uint32)kWidth * kHeight * kIterations, timer.elapsedMicros(), "pixels");
+
+		surface.free();
+	}
+
+	void benchFormats(const char *kernelName, uint32 featureMask) {
+		Common::setCPUFeatureMask(featureMask);
+
+		benchFormat("565", kernelName, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		benchFormat("ARGB8888", kernelName, Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24));
+	}
+
+public:
+	void setUp() {
+		uint32 seed = 1;
+		for (int i = 0; i < kWidth * kHeight; ++i) {
+			seed = seed * 1103515245 + 12345;
+			_y[i] = seed >> 16;
+		}
+		for (int i = 0; i < kWidth * kHeight / 4; ++i) {
+			seed = seed * 1103515245 + 12345;
+			_u[i] = seed >> 16;
+			_v[i] = seed >> 24;
+		}
+	}
+
+	void tearDown() {
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+	}
+
+	void test_yuv_to_rgb() {
+		const bool hasSSE2 = Common::hasCPUFeature(Common::kCPUFeatureSSE2);
+		const bool hasAVX2 = Common::hasCPUFeature(Common::kCPUFeatureAVX2);
+		const bool hasNEON = Common::hasCPUFeature(Common::kCPUFeatureNEON);
+
+		benchFormats("Tables", 0);
+		if (hasSSE2)
+			benchFormats("SSE2", Common::kCPUFeatureSSE2);
+		if (hasAVX2)
+			benchFormats("AVX2", Common::kCPUFeatureAVX2);
+		if (hasNEON)
+			benchFormats("NEON", Common::kCPUFeatureNEON);
+	}
+};
@@ -3,10 +3,14 @@
 # Use the 'test' target to run them.
 # Edit TESTS and TESTLIBS to add more tests.
 #
+# Benchmarks live next to the tests in files named *_bench.h. They are
+# not part of the 'test' target; use the 'bench' target to run them.
+#
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
-TEST_LIBS    := audio/libaudio.a common/libcommon.a
+TESTS        := $(filter-out %_bench.h,$(wildcard $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h))
+BENCHES      := $(wildcard $(srcdir)/test/common/*_bench.h $(srcdir)/test/audio/*_bench.h $(srcdir)/test/graphics/*_bench.h)
+TEST_LIBS    := audio/libaudio.a graphics/libgraphics.a common/libcommon.a
 
 #
 TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh --include=$(srcdir)/test/cxxtest_mingw.h
@@ -34,9 +38,17 @@ test/runner.cpp: $(TESTS)
 	@mkdir -p test
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
+bench: test/bench_runner
+	./test/bench_runner
+test/bench_runner: test/bench_runner.cpp $(TEST_LIBS)
+	$(QUIET_LINK)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) $(TEST_CFLAGS) -o $@ $+ $(TEST_LDFLAGS)
+test/bench_runner.cpp: $(BENCHES)
+	@mkdir -p test
+	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
+
 
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner test/bench_runner.cpp test/bench_runner
 
-.PHONY: test clean-test
+.PHONY: test bench clean-test
@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/readaheadstream.h"
 #include "common/stream.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -233,6 +234,13 @@ void AviDecoder::handleStreamHeader() {
 bool AviDecoder::loadStream(Common::SeekableReadStream *stream) {
 	close();
 
+	// The chunks are read in file order, so loading ahead in the
+	// background keeps the frame deadlines from waiting for the disk
+	if (!stream->isResident()) {
+		stream = new Common::AsyncReadAheadStream(stream, Common::AsyncReadAheadStream::kVideoBlockSize,
+				Common::AsyncReadAheadStream::kVideoBlocks, DisposeAfterUse::YES);
+	}
+
 	_fileStream = stream;
 	_decodedHeader = false;
 
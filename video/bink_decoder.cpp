@@ -29,6 +29,7 @@
 #include "common/util.h"
 #include "common/textconsole.h"
 #include "common/math.h"
+#include "common/readaheadstream.h"
 #include "common/stream.h"
 #include "common/file.h"
 #include "common/str.h"
@@ -82,6 +83,7 @@ BinkDecoder::AudioTrack::~AudioTrack() {
 
 BinkDecoder::BinkDecoder() {
 	_bink = 0;
+	_readAhead = 0;
 	_audioTrack = 0;
 
 	for (int i = 0; i < 16; i++)
@@ -143,6 +145,7 @@ void BinkDecoder::close() {
 	}
 
 	delete _bink; _bink = 0;
+	_readAhead = 0;
 	_surface.free();
 
 	_audioTrack = 0;
@@ -186,6 +189,10 @@ const Graphics::Surface *BinkDecoder::decodeNextFrame() {
 	if (!_bink->seek(frame.offset))
 		error("Bad bink seek");
 
+	// Ask for the next frame while this one is being decoded
+	if (_readAhead && (uint32)_curFrame + 2 < _frames.size())
+		_readAhead->willNeed(_frames[_curFrame + 2].offset, _frames[_curFrame + 2].size);
+
 	uint32 frameSize = frame.size;
 
 	for (uint32 i = 0; i < _audioTracks.size(); i++) {
@@ -528,6 +535,16 @@ bool BinkDecoder::loadStream(Common::SeekableReadStream *stream) {
 	}
 
 	_frameRate = Common::Rational(frameRateNum, frameRateDen);
+
+	// Load the frames in the background, so that the frame deadlines are
+	// not missed waiting for the disk
+	if (!stream->isResident()) {
+		_readAhead = new Common::AsyncReadAheadStream(stream, Common::AsyncReadAheadStream::kVideoBlockSize,
+				Common::AsyncReadAheadStream::kVideoBlocks, DisposeAfterUse::YES);
+		_readAhead->seek(stream->pos());
+		stream = _readAhead;
+	}
+
 	_bink = stream;
 
 	_videoFlags = _bink->readUint32LE();
@@ -39,6 +39,7 @@
 #include "video/video_decoder.h"
 
 namespace Common {
+	class AsyncReadAheadStream;
 	class SeekableReadStream;
 	class BitStream;
 	class Huffman;
@@ -210,6 +211,8 @@ private:
 	};
 
 	Common::SeekableReadStream *_bink;
+	/** Wraps the file, unless it is in memory already; same as _bink then. */
+	Common::AsyncReadAheadStream *_readAhead;
 
 	uint32 _id; ///< The BIK FourCC.
 
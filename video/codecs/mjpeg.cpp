@@ -49,23 +49,29 @@ JPEGDecoder::~JPEGDecoder() {
 }
 
 const Graphics::Surface *JPEGDecoder::decodeImage(Common::SeekableReadStream* stream) {
+	// Once the size of the frames is known, decode straight into the frame
+	// surface
+	if (_surface) {
+		if (!_jpeg->read(stream, _surface)) {
+			warning("Failed to decode JPEG frame");
+			return 0;
+		}
+
+		return _surface;
+	}
+
 	if (!_jpeg->read(stream)) {
 		warning("Failed to decode JPEG frame");
 		return 0;
 	}
 
-	if (!_surface) {
-		_surface = new Graphics::Surface();
-		_surface->create(_jpeg->getWidth(), _jpeg->getHeight(), _pixelFormat);
-	}
+	_surface = new Graphics::Surface();
+	_surface->create(_jpeg->getWidth(), _jpeg->getHeight(), _pixelFormat);
 
-	Graphics::Surface *frame = _jpeg->getSurface(_pixelFormat);
-	assert(frame);
-
-	_surface->copyFrom(*frame);
-
-	frame->free();
-	delete frame;
+	if (!_jpeg->convertTo(_surface)) {
+		warning("Failed to convert JPEG frame");
+		return 0;
+	}
 
 	return _surface;
 }
@@ -35,6 +35,7 @@
 #include "common/debug.h"
 #include "common/endian.h"
 #include "common/memstream.h"
+#include "common/readaheadstream.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "common/util.h"
@@ -323,6 +324,13 @@ bool QuickTimeDecoder::loadFile(const Common::String &filename) {
 }
 
 bool QuickTimeDecoder::loadStream(Common::SeekableReadStream *stream) {
+	// The samples of the tracks are mostly interleaved in playback order,
+	// so loading the file ahead in the background hides the disk latency
+	if (!stream->isResident()) {
+		stream = new Common::AsyncReadAheadStream(stream, Common::AsyncReadAheadStream::kVideoBlockSize,
+				Common::AsyncReadAheadStream::kVideoBlocks, DisposeAfterUse::YES);
+	}
+
 	if (!Common::QuickTimeParser::parseStream(stream))
 		return false;
 
@@ -28,6 +28,7 @@
 
 #include "common/endian.h"
 #include "common/util.h"
+#include "common/readaheadstream.h"
 #include "common/stream.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -353,6 +354,7 @@ SmackerDecoder::SmackerDecoder(Audio::Mixer *mixer, Audio::Mixer::SoundType soun
 	: _audioStarted(false), _audioStream(0), _mixer(mixer), _soundType(soundType) {
 	_surface = 0;
 	_fileStream = 0;
+	_readAhead = 0;
 	_dirtyPalette = false;
 }
 
@@ -370,6 +372,14 @@ uint32 SmackerDecoder::getElapsedTime() const {
 bool SmackerDecoder::loadStream(Common::SeekableReadStream *stream) {
 	close();
 
+	// Load the frames in the background, so that the frame deadlines are
+	// not missed waiting for the disk.
+	if (!stream->isResident()) {
+		_readAhead = new Common::AsyncReadAheadStream(stream, Common::AsyncReadAheadStream::kVideoBlockSize,
+				Common::AsyncReadAheadStream::kVideoBlocks, DisposeAfterUse::YES);
+		stream = _readAhead;
+	}
+
 	_fileStream = stream;
 
 	// Read in the Smacker header
@@ -497,6 +507,7 @@ void SmackerDecoder::close() {
 
 	delete _fileStream;
 	_fileStream = 0;
+	_readAhead = 0;
 
 	_surface->free();
 	delete _surface;
@@ -522,6 +533,10 @@ const Graphics::Surface *SmackerDecoder::decodeNextFrame() {
 
 	_curFrame++;
 
+	// Ask for the next frame while this one is being decoded
+	if (_readAhead && (uint32)_curFrame + 1 < _frameCount)
+		_readAhead->willNeed(startPos + (_frameSizes[_curFrame] & ~3), _frameSizes[_curFrame + 1] & ~3);
+
 	// Check if we got a frame with palette data, and
 	// call back the virtual setPalette function to set
 	// the current palette
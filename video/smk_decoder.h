@@ -34,6 +34,7 @@ class QueuingAudioStream;
 }
 
 namespace Common {
+class AsyncReadAheadStream;
 class SeekableReadStream;
 }
 
@@ -79,6 +80,8 @@ public:
 protected:
 	Common::Rational getFrameRate() const { return _frameRate; }
 	Common::SeekableReadStream *_fileStream;
+	// Wraps the file, unless it is in memory already; same as _fileStream then
+	Common::AsyncReadAheadStream *_readAhead;
 
 protected:
 	void unpackPalette();